@@ -1,9 +1,30 @@
+%getTreeLenDist will get the trunk length and height of the lineage tree
+%of every clonotype, walking the parent links of all clonotypes of a file in
+%1 ancMapMEX call. Each link is as long as the child's SHM count, which is
+%counted against its RefSeq (the parent's Seq).
+%
+%  S = getTreeLenDist(S)
+%
+%  S = getTreeLenDist(S, SizeFilter)
+%
+%  INPUT
+%    S: structure of BRILIA output files
+%    SizeFilter: clonotype filter of getGrpIdx (ex: 'AC', 'BC')
+%
+%  OUTPUT
+%    S: input with the added field
+%      .TreeLenDist = Gx3 matrix of [GermToRoot Height TrunkLen] per
+%        clonotype, as a fraction of the seq length. GermToRoot is from the
+%        germline to the 1st seq, Height is from the 1st seq to the furthest
+%        descendant, and TrunkLen is from the 1st seq to the 1st branch.
+%
+%  See also ancMapMEX, getGrpIdx
 
-function S = getTrunkData(S, varargin)
-if ~isfield(S, 'TrunkData')
-    S(1).TrunkData = [];
+function S = getTreeLenDist(S, varargin)
+if ~isfield(S, 'TreeLenDist')
+    S(1).TreeLenDist = [];
 end
-parfor f = 1:length(S)
+for f = 1:length(S)
     Map = getVDJmapper(S(f).VDJheader);
     SeqIdx = nonzeros(vertcat(Map.hSeq, Map.lSeq));
     
@@ -12,18 +33,18 @@ parfor f = 1:length(S)
     MutNames = FieldNames(MutLoc);
     MutIdx = nonzeros(cellfun(@(x) Map.(x), MutNames));
     
-    G = getGrpIdx(S(f).VDJdata, S(f),VDJheader, varargin{:});
-    
-    TrunkData = zeros(length(G), 2); %TrunkDist(Germ-2-Ancestor) and TreeHeight (Ancestor to furthest one);
-    for j = 1:length(G)
-        AllSHM = sum(cell2mat(VDJdata(G(j).Idx, MutIdx)), 2);
-        SeqLen = sum(cellfun('length', VDJdata(G(j).Idx(1), SeqIdx)), 2);
-        TrunkData(j, 1) = AllSHM(1) / SeqLen;
-        TrunkData(j, 2) = (max(AllSHM) - AllSHM(1)) / SeqLen;
-    end
-    S(f).TrunkData = TrunkData;
+    G = getGrpIdx(S(f).VDJdata, S(f).VDJheader, varargin{:});
+    RowIdx = cell2mat(cellfun(@(x) x(:), {G.Idx}', 'un', 0));
+    FirstIdx = arrayfun(@(x) x.Idx(1), G(:));
+
+    AllSHM = sum(cell2mat(S(f).VDJdata(RowIdx, MutIdx)), 2);
+    AncMap = [cell2mat(S(f).VDJdata(RowIdx, [Map.SeqNum Map.ParNum])) AllSHM];
+    TreeStat = ancMapMEX('stat', AncMap, repelem((1:length(G))', [G.Size]));
+
+    SeqLen = sum(cellfun('length', S(f).VDJdata(FirstIdx, SeqIdx)), 2);
+    GermToRoot = sum(cell2mat(S(f).VDJdata(FirstIdx, MutIdx)), 2);
+    S(f).TreeLenDist = [GermToRoot TreeStat(:, [4 5])] ./ SeqLen;
 end
-    
 % 
 % function getTreeLenDist_Local(InFileName)
 % 
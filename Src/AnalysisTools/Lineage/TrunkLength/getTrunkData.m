@@ -1,17 +1,23 @@
 %getTreeSpecs will get the lineage tree summary data, such as tree trunk
-%lengths, heights, nodes, and leaves. 
+%lengths, heights, nodes, and leaves. The nodes and leaves of all the
+%clonotypes of a file are counted in 1 ancMapMEX call.
 %
 %  S = getTrunkData(S)
 %
+%  S = getTrunkData(S, SizeFilter)
+%
 %  INPUT
 %    S: structure of BRILIA output files
+%    SizeFilter: clonotype filter of getGrpIdx (ex: 'AC', 'BC')
 %
 %  OUTPUT
 %    S: input with added fields 
-%      .TreeTrunks = germline to 1st ancestor hamming %
-%      .TreeHeights = ancestor to furthest descendant hamming %
-%      .TreeNodes = number of nodes per clonotype
-%      .TreeLeaves = number of leaves per clonotype
+%      .TreeSpecs.Trunks = germline to 1st ancestor hamming %
+%      .TreeSpecs.Heights = ancestor to furthest descendant hamming %
+%      .TreeSpecs.Nodes = number of nodes per clonotype
+%      .TreeSpecs.Leaves = number of leaves per clonotype
+%
+%  See also ancMapMEX, getGrpIdx
 %
 function S = getTreeSpecs(S, varargin)
 if ~isfield(S, 'TreeSpecs') 
@@ -38,9 +44,14 @@ for f = 1:length(S)
     for j = 1:length(G)
         AllSHM = sum(cell2mat(S(f).VDJdata(G(j).Idx, MutIdx)), 2);
         SeqLen = sum(cellfun('length', S(f).VDJdata(G(j).Idx(1), SeqIdx)), 2);
-        TrunkData(j, 1) = AllSHM(1) / SeqLen;
-        TrunkData(j, 2) = (max(AllSHM) - AllSHM(1)) / SeqLen;
+        S(f).TreeSpecs.Trunks(j)  = AllSHM(1) / SeqLen;
+        S(f).TreeSpecs.Heights(j) = (max(AllSHM) - AllSHM(1)) / SeqLen;
     end
-    S(f).TrunkData = TrunkData;
+
+    %Count the nodes and leaves of every group at once, in the order of G
+    RowIdx = cell2mat(cellfun(@(x) x(:), {G.Idx}', 'un', 0));
+    AncMap = cell2mat(S(f).VDJdata(RowIdx, [Map.SeqNum Map.ParNum]));
+    TreeStat = ancMapMEX('stat', AncMap, repelem((1:length(G))', [G.Size]));
+    S(f).TreeSpecs.Nodes  = TreeStat(:, 1);
+    S(f).TreeSpecs.Leaves = TreeStat(:, 2);
 end
-    
\ No newline at end of file
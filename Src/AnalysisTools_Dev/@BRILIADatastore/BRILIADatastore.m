@@ -34,10 +34,19 @@
 %      Sets the file grouping by Options ['file', 'dir'] and using regular
 %      expression defined by Format, such as 'Grp#'.
 %
+%    [GrpNum, Key, Count, Sum] = groupCount(O, KeyVars, SumVars, By)
+%      Counts the rows and sums the SumVars numbers per unique KeyVars
+%      value (ex: gene name) in each group (By = 'group') or file (By =
+%      'file'), using all files at once (see dlmStoreMEX).
+%
 %  NOTE
 %    When handling multiple data files, ALL data files MUST have the SAME
 %    number of columns, in the SAME order. This is not an issue for
 %    individual files.
+%
+%    The files are kept memory-mapped by dlmStoreMEX, and only the
+%    SelectedVariableNames columns are parsed by read and readall. The
+%    datastore is used for the file list, variable names, and formats.
 
 classdef BRILIADatastore < handle
     properties (AbortSet, Access = public, Dependent)
@@ -55,6 +64,9 @@ classdef BRILIADatastore < handle
         CtrlGroupName     %Control group name or number
         Diversity struct  %Graphics array of clonotype data of all files
         DataObj cell      %Struct of cell array data of frequency data
+        Handle            %dlmStoreMEX handles of the HandleFile
+        HandleFile        %Cell array of file names opened by dlmStoreMEX
+        ReadIdx = 0       %Number of the last file read by read
     end
     
     properties (Access = public)
@@ -87,6 +99,7 @@ classdef BRILIADatastore < handle
             O.VDJheader = readDlmFile(O.DS.Files{1}, 'LineRange', 1);
             O.Map = getVDJmapper(O.VDJheader);
             O.fixTextscanFormats; %Needs to be prevent error reading char as a number.
+            O.openFiles;
             O.Idx = cell(length(O.Files), 1); %Get the group indices once
             for f = 1:numel(O.Files)
                 GrpNum = read(O, O.Map.GrpNum); 
@@ -100,14 +113,15 @@ classdef BRILIADatastore < handle
         function [Data, Map, VariableNames] = read(O, varargin)
             %Reads the data file-by-file, starting after last read file. 
             [Data, Map, VariableNames] = deal([]);
-            if ~O.DS.hasdata
+            if O.ReadIdx >= numel(O.Files)
                 fprintf('%s: End of file reached. Use "reset" to go to the beginning.\n', mfilename);
                 return
             end
             if ~isempty(varargin)
                 O.SelectedVariableNames = varargin;
             end
-            Data = table2cell(read(O.DS));
+            O.ReadIdx = O.ReadIdx + 1;
+            Data = O.readFile(O.ReadIdx);
             if nargout >= 2
                 VariableNames = O.SelectedVariableNames;
                 Map = getVDJmapper(VariableNames);
@@ -117,13 +131,14 @@ classdef BRILIADatastore < handle
                 
         function [Data, Map, VariableNames] = readall(O, varargin)
             %Reads all data, starting from the beggining
-            O.SelectedVariableNames(varargin{:});
-            O.DS.reset;
+            if ~isempty(varargin)
+                O.SelectedVariableNames = varargin;
+            end
             Data = cell(size(O.DS.Files));
-            for j = 1:size(Data, 1)
-                Data{j} = table2cell(read(O.DS));
+            for j = 1:numel(Data)
+                Data{j} = O.readFile(j);
             end
-            O.DS.reset;
+            O.reset;
             if nargout >= 2
                 VariableNames = O.SelectedVariableNames;
                 Map = getVDJmapper(VariableNames);
@@ -134,6 +149,22 @@ classdef BRILIADatastore < handle
         function reset(O)
             %Resets the datastore to start from the beginning of the files
             O.DS.reset;
+            O.ReadIdx = 0;
+        end
+        
+        function [GrpNum, Key, Count, Sum] = groupCount(O, KeyVars, SumVars, By)
+            %Counts rows and sums SumVars per unique KeyVars in each group or file
+            if nargin < 3
+                SumVars = [];
+            end
+            if nargin < 4 || strcmpi(By, 'group')
+                FileGrpNum = O.Group(:)';
+            elseif strcmpi(By, 'file')
+                FileGrpNum = 1:numel(O.Files);
+            else
+                error('%s: By must be ''group'' or ''file''.', mfilename);
+            end
+            [GrpNum, Key, Count, Sum] = dlmStoreMEX('groupby', O.Handle, KeyVars, SumVars, FileGrpNum);
         end
         
         joinFiles(O, Option, Level); 
@@ -164,6 +195,7 @@ classdef BRILIADatastore < handle
         
         function set.Files(O, Files)
             O.DS.Files = Files;
+            O.openFiles;
         end
         
         function Files = get.Files(O)
@@ -343,8 +375,11 @@ classdef BRILIADatastore < handle
         end           
         
         function delete(O)
-            %Closes all plots before deleting BRILIADatastore
+            %Closes all plots and files before deleting BRILIADatastore
             O.close;
+            if ~isempty(O.Handle)
+                dlmStoreMEX('close', O.Handle);
+            end
         end
                 
         function saveData(O, SaveDir)
@@ -446,6 +481,30 @@ classdef BRILIADatastore < handle
             O.DS.TextscanFormats(CharIdx) = {'%q'}; %Correct the GeneNum "[# # #]" formats to Str. This will no longer be used in future releases.
         end
         
+        function openFiles(O)
+            %Maps the files with dlmStoreMEX, reusing the handles of files already open
+            Files = O.Files;
+            Handle = zeros(1, numel(Files));
+            [IsOpen, OpenIdx] = ismember(Files, O.HandleFile);
+            Handle(IsOpen) = O.Handle(OpenIdx(IsOpen));
+            CloseLoc = ~ismember(O.HandleFile, Files);
+            if any(CloseLoc)
+                dlmStoreMEX('close', O.Handle(CloseLoc));
+            end
+            for f = find(~IsOpen(:)')
+                Handle(f) = dlmStoreMEX('open', Files{f});
+            end
+            O.Handle = Handle;
+            O.HandleFile = Files;
+        end
+        
+        function Data = readFile(O, f)
+            %Reads the SelectedVariableNames of the fth file, with the numeric TextscanFormats as double
+            [~, ColIdx] = ismember(O.SelectedVariableNames, O.DS.VariableNames);
+            NumIdx = find(~ismember(O.DS.TextscanFormats, {'%q', '%s'}));
+            Data = dlmStoreMEX('read', O.Handle(f), ColIdx, NumIdx);
+        end
+        
         function ObjNum = findDataObj(O, DataNameOrNum)
             %Finds the number of the DataObj based on data name or number
             if isnumeric(DataNameOrNum)
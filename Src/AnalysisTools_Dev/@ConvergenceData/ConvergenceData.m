@@ -10,6 +10,7 @@
 %    plotKmerProp(AtoP) for reduced-letter kmers
 %    plotDendrogram plots reperotire similarity by ...
 %    plotCDR3LineConvergence 
+%    getClusterData(K) clusters CDR3s within K mismatches across repertoires
 %    
 %    savePlot: saves the current plot
 %    saveData: saves the current data
@@ -21,6 +22,8 @@
 %    ModData.Kmer: MxMxY matrix of overlap Kmer Freq for Y unique 
 %    ModData.CDR3Prop: MxM 
 %    ModData.KmerProp: MxMxY matrix of overlap kmer properties for Y unique ...
+%    ModData.Cluster: struct of the Incidence (repertoire x cluster sparse
+%      matrix of weights) and ClustSeq of the CDR3 clusters (see findConvCDR3)
 %
 %  NOTE: this is done for ALL lineages PER REPERTOIRE
 %
@@ -102,7 +105,7 @@ classdef ConvergenceData < DataInterface
                 Fields = Fields(endsWith(Fields, 'CDR3', 'ignorecase', true));
                 if strcmpi(Alphabet, 'prop')
                     for j = 1:numel(Fields)
-                        O.ModData(f).(Fields{j}) = cellfun(@convAA2PropMEX, O.ModData(f).(Fields{j})([G.Idx]'), 'un', 0);
+                        O.ModData(f).(Fields{j}) = convSeq2PropMEX(O.ModData(f).(Fields{j})([G.Idx]'));
                     end
                 else
                     for j = 1:numel(Fields)
@@ -224,5 +227,15 @@ classdef ConvergenceData < DataInterface
         function getHeatmapData(O)
             O.ModData.Heatmap = calcConvMatrix(O.ModData.Data{:});
         end
+
+        %ClusterData stores the CDR3 clusters shared by repertoires, where
+        %CDR3s of the same length differing by <= K letters are linked.
+        function getClusterData(O, K)
+            if nargin < 2
+                K = 0;
+            end
+            [Incidence, ClustSeq] = findConvCDR3(O.ModData.Data{:}, K);
+            O.ModData.Cluster = struct('Incidence', Incidence, 'ClustSeq', {ClustSeq}, 'K', K);
+        end
     end
 end
\ No newline at end of file
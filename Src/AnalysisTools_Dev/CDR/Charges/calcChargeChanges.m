@@ -26,8 +26,7 @@ for k = 1:length(CDRs)
         DeltaCharge = zeros(length(G(y).Idx), 1);
         for j = 1:length(G(y).Idx)
             RefSeq = VDJdata{G(y).Idx(j), Map.hRefSeq};
-            RefCDR = nt2aa(RefSeq(CDRbgn:CDRend), 'acgtonly', false);
-            RefProp = convAA2PropMEX(RefCDR);%;, ReducedLetter);
+            RefProp = convSeq2PropMEX(RefSeq(CDRbgn:CDRend), 'nt');
 
             CDR = VDJdata{G(y).Idx(j), Map.(CDRs{k})};
             Prop = convAA2PropMEX(CDR);%, ReducedLetter);
@@ -35,7 +34,7 @@ for k = 1:length(CDRs)
             
             [~, DeltaCharge(j)] = convProp2Charge(RefProp, Prop);
         end
-        ChargeChanges.(CDRs{k})(y, :) = {length(RefCDR) DeltaCharge(DeltaCharge ~= 0)};        
+        ChargeChanges.(CDRs{k})(y, :) = {length(RefProp) DeltaCharge(DeltaCharge ~= 0)};        
     end
 end
 
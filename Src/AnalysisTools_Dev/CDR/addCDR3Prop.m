@@ -36,15 +36,16 @@ for f = 1:length(FileNames)
 
     AddData = cell(size(VDJdata, 1), length(AddHeader));
     CDR3Seq = VDJdata(:, Map.hCDR3(1));
-    AddData(:, contains(AddHeader, 'H-CDR3_Code')) = cellfun(@convAA2PropMEX, CDR3Seq, 'unif', false);
+    [Code, ~, Charge, HPI] = convSeq2PropMEX(CDR3Seq, 'aa', 1, [7 6 5]); %Charge(:, k) is at the k-th pH
+    AddData(:, contains(AddHeader, 'H-CDR3_Code')) = Code;
     AddData(:, contains(AddHeader, 'H-CDR3_MW'))   = num2cell(calcMW(CDR3Seq));
     AddData(:, contains(AddHeader, 'H-CDR3_VDWV')) = num2cell(calcVDWV(CDR3Seq));
-    AddData(:, contains(AddHeader, 'H-CDR3_Hydropathicity')) = num2cell(calcHPI(CDR3Seq));
+    AddData(:, contains(AddHeader, 'H-CDR3_Hydropathicity')) = num2cell(HPI);
     AddData(:, contains(AddHeader, 'H-CDR3_Aromaticity'))    = num2cell(calcAromaticity(CDR3Seq));
     AddData(:, contains(AddHeader, 'H-CDR3_Aliphaticity'))   = num2cell(calcAliphaticity(CDR3Seq));
-    AddData(:, contains(AddHeader, 'H-CDR3_pH7Charge')) = num2cell(calcCharge(CDR3Seq, 'pH', 7, 'IncludeTerminus', false));
-    AddData(:, contains(AddHeader, 'H-CDR3_pH6Charge')) = num2cell(calcCharge(CDR3Seq, 'pH', 6, 'IncludeTerminus', false));
-    AddData(:, contains(AddHeader, 'H-CDR3_pH5Charge')) = num2cell(calcCharge(CDR3Seq, 'pH', 5, 'IncludeTerminus', false));
+    AddData(:, contains(AddHeader, 'H-CDR3_pH7Charge')) = num2cell(Charge(:, 1));
+    AddData(:, contains(AddHeader, 'H-CDR3_pH6Charge')) = num2cell(Charge(:, 2));
+    AddData(:, contains(AddHeader, 'H-CDR3_pH5Charge')) = num2cell(Charge(:, 3));
 
     %Overwrite and/or add the new data
     [~, DelThese] = intersect(VDJheader, AddHeader);
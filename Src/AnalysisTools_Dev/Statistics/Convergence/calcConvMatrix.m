@@ -51,33 +51,32 @@ for j = 1:nargin
         Weight{j} = ones(size(Data{j}));
     end
 end
-[UnqSeq, UnqIdx] = getUnqSeq(Data);
-Lookup = getLookup(Data, UnqSeq, UnqIdx);
+Lookup = getLookup(Data);
 LookupWeight = lookupData(Data, Lookup, Weight);
 Out = calcConv(Data, Weight, Lookup, LookupWeight);
 
-function [UnqSeq, UnqIdx] = getUnqSeq(Data)
+%Create a NxN cell of indices of overlapping entities. The entities of all
+%Data are numbered at once by clusterSeqMEX, so that overlaps are found by
+%intersecting numbers instead of sequences.
+function Lookup = getLookup(Data)
 N = numel(Data);
-UnqSeq = cell(N, 1);
+NumSeq = cellfun('length', Data);
+ClustNum = mat2cell(clusterSeqMEX(vertcat(Data{:}), 0), NumSeq, 1);
+UnqNum = cell(N, 1);
 UnqIdx = cell(N, 1);
 for f = 1:N
-    [UnqSeq{f}, ~, ~, UnqIdx{f}] = unique2(Data{f});
+    [UnqNum{f}, ~, GrpIdx] = unique(ClustNum{f});
+    UnqIdx{f} = accumarray(GrpIdx, (1:numel(GrpIdx))', [numel(UnqNum{f}) 1], @(x) {sort(x)});
 end
 
-%Create a NxN cell of indices of overlapping entities
-function Lookup = getLookup(Data, UnqSeq, UnqIdx)
-N = numel(Data);
 Lookup = cell(N);
-fprintf('%s: Finding overlaps: %d...', mfilename, 1);
 for r = 2:N
-    fprintf('%d...', r);
     for c = 1:r-1
-        [~, IA, IB] = intersect(UnqSeq{r}, UnqSeq{c});
+        [~, IA, IB] = intersect(UnqNum{r}, UnqNum{c});
         Lookup{r, c} = UnqIdx{r}(IA);
         Lookup{c, r} = UnqIdx{c}(IB);
     end
 end
-fprintf('\n');
 
 %Generates a NxN cell array, replacing index in Lookup with the value in T
 function Out = lookupData(Data, Lookup, T)
@@ -0,0 +1,59 @@
+%findConvCDR3 will find the convergent CDR3s of many repertoires, which are
+%CDR3s that are identical or differ by at most K letters, using
+%clusterSeqMEX on all repertoires at once. Returns the repertoire x cluster
+%incidence matrix of the weights of each CDR3 cluster.
+%
+%  [Incidence, ClustSeq, ClustNum] = findConvCDR3(Data1, ..., DataN)
+%
+%  [Incidence, ClustSeq, ClustNum] = findConvCDR3(Data1, ..., DataN, K)
+%
+%  INPUT
+%    DataN: Mx2 cell where col 1 is the CDR3 (aa or property code), col 2
+%      is the weight of that CDR3. A Mx1 cell uses a weight of 1.
+%    K [0]: max number of mismatched letters between linked CDR3s of the
+%      same length (see clusterSeqMEX)
+%
+%  OUTPUT
+%    Incidence: NxC sparse matrix of the summed weights of each of the C
+%      CDR3 clusters in each of the N repertoires
+%    ClustSeq: Cx1 cell of the 1st CDR3 of each cluster
+%    ClustNum: 1xN cell of the Mx1 cluster number of each CDR3 of DataN
+%
+%  EXAMPLE
+%    Mat{1} = {'CARDYW' 1; 'CTTW' 2};
+%    Mat{2} = {'CARDFW' 3; 'CAKEFW' 1};
+%    [Incidence, ClustSeq] = findConvCDR3(Mat{:}, 1);
+%    full(Incidence)
+%    ans =
+%         1     2     0
+%         3     0     1
+%    ClustSeq(sum(Incidence > 0, 1) > 1)  %convergent CDR3s
+%    ans =
+%      1x1 cell array
+%        {'CARDYW'}
+%
+%  See also clusterSeqMEX, calcConvMatrix, ConvergenceData
+
+function [Incidence, ClustSeq, ClustNum] = findConvCDR3(varargin)
+K = 0;
+if nargin > 1 && isnumeric(varargin{end})
+    K = varargin{end};
+    varargin = varargin(1:end-1);
+end
+N = numel(varargin);
+Data = cell(N, 1);
+Weight = cell(N, 1);
+for j = 1:N
+    Data{j} = varargin{j}(:, 1);
+    if size(varargin{j}, 2) == 2
+        Weight{j} = cell2mat(varargin{j}(:, 2));
+    else
+        Weight{j} = ones(size(Data{j}));
+    end
+end
+
+NumSeq = cellfun('length', Data);
+SampleNum = repelem((1:N)', NumSeq);
+[AllClustNum, ClustSeq] = clusterSeqMEX(vertcat(Data{:}), K);
+Incidence = sparse(SampleNum, AllClustNum, vertcat(Weight{:}), N, numel(ClustSeq));
+ClustNum = mat2cell(AllClustNum, NumSeq, 1)';
@@ -174,8 +174,7 @@ end
 Tdata(AncMap(:, 2) ~= 0, Map.ParNum) = Tdata(AncMap(AncMap(:, 2) ~= 0, 2), Map.SeqNum);
 
 %Determine the number of children per each sequence
-for k = 1:size(AncMap, 1)
-    Tdata{k, Map.ChildCount} = length(findChild(AncMap, AncMap(k, 1)));
-end
+[~, ~, ChildCount] = ancMapMEX('child', AncMap, []);
+Tdata(:, Map.ChildCount) = num2cell(ChildCount);
 
 Tdata(:, Map.GrpNum) = num2cell(AncMap(:, 4));
@@ -0,0 +1,45 @@
+%collapseVDJdata will keep only the 1st copy of identical reads (same Seq
+%and overhang seqs, ignoring case) so that each unique read is annotated
+%once. Reads that were annotated in past batches and kept by expandVDJdata
+%are removed too. Use expandVDJdata after the annotation to copy the
+%results back to all reads.
+%
+%  [VDJdata, KeepLoc, Dup] = collapseVDJdata(VDJdata, Map, KeepLoc)
+%
+%  INPUT
+%    VDJdata: main BRILIA data cell
+%    Map: structure of VDJdata column indices (see getVDJmapper)
+%    KeepLoc: Mx1 logical of reads to annotate. Other reads are not
+%      collapsed.
+%
+%  OUTPUT
+%    VDJdata: VDJdata with only the 1st copy of each unique read, in the
+%      original order
+%    KeepLoc: KeepLoc of the collapsed VDJdata
+%    Dup: structure needed by expandVDJdata
+%
+%  See also expandVDJdata, findUniqueSeqMEX
+
+function [VDJdata, KeepLoc, Dup] = collapseVDJdata(VDJdata, Map, KeepLoc)
+Dup.Num = size(VDJdata, 1);
+Dup.IdCol = nonzeros([Map.SeqName Map.SeqNum Map.GrpNum Map.Template]); %These belong to each read
+Dup.IdData = VDJdata(:, Dup.IdCol);
+Dup.Seq = VDJdata(:, nonzeros([Map.hSeq Map.hOverSeq5 Map.hOverSeq3 Map.lSeq Map.lOverSeq5 Map.lOverSeq3]));
+
+%Find reads annotated in past batches, then the unique new reads
+Dup.Known = zeros(Dup.Num, 1);
+Dup.Known(KeepLoc) = findUniqueSeqMEX(Dup.Seq(KeepLoc, :), 'find');
+NewIdx = find(KeepLoc & Dup.Known == 0);
+[UnqIdx, GrpIdx] = findUniqueSeqMEX(Dup.Seq(NewIdx, :));
+
+%Src is the row of each read in the collapsed VDJdata, or 0 if known
+Dup.IsRep = zeros(Dup.Num, 1, 'logical');
+Dup.IsRep(NewIdx(UnqIdx)) = 1;
+CollLoc = ~KeepLoc | Dup.IsRep;
+Pos = cumsum(CollLoc);
+Dup.Src = zeros(Dup.Num, 1);
+Dup.Src(~KeepLoc) = Pos(~KeepLoc);
+Dup.Src(NewIdx) = Pos(NewIdx(UnqIdx(GrpIdx)));
+
+VDJdata = VDJdata(CollLoc, :);
+KeepLoc = KeepLoc(CollLoc);
@@ -0,0 +1,48 @@
+%expandVDJdata will copy the annotations of a VDJdata collapsed by
+%collapseVDJdata back to all copies of each read, in the original order.
+%Each read keeps its own SeqName, SeqNum, GroupNum, and TemplateCount. The
+%new unique annotations can also be kept, so that identical reads in later
+%batches are not annotated again.
+%
+%  [VDJdata, Known] = expandVDJdata(VDJdata, VDJheader, Dup, Known)
+%
+%  INPUT
+%    VDJdata: collapsed VDJdata after annotation
+%    VDJheader: main BRILIA header cell
+%    Dup: structure returned by collapseVDJdata
+%    Known: structure of the annotations kept from past batches, with
+%      fields Handle ([] at first, see vdjTableMEX) and MaxBytes. New
+%      unique annotations are added until it uses MaxBytes of memory. Use
+%      [] to not keep any.
+%
+%  OUTPUT
+%    VDJdata: VDJdata with 1 row per read
+%    Known: Known with the new unique annotations
+%
+%  See also collapseVDJdata, findUniqueSeqMEX
+
+function [VDJdata, Known] = expandVDJdata(CVDJdata, VDJheader, Dup, Known)
+if nargin < 4
+    Known = [];
+end
+VDJdata = cell(Dup.Num, size(CVDJdata, 2));
+CollLoc = Dup.Src > 0;
+VDJdata(CollLoc, :) = CVDJdata(Dup.Src(CollLoc), :);
+if ~all(CollLoc)
+    VDJdata(~CollLoc, :) = vdjTableMEX('export', Known.Handle, Dup.Known(~CollLoc));
+end
+VDJdata(:, Dup.IdCol) = Dup.IdData;
+
+%Keep the new unique annotations for the next batches
+RepIdx = find(Dup.IsRep);
+if isempty(Known) || isempty(RepIdx); return; end
+if isempty(Known.Handle)
+    Known.Handle = vdjTableMEX('create', VDJdata(RepIdx, :), VDJheader);
+    NumRow = 0;
+else
+    Info = vdjTableMEX('info', Known.Handle);
+    if Info.Bytes >= Known.MaxBytes; return; end
+    NumRow = Info.NumRow;
+    vdjTableMEX('append', Known.Handle, VDJdata(RepIdx, :));
+end
+findUniqueSeqMEX(Dup.Seq(RepIdx, :), 'add', NumRow + (1:numel(RepIdx))');
@@ -117,64 +117,67 @@ if max(VcutLen) > 0 || max(JcutLen) > 0 %Change probably needed
     end
     
     %Calculate the various D alignment result for all combination of Vcut
-    CompareMat = zeros(length(JcutLen)*length(VcutLen), 7); %[Vcut Jcut Dscore Vscore Jscore NvdScore NdjScore]
-    Dmatch = cell(length(JcutLen)*length(VcutLen), 6);
+    %and Jcut in one findDmatchMEX call
+    [JcutGrid, VcutGrid] = ndgrid(JcutLen, VcutLen);
+    CompareMat = zeros(numel(VcutGrid), 7); %[Vcut Jcut Dscore Vscore Jscore NvdScore NdjScore]
+    CompareMat(:, 1) = VcutGrid(:);
+    CompareMat(:, 2) = JcutGrid(:);
     MissRate = MaxMiss/VconsSeg;
     
-    q = 1;
-    for v = 1:length(VcutLen)
-        for j = 1:length(JcutLen)
-            TestDseg = RefSeq(VMDNJ(1)-VcutLen(v)+1:end-VMDNJ(end)+JcutLen(j));
-            AllowedMiss = ceil(MissRate * length(TestDseg));
-            
-            Dmatch(q, :) = findGeneMatch(TestDseg, DB.Dmap, 'D', AllowedMiss);
-            CompareMat(q, 1) = VcutLen(v);
-            CompareMat(q, 2) = JcutLen(j);
-            CompareMat(q, 3) = Dmatch{q, 5}(2); %Scoring results
-            
-            %Calculate the new V score
-            VconsMatch = ~ConsMiss(1:VMDNJ(1)-VcutLen(v));
-            CompareMat(q, 4) = calcAlignScoreMEX(VconsMatch);
-            
-            %Calculate the new J score
-            JconsMatch = ~ConsMiss(end-VMDNJ(end)+1+JcutLen(j):end);
-            CompareMat(q, 5) = calcAlignScoreMEX(JconsMatch);
-            
-            %Get the new Nvd D Ndj lengths
-            Mlen = Dmatch{q, 4}(1);
-            Dlen = Dmatch{q, 4}(2);
-            Nlen = Dmatch{q, 4}(3);
-            
-            %Calculate TDT score for Nvd
-            Mseq = '';
-            if Mlen >= 1
-                Mseq = RefSeq(VMDNJ(1)-VcutLen(v)+1:VMDNJ(1)-VcutLen(v)+Mlen);
-            end
-            MtdtScore = calcTDTscore(Mseq);
-            if isempty(MtdtScore); MtdtScore = 0; end
-            
-            %Calculate TDT score for Ndj
-            Nseq = '';
-            if Nlen >= 1
-                Nseq = RefSeq(VMDNJ(1)-VcutLen(v)+Mlen+Dlen+1:VMDNJ(1)-VcutLen(v)+Mlen+Dlen+Nlen);
-            end
-            NtdtScore = calcTDTscore(Nseq);
-            if isempty(NtdtScore); NtdtScore = 0; end
-            
-            %Calculate Nscores for Nvd and Ndj
-            CompareMat(q, 6) = (2*MtdtScore - 1)*length(Mseq)^2;
-            CompareMat(q, 7) = (2*NtdtScore - 1)*length(Nseq)^2;
-            
-            q = q+1;
+    TestDseg = cell(size(CompareMat, 1), 1);
+    for q = 1:size(CompareMat, 1)
+        TestDseg{q} = RefSeq(VMDNJ(1)-CompareMat(q, 1)+1:end-VMDNJ(end)+CompareMat(q, 2));
+    end
+    AllowedMiss = min(ceil(MissRate * cellfun('length', TestDseg)), 1); %findGeneMatch caps MissRate at 1
+    M = getMapHeaderVar(DB.MapHeader);
+    [Dnum, DrefLMR, DsamLMR, Dscore] = findDmatchMEX(TestDseg, DB.Dmap(:, M.Seq), AllowedMiss);
+    CompareMat(:, 3) = Dscore(:, 2);
+    CompareMat(cellfun('isempty', Dnum), 3) = -Inf; %No D match
+    
+    for q = 1:size(CompareMat, 1)
+        Vcut = CompareMat(q, 1);
+        Jcut = CompareMat(q, 2);
+        
+        %Calculate the new V score
+        VconsMatch = ~ConsMiss(1:VMDNJ(1)-Vcut);
+        CompareMat(q, 4) = calcAlignScoreMEX(VconsMatch);
+        
+        %Calculate the new J score
+        JconsMatch = ~ConsMiss(end-VMDNJ(end)+1+Jcut:end);
+        CompareMat(q, 5) = calcAlignScoreMEX(JconsMatch);
+        
+        %Get the new Nvd D Ndj lengths
+        Mlen = DsamLMR(q, 1);
+        Dlen = DsamLMR(q, 2);
+        Nlen = DsamLMR(q, 3);
+        
+        %Calculate TDT score for Nvd
+        Mseq = '';
+        if Mlen >= 1
+            Mseq = RefSeq(VMDNJ(1)-Vcut+1:VMDNJ(1)-Vcut+Mlen);
+        end
+        MtdtScore = calcTDTscore(Mseq);
+        if isempty(MtdtScore); MtdtScore = 0; end
+        
+        %Calculate TDT score for Ndj
+        Nseq = '';
+        if Nlen >= 1
+            Nseq = RefSeq(VMDNJ(1)-Vcut+Mlen+Dlen+1:VMDNJ(1)-Vcut+Mlen+Dlen+Nlen);
         end
+        NtdtScore = calcTDTscore(Nseq);
+        if isempty(NtdtScore); NtdtScore = 0; end
+        
+        %Calculate Nscores for Nvd and Ndj
+        CompareMat(q, 6) = (2*MtdtScore - 1)*length(Mseq)^2;
+        CompareMat(q, 7) = (2*NtdtScore - 1)*length(Nseq)^2;
     end
     
     %Determine maximum alignment score for D
     TotScore = sum(CompareMat(:, 3:7), 2);
+    if max(TotScore) == -Inf; return; end %No D match at all
     BestD = TotScore == max(TotScore);
     if sum(BestD) > 1 %Break ties by looking at the D end deletion counts
-        D5D3del = cell2mat(Dmatch(:, 3));
-        MaxDels = max(D5D3del(:, [1 3]), [], 2);
+        MaxDels = max(DrefLMR(:, [1 3]), [], 2);
         BestD = BestD & (MaxDels == min(MaxDels(BestD)));
     end
     BestMatch = find(BestD == 1);
@@ -182,7 +185,8 @@ if max(VcutLen) > 0 || max(JcutLen) > 0 %Change probably needed
     if BestMatch == 1; return; end %no changes needed after all
     
     %Update the necessary informations for the Tdata
-    Dmatch = Dmatch(BestMatch, :);
+    Dname = sprintf('%s|', DB.Dmap{Dnum{BestMatch}, M.Gene});
+    Dmatch = {Dnum{BestMatch}, Dname(1:end-1), DrefLMR(BestMatch, :), DsamLMR(BestMatch, :), Dscore(BestMatch, :)};
     VnewDel = CompareMat(BestMatch, 1); %Nts to trim from V portion
     JnewDel = CompareMat(BestMatch, 2); %Nts to trim from J portion
     VMDNJnew = [VMDNJ(1)-VnewDel  Dmatch{1, 4}  VMDNJ(end)-JnewDel];
@@ -33,154 +33,66 @@ else
     Num = varargin{1};
 end
 
-for n = 1:length(Num)
-    for c = 1:length(Map.Chain)
-        C = lower(Map.Chain(c));
-        switch Num(n)
-            case 1
-                VDJdata = findCDR_Prefilter(VDJdata, Map, DB, C, Num(n));
-            case 2
-                VDJdata = findCDR_Prefilter(VDJdata, Map, DB, C, Num(n));
-            case 3
-                VDJdata = findCDR3_Prefilter(VDJdata, Map, DB, C, Num(n), UseIMGT);
-            otherwise
-                error('%s: Num must be a vector between 1:3', mfilename);
-        end
-    end
-end
-
-function VDJdata = findCDR_Prefilter(VDJdata, Map, DB, C, Num)
-DelIdx = Map.([C 'Del'])(1);
-SeqIdx = Map.([C 'Seq']);
-LenIdx = Map.([C 'Length'])(1);
-GeneIdx = Map.([C 'GeneName'])(1);KeepLoc = ~any(cellfun('isempty', VDJdata(:, [DelIdx; SeqIdx; LenIdx; GeneIdx])), 2);
-
-if strcmpi(C, 'H')
-    VDJdata(KeepLoc, :) = findCDR_Calc(VDJdata(KeepLoc, :), Map, DB, C, 'V', Num);
-else 
-    KLoc = KeepLoc & contains(VDJdata(:, GeneIdx), 'IGKV', 'ignorecase', true);
-    VDJdata(KLoc, :) = findCDR_Calc(VDJdata(KLoc, :), Map, DB, C, 'Vk', Num);
-    
-    LLoc = KeepLoc & contains(VDJdata(:, GeneIdx), 'IGLV', 'ignorecase', true);
-    VDJdata(LLoc, :) = findCDR_Calc(VDJdata(LLoc, :), Map, DB, C, 'Vl', Num);
-end
-
-function VDJdata = findCDR_Calc(VDJdata, Map, DB, C, X, Num)
-DelIdx = Map.([C 'Del'])(1);
-SeqIdx = Map.([C 'Seq']);
-LenIdx = Map.([C 'Length'])(1);
-GeneIdx = Map.([C 'GeneName'])(1);
-CDRIdx = Map.([C 'CDR' num2str(Num)]);
-DBIdx = getGeneNameIdx(VDJdata(:, GeneIdx), DB, X);
-UnqDBIdx = unique(DBIdx);
-M = getMapHeaderVar(DB.MapHeader);
-for j = 1:length(UnqDBIdx)
-    if UnqDBIdx(j) == 0; continue; end
-    RefVLen = length(DB.([X 'map']){UnqDBIdx(j), M.Seq});
-    RefCDRS = DB.([X 'map']){UnqDBIdx(j), M.(sprintf('CDR%ds', Num))};
-    RefCDRE = DB.([X 'map']){UnqDBIdx(j), M.(sprintf('CDR%de', Num))};
-    RefCDR  = nt2aa(DB.([X 'map']){UnqDBIdx(j), M.Seq}(RefCDRS:RefCDRE), 'ACGTonly', false, 'alternativestart', false);
-
-    Idx = find(UnqDBIdx(j) == DBIdx);
-    SeqVLen = cell2mat(VDJdata(Idx, LenIdx));
-    SeqVDel = cell2mat(VDJdata(Idx, DelIdx));
-    
-    Vshift = SeqVLen + SeqVDel - RefVLen;
-    CDRS = Vshift + RefCDRS;
-    CDRE = Vshift + RefCDRE;
-    CDRLen = (CDRE - CDRS + 1) / 3;
-    
-    SeqCDR = cell(size(Idx));
-    for k = 1:length(Idx)
-        if min([CDRS(k) CDRE(k)]) > 0
-            SeqCDR{k} = nt2aa(VDJdata{Idx(k), SeqIdx}(CDRS(k):CDRE(k)), 'ACGTonly', false, 'alternativestart', false);
-            MissLoc = SeqCDR{k} ~= RefCDR;
-            SeqCDR{k}(MissLoc) = lower(SeqCDR{k}(MissLoc));
-        else
-            SeqCDR{k} = RefCDR;
-        end
-    end
-    VDJdata(Idx, CDRIdx) = [SeqCDR num2cell([CDRLen CDRS CDRE])];
+if any(Num < 1 | Num > 3)
+    error('%s: Num must be a vector between 1:3', mfilename);
 end
-        
-function VDJdata = findCDR3_Prefilter(VDJdata, Map, DB, C, Num, UseIMGT)
-DelIdx = Map.([C 'Del'])([1 end]);
-SeqIdx = Map.([C 'Seq']);
-LenIdx = Map.([C 'Length'])([1 end]);
-GeneIdx = Map.([C 'GeneName'])([1 end]);
-KeepLoc = ~any(cellfun('isempty', VDJdata(:, [DelIdx; SeqIdx; LenIdx; GeneIdx])), 2);
 
-if Num < 3
+for c = 1:length(Map.Chain)
+    C = lower(Map.Chain(c));
     if strcmpi(C, 'H')
-        VDJdata(KeepLoc, :) = findCDR_Calc(VDJdata(KeepLoc, :), Map, DB, C, 'V', Num);
-    else 
-        if all(cellfun('isempty', VDJdata(:, GeneIdx(1)))); return; end %Did not annotate light chain yet
-        KLoc = KeepLoc & contains(VDJdata(:, GeneIdx(1)), 'IGKV', 'ignorecase', true);
-        VDJdata(KLoc, :) = findCDR_Calc(VDJdata(KLoc, :), Map, DB, C, 'Vk', Num);
-
-        LLoc = KeepLoc & contains(VDJdata(:, GeneIdx(1)), 'IGLV', 'ignorecase', true);
-        VDJdata(LLoc, :) = findCDR_Calc(VDJdata(LLoc, :), Map, DB, C, 'Vl', Num);
-    end
-else
-    if strcmpi(C, 'H')
-        VDJdata(KeepLoc, :) = findCDR3_Calc(VDJdata(KeepLoc, :), Map, DB, C, 'V', UseIMGT);
-    else 
-        if all(cellfun('isempty', VDJdata(:, GeneIdx(1)))); return; end %Did not annotate light chain yet
-        KLoc = KeepLoc & contains(VDJdata(:, GeneIdx(1)), 'IGKV', 'ignorecase', true);
-        VDJdata(KLoc, :) = findCDR3_Calc(VDJdata(KLoc, :), Map, DB, C, 'Vk', UseIMGT);
-
-        LLoc = KeepLoc & contains(VDJdata(:, GeneIdx(1)), 'IGLV', 'ignorecase', true);
-        VDJdata(LLoc, :) = findCDR3_Calc(VDJdata(LLoc, :), Map, DB, C, 'Vl', UseIMGT);
+        VDJdata = findCDR_Calc(VDJdata, Map, DB, C, 'V', 'J', true(size(VDJdata, 1), 1), Num, UseIMGT);
+    else
+        GeneIdx = Map.([C 'GeneName'])(1);
+        if all(cellfun('isempty', VDJdata(:, GeneIdx))); continue; end %Did not annotate light chain yet
+        KLoc = contains(VDJdata(:, GeneIdx), 'IGKV', 'ignorecase', true);
+        VDJdata = findCDR_Calc(VDJdata, Map, DB, C, 'Vk', 'Jk', KLoc, Num, UseIMGT);
+        
+        LLoc = contains(VDJdata(:, GeneIdx), 'IGLV', 'ignorecase', true);
+        VDJdata = findCDR_Calc(VDJdata, Map, DB, C, 'Vl', 'Jl', LLoc, Num, UseIMGT);
     end
 end
 
-function VDJdata = findCDR3_Calc(VDJdata, Map, DB, C, V, UseIMGT)
-if isempty(VDJdata); return; end
+%Computes the CDRs of the RowLoc rows of VDJdata with findCDRMEX, using the
+%V and J gene database named by V and J.
+function VDJdata = findCDR_Calc(VDJdata, Map, DB, C, V, J, RowLoc, Num, UseIMGT)
 DelIdx = Map.([C 'Del'])([1 end]);
 SeqIdx = Map.([C 'Seq']);
 LenIdx = Map.([C 'Length'])([1 end]);
 GeneIdx = Map.([C 'GeneName'])([1 end]);
-CDRIdx = Map.([C 'CDR3']);
-switch V
-    case 'V'
-        J = 'J';
-    case 'Vk'
-        J = 'Jk';
-    case 'Vl'
-        J = 'Jl';
+M = getMapHeaderVar(DB.MapHeader);
+
+%CDR1/2 need the V info, and CDR3 needs the J info too
+VLoc = RowLoc & ~any(cellfun('isempty', VDJdata(:, [DelIdx(1); SeqIdx; LenIdx(1); GeneIdx(1)])), 2);
+Idx = find(VLoc);
+if isempty(Idx); return; end
+GeneNum = zeros(length(Idx), 2);
+GeneNum(:, 1) = getGeneNameIdx(VDJdata(Idx, GeneIdx(1)), DB, V);
+Idx = Idx(GeneNum(:, 1) > 0);
+GeneNum = GeneNum(GeneNum(:, 1) > 0, :);
+if isempty(Idx); return; end
+
+JLoc = ~any(cellfun('isempty', VDJdata(Idx, [DelIdx(end); LenIdx(end); GeneIdx(end)])), 2);
+LenDel = zeros(length(Idx), 4);
+LenDel(:, 1:2) = cell2mat(VDJdata(Idx, [LenIdx(1) DelIdx(1)]));
+if any(JLoc)
+    GeneNum(JLoc, 2) = getGeneNameIdx(VDJdata(Idx(JLoc), GeneIdx(end)), DB, J);
+    LenDel(JLoc, 3:4) = cell2mat(VDJdata(Idx(JLoc), [LenIdx(end) DelIdx(end)]));
 end
-VDBIdx = getGeneNameIdx(VDJdata(:, GeneIdx(1)),   DB, V);
-JDBIdx = getGeneNameIdx(VDJdata(:, GeneIdx(end)), DB, J);
 
-UnqVDBIdx = unique(VDBIdx);
-M = getMapHeaderVar(DB.MapHeader);
-for j = 1:length(UnqVDBIdx)
-    if UnqVDBIdx(j) == 0; continue; end
-    Idx = find(UnqVDBIdx(j) == VDBIdx);
-    
-    RefVAnchor = DB.([V 'map']){UnqVDBIdx(j), M.Anchor};
-    RefJAnchor = vertcat(DB.([J 'map']){JDBIdx(Idx), M.Anchor});
+%Germline CDR positions and anchors, with 0 for unknown ones
+Vinfo = DB.([V 'map'])(:, [M.CDR1s M.CDR1e M.CDR2s M.CDR2e M.Anchor]);
+Vinfo(cellfun('isempty', Vinfo)) = {0};
+Janchor = DB.([J 'map'])(:, M.Anchor);
+Janchor(cellfun('isempty', Janchor)) = {0};
 
-    SeqLen = cellfun('length', VDJdata(Idx, SeqIdx));
-    SeqVLen = cell2mat(VDJdata(Idx, LenIdx(1)));
-    SeqVDel = cell2mat(VDJdata(Idx, DelIdx(1)));
-    SeqJLen = cell2mat(VDJdata(Idx, LenIdx(end)));
-    SeqJDel = cell2mat(VDJdata(Idx, DelIdx(end)));
-    
-    CDRS = SeqVLen + SeqVDel - RefVAnchor + 1; %Add 1 to ensure it starts on that nt
-    CDRE = SeqLen - (SeqJLen + SeqJDel) + RefJAnchor + 2; %Add 2 to ensure it end on 3rd nt of codon   
-    if UseIMGT
-        CDRS = CDRS + 3;
-        CDRE = CDRE - 3;
-    end
-    CDRLen = (CDRE - CDRS + 1) / 3;
-    
-    SeqCDR = cell(size(Idx));
-    for k = 1:length(Idx)
-        if min([CDRS(k) CDRE(k)]) > 0 && CDRE(k) <= length(VDJdata{Idx(k), SeqIdx})
-            SeqCDR{k} = nt2aa(VDJdata{Idx(k), SeqIdx}(CDRS(k):CDRE(k)), 'ACGTonly', false, 'alternativestart', false);
-        end
-    end
-    
-    VDJdata(Idx, CDRIdx) = [SeqCDR num2cell([CDRLen CDRS CDRE])];
+[CDR1, CDR2, CDR3] = findCDRMEX(VDJdata(Idx, SeqIdx), GeneNum, LenDel, DB.([V 'map'])(:, M.Seq), cell2mat(Vinfo), cell2mat(Janchor), UseIMGT);
+if any(Num == 1)
+    VDJdata(Idx, Map.([C 'CDR1'])) = CDR1;
+end
+if any(Num == 2)
+    VDJdata(Idx, Map.([C 'CDR2'])) = CDR2;
+end
+if any(Num == 3)
+    J3Loc = GeneNum(:, 2) > 0;
+    VDJdata(Idx(J3Loc), Map.([C 'CDR3'])) = CDR3(J3Loc, :);
 end
\ No newline at end of file
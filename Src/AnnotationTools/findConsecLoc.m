@@ -22,7 +22,7 @@
 %    TrimLen = 
 %           14
 %
-%  See also trimGeneEdge
+%  See also trimGeneEdge, findConsecOnesMEX
 
 function TrimLen = findConsecLoc(Q,MinConsec,StartSide)
 %Check inputs for validity
@@ -40,47 +40,22 @@ if sum(Q) == length(Q) && length(Q) == MinConsec
     return
 end
 
-%Begin computing location after largest consec 1's from the left or right
-TrimLen = 0; 
-c = 0; %Concsecutive counter
-if MinConsec > 1
-    if StartSide == 'R'
-        for k = length(Q)-1:-1:1
-            if (Q(k+1) + Q(k)) == 2
-                c = c+1;
-                if c >= MinConsec
-                    TrimLen = length(Q) - k + 1;
-                end
-            else
-                c = 1;
-            end       
-        end
-    elseif StartSide == 'L'
-        for k = 1:length(Q)-1
-            if (Q(k+1) + Q(k)) == 2
-                c = c+1;
-                if c >= MinConsec
-                    TrimLen = k + 1;
-                end
-            else
-                c = 1;
-            end       
-        end
-    else
-        warning('%s: Nothing has been done. Set StartSide correctly',mfilename);
+%Find the runs of 1's as [Start Length Label]. A run touching the starting
+%edge needs 1 more match, since only pairs of consecutive 1's are counted.
+TrimLen = 0;
+Runs = findConsecOnesMEX(Q(:) == 1, 'runs');
+if isempty(Runs); return; end
+RunEnd = Runs(:, 1) + Runs(:, 2) - 1;
+if StartSide == 'L'
+    RunLen = Runs(:, 2) - (MinConsec > 1 & Runs(:, 1) == 1);
+    Idx = find(RunLen >= MinConsec, 1, 'last');
+    if ~isempty(Idx)
+        TrimLen = RunEnd(Idx);
     end
 else
-    if StartSide == 'R'
-        for k = length(Q):-1:1
-            if Q(k) == 1
-                TrimLen = length(Q) - k + 1;
-            end
-        end
-    elseif StartSide == 'L'
-        for k = 1:length(Q)
-            if Q(k) == 1
-                TrimLen = k;
-            end       
-        end
+    RunLen = Runs(:, 2) - (MinConsec > 1 & RunEnd == length(Q));
+    Idx = find(RunLen >= MinConsec, 1, 'first');
+    if ~isempty(Idx)
+        TrimLen = length(Q) - Runs(Idx, 1) + 1;
     end
 end
@@ -169,7 +169,7 @@ if ExactMatch == 'n'
     FitScore = -Inf*ones(1, size(Xmap, 1));
     for x = 1:size(Xmap, 1)
         if isempty(Xmap{x, 1}); continue; end
-        ScoreT = alignSeqMEX(Seq, Xmap{x, 1}, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide); 
+        ScoreT = alignSeqMEX(Seq, Xmap{x, 1}, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, 'score'); 
         FitScore(1, x) = ScoreT(2);
     end
     BestXmapNum = find(FitScore == max(FitScore)); %The index number in Xmap of best matches
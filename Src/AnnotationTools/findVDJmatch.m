@@ -71,6 +71,8 @@ M = getMapHeaderVar(DB.MapHeader);
 AnchorIdx = M.Anchor;
 Vmap = DB.Vmap;
 Dmap = DB.Dmap;
+Dseq = DB.Dmap(:, M.Seq);
+GeneIdx = M.Gene;
 Jmap = DB.Jmap;
 
 %Begin finding the VDJ genes  
@@ -151,11 +153,13 @@ parfor j = 1:size(VDJdata, 1)
 
     %Look for D gene for each seq
     Dnt = Seq(Vlen+1:end-Jlen);
-    Dmatch = findGeneMatch(Dnt, Dmap, 'D', MissRate);
-    if isempty(Dmatch{1})
+    [Dnum, DrefLMR, DsamLMR] = findDmatchMEX({Dnt}, Dseq, MissRate);
+    if isempty(Dnum{1})
         BadLoc(j) = 1;
         continue
     end
+    Dname = sprintf('%s|', Dmap{Dnum{1}, GeneIdx});
+    Dmatch = {Dnum{1}, Dname(1:end-1), DrefLMR, DsamLMR};
     
     %Begin trimming sequences that go beyond the V or J genes
     VsamLMR = Vmatch{4};
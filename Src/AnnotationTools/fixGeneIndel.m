@@ -59,37 +59,29 @@ for k = 1:length(Map.Chain)
         continue
     end
     
-    %Pre-determined allowed V ref seq and anchors to avoid broadcasting
-    VseqSlice = cell(size(VDJdata, 1), 1); %Vref and Vanchor
-    VanchorSlice = cell(size(VDJdata, 1), 1); %Vref and Vanchor
+    %Determine which seq need an indel check, and their V seq and V ref seq
+    SeqV = cell(size(VDJdata, 1), 1);
+    SeqVref = cell(size(VDJdata, 1), 1);
+    VMlen = zeros(size(VDJdata, 1), 2); %[Vlen Mlen] after reanchoring C
+    CheckLoc = zeros(size(VDJdata, 1), 1, 'logical');
     for j = 1:size(VDJdata, 1)
-        Vnum = VDJdata{j, GeneNumLoc};        
+        Vnum = VDJdata{j, GeneNumLoc};
         Vname = VDJdata{j, GeneNameLoc};
-        if isempty(Vnum); continue; end
-        if isempty(Vname); continue; end
+        if isempty(Vnum) || isempty(Vname) || Vnum(1) <= 0; continue; end
 
         %Determine locus and if lambda, shift Vmap number
         if ~isempty(regexpi(Vname, 'IGLV', 'once')) %Lambda, so shift map num
             Vnum = Vnum + VkCount;
         end
-        
-        %Construct the sliced Vseq and Vanchor cells
-        if ~isempty(Vnum) && Vnum(1) > 0
-            VseqSlice{j} = Vmap{Vnum, M.Seq};
-            VanchorSlice{j} = Vmap{Vnum, M.Anchor};
-        end
-    end
-    
-    %Correct indel
-    parfor j = 1:size(VDJdata, 1)
-        Tdata = VDJdata(j, :);
-        
+        SeqVrefFull = Vmap{Vnum(1), M.Seq};
+        Vanchor = Vmap{Vnum(1), M.Anchor};
+
         %Extract all necessary information
-        Seq = Tdata{1, SeqLoc};
-        Vdel = Tdata{1, DelLoc};
-        Vshm = Tdata{1, VmutLoc};
-        Vlen = Tdata{1, VLengthLoc};
-        Mlen = Tdata{1, MLengthLoc};
+        Seq = VDJdata{j, SeqLoc};
+        Vdel = VDJdata{j, DelLoc};
+        Vshm = VDJdata{j, VmutLoc};
+        Vlen = VDJdata{j, VLengthLoc};
+        Mlen = VDJdata{j, MLengthLoc};
         
         %Make sure all info is available before proceeding
         if isempty(Seq); continue; end
@@ -97,12 +89,12 @@ for k = 1:length(Map.Chain)
         if isempty(Vshm); continue; end
         if isempty(Vlen); continue; end
         if isempty(Mlen); continue; end
-        if isempty(VanchorSlice{j}); continue; end
-        if isempty(VseqSlice{j}); continue; end
-        if min([Vshm, Vnum, Vdel, Vlen, Mlen]) < 0; continue; end
+        if isempty(Vanchor); continue; end
+        if isempty(SeqVrefFull); continue; end
+        if min([Vshm, Vdel, Vlen, Mlen]) < 0; continue; end
         
         %Calc the allowed deletion of V gene 3' end and Valigment miss rate
-        VallowedDel = VanchorSlice{j} - 3; %Subtract 3 since you want to preserve codon of C
+        VallowedDel = Vanchor - 3; %Subtract 3 since you want to preserve codon of C
         if VallowedDel < 0; VallowedDel = 25; end
 
         %Check if V and Nvd extends past 104C codon
@@ -111,79 +103,61 @@ for k = 1:length(Map.Chain)
         end
         
         %Perform indel check Vdel is too large or Vshm >= 30% of Vlen
-        if Vdel > VallowedDel || Vshm/Vlen >= 0.30
-            %Reanchor C if Vdel > VallowedDel
-            if Vdel > VallowedDel
-                AdjustLen = Vdel - VallowedDel;
-                Vlen = Vlen + AdjustLen;
-                Mlen = Mlen - AdjustLen;
-                Vdel = VallowedDel;
-            end
-            
-            %Determine minimum Seq needed to reach RefGene's C codon
-            VaddLen = Vdel - VallowedDel;
-            VendLoc = Vlen + VaddLen;
-            if VendLoc > (Vlen + Mlen) || VendLoc < 1; continue; end %Nonsense VendLoc
-            SeqV = Seq(1:VendLoc);
-
-            %Take the full V ref seq up to the same C codon
-            SeqVrefFull = VseqSlice{j};
-            if VallowedDel-1 >= length(SeqVrefFull); continue; end %Bad Vmap seq
-            SeqVref = SeqVrefFull(1:end-VallowedDel);
-
-            %Check for sequencing error insertion/deletion (indel)
-            [~, Alignment, StartAt] = swalign(SeqV, SeqVref, 'alphabet', 'nt');
-            if max(StartAt) == 0; continue; end %No alignment
-            Deletes = regexp(Alignment(1, :), '-'); %Location of deletion error in SeqV
-            Inserts = regexp(Alignment(3, :), '-'); %Location of insertion error in SeqV
-            if isempty(Deletes) && isempty(Inserts); continue; end %Nothing to change
+        if ~(Vdel > VallowedDel || Vshm/Vlen >= 0.30); continue; end
 
-            %Make sure there're no consecutive del/ins, as these are NOT
-            %likely sequencing errors, but rather SHMs or other stuff. 
-            ConsecDel = sum(diff(Deletes) == 1);
-            ConsecIns = sum(diff(Inserts) == 1);
-            if ConsecDel >= 1 || ConsecIns >= 1; continue; end
-
-            %Fix indel in SeqV
-            FixedSeq = Alignment(1, :);
-            if ~isempty(Deletes) %Fill in the deletions
-                FixedSeq(Deletes) = Alignment(3, Deletes);
-            end
-            if ~isempty(Inserts) %Remove the insertions
-                FixedSeq(:, Inserts) = [];
-            end
+        %Reanchor C if Vdel > VallowedDel
+        if Vdel > VallowedDel
+            AdjustLen = Vdel - VallowedDel;
+            Vlen = Vlen + AdjustLen;
+            Mlen = Mlen - AdjustLen;
+            Vdel = VallowedDel;
+        end
+        
+        %Determine minimum Seq needed to reach RefGene's C codon
+        VaddLen = Vdel - VallowedDel;
+        VendLoc = Vlen + VaddLen;
+        if VendLoc > (Vlen + Mlen) || VendLoc < 1; continue; end %Nonsense VendLoc
 
-            %If left is trimmed, add trimmed seq to TempSeq (swalign issue)
-            if StartAt(1) ~= 1
-                FixedSeq = sprintf('%s%s', SeqV(1:StartAt(1)-1), FixedSeq);
-            end
+        %Take the full V ref seq up to the same C codon
+        if VallowedDel-1 >= length(SeqVrefFull); continue; end %Bad Vmap seq
+        SeqV{j} = Seq(1:VendLoc);
+        SeqVref{j} = SeqVrefFull(1:end-VallowedDel);
+        VMlen(j, :) = [Vlen Mlen];
+        CheckLoc(j) = 1;
+    end
+    
+    %Check for sequencing error insertion/deletion (indel) of all seq at once
+    CheckIdx = find(CheckLoc);
+    [FixSeq, ~, IndelCt, StartAt] = fixIndelMEX(SeqV(CheckIdx), SeqVref(CheckIdx));
+    for q = 1:length(CheckIdx)
+        j = CheckIdx(q);
+        if max(StartAt(q, :)) == 0; continue; end %No alignment
+        if sum(IndelCt(q, 1:2)) == 0; continue; end %Nothing to change
 
-            %If right is trimmed, including from swalign & Indel, read to
-            %FixedSeq (swalign issue)
-            Radd = length(SeqV) - (size(Alignment, 2) + StartAt(1) - 1 - length(Deletes));
-            if Radd > 0
-                FixedSeq(end+1:end+Radd) = SeqV(end-Radd+1:end);
-            end
-            
-            %Determine if you need to trim 5' end
-            if length(FixedSeq) > length(SeqVref) 
-                TrimLen = length(FixedSeq) - length(SeqVref);
-                FixedSeq(1:TrimLen) = [];
-            end
+        %Make sure there're no consecutive del/ins, as these are NOT
+        %likely sequencing errors, but rather SHMs or other stuff. 
+        if IndelCt(q, 3) >= 2; continue; end
 
-            %Update fields
-            NewVlen = Vlen - length(SeqV) + length(FixedSeq);
-            if min([NewVlen Mlen]) < 0; continue; end %Invalide correction
-            
-            FinalSeq = [FixedSeq Seq(VendLoc+1:end)];
-            Tdata{1, SeqLoc} = FinalSeq; %New seq
-            Tdata{1, VLengthLoc} = NewVlen; %New V len
-            Tdata{1, MLengthLoc} = Mlen;
-            
-            %Mark which one is updated - must redo CDR3, SHM, refSeq
-            VDJdata(j, :) = Tdata;
-            UpdateIdx(j) = 1;
+        %Determine if you need to trim 5' end
+        FixedSeq = FixSeq{q};
+        if length(FixedSeq) > length(SeqVref{j}) 
+            TrimLen = length(FixedSeq) - length(SeqVref{j});
+            FixedSeq(1:TrimLen) = [];
         end
+
+        %Update fields
+        Vlen = VMlen(j, 1);
+        Mlen = VMlen(j, 2);
+        NewVlen = Vlen - length(SeqV{j}) + length(FixedSeq);
+        if min([NewVlen Mlen]) < 0; continue; end %Invalide correction
+        
+        Seq = VDJdata{j, SeqLoc};
+        VDJdata{j, SeqLoc} = [FixedSeq Seq(length(SeqV{j})+1:end)]; %New seq
+        VDJdata{j, VLengthLoc} = NewVlen; %New V len
+        VDJdata{j, MLengthLoc} = Mlen;
+        
+        %Mark which one is updated - must redo CDR3, SHM, refSeq
+        UpdateIdx(j) = 1;
     end
 end
 
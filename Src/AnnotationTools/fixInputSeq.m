@@ -24,7 +24,7 @@ if nargin < 3
 end
 
 SeqIdx = nonzeros([Map.hSeq; Map.lSeq]);
-VDJdata(:, SeqIdx) = regexprep(upper(VDJdata(:, SeqIdx)), '[^ACGTU]', 'N');
+VDJdata(:, SeqIdx) = fixSeqDirMEX(VDJdata(:, SeqIdx));
 
 BadLoc = repelem(false, size(VDJdata, 1), 1);
 for c = 1:length(Map.Chain)
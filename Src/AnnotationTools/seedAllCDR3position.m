@@ -0,0 +1,76 @@
+%seedAllCDR3position will find the "potential" CDR3 start and end locations
+%of the heavy and light chain seqs, touching each read once in 1
+%seedCDR3MEX call for all chains. It gives the same results as running
+%seedCDR3position for 'V', 'J', 'Vk,Vl', and 'Jk,Jl', except that each
+%light chain read is first assigned to the kappa or lambda locus by a k-mer
+%vote, and then only the seeds of that locus are used. Reads with no clear
+%locus use both.
+%
+%  VDJdata = seedAllCDR3position(VDJdata, Map, DB, CheckSeqDir)
+%
+%  INPUT
+%    VDJdata: main BRILIA data cell
+%    Map: structure of VDJdata column indices (see getVDJmapper)
+%    DB: Gene database structure (getCurrentDatabase.m)
+%    CheckSeqDir ['n' or 'y']: no or yes for checking both sequence
+%      directions, as in seedCDR3position
+%
+%  OUTPUT
+%    VDJdata: VDJdata with the CDR3 start and end positions
+%
+%  See also seedCDR3position, seedCDR3MEX, getGeneSeed
+
+function VDJdata = seedAllCDR3position(VDJdata, Map, DB, CheckSeqDir)
+if isempty(VDJdata); return; end
+M = getMapHeaderVar(DB.MapHeader);
+Chain = lower(Map.Chain);
+NumChain = length(Chain);
+
+%Same seeds and alignSeqMEX options as seedCDR3position, with 1 Seq column per chain
+SeqIdx = zeros(1, NumChain);
+CDR3Idx = zeros(NumChain, 2);
+Group = cell(1, NumChain);
+DirRef = cell(1, NumChain);
+LocusRef = [];
+for c = 1:NumChain
+    SeqIdx(c) = Map.([Chain(c) 'Seq']);
+    CDR3Idx(c, :) = Map.([Chain(c) 'CDR3'])(3:4);
+    if Chain(c) == 'h'
+        Group{c} = [makeSeedGroup(DB, 'V', 40,  2, 'rll', 'TGT', 0, c) ...
+                    makeSeedGroup(DB, 'J',  3, 14, 'lrr', 'TGG', 0, c)];
+        DirX = {'V'};
+    else
+        Group{c} = [makeSeedGroup(DB, 'Vk,Vl', 40,  2, 'nnn', 'TGT', 0, c) ...
+                    makeSeedGroup(DB, 'Jk,Jl',  3, 14, 'nnn', 'TTT|TTC', 0, c) ...
+                    makeSeedGroup(DB, 'Vk',    40,  2, 'nnn', 'TGT', 1, c) ...
+                    makeSeedGroup(DB, 'Jk',     3, 14, 'nnn', 'TTT|TTC', 1, c) ...
+                    makeSeedGroup(DB, 'Vl',    40,  2, 'nnn', 'TGT', 2, c) ...
+                    makeSeedGroup(DB, 'Jl',     3, 14, 'nnn', 'TTT|TTC', 2, c)];
+        DirX = {'Vk', 'Vl'};
+        LocusRef = {[DB.Vkmap(:, M.Seq); DB.Jkmap(:, M.Seq)], [DB.Vlmap(:, M.Seq); DB.Jlmap(:, M.Seq)]};
+    end
+    if strcmpi(CheckSeqDir, 'y')
+        XmapName = strcat(DirX, 'map');
+        XmapName = XmapName(isfield(DB, XmapName));
+        RefSeq = cellfun(@(x) DB.(x)(:, M.Seq), XmapName, 'un', 0);
+        DirRef{c} = vertcat(RefSeq{:});
+    end
+end
+Group = [Group{:}];
+if ~strcmpi(CheckSeqDir, 'y')
+    DirRef = [];
+end
+
+[CDR3Pos, Seq] = seedCDR3MEX(VDJdata(:, SeqIdx), Group, DirRef, LocusRef);
+if ~isempty(DirRef)
+    VDJdata(:, SeqIdx) = Seq;
+end
+for g = 1:numel(Group)
+    Loc = ~cellfun('isempty', CDR3Pos(:, g));
+    VDJdata(Loc, CDR3Idx(Group(g).Col, Group(g).IsJ + 1)) = CDR3Pos(Loc, g);
+end
+
+%Returns the seedCDR3MEX group of the X genes
+function Group = makeSeedGroup(DB, X, Nleft, Nright, Side, Motif, Locus, Col)
+Group = struct('Seed', {getGeneSeed(DB, X, Nleft, Nright, 'nt')}, 'Nleft', Nleft, 'Nright', Nright, ...
+    'IsJ', double(X(1) == 'J'), 'Side', Side, 'Motif', Motif, 'Locus', Locus, 'Col', Col);
@@ -16,7 +16,8 @@
 %    Nleft: num of nts left of CDR3 codon 1st nt Anchor for align seed. 
 %    Nright: num of nts right of CDR3 codon 1st nt Anchor for align seed.
 %    CheckSeqDir ['n' or 'y']: no or yes for checking both sequence
-%      directions. If 'y', Will take complements of sequences if needed.
+%      directions. If 'y', will take the reverse complement of sequences
+%      that share more k-mers with the X germline genes in reverse.
 %
 %  OUTPUT
 %    VDJdata: processed BRILIA data cell
@@ -29,8 +30,12 @@
 %
 %    Cannot seed a heavy and light chain V or J together. Ex, X = 'V, Vk'
 %    will not work.
+%
+%    BRILIA uses seedAllCDR3position, which seeds V and J of both chains
+%    in 1 pass per chain.
 
 function VDJdata = seedCDR3position(VDJdata, Map, DB, X, Nleft, Nright, CheckSeqDir)
+if isempty(VDJdata); return; end
 if contains(X, {'Vk', 'Vl'}, 'ignorecase', true)
     IsJ = 0;
     Chain = 'l';
@@ -61,7 +66,14 @@ CDR3Idx = Map.([Chain 'CDR3'])(CIdx);
 Xseed = getGeneSeed(DB, X, Nleft, Nright, 'nt');
 if isempty(Xseed); return; end
 
-CheckRev = strcmpi(CheckSeqDir, 'y');
+%Flip sequences to the direction with more k-mer hits to the germline genes
+if strcmpi(CheckSeqDir, 'y')
+    M = getMapHeaderVar(DB.MapHeader);
+    XmapName = strcat(strsplit(strrep(X, ' ', ''), ','), 'map');
+    XmapName = XmapName(isfield(DB, XmapName));
+    RefSeq = cellfun(@(x) DB.(x)(:, M.Seq), XmapName, 'un', 0);
+    VDJdata(:, SeqIdx) = fixSeqDirMEX(VDJdata(:, SeqIdx), vertcat(RefSeq{:}));
+end
 
 %Setup the input for alignSeqMEX.
 MissRate   = 0;
@@ -91,20 +103,9 @@ DQ = PT.DataQueue;
 parfor j = 1:size(VDJdata, 1)
     Tdata = VDJdata(j, :);  
     if length(Tdata{SeqIdx}) <= (Nleft + Nright); continue; end
-    [Score, StartAt] = alignSeqMEX(Tdata{SeqIdx}, Xseed, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide); 
+    [~, StartAt] = alignSeqMEX(Tdata{SeqIdx}, Xseed, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, 'score'); 
     UnqPos = unique(StartAt(2, :) + Nleft + (StartAt(2, :) < 0));
     
-    if CheckRev
-        SeqR = seqrcomplement(Tdata{SeqIdx});
-        [ScoreR, StartAtR] = alignSeqMEX(SeqR, Xseed, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide); 
-        UnqPosR = unique(StartAtR(2, :) + Nleft + (StartAtR(2, :) < 0));
-        
-        if max(ScoreR(2, :)) > max(Score(2, :)) && length(UnqPosR) <= length(UnqPos) %Accept complement sequence if it's a higher score AND less positions
-            Tdata{SeqIdx} = SeqR;
-            UnqPos = UnqPosR;
-        end
-    end
-    
     SpecPos = strfind(Tdata{SeqIdx}, SeedPat); %Include special CDR3 anchor locations
     CDR3Pos = unique([UnqPos(:); SpecPos(:)])';
     if IsJ; CDR3Pos = CDR3Pos +2; end %Need to include 2 nt of codon for J (since it's the end)
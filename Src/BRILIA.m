@@ -73,6 +73,11 @@
 %                   all                    All of the above
 %     Batch       * 30000                  Process 30000 sequences per batch to prevent memory overload
 %                   #                      Process # sequences per batch
+%     PipeMemory  * 256                    Read the next batch and write the last batch in the background, using <= 256 MB
+%                   #                      Use <= # MB for the background reads/writes. 0 to read, process, and write in turn.
+%     Collapse    * n                      Annotate every sequence
+%                   y                      Annotate identical sequences once and copy the results to all copies. Also reuses
+%                                          <= PipeMemory MB of annotations from past batches.
 %     Cores       * max                    Use maximum number of cores
 %                   #                      Use # number of cores
 %     Resume      * y                      Resume from an interrupted job 
@@ -90,6 +95,9 @@
 %                   y                      Skip lineage-based correction, if all sequences are clonally unrelated
 %     AutoExit    * n                      Do not exit BRILIA local environment when job completes
 %                   y                      Exit BRILIA local environment when job completes
+%     Benchmark   * n                      Do not time the pipeline stages
+%                   y                      Save the time, reads/s, and peak memory of each stage to "OutDir\OutFile.Bench.json"
+%                                          NOTE: see benchPipeline to run and compare benchmarks
 
 function varargout = BRILIA(varargin)
 Version = '3.5.9'; 
@@ -109,6 +117,17 @@ if ~isdeployed
             return
         end
     end
+    %Compile the MEX files that have no binary for this machine
+    MexFiles = dir(fullfile(MainPath, 'Src', 'MEX', '*MEX.cpp'));
+    MexNames = strrep({MexFiles.name}, '.cpp', '');
+    MissLoc = cellfun(@(x) exist(x, 'file') ~= 3, MexNames);
+    if any(MissLoc)
+        if isempty(mex.getCompilerConfigurations('C++', 'Selected'))
+            error('%s: These MEX files are not compiled for this machine: %s. Set up a C++ compiler with "mex -setup C++", and then run compileMexBRILIA.', mfilename, strjoin(MexNames(MissLoc), ', '));
+        end
+        fprintf('Compiling the MEX files: %s\n', strjoin(MexNames(MissLoc), ', '));
+        compileMexBRILIA;
+    end
 end
 
 %--------------------------------------------------------------------------
@@ -129,6 +148,8 @@ addParameter(P, 'Strain',        'all',   @ischar);
 addParameter(P, 'Dgene',         'all',   @(x) ischar(x) && ismember(lower(x), {'all', 'fwd', 'rev'}));
 addParameter(P, 'Vgene',         'f',     @(x) ischar(x) && all(ismember(strsplit(lower(x), ','), {'all', 'f', 'p', 'orf'})));
 addParameter(P, 'BatchSize',     30000,   @(x) isnumeric(x) && x >= 1);
+addParameter(P, 'PipeMemory',    256,     @(x) isnumeric(x) && x >= 0);
+addParameter(P, 'Collapse',      'n',     @(x) ischar(x) && ismember(lower(x), {'y', 'n'}));
 addParameter(P, 'Cores',         'max',   @(x) ischar(x) || isnumeric(x));
 addParameter(P, 'SeqRange',      [1,Inf], @(x) isnumeric(x) || ischar(x));
 addParameter(P, 'MinQuality',    '2',     @(x) ischar(x) || isnumeric(x)); %ASCII_BASE=33, '2' = P_error 0.01995
@@ -137,6 +158,7 @@ addParameter(P, 'Resume',        'y',     @(x) ischar(x) && ismember(lower(x), {
 addParameter(P, 'CheckSeqDir',   'y',     @(x) ischar(x) && ismember(lower(x), {'y', 'n'}));
 addParameter(P, 'SkipLineage',   'n',     @(x) ischar(x) && ismember(lower(x), {'y', 'n'}));
 addParameter(P, 'AutoExit',      'n',     @(x) ischar(x) && ismember(lower(x), {'y', 'n'}));
+addParameter(P, 'Benchmark',     'n',     @(x) ischar(x) && ismember(lower(x), {'y', 'n'}));
 addParameter(P, 'SettingFile',   '',      @(x) isempty(x) || ~isempty(dir(x))); %This is kept for backward compatibility only. Will be removed.
 
 while true
@@ -244,6 +266,8 @@ while true
     Dgene = Ps.Dgene;
     Cores = Ps.Cores;
     BatchSize = round(Ps.BatchSize);
+    PipeMemory = Ps.PipeMemory;
+    Collapse = Ps.Collapse;
     if ischar(Ps.SeqRange)
         Ps.SeqRange = convStr2NumMEX(Ps.SeqRange);
     end
@@ -253,6 +277,7 @@ while true
     CheckSeqDir = Ps.CheckSeqDir;
     SkipLineage = Ps.SkipLineage;
     AutoExit = Ps.AutoExit;
+    Benchmark = Ps.Benchmark;
     MinQuality = Ps.MinQuality;
 
     if ~HasShownCredit
@@ -276,7 +301,7 @@ while true
     %Input and Output Files
 
     if isempty(InputFile) %Ask user to choose
-        InputFile = openFileDialog('*.fa*;*.*sv', 'Select the input sequence files', 'multiselect', 'on');
+        InputFile = openFileDialog('*.fa*;*.*sv;*.gz', 'Select the input sequence files', 'multiselect', 'on');
     elseif ischar(InputFile) %Search for all files that matches
         InputFile = dir(InputFile);
         InputFile = fullfile({InputFile.folder}, {InputFile.name});
@@ -288,7 +313,7 @@ while true
     end
 
     %Correct chain from HL to H if dealing with fasta/q
-    if strcmpi(Chain, 'HL') && any(endsWith(InputFile, {'.fa', '.fasta', '.fastq'}, 'ignorecase', true))
+    if strcmpi(Chain, 'HL') && any(endsWith(InputFile, {'.fa', '.fasta', '.fastq', '.gz'}, 'ignorecase', true))
         fprintf('For Chain = HL option, only delimited (ie, *.csv) files can be used.\n')
         fprintf('The delimited file must have defined "H-Seq" and "L-Seq" columns.\n'); 
         if RunInLocalEnv; continue; else; return; end
@@ -342,11 +367,22 @@ while true
     showStatus('Setting up parallel computing ...', StatusHandle);
     [~, NumWorkers] = setCores(Cores);
     showStatus(sprintf('  Using %d cores.', NumWorkers), StatusHandle);
+    
+    %Batch b+1 is read and batch b-1 is written in the background while batch b is processed
+    setenv('BRILIA_PIPE_MB', num2str(PipeMemory));
+    SaveOpt = {'append'};
+    if PipeMemory > 0
+        SaveOpt{end+1} = 'async';
+    end
 
     for f = 1:length(InputFile)
         SeqRange = SeqRangeT; %Reset this every time, otherwise you'll get odd results.
         
         TicInputFile = tic;
+        Bench = []; %Stage times, see benchStage
+        if strcmpi(Benchmark, 'y')
+            Bench = benchStage('start');
+        end
         %------------------------------------------------------------------
         %File Management
 
@@ -359,13 +395,23 @@ while true
             end
         end
         ErrFileName = fullfile(OutPath, [OutFilePre '.Err.csv']);
-        TmpFileName = fullfile(OutPath, [OutFilePre '.Tmp.csv']);
-        RawFileName = fullfile(OutPath, [OutFilePre '.Raw.csv']);
+        TmpFileName = fullfile(OutPath, [OutFilePre '.Tmp.bcol']); %Binary checkpoint (see writeColFileMEX)
+        RawFileName = fullfile(OutPath, [OutFilePre '.Raw.bcol']);
         TmpExist = ~isempty(dir(TmpFileName));
         ErrExist = ~isempty(dir(ErrFileName));
         RawExist = ~isempty(dir(RawFileName));
         
-        %Resume from the highest sequence number
+        %Ask to resume if there are incomplete annotation files
+        if TmpExist && strncmpi(Resume, 'a', 1) %'ask'
+            Choice = input('Found incomplete annotation files. Resume? [y or n] (Enter = y): ', 's');
+            if isempty(Choice) || ~ismember(lower(Choice(1)), {'y', 'n'})
+                Resume = 'y';
+            else
+                Resume = Choice(1);
+            end
+        end
+
+        %Delete the incomplete files only on an explicit restart
         if strcmpi(Resume, 'n')
             showStatus('Deleting incomplete job and starting over.\n', StatusHandle);
             if TmpExist; delete(TmpFileName); end
@@ -377,32 +423,20 @@ while true
         end
         
         %Resume from the highest sequence number
-        if TmpExist
-            if strcmpi(Resume, 'a')
-                Choice = input('Found incomplete annotation files. Resume? [y or n] (Enter = y): ', 's');
-                if isempty(Choice) || ~ismember(lower(Choice(1)), {'y', 'n'})
-                    Resume = 'y';
-                else
-                    Resume = Choice(1);
-                end
+        if TmpExist && strcmpi(Resume, 'y')
+            showStatus('Resuming from a past incomplete job.', StatusHandle);
+            try %The Tmp file footer has the last SeqNum of each saved batch, including the ones sent to the Err file
+                [~, ~, Info] = readColFileMEX(TmpFileName, []);
+            catch ME
+                showStatus(sprintf('Could not read the resume point from "%s". Use Resume = n to start over.', TmpFileName), StatusHandle);
+                rethrow(ME);
             end
-
-            if strcmpi(Resume, 'y')
-                showStatus('Resuming from a past incomplete job.', StatusHandle);
-                MaxSeqNum = 0;
-                if ErrExist
-                    [VDJdata, ~, ~, ~, Map] = openSeqData(ErrFileName);
-                    MaxSeqNum = max(cell2mat(VDJdata(:, Map.SeqNum)));
-                end
-                [VDJdata, ~, ~, ~, Map] = openSeqData(TmpFileName);
-                MaxSeqNum = max([max(cell2mat(VDJdata(:, Map.SeqNum))), MaxSeqNum]);
-                if MaxSeqNum == 0
-                    showStatus('No sequences in temp files.', StatusHandle);
-                    Resume = 'n'; 
-                else
-                    SeqRange(1) = MaxSeqNum + 1;
-                end
+            MaxSeqNum = max([0; Info.LastSeqNum]);
+            if MaxSeqNum == 0
+                showStatus(sprintf('No resume point in "%s". Use Resume = n to start over.', TmpFileName), StatusHandle);
+                error('%s: No resume point in "%s".', mfilename, TmpFileName);
             end
+            SeqRange(1) = MaxSeqNum + 1;
         end
         
         if ~RawExist
@@ -411,71 +445,107 @@ while true
                 SeqRange = repelem(SeqRange, 1, 2);
             end
             MaxSeqCount = countSeq(InputFile{f});
+            Bench = benchStage(Bench, 'countSeq', MaxSeqCount);
             SeqRange(SeqRange > MaxSeqCount) = MaxSeqCount;
             SeqRange(SeqRange < 1) = 1;
             SeqCount = diff(SeqRange) + 1;
 
             %Part 1: performs V(D)J annotation
             showStatus(sprintf('Opening "%s" ...', InputFile{f}), StatusHandle); 
+            findUniqueSeqMEX('clear');
+            Known = [];
+            if PipeMemory > 0 %Annotations of unique seqs kept across batches, see expandVDJdata
+                Known = struct('Handle', [], 'MaxBytes', PipeMemory*2^20);
+            end
             for b = 1:ceil(SeqCount/BatchSize)
                 SeqRangeB = [SeqRange(1)+BatchSize*(b-1)  SeqRange(1)+b*BatchSize-1]; %batch seq range
-                SeqRangeB(end) = min([SeqRangeB(end) SeqCount]);
+                SeqRangeB(end) = min([SeqRangeB(end) SeqRange(2)]);
                 KeepLoc = ones(diff(SeqRangeB)+1, 1, 'logical');
 
                 showStatus(sprintf('Processing sequences %d to %d (out of %d) ...', SeqRangeB(1), SeqRangeB(2), SeqCount), StatusHandle);
-                [VDJdata, VDJheader, ~, ~, Map] = convertInput2VDJdata(InputFile{f}, 'Chain', Chain, 'SeqRange', SeqRangeB, 'MinQuality', MinQuality);
+                [VDJdata, VDJheader, ~, ~, Map, BadLoc] = convertInput2VDJdata(InputFile{f}, 'Chain', Chain, 'SeqRange', SeqRangeB, 'MinQuality', MinQuality);
+                Bench = benchStage(Bench, 'convertInput2VDJdata', size(VDJdata, 1));
 
-                showStatus('Fixing input sequences', StatusHandle);
-                [VDJdata, BadLoc] = fixInputSeq(VDJdata, Map);
+                if isempty(BadLoc) %Fasta/fastq seq are already fixed while reading
+                    showStatus('Fixing input sequences', StatusHandle);
+                    [VDJdata, BadLoc] = fixInputSeq(VDJdata, Map);
+                    Bench = benchStage(Bench, 'fixInputSeq', size(VDJdata, 1));
+                end
                 KeepLoc(BadLoc) = 0;
 
-                showStatus('Determining V gene CDR3 start ...', StatusHandle)
-                VDJdata(KeepLoc, :) = seedCDR3position(VDJdata(KeepLoc, :), Map, DB, 'V',     40,  2, CheckSeqDir);
-                showStatus('Determining J gene CDR3 end ...', StatusHandle)
-                VDJdata(KeepLoc, :) = seedCDR3position(VDJdata(KeepLoc, :), Map, DB, 'J',      3, 14, 'n');
-                showStatus('Determining Vk/Vl gene CDR3 start ...', StatusHandle)
-                VDJdata(KeepLoc, :) = seedCDR3position(VDJdata(KeepLoc, :), Map, DB, 'Vk,Vl', 40,  2, CheckSeqDir);
-                showStatus('Determining Jk/jl gene CDR3 end ...', StatusHandle)
-                VDJdata(KeepLoc, :) = seedCDR3position(VDJdata(KeepLoc, :), Map, DB, 'Jk,Jl',  3, 14, 'n');
+                if strcmpi(Collapse, 'y')
+                    showStatus('Collapsing identical sequences ...', StatusHandle);
+                    [VDJdata, KeepLoc, Dup] = collapseVDJdata(VDJdata, Map, KeepLoc);
+                    Bench = benchStage(Bench, 'collapseVDJdata', size(VDJdata, 1));
+                end
+
+                showStatus('Determining V/J gene CDR3 start and end ...', StatusHandle)
+                VDJdata(KeepLoc, :) = seedAllCDR3position(VDJdata(KeepLoc, :), Map, DB, CheckSeqDir);
+                Bench = benchStage(Bench, 'seedAllCDR3position', sum(KeepLoc));
 
                 showStatus('Finding heavy chain VDJ annotations ...', StatusHandle)
                 [VDJdata(KeepLoc, :), BadLoc1] = findVDJmatch(VDJdata(KeepLoc, :), Map, DB, 'Update', 'Y');
+                Bench = benchStage(Bench, 'findVDJmatch', sum(KeepLoc));
 
                 showStatus('Finding light chain VJ annotations ...', StatusHandle)
                 [VDJdata(KeepLoc, :), BadLoc2] = findVJmatch(VDJdata(KeepLoc, :), Map, DB, 'Update', 'Y');
+                Bench = benchStage(Bench, 'findVJmatch', sum(KeepLoc));
                 Loc = find(KeepLoc);
                 KeepLoc(Loc(BadLoc1|BadLoc2)) = 0;
 
                 showStatus('Fixing insertions/deletions in V genes ...', StatusHandle);
                 VDJdata(KeepLoc, :) = fixGeneIndel(VDJdata(KeepLoc, :), Map, DB);
+                Bench = benchStage(Bench, 'fixGeneIndel', sum(KeepLoc));
 
                 showStatus('Accepting F genes instead of ORF/P ...', StatusHandle);
                 VDJdata(KeepLoc, :) = fixDegenVDJ(VDJdata(KeepLoc, :), Map, DB);
+                Bench = benchStage(Bench, 'fixDegenVDJ', sum(KeepLoc));
 
                 showStatus('Anchoring 104C and 118W/F ...', StatusHandle);
                 VDJdata(KeepLoc, :) = constrainGeneVJ(VDJdata(KeepLoc, :), Map, DB);
+                Bench = benchStage(Bench, 'constrainGeneVJ', sum(KeepLoc));
 
                 showStatus('Moving non-functional Seq to Err file ...', StatusHandle);
                 VDJdata = labelSeqQuality(VDJdata, Map, 0.4);
+                Bench = benchStage(Bench, 'labelSeqQuality', size(VDJdata, 1));
+
+                if strcmpi(Collapse, 'y')
+                    showStatus('Copying annotations to identical sequences ...', StatusHandle);
+                    [VDJdata, Known] = expandVDJdata(VDJdata, VDJheader, Dup, Known);
+                    Bench = benchStage(Bench, 'expandVDJdata', size(VDJdata, 1));
+                end
 
                 FunctIdx = nonzeros([Map.hFunct Map.lFunct]);
                 KeepLoc = all(strcmpi(VDJdata(:, FunctIdx), 'Y'), 2);
                 if ~all(KeepLoc)
-                    saveSeqData(ErrFileName, VDJdata(~KeepLoc, :), VDJheader, 'append');
+                    saveSeqData(ErrFileName, VDJdata(~KeepLoc, :), VDJheader, SaveOpt{:});
+                    Bench = benchStage(Bench, 'saveSeqData:Err', sum(~KeepLoc));
                     VDJdata = VDJdata(KeepLoc, :);
                     if isempty(VDJdata)
                         showStatus(sprintf('No sequences left to annotate in batch #%d.', b), StatusHandle);
+                        writeColFileMEX(VDJdata, VDJheader, TmpFileName, SeqRangeB(2), SaveOpt{:}); %Still save the resume point
+                        Bench = benchStage(Bench, 'writeColFileMEX', 0);
                         continue
                     end 
                 end
 
                 if strcmpi(SkipLineage, 'y')
                     VDJdata = findCDR(VDJdata, Map, DB, 1:3, 'imgt');
+                    Bench = benchStage(Bench, 'findCDR', size(VDJdata, 1));
                     VDJdata = buildVDJalignment(VDJdata, Map, DB);
+                    Bench = benchStage(Bench, 'buildVDJalignment', size(VDJdata, 1));
                 end
 
-                saveSeqData(TmpFileName, VDJdata, VDJheader, 'append');
+                writeColFileMEX(VDJdata, VDJheader, TmpFileName, SeqRangeB(2), SaveOpt{:});
+                Bench = benchStage(Bench, 'writeColFileMEX', size(VDJdata, 1));
+            end
+            writeDlmFileMEX('flush'); %The Err rows are written in the background, so wait for them once here
+            writeColFileMEX('flush');
+            Bench = benchStage(Bench, 'writeDlmFileMEX:flush', 0);
+            if ~isempty(Known) && ~isempty(Known.Handle)
+                vdjTableMEX('delete', Known.Handle);
             end
+            findUniqueSeqMEX('clear');
             if exist(TmpFileName, 'file')
                 movefile(TmpFileName, RawFileName);
             else
@@ -491,6 +561,8 @@ while true
             showStatus(sprintf('Processing %s ...', RawFileName), StatusHandle);
             [VDJdata, VDJheader, ~, ~, Map] = openSeqData(RawFileName);
             if isempty(VDJdata); continue; end
+            NumSeq = size(VDJdata, 1);
+            Bench = benchStage(Bench, 'openSeqData', NumSeq);
     
 %CODING_NOTE: This will be added for future release due to HTS paired end reads with poor quality edge reads.
 %Still under development and testing with other datasets.
@@ -500,32 +572,56 @@ while true
             
             showStatus('Clustering by lineage ...', StatusHandle)
             VDJdata = clusterByJunction(VDJdata, Map);
+            Bench = benchStage(Bench, 'clusterByJunction', NumSeq);
             VDJdata = spliceData(VDJdata, Map); %Make it parfor-capable
+            Bench = benchStage(Bench, 'spliceData', NumSeq);
             VDJdata = clusterByLineage(VDJdata, Map, 'shmham');
+            Bench = benchStage(Bench, 'clusterByLineage', NumSeq);
 
             showStatus('Correcting annotations by lineage ...', StatusHandle)
             VDJdata = conformGeneGroup(VDJdata, Map, DB);     
+            Bench = benchStage(Bench, 'conformGeneGroup', NumSeq);
             
             showStatus('Refining D annotations ...', StatusHandle)
             VDJdata = findBetterD(VDJdata, Map, DB);
+            Bench = benchStage(Bench, 'findBetterD', NumSeq);
 
             showStatus('Trimming N regions ...', StatusHandle)
             VDJdata = trimGeneEdge(VDJdata, Map, DB);
+            Bench = benchStage(Bench, 'trimGeneEdge', NumSeq);
                 
             VDJdata = joinData(VDJdata, Map);
+            Bench = benchStage(Bench, 'joinData', NumSeq);
 
             showStatus('Finalizing annotations ...', StatusHandle);
             VDJdata = padtrimSeqGroup(VDJdata, Map, 'grpnum', 'trim', 'Seq'); 
+            Bench = benchStage(Bench, 'padtrimSeqGroup', NumSeq);
             VDJdata = findCDR(VDJdata, Map, DB, 1:3, 'imgt');
+            Bench = benchStage(Bench, 'findCDR', NumSeq);
             VDJdata = buildVDJalignment(VDJdata, Map, DB);
+            Bench = benchStage(Bench, 'buildVDJalignment', NumSeq);
                 
             saveSeqData(OutputFile{f}, VDJdata, VDJheader);
+            Bench = benchStage(Bench, 'saveSeqData', NumSeq);
             
             %Post processing step
             if Cutoff > 0
                 showStatus('Removing sequences that are too similar ...', StatusHandle);
                 mergeSimilarSeq(OutputFile{f}, Cutoff);
+                Bench = benchStage(Bench, 'mergeSimilarSeq', NumSeq);
             end
+        else %The Raw file is a binary checkpoint, so save the annotations as a .csv file
+            [VDJdata, VDJheader] = openSeqData(RawFileName);
+            Bench = benchStage(Bench, 'openSeqData', size(VDJdata, 1));
+            saveSeqData(OutputFile{f}, VDJdata, VDJheader);
+            Bench = benchStage(Bench, 'saveSeqData', size(VDJdata, 1));
+        end
+        if ~isempty(Bench)
+            BenchFile = fullfile(OutPath, [OutFilePre '.Bench.json']);
+            BenchInfo = struct('Version', Version, 'Input', InputFile{f}, 'Species', Species, 'Chain', Chain, ...
+                               'BatchSize', BatchSize, 'Cores', NumWorkers, 'Collapse', Collapse, 'SkipLineage', SkipLineage);
+            benchStage(Bench, 'save', BenchFile, BenchInfo);
+            showStatus(sprintf('Saved the stage times to "%s".', BenchFile), StatusHandle);
         end
         showStatus(sprintf('Finished in %0.1f sec.', toc(TicInputFile)), StatusHandle);
     end
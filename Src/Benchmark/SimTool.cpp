@@ -0,0 +1,268 @@
+/*  SimTool is a C++ port of the heavy chain part of generateVDJseq.m,
+ *  generateSHMseq.m, and generateNregion.m, used to make realistic reads
+ *  and germline seq for benchBRILIA without MATLAB. The random numbers
+ *  differ from MATLAB's, but the distributions and rules are the same.
+ *
+ *  NOTE: Germline genes are read from the IMGT gapped fasta files in the
+ *  Databases folder. Only functional (F) genes with a 104C or 118W/F
+ *  anchor are used, same as the Vfunction = 'F' default.
+ */
+
+#include "SimTool.hpp"
+#include <fstream>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <ctype.h>
+
+static double rand1(std::mt19937_64 &Rng) {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(Rng);
+}
+
+static int randIdx(std::mt19937_64 &Rng, size_t N) {
+    return (int) std::uniform_int_distribution<size_t>(0, N - 1)(Rng);
+}
+
+// Same as round(-Mean*log(rand(1))), capped at Cap
+static int randExpLen(std::mt19937_64 &Rng, double Mean, int Cap) {
+    int Len = (int) round(-Mean * log(1.0 - rand1(Rng)));
+    return Len > Cap ? Cap : Len;
+}
+
+static char translateCodon(const char *pCodon) {
+    static const char *pTable = "KNKNTTTTRSRSIIMIQHQHPPPPRRRRLLLLEDEDAAAAGGGGVVVV*Y*YSSSS*CWCLFLF";
+    int Idx = 0;
+    for (int k = 0; k < 3; k++) {
+        const char *pNT = strchr("ACGT", pCodon[k]);
+        if (pNT == NULL || pCodon[k] == '\0') { return 'X'; }
+        Idx = 4*Idx + (int) (pNT - "ACGT");
+    }
+    return pTable[Idx];
+}
+
+// Finds the J gene 118W/F anchor as the 1st nt of the W/F codon of the WGxG/FGxG motif
+static int findJAnchor(const std::string &Seq) {
+    for (size_t j = 0; j + 12 <= Seq.size(); j++) {
+        char AA = translateCodon(&Seq[j]);
+        if ((AA == 'W' || AA == 'F') && translateCodon(&Seq[j+3]) == 'G' && translateCodon(&Seq[j+9]) == 'G') {
+            return (int) j + 1;
+        }
+    }
+    return 0;
+}
+
+// Reads an IMGT gapped fasta file of X = 'V', 'D', or 'J' genes
+std::vector<gene_seq> readGeneFasta(const std::string &FileName, char X) {
+    std::vector<gene_seq> Genes;
+    std::ifstream File(FileName.c_str());
+    std::string Line, GappedSeq;
+    bool IsFunct = false;
+    gene_seq Gene;
+    while (true) {
+        bool HasLine = (bool) std::getline(File, Line);
+        if (!Line.empty() && Line.back() == '\r') { Line.pop_back(); }
+        if (!HasLine || (!Line.empty() && Line[0] == '>')) {
+            if (IsFunct && !GappedSeq.empty()) {
+                Gene.Seq.clear();
+                int CIdx = 0;
+                for (size_t j = 0; j < GappedSeq.size(); j++) {
+                    if (j == 309) { CIdx = (int) Gene.Seq.size() + 1; } //IMGT 104C codon starts at gapped nt 310
+                    if (GappedSeq[j] == '.') { continue; }
+                    char NT = (char) toupper(GappedSeq[j]);
+                    Gene.Seq += strchr("ACGT", NT) != NULL ? NT : 'N'; //Same as fixSeqDNA
+                }
+                if (X == 'V') {
+                    Gene.Anchor = CIdx > 0 ? (int) Gene.Seq.size() - CIdx + 1 : 0;
+                } else if (X == 'J') {
+                    Gene.Anchor = findJAnchor(Gene.Seq);
+                }
+                if (X == 'D' || Gene.Anchor > 0) { Genes.push_back(Gene); }
+            }
+            if (!HasLine) { break; }
+            size_t Bar1 = Line.find('|');
+            size_t Bar2 = Line.find('|', Bar1 + 1);
+            size_t Bar3 = Line.find('|', Bar2 + 1);
+            size_t Bar4 = Line.find('|', Bar3 + 1);
+            Gene.Name = Bar2 != std::string::npos ? Line.substr(Bar1 + 1, Bar2 - Bar1 - 1) : Line.substr(1);
+            IsFunct = Bar4 != std::string::npos && Line.substr(Bar3 + 1, Bar4 - Bar3 - 1) == "F";
+            GappedSeq.clear();
+        } else {
+            GappedSeq += Line;
+        }
+    }
+    return Genes;
+}
+
+// Reads the IGHV/D/J fasta files in <DBPath>/<Species>/
+gene_db readGeneDatabase(const std::string &DBPath, const std::string &Species) {
+    gene_db DB;
+    std::string Prefix = DBPath + "/" + Species + "/IGH";
+    DB.V = readGeneFasta(Prefix + "V_" + Species + ".fa", 'V');
+    DB.D = readGeneFasta(Prefix + "D_" + Species + ".fa", 'D');
+    DB.J = readGeneFasta(Prefix + "J_" + Species + ".fa", 'J');
+    return DB;
+}
+
+// Makes a TDT-like N region, which is mostly A and G (or C and T if flipped)
+std::string generateNregion(int Len, double FlipProb, std::mt19937_64 &Rng) {
+    static const double pCumProb[4] = {0.25, 0.33, 0.93, 1.00}; //A, C, G, T
+    std::string Nregion(Len, 'N');
+    for (int j = 0; j < Len; j++) {
+        double R = rand1(Rng);
+        int k = 0;
+        while (k < 3 && R > pCumProb[k]) { k++; }
+        Nregion[j] = "ACGT"[k];
+    }
+    if (Len > 0 && rand1(Rng) <= FlipProb) {
+        for (int j = 0; j < Len; j++) {
+            Nregion[j] = "TGCA"[strchr("ACGT", Nregion[j]) - "ACGT"];
+        }
+    }
+    return Nregion;
+}
+
+std::vector<sim_seq> generateVDJseq(const gene_db &DB, const sim_param &P) {
+    std::vector<sim_seq> Out;
+    if (DB.V.empty() || DB.D.empty() || DB.J.empty()) { return Out; }
+    std::mt19937_64 Rng(P.Seed);
+
+    double MeanV3del = 2.1, MeanD5del = 4.5, MeanD3del = 5.0, MeanJ5del = 6.8, MeanMlen = 7, MeanNlen = 7;
+    if (P.IsMouse) {
+        MeanV3del = 1;
+        MeanD5del = 4.5;
+        MeanD3del = 3.4;
+        MeanJ5del = 3.9;
+        MeanMlen = 3.8;
+        MeanNlen = 2.9;
+    }
+    int DelCap = 13;
+    int InsCap = P.TDTon ? 13 : 0;
+
+    for (int g = 1; g <= P.CloneCount; g++) {
+        sim_seq S;
+        while (true) {
+            S.Vnum = randIdx(Rng, DB.V.size());
+            S.Dnum = randIdx(Rng, DB.D.size());
+            S.Jnum = randIdx(Rng, DB.J.size());
+            const gene_seq &V = DB.V[S.Vnum], &D = DB.D[S.Dnum], &J = DB.J[S.Jnum];
+            int V3del = randExpLen(Rng, MeanV3del, DelCap);
+            int D5del = randExpLen(Rng, MeanD5del, DelCap);
+            int D3del = randExpLen(Rng, MeanD3del, DelCap);
+            int J5del = randExpLen(Rng, MeanJ5del, DelCap);
+            int Mlen  = randExpLen(Rng, MeanMlen, InsCap);
+            int Nlen  = randExpLen(Rng, MeanNlen, InsCap);
+
+            //Make sure deletions avoid 104C and 118W codons, and whole D gene
+            if (V3del >= V.Anchor - 2 || J5del >= J.Anchor) { continue; }
+            if (D5del + D3del >= (int) D.Seq.size()) { continue; }
+
+            std::string Vseq = V.Seq.substr(0, V.Seq.size() - V3del);
+            std::string Mseq = generateNregion(Mlen, 0.25, Rng);
+            std::string Dseq = D.Seq.substr(D5del, D.Seq.size() - D5del - D3del);
+            std::string Nseq = generateNregion(Nlen, 0.45, Rng);
+            std::string Jseq = J.Seq.substr(J5del);
+            S.Seq = Vseq + Mseq + Dseq + Nseq + Jseq;
+            int pLen[5] = {(int) Vseq.size(), (int) Mseq.size(), (int) Dseq.size(), (int) Nseq.size(), (int) Jseq.size()};
+            std::copy(pLen, pLen + 5, S.Len);
+
+            //Check for an in-frame CDR3 without stop codons
+            S.CDR3s = pLen[0] + V3del - V.Anchor + 1;
+            S.CDR3e = pLen[0] + pLen[1] + pLen[2] + pLen[3] - J5del + J.Anchor + 2;
+            int CDR3Len = S.CDR3e - S.CDR3s + 1;
+            if (CDR3Len % 3 != 0 || CDR3Len / 3 < 5) { continue; }
+            bool HasStop = false;
+            for (size_t j = (S.CDR3s - 1) % 3; j + 3 <= S.Seq.size(); j += 3) {
+                if (translateCodon(&S.Seq[j]) == '*') {
+                    HasStop = true;
+                    break;
+                }
+            }
+            if (!HasStop) { break; }
+        }
+        S.RefSeq = S.Seq;
+        S.GrpNum = g;
+        generateSHMseq(Out, S, P, Rng);
+    }
+    return Out;
+}
+
+// Adds the germline seq and BranchWidth x BranchLength descendants with SHMs
+void generateSHMseq(std::vector<sim_seq> &Out, const sim_seq &Germline, const sim_param &P, std::mt19937_64 &Rng) {
+    //Prob of nt (column) mutating to nt (row), from D Lee 2017 BRILIA mouse data
+    static const double pNT2NT[4][4] = {{0,     7320,  22093, 5798},
+                                        {9228,  0,     8200,  19160},
+                                        {30650, 7874,  0,     7492},
+                                        {12086, 23588, 5886,  0}};
+    double pNT[4] = {0}, pCumNT2NT[4][4];
+    for (int c = 0; c < 4; c++) {
+        double ColSum = 0;
+        for (int r = 0; r < 4; r++) { ColSum += pNT2NT[r][c]; }
+        double CumSum = 0;
+        for (int r = 0; r < 4; r++) {
+            CumSum += pNT2NT[r][c];
+            pCumNT2NT[r][c] = CumSum / ColSum;
+        }
+        pNT[c] = ColSum;
+    }
+
+    size_t GrpStart = Out.size();
+    Out.push_back(Germline);
+    for (int b = 0; b < P.BranchWidth; b++) {
+        size_t AncIdx = GrpStart + randIdx(Rng, Out.size() - GrpStart);
+        sim_seq Parent = Out[AncIdx];
+        int SHMcount = (int) round(P.SHMperc / 100 * Parent.Seq.size());
+        int Frame = (Parent.CDR3s - 1) % 3;
+        for (int d = 0; d < P.BranchLength; d++) {
+            std::string Seq = Parent.Seq;
+            int MutCount = 0;
+            while (MutCount < SHMcount) {
+                //Select the nt type to mutate, weighted by count and propensity
+                double pBaseCt[4] = {0}, Total = 0;
+                for (size_t j = 0; j < Seq.size(); j++) {
+                    const char *pNTk = strchr("ACGT", Seq[j]);
+                    if (pNTk != NULL) { pBaseCt[pNTk - "ACGT"]++; }
+                }
+                for (int k = 0; k < 4; k++) { Total += pBaseCt[k] * pNT[k]; }
+                if (Total <= 0) { break; }
+                double R = rand1(Rng) * Total, CumSum = 0;
+                int X0 = 0;
+                for (; X0 < 3; X0++) {
+                    CumSum += pBaseCt[X0] * pNT[X0];
+                    if (R <= CumSum) { break; }
+                }
+                double R1 = rand1(Rng);
+                int X1 = 0;
+                while (X1 < 3 && R1 > pCumNT2NT[X1][X0]) { X1++; }
+
+                //Pick a position with nt X0
+                int Nth = randIdx(Rng, (size_t) pBaseCt[X0]);
+                int Pos = -1;
+                for (size_t j = 0; j < Seq.size(); j++) {
+                    if (Seq[j] == "ACGT"[X0] && Nth-- == 0) {
+                        Pos = (int) j;
+                        break;
+                    }
+                }
+                if (Pos < Frame) { continue; }
+
+                //Reject stop codons, and changes to the 104C and 118W/F
+                int CodonS = Frame + (Pos - Frame) / 3 * 3;
+                if (CodonS + 3 <= (int) Seq.size()) {
+                    std::string Codon = Seq.substr(CodonS, 3);
+                    Codon[Pos - CodonS] = "ACGT"[X1];
+                    char AA = translateCodon(Codon.c_str());
+                    if (AA == '*') { continue; }
+                    if (CodonS + 1 == Parent.CDR3s && AA != 'C') { continue; }
+                    if (CodonS + 3 == Parent.CDR3e && AA != 'W' && AA != 'F') { continue; }
+                }
+                Seq[Pos] = "ACGT"[X1];
+                MutCount++;
+            }
+            sim_seq Child = Parent;
+            Child.RefSeq = Parent.Seq;
+            Child.Seq = Seq;
+            Out.push_back(Child);
+            Parent = Child;
+        }
+    }
+}
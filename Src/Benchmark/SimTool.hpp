@@ -0,0 +1,48 @@
+#ifndef SIM_TOOL_HPP
+#define SIM_TOOL_HPP
+
+#include <string>
+#include <vector>
+#include <random>
+
+// gene_seq stores one germline gene from an IMGT fasta file
+struct gene_seq {
+    std::string Name;  //Name: gene name, ex: IGHV1-11*01
+    std::string Seq;   //Seq: ACGTN nt seq without the IMGT '.' gaps
+    int Anchor = 0;    //Anchor: V = nts from 3' end to 104C 1st nt; J = 118W/F 1st nt from 5' end. 0 if none.
+};
+
+// gene_db stores the heavy chain germline genes of a species
+struct gene_db {
+    std::vector<gene_seq> V, D, J;
+};
+
+// sim_seq stores one simulated heavy chain sequence
+struct sim_seq {
+    std::string Seq;    //Seq: simulated nt seq
+    std::string RefSeq; //RefSeq: parent seq (germline VDJ for 1st descendants)
+    int GrpNum = 0;     //GrpNum: clonal group number, 1-based
+    int Vnum = 0, Dnum = 0, Jnum = 0;  //Vnum/Dnum/Jnum: 0-based index of the genes in gene_db
+    int Len[5] = {0};   //Len: V, Nvd, D, Ndj, J lengths
+    int CDR3s = 0;      //CDR3s: 1-based position of 104C codon 1st nt
+    int CDR3e = 0;      //CDR3e: 1-based position of 118W codon 3rd nt
+};
+
+// sim_param stores the generateVDJseq settings
+struct sim_param {
+    int CloneCount = 100;
+    int BranchLength = 5;
+    int BranchWidth = 2;
+    double SHMperc = 2;
+    bool TDTon = true;
+    bool IsMouse = true;
+    unsigned int Seed = 1;
+};
+
+std::vector<gene_seq> readGeneFasta(const std::string&, char);
+gene_db readGeneDatabase(const std::string&, const std::string&);
+std::string generateNregion(int, double, std::mt19937_64&);
+std::vector<sim_seq> generateVDJseq(const gene_db&, const sim_param&);
+void generateSHMseq(std::vector<sim_seq>&, const sim_seq&, const sim_param&, std::mt19937_64&);
+
+#endif
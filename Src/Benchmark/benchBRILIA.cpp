@@ -0,0 +1,311 @@
+/*
+benchBRILIA is a native micro-benchmark of the BRILIA MEX kernels that
+runs without MATLAB. The kernels are compiled against the mex.h shim in
+this folder, and are fed with reads and germline seq from SimTool, a C++
+port of generateVDJseq and generateSHMseq. Results are printed and can be
+saved as JSON to compare across commits. With --fasta, it only saves the
+simulated reads to a fasta file, which benchPipeline uses to run the whole
+BRILIA pipeline on data of a chosen size.
+
+  benchBRILIA [Param Value ...]
+
+  INPUT
+     Param          Value (* = default)   Details
+     -------------- --------------------- --------------------------------
+     --db           * ../../Databases     Path to the BRILIA Databases folder
+     --species      * Mouse               Species folder name (Mouse, Human, ...)
+     --clones       * 100                 # of germline VDJ seq (clonal groups)
+     --branchlen    * 5                   # of linear descendants per branch
+     --branchwidth  * 2                   # of branches per clonal group
+     --shm          * 2                   % of nts mutated per descendant
+     --refs         * 4                   # of V germlines each read is aligned to
+     --reps         * 2                   # of timed passes over the data
+     --seed         * 1                   random number generator seed
+     --tag          * ''                  label saved in the JSON, ex: commit hash
+     --json         * ''                  JSON output file name. If empty, no JSON.
+     --fasta        * ''                  Save the simulated reads to this fasta file and exit
+
+  OUTPUT
+    For each kernel: # of ops, throughput (ops/s and nt/s), and the p50,
+    p90, and p99 latency per op in microseconds.
+
+  EXAMPLE
+    From the Src/Benchmark folder (or use compileBenchBRILIA in MATLAB):
+      g++ -O2 -std=c++11 -pthread -I. -I../MEX/Include benchBRILIA.cpp SimTool.cpp
+        ../MEX/Include/AlignTool.cpp ../MEX/Include/CpuTool.cpp ../MEX/Include/DgeneTool.cpp
+        ../MEX/Include/HotspotTool.cpp ../MEX/Include/SeqTool.cpp -o benchBRILIA
+      ./benchBRILIA --clones 500 --shm 5 --tag abc1234 --json bench.json
+      ./benchBRILIA --clones 1000 --fasta Sim11000.fa
+*/
+
+#include "mex.h"
+#include "SimTool.hpp"
+#include "AlignTool.hpp"
+#include "DgeneTool.hpp"
+#include "HotspotTool.hpp"
+#include <chrono>
+#include <algorithm>
+#include <map>
+#include <ctime>
+
+#define mexFunction convStr2NumMEX
+#include "../MEX/convStr2NumMEX.cpp"
+#undef mexFunction
+
+typedef std::basic_string<mxChar> mx_string;
+typedef std::chrono::steady_clock bench_clock;
+
+// bench_result stores the timing of one kernel
+struct bench_result {
+    std::string Name;
+    std::string OpUnit;          //OpUnit: what 1 op is, ex: alignments
+    double Ops = 0;              //Ops: # of timed ops
+    double NT = 0;               //NT: # of nt processed by the timed ops
+    double TotalSec = 0;
+    std::vector<double> LatUs;   //LatUs: latency per op in microseconds
+};
+
+static mx_string convStr2MxStr(const std::string &Str) {
+    return mx_string(Str.begin(), Str.end());
+}
+
+static double getPercentile(std::vector<double> &Sorted, double Pct) {
+    if (Sorted.empty()) { return 0; }
+    size_t Idx = (size_t) (Pct / 100 * (Sorted.size() - 1) + 0.5);
+    return Sorted[std::min(Idx, Sorted.size() - 1)];
+}
+
+// Times Func(j) for j = 0 to N-1, over Reps passes after 1 warm-up pass
+template <typename F>
+static void timeKernel(bench_result &R, size_t N, int Reps, F Func) {
+    for (size_t j = 0; j < N; j++) { Func(j); }
+    R.LatUs.reserve(N * Reps);
+    for (int r = 0; r < Reps; r++) {
+        for (size_t j = 0; j < N; j++) {
+            bench_clock::time_point T0 = bench_clock::now();
+            double NT = Func(j);
+            double Us = std::chrono::duration<double, std::micro>(bench_clock::now() - T0).count();
+            R.LatUs.push_back(Us);
+            R.TotalSec += Us / 1e6;
+            R.NT += NT;
+            R.Ops++;
+        }
+    }
+}
+
+static void printResult(bench_result &R) {
+    std::sort(R.LatUs.begin(), R.LatUs.end());
+    printf("%-16s %10.0f %-12s %12.0f ops/s %12.3e nt/s   p50 %8.2f  p90 %8.2f  p99 %8.2f us\n",
+           R.Name.c_str(), R.Ops, R.OpUnit.c_str(), R.Ops / R.TotalSec, R.NT / R.TotalSec,
+           getPercentile(R.LatUs, 50), getPercentile(R.LatUs, 90), getPercentile(R.LatUs, 99));
+}
+
+static void writeJson(const std::string &FileName, const std::string &Tag,
+                      const std::map<std::string, std::string> &Param, std::vector<bench_result> &Results) {
+    FILE *pFile = fopen(FileName.c_str(), "w");
+    if (pFile == NULL) {
+        fprintf(stderr, "benchBRILIA: Could not write to \"%s\".\n", FileName.c_str());
+        return;
+    }
+    char DateStr[32];
+    time_t Now = time(NULL);
+    strftime(DateStr, sizeof(DateStr), "%Y-%m-%dT%H:%M:%S", localtime(&Now));
+    fprintf(pFile, "{\n  \"tag\": \"%s\",\n  \"date\": \"%s\",\n  \"param\": {", Tag.c_str(), DateStr);
+    for (std::map<std::string, std::string>::const_iterator it = Param.begin(); it != Param.end(); ++it) {
+        fprintf(pFile, "%s\n    \"%s\": \"%s\"", it == Param.begin() ? "" : ",", it->first.c_str(), it->second.c_str());
+    }
+    fprintf(pFile, "\n  },\n  \"results\": [");
+    for (size_t k = 0; k < Results.size(); k++) {
+        bench_result &R = Results[k];
+        fprintf(pFile, "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", \"ops\": %.0f, \"total_s\": %.6f, "
+                "\"ops_per_s\": %.1f, \"nt_per_s\": %.1f, \"p50_us\": %.3f, \"p90_us\": %.3f, \"p99_us\": %.3f}",
+                k == 0 ? "" : ",", R.Name.c_str(), R.OpUnit.c_str(), R.Ops, R.TotalSec,
+                R.Ops / R.TotalSec, R.NT / R.TotalSec,
+                getPercentile(R.LatUs, 50), getPercentile(R.LatUs, 90), getPercentile(R.LatUs, 99));
+    }
+    fprintf(pFile, "\n  ]\n}\n");
+    fclose(pFile);
+}
+
+// Saves the simulated reads, named like generateVDJseq's Seq#_Grp#_V_D_J_Len(V|Nvd|D|Ndj|J)
+static bool writeFasta(const std::string &FileName, const gene_db &DB, const std::vector<sim_seq> &Sim) {
+    FILE *pFile = fopen(FileName.c_str(), "w");
+    if (pFile == NULL) {
+        fprintf(stderr, "benchBRILIA: Could not write to \"%s\".\n", FileName.c_str());
+        return false;
+    }
+    for (size_t j = 0; j < Sim.size(); j++) {
+        const sim_seq &S = Sim[j];
+        fprintf(pFile, ">Seq%d_Grp%d_%s_%s_%s_Len(%d|%d|%d|%d|%d)\n%s\n", (int) j + 1, S.GrpNum,
+                DB.V[S.Vnum].Name.c_str(), DB.D[S.Dnum].Name.c_str(), DB.J[S.Jnum].Name.c_str(),
+                S.Len[0], S.Len[1], S.Len[2], S.Len[3], S.Len[4], S.Seq.c_str());
+    }
+    fclose(pFile);
+    printf("Saved %d reads to \"%s\".\n", (int) Sim.size(), FileName.c_str());
+    return true;
+}
+
+int main(int argc, char *argv[]) {
+    std::map<std::string, std::string> Param;
+    Param["db"] = "../../Databases";
+    Param["species"] = "Mouse";
+    Param["clones"] = "100";
+    Param["branchlen"] = "5";
+    Param["branchwidth"] = "2";
+    Param["shm"] = "2";
+    Param["refs"] = "4";
+    Param["reps"] = "2";
+    Param["seed"] = "1";
+    std::string Tag, JsonFile, FastaFile;
+    for (int k = 1; k + 1 < argc; k += 2) {
+        std::string Name = argv[k];
+        if (Name.compare(0, 2, "--") != 0 || (Param.count(Name.substr(2)) == 0 && Name != "--tag" && Name != "--json" && Name != "--fasta")) {
+            fprintf(stderr, "benchBRILIA: Unknown parameter \"%s\".\n", argv[k]);
+            return 1;
+        }
+        if (Name == "--tag") {
+            Tag = argv[k+1];
+        } else if (Name == "--json") {
+            JsonFile = argv[k+1];
+        } else if (Name == "--fasta") {
+            FastaFile = argv[k+1];
+        } else {
+            Param[Name.substr(2)] = argv[k+1];
+        }
+    }
+
+    sim_param SP;
+    SP.CloneCount   = atoi(Param["clones"].c_str());
+    SP.BranchLength = atoi(Param["branchlen"].c_str());
+    SP.BranchWidth  = atoi(Param["branchwidth"].c_str());
+    SP.SHMperc      = atof(Param["shm"].c_str());
+    SP.Seed         = (unsigned int) atoi(Param["seed"].c_str());
+    SP.IsMouse      = Param["species"] == "Mouse";
+    int NumRef = std::max(1, atoi(Param["refs"].c_str()));
+    int Reps = std::max(1, atoi(Param["reps"].c_str()));
+
+    gene_db DB = readGeneDatabase(Param["db"], Param["species"]);
+    if (DB.V.empty() || DB.D.empty() || DB.J.empty()) {
+        fprintf(stderr, "benchBRILIA: Could not read the IGHV/D/J genes from \"%s/%s\".\n", Param["db"].c_str(), Param["species"].c_str());
+        return 1;
+    }
+    std::vector<sim_seq> Sim = generateVDJseq(DB, SP);
+    printf("Simulated %d reads from %d V, %d D, %d J genes (%s).\n",
+           (int) Sim.size(), (int) DB.V.size(), (int) DB.D.size(), (int) DB.J.size(), Param["species"].c_str());
+    if (!FastaFile.empty()) {
+        return writeFasta(FastaFile, DB, Sim) ? 0 : 1;
+    }
+
+    //Convert to the mxChar seq used by the kernels
+    size_t NumSeq = Sim.size();
+    std::vector<mx_string> Seq(NumSeq), RefSeq(NumSeq), Vseq(DB.V.size());
+    std::vector<mx_string> LenStr(NumSeq);
+    for (size_t j = 0; j < NumSeq; j++) {
+        Seq[j] = convStr2MxStr(Sim[j].Seq);
+        RefSeq[j] = convStr2MxStr(Sim[j].RefSeq);
+        char Buf[64];
+        snprintf(Buf, sizeof(Buf), "%d|%d|%d|%d|%d", Sim[j].Len[0], Sim[j].Len[1], Sim[j].Len[2], Sim[j].Len[3], Sim[j].Len[4]);
+        LenStr[j] = convStr2MxStr(Buf);
+    }
+    for (size_t v = 0; v < DB.V.size(); v++) {
+        Vseq[v] = convStr2MxStr(DB.V[v].Seq);
+    }
+
+    //N-D-N windows for the D gene search
+    std::vector<mx_string> NDNseq(NumSeq);
+    std::vector<std::string> Dseq(DB.D.size());
+    for (size_t j = 0; j < NumSeq; j++) {
+        NDNseq[j] = convStr2MxStr(Sim[j].Seq.substr(Sim[j].Len[0], Sim[j].Len[1] + Sim[j].Len[2] + Sim[j].Len[3]));
+    }
+    for (size_t d = 0; d < DB.D.size(); d++) {
+        Dseq[d] = DB.D[d].Seq;
+    }
+    dgene_set DS;
+    buildDgeneSet(DS, Dseq);
+
+    //Each read is aligned to its true V gene and NumRef-1 random ones
+    std::mt19937_64 Rng(SP.Seed);
+    std::vector<int> RefIdx(NumSeq * NumRef);
+    for (size_t j = 0; j < NumSeq; j++) {
+        RefIdx[j*NumRef] = Sim[j].Vnum;
+        for (int r = 1; r < NumRef; r++) {
+            RefIdx[j*NumRef + r] = (int) (Rng() % DB.V.size());
+        }
+    }
+
+    std::vector<bench_result> Results;
+    bench_result R;
+
+    R = bench_result();
+    R.Name = "alignSeq";
+    R.OpUnit = "alignments";
+    timeKernel(R, NumSeq * NumRef, Reps, [&](size_t k) {
+        mx_string &A = Seq[k / NumRef];
+        mx_string &B = Vseq[RefIdx[k]];
+        align_info AI;
+        alignSeq(&A[0], &B[0], A.size(), B.size(), 0, 'n', 'n', 'r', 'l', 'l', AI);
+        return (double) A.size();
+    });
+    Results.push_back(R);
+
+    R = bench_result();
+    R.Name = "findDmatch";
+    R.OpUnit = "seqs";
+    timeKernel(R, NumSeq, Reps, [&](size_t j) {
+        d_match DM;
+        findDmatch(DS, &NDNseq[j][0], NDNseq[j].size(), 0.15, DM);
+        return (double) NDNseq[j].size();
+    });
+    Results.push_back(R);
+
+    R = bench_result();
+    R.Name = "cmprSeq";
+    R.OpUnit = "pairs";
+    timeKernel(R, NumSeq, Reps, [&](size_t j) {
+        mwSize Len = std::min(Seq[j].size(), RefSeq[j].size());
+        bool *pMatch = new bool[Len];
+        cmprSeq(&Seq[j][0], &RefSeq[j][0], Len, 'n', pMatch);
+        delete[] pMatch;
+        return (double) Len;
+    });
+    Results.push_back(R);
+
+    R = bench_result();
+    R.Name = "calcSeqShmScore";
+    R.OpUnit = "pairs";
+    timeKernel(R, NumSeq, Reps, [&](size_t j) {
+        mwSize Len = std::min(Seq[j].size(), RefSeq[j].size());
+        double pScore[6] = {0};
+        calcSeqShmScore(&Seq[j][0], &RefSeq[j][0], Len, pScore);
+        return (double) Len;
+    });
+    Results.push_back(R);
+
+    R = bench_result();
+    R.Name = "countHotspots";
+    R.OpUnit = "seqs";
+    timeKernel(R, NumSeq, Reps, [&](size_t j) {
+        countHotspots(&Seq[j][0], Seq[j].size());
+        return (double) Seq[j].size();
+    });
+    Results.push_back(R);
+
+    R = bench_result();
+    R.Name = "convStrToMatrix";
+    R.OpUnit = "strings";
+    timeKernel(R, NumSeq, Reps, [&](size_t j) {
+        mxDestroyArray(convStrToMatrix(&LenStr[j][0], LenStr[j].size()));
+        return (double) LenStr[j].size();
+    });
+    Results.push_back(R);
+
+    printf("%-16s %10s %-12s %18s %18s\n", "Kernel", "Ops", "Unit", "Throughput", "");
+    for (size_t k = 0; k < Results.size(); k++) {
+        printResult(Results[k]);
+    }
+    if (!JsonFile.empty()) {
+        writeJson(JsonFile, Tag, Param, Results);
+        printf("Saved results to \"%s\".\n", JsonFile.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,229 @@
+%benchPipeline will run the whole BRILIA pipeline on the bundled Examples
+%or on simulated data of chosen sizes, and report the wall time, reads/s,
+%and peak memory of each stage (see benchStage). Reports are saved as
+%JSON so that the ones of different versions can be compared to catch
+%throughput regressions.
+%
+%  Report = benchPipeline(Param, Value, ...)
+%
+%  IsSlower = benchPipeline('compare', OldReport, NewReport)
+%
+%  IsSlower = benchPipeline('compare', OldReport, NewReport, MaxSlowdown)
+%
+%  INPUT
+%    Param       Value (* = default)   Details
+%    ----------- --------------------- --------------------------------
+%    Input       * 'Examples'          Run all .fa and .csv files in the Examples folder
+%                  "Folder\File*.csv"  Run these files, which have the Species and Chain below
+%    Sizes       * []                  Run the Input files
+%                  [N1 N2 ...]         Run N1, N2, ... simulated heavy chain reads instead,
+%                                        made by benchBRILIA with 5 descendants x 2 branches
+%    Species     * 'Mouse'             Species of the Input or simulated files
+%    Chain       * 'H'                 Chain of the Input files
+%    SHMperc     * 2                   % of nts mutated per descendant of simulated reads
+%    Cores       * 'max'               Cores used by BRILIA
+%    BatchSize   * 30000               Reads per BRILIA batch
+%    OutputDir   * tempdir/BRILIA_Bench Folder for the BRILIA outputs and simulated reads
+%    Tag         * ''                  Label saved in the report, ex: commit hash
+%    SaveAs      * ''                  JSON report file name. If empty, no JSON.
+%
+%    OldReport, NewReport: report structures or their JSON file names
+%    MaxSlowdown [0.1]: flag stages whose reads/s dropped by more than
+%      this fraction
+%
+%  OUTPUT
+%    Report: structure with the Tag, Date, Version, Computer, and the File
+%      structure of the benchStage report of each input file
+%    IsSlower: true if any stage or file total is flagged as slower
+%
+%  NOTE
+%    Simulated reads number 11 x ceil(N/11), since each clonal group has a
+%    germline and 10 descendants. Simulations need benchBRILIA, which is
+%    compiled with compileBenchBRILIA if it is not found.
+%
+%    Stages that take < 0.1 s in both reports are not flagged, since their
+%    times are mostly noise.
+%
+%  EXAMPLE
+%    benchPipeline('Sizes', [1000 10000], 'Tag', 'v3.5.9', 'SaveAs', 'Old.json');
+%    %...change the code...
+%    benchPipeline('Sizes', [1000 10000], 'Tag', 'new', 'SaveAs', 'New.json');
+%    IsSlower = benchPipeline('compare', 'Old.json', 'New.json')
+%
+%  See also benchStage, BRILIA, compileBenchBRILIA
+
+function varargout = benchPipeline(varargin)
+if nargin >= 1 && ischar(varargin{1}) && strcmpi(varargin{1}, 'compare')
+    varargout{1} = compareReport(varargin{2:end});
+    return
+end
+
+P = inputParser;
+addParameter(P, 'Input',     'Examples', @(x) ischar(x) || iscell(x));
+addParameter(P, 'Sizes',     [],         @(x) isnumeric(x) && all(x >= 1));
+addParameter(P, 'Species',   'Mouse',    @ischar);
+addParameter(P, 'Chain',     'H',        @ischar);
+addParameter(P, 'SHMperc',   2,          @(x) isnumeric(x) && x >= 0 && x <= 100);
+addParameter(P, 'Cores',     'max',      @(x) ischar(x) || isnumeric(x));
+addParameter(P, 'BatchSize', 30000,      @(x) isnumeric(x) && x >= 1);
+addParameter(P, 'OutputDir', fullfile(tempdir, 'BRILIA_Bench'), @ischar);
+addParameter(P, 'Tag',       '',         @ischar);
+addParameter(P, 'SaveAs',    '',         @ischar);
+[Ps, ~, ReturnThis] = parseInput(P, varargin{:});
+if ReturnThis
+    varargout{1} = Ps;
+    return
+end
+
+if ~isdir(Ps.OutputDir)
+    [Success, Msg] = mkdir(Ps.OutputDir);
+    assert(Success > 0, '%s: Could not make the output dir "%s".\n  %s', mfilename, Ps.OutputDir, Msg);
+end
+
+if ~isempty(Ps.Sizes)
+    Job = makeSimJob(Ps);
+else
+    Job = makeInputJob(Ps);
+end
+assert(~isempty(Job), '%s: No input files were found.', mfilename);
+
+File = cell(numel(Job), 1);
+for k = 1:numel(Job)
+    fprintf('%s: Running BRILIA on "%s" ...\n', mfilename, Job(k).File);
+    OutFile = BRILIA(Job(k).File, 'Species', Job(k).Species, 'Chain', Job(k).Chain, 'OutputDir', Ps.OutputDir, ...
+        'Resume', 'n', 'Cores', Ps.Cores, 'BatchSize', Ps.BatchSize, 'Benchmark', 'y');
+    [OutPath, ~, ~, OutFilePre] = parseFileName(OutFile{1});
+    File{k} = jsondecode(fileread(fullfile(OutPath, [OutFilePre '.Bench.json'])));
+    showReport(File{k});
+end
+
+Report = struct('Tag', Ps.Tag, 'Date', datestr(now, 'yyyy-mm-ddTHH:MM:SS'), 'Version', BRILIA('version'), ...
+                'Computer', computer, 'File', vertcat(File{:}));
+if ~isempty(Ps.SaveAs)
+    [FID, Msg] = fopen(Ps.SaveAs, 'w');
+    assert(FID > 0, '%s: Could not write to "%s".\n  %s', mfilename, Ps.SaveAs, Msg);
+    fprintf(FID, '%s', jsonencode(Report));
+    fclose(FID);
+    fprintf('%s: Saved the report to "%s".\n', mfilename, Ps.SaveAs);
+end
+varargout{1} = Report;
+
+%Returns the Examples files or the Input files to run, with the species
+%and chain of each one. Examples folders are named as SpeciesChain.
+function Job = makeInputJob(Ps)
+Job = struct('File', {}, 'Species', {}, 'Chain', {});
+if ischar(Ps.Input) && strcmpi(Ps.Input, 'Examples')
+    [FullDirList, DirList] = dir2(fullfile(findRoot, 'Examples'), 'dir');
+    for j = 1:numel(FullDirList)
+        CapIdx = find(isstrprop(DirList{j}, 'upper'));
+        if numel(CapIdx) < 2; continue; end
+        FileName = dir2(fullfile(FullDirList{j}, '*.*'), 'file');
+        FileName = FileName(endsWith(FileName, {'.fa', '.fasta', '.csv'}, 'ignorecase', true));
+        for f = 1:numel(FileName)
+            Job(end+1) = struct('File', FileName{f}, 'Species', DirList{j}(1:CapIdx(2)-1), 'Chain', DirList{j}(CapIdx(2):end)); %#ok<AGROW>
+        end
+    end
+else
+    InputFile = Ps.Input;
+    if ischar(InputFile)
+        InputFile = dir(InputFile);
+        InputFile = fullfile({InputFile.folder}, {InputFile.name});
+    end
+    for f = 1:numel(InputFile)
+        Job(end+1) = struct('File', InputFile{f}, 'Species', Ps.Species, 'Chain', Ps.Chain); %#ok<AGROW>
+    end
+end
+
+%Simulates the reads of each size with benchBRILIA, which are saved in OutputDir
+function Job = makeSimJob(Ps)
+BenchExe = fullfile(findRoot, 'Src', 'Benchmark', 'benchBRILIA');
+if ispc
+    BenchExe = [BenchExe '.exe'];
+end
+if ~exist(BenchExe, 'file')
+    compileBenchBRILIA;
+end
+Job = struct('File', {}, 'Species', {}, 'Chain', {});
+for k = 1:numel(Ps.Sizes)
+    FastaFile = fullfile(Ps.OutputDir, sprintf('Sim%d.fa', Ps.Sizes(k)));
+    Cmd = sprintf('"%s" --db "%s" --species %s --clones %d --shm %g --fasta "%s"', BenchExe, ...
+        fullfile(findRoot, 'Databases'), Ps.Species, ceil(Ps.Sizes(k)/11), Ps.SHMperc, FastaFile);
+    [Status, Msg] = system(Cmd);
+    assert(Status == 0, '%s: Could not simulate reads.\n  CMD: %s\n  MSG: %s', mfilename, Cmd, Msg);
+    Job(end+1) = struct('File', FastaFile, 'Species', Ps.Species, 'Chain', 'H'); %#ok<AGROW>
+end
+
+%Prints the stage results of 1 file
+function showReport(File)
+fprintf('\n%s  (%0.1f s)\n', File.Input, File.TotalSec);
+fprintf('  %-24s %6s %10s %10s %12s %10s\n', 'Stage', 'Calls', 'Reads', 'Sec', 'Reads/s', 'PeakMB');
+for s = 1:numel(File.Stage)
+    S = File.Stage(s);
+    fprintf('  %-24s %6d %10d %10.3f %12.0f %10.1f\n', S.Name, S.Calls, S.Reads, S.Sec, S.ReadsPerSec, getPeakMB(S));
+end
+fprintf('\n');
+
+%Returns the PeakMB, which is [] if it was saved as a JSON null
+function MB = getPeakMB(S)
+MB = S.PeakMB;
+if isempty(MB)
+    MB = NaN;
+end
+
+%Loads a report structure from a JSON file, if needed
+function Report = loadReport(Report)
+if ischar(Report)
+    Report = jsondecode(fileread(Report));
+end
+
+%Prints the speed of each stage in both reports, and flags the ones that
+%are slower by more than MaxSlowdown
+function IsSlower = compareReport(Old, New, MaxSlowdown)
+if nargin < 3 || isempty(MaxSlowdown)
+    MaxSlowdown = 0.1;
+end
+Old = loadReport(Old);
+New = loadReport(New);
+MinSec = 0.1;
+
+IsSlower = false;
+OldName = arrayfun(@(x) getFileName(x.Input), Old.File, 'un', 0);
+fprintf('Old: %s (%s)\nNew: %s (%s)\n', Old.Tag, Old.Date, New.Tag, New.Date);
+for k = 1:numel(New.File)
+    NewFile = New.File(k);
+    Idx = find(strcmp(OldName, getFileName(NewFile.Input)), 1);
+    if isempty(Idx); continue; end
+    OldFile = Old.File(Idx);
+
+    fprintf('\n%s\n', getFileName(NewFile.Input));
+    fprintf('  %-24s %12s %12s %8s\n', 'Stage', 'Old reads/s', 'New reads/s', 'New/Old');
+    OldStage = {OldFile.Stage.Name};
+    for s = 1:numel(NewFile.Stage)
+        S = NewFile.Stage(s);
+        j = find(strcmp(OldStage, S.Name), 1);
+        if isempty(j); continue; end
+        [Ratio, Flag] = cmprSpeed(OldFile.Stage(j), S, MaxSlowdown, MinSec);
+        fprintf('  %-24s %12.0f %12.0f %8.2f %s\n', S.Name, OldFile.Stage(j).ReadsPerSec, S.ReadsPerSec, Ratio, Flag);
+        IsSlower = IsSlower || ~isempty(Flag);
+    end
+    Ratio = OldFile.TotalSec / NewFile.TotalSec;
+    Flag = '';
+    if Ratio < 1 - MaxSlowdown && max(OldFile.TotalSec, NewFile.TotalSec) >= MinSec
+        Flag = '<< SLOWER';
+        IsSlower = true;
+    end
+    fprintf('  %-24s %11.1fs %11.1fs %8.2f %s\n', 'Total', OldFile.TotalSec, NewFile.TotalSec, Ratio, Flag);
+end
+
+%Returns the new/old speed ratio of a stage, and a flag if it is slower.
+%Stages with 0 reads, like flushing files, are compared by time.
+function [Ratio, Flag] = cmprSpeed(OldS, NewS, MaxSlowdown, MinSec)
+Ratio = (max(NewS.Reads, 1) / NewS.Sec) / (max(OldS.Reads, 1) / OldS.Sec);
+Flag = '';
+if Ratio < 1 - MaxSlowdown && max(OldS.Sec, NewS.Sec) >= MinSec
+    Flag = '<< SLOWER';
+end
+
+%Returns the file name without the path
+function Name = getFileName(FullName)
+[~, Name] = parseFileName(FullName);
@@ -0,0 +1,118 @@
+%benchStage records the wall time, reads/s, and peak memory of each stage
+%of the BRILIA pipeline. BRILIA calls it after each stage when the
+%"Benchmark" option is "y". Calls with an empty Bench do nothing, so the
+%stages cost nothing extra when not benchmarking.
+%
+%  Bench = benchStage('start')
+%
+%  Bench = benchStage(Bench, StageName, ReadCount)
+%
+%  Report = benchStage(Bench, 'save', FileName, Info)
+%
+%  INPUT
+%    Bench: benchmark structure from benchStage('start'), or [] to skip
+%    StageName: name of the stage that just finished, ex: 'findVDJmatch'.
+%      Stages of the same name, such as in each batch, are added up.
+%    ReadCount: number of reads given to the stage
+%    FileName: JSON file to save the report to
+%    Info: structure of other fields to save in the report, ex: Version
+%
+%  OUTPUT
+%    Bench: benchmark structure with the stage results so far
+%    Report: Info structure with the TotalSec and a Stage structure, which
+%      has the Name, Calls, Reads, Sec, ReadsPerSec, and PeakMB per stage
+%
+%  NOTE
+%    The time of a stage is the time since the last benchStage call, so
+%    anything done between 2 stages is added to the 2nd one.
+%
+%    PeakMB is the peak resident memory of this MATLAB process during the
+%    stage on Linux, where the peak is reset after each stage. On Windows,
+%    it is the memory used by MATLAB at the end of the stage. It is NaN on
+%    other OS. Memory used by parallel workers is not included.
+%
+%  EXAMPLE
+%    Bench = benchStage('start');
+%    VDJdata = findCDR(VDJdata, Map, DB, 1:3, 'imgt');
+%    Bench = benchStage(Bench, 'findCDR', size(VDJdata, 1));
+%    Report = benchStage(Bench, 'save', 'test.Bench.json', struct('Version', BRILIA('version')));
+%
+%  See also BRILIA, benchPipeline
+
+function Bench = benchStage(varargin)
+if nargin == 1 && strcmpi(varargin{1}, 'start')
+    Bench.Stage = struct('Name', {}, 'Calls', {}, 'Reads', {}, 'Sec', {}, 'PeakMB', {});
+    resetPeakMemory;
+    Bench.Tic = tic;
+    return
+end
+
+Bench = varargin{1};
+if isempty(Bench); return; end
+
+if strcmpi(varargin{2}, 'save')
+    Bench = saveReport(Bench, varargin{3:end});
+    return
+end
+
+Sec = toc(Bench.Tic);
+PeakMB = getPeakMemory;
+StageName = varargin{2};
+ReadCount = varargin{3};
+
+Idx = find(strcmp({Bench.Stage.Name}, StageName), 1);
+if isempty(Idx)
+    Idx = numel(Bench.Stage) + 1;
+    Bench.Stage(Idx) = struct('Name', StageName, 'Calls', 0, 'Reads', 0, 'Sec', 0, 'PeakMB', PeakMB);
+end
+Bench.Stage(Idx).Calls  = Bench.Stage(Idx).Calls + 1;
+Bench.Stage(Idx).Reads  = Bench.Stage(Idx).Reads + ReadCount;
+Bench.Stage(Idx).Sec    = Bench.Stage(Idx).Sec + Sec;
+Bench.Stage(Idx).PeakMB = max(Bench.Stage(Idx).PeakMB, PeakMB);
+
+resetPeakMemory;
+Bench.Tic = tic;
+
+%Saves the stage results and Info as a JSON file
+function Report = saveReport(Bench, FileName, Info)
+if nargin < 3 || isempty(Info)
+    Info = struct;
+end
+Stage = Bench.Stage;
+for j = 1:numel(Stage)
+    Stage(j).ReadsPerSec = Stage(j).Reads / max(Stage(j).Sec, eps);
+end
+Report = Info;
+Report.Date = datestr(now, 'yyyy-mm-ddTHH:MM:SS');
+Report.TotalSec = sum([Stage.Sec]);
+Report.Stage = Stage;
+
+[FID, Msg] = fopen(FileName, 'w');
+assert(FID > 0, '%s: Could not write to "%s".\n  %s', mfilename, FileName, Msg);
+fprintf(FID, '%s', jsonencode(Report));
+fclose(FID);
+
+%Returns the peak resident memory in MB since the last resetPeakMemory on
+%Linux, the memory used by MATLAB on Windows, or NaN.
+function MB = getPeakMemory
+MB = NaN;
+try
+    if isunix && ~ismac
+        KB = regexp(fileread('/proc/self/status'), 'VmHWM:\s*(\d+)', 'tokens', 'once');
+        MB = str2double(KB{1}) / 1024;
+    elseif ispc
+        UserMem = memory;
+        MB = UserMem.MemUsedMATLAB / 2^20;
+    end
+catch
+end
+
+%Resets the peak resident memory to the current one (Linux 4.0 or later)
+function resetPeakMemory
+if isunix && ~ismac
+    FID = fopen('/proc/self/clear_refs', 'w');
+    if FID > 0
+        fprintf(FID, '5');
+        fclose(FID);
+    end
+end
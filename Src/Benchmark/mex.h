@@ -0,0 +1,142 @@
+/*  mex.h shim for building the BRILIA MEX kernels as a native program,
+ *  without MATLAB (see benchBRILIA.cpp). Only the subset of the MATLAB
+ *  C API used by BRILIA is implemented. Arrays are plain heap objects,
+ *  and mexErrMsgIdAndTxt throws a std::runtime_error.
+ *
+ *  WARNING: Never put this folder on the mex include path, since it will
+ *  shadow MATLAB's own mex.h.
+ */
+#ifndef MEX_SHIM_H
+#define MEX_SHIM_H
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cstdarg>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef char16_t mxChar;
+typedef bool mxLogical;
+typedef enum { mxUNKNOWN_CLASS, mxCELL_CLASS, mxSTRUCT_CLASS, mxLOGICAL_CLASS, mxCHAR_CLASS, mxVOID_CLASS,
+    mxDOUBLE_CLASS, mxSINGLE_CLASS, mxINT8_CLASS, mxUINT8_CLASS, mxINT16_CLASS, mxUINT16_CLASS,
+    mxINT32_CLASS, mxUINT32_CLASS, mxINT64_CLASS, mxUINT64_CLASS } mxClassID;
+typedef enum { mxREAL, mxCOMPLEX } mxComplexity;
+
+struct mxArray {
+    mxClassID Class = mxDOUBLE_CLASS;
+    std::vector<mwSize> Dims;
+    std::vector<unsigned char> Data;
+    std::vector<mxArray*> Cells;
+    std::vector<std::string> Fields;
+    mwSize numel() const { mwSize n = 1; for (auto d : Dims) n *= d; return n; }
+};
+
+inline size_t mxShimElemSize(mxClassID c) {
+    switch (c) {
+        case mxDOUBLE_CLASS: case mxINT64_CLASS: case mxUINT64_CLASS: return 8;
+        case mxSINGLE_CLASS: case mxINT32_CLASS: case mxUINT32_CLASS: return 4;
+        case mxCHAR_CLASS: case mxINT16_CLASS: case mxUINT16_CLASS: return 2;
+        default: return 1;
+    }
+}
+inline mxArray *mxShimNew(mxClassID c, mwSize nd, const mwSize *d) {
+    mxArray *p = new mxArray; p->Class = c; p->Dims.assign(d, d + nd);
+    if (nd < 2) p->Dims.resize(2, 1);
+    if (c == mxCELL_CLASS) p->Cells.assign(p->numel(), nullptr);
+    else if (c != mxSTRUCT_CLASS) p->Data.assign(p->numel() * mxShimElemSize(c), 0);
+    return p;
+}
+[[noreturn]] inline void mexErrMsgIdAndTxt(const char *id, const char *fmt, ...) {
+    char buf[1024]; va_list a; va_start(a, fmt); vsnprintf(buf, sizeof(buf), fmt, a); va_end(a);
+    throw std::runtime_error(std::string(id) + ": " + buf);
+}
+[[noreturn]] inline void mexErrMsgTxt(const char *m) { throw std::runtime_error(m); }
+inline void mexWarnMsgIdAndTxt(const char *, const char *fmt, ...) { va_list a; va_start(a, fmt); vfprintf(stderr, fmt, a); va_end(a); }
+inline int mexPrintf(const char *fmt, ...) { va_list a; va_start(a, fmt); int r = vprintf(fmt, a); va_end(a); return r; }
+inline void mexLock() {}
+inline void mexUnlock() {}
+inline bool mexIsLocked() { return false; }
+inline int mexAtExit(void (*)(void)) { return 0; }
+inline void *mxMalloc(size_t n) { return malloc(n); }
+inline void *mxCalloc(size_t n, size_t s) { return calloc(n, s); }
+inline void mxFree(void *p) { free(p); }
+
+inline mxArray *mxCreateNumericArray(mwSize nd, const mwSize *d, mxClassID c, mxComplexity) { return mxShimNew(c, nd, d); }
+inline mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID c, mxComplexity) { mwSize d[2] = {m, n}; return mxShimNew(c, 2, d); }
+inline mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity x) { return mxCreateNumericMatrix(m, n, mxDOUBLE_CLASS, x); }
+inline mxArray *mxCreateDoubleScalar(double v) { mxArray *p = mxCreateDoubleMatrix(1, 1, mxREAL); memcpy(p->Data.data(), &v, 8); return p; }
+inline mxArray *mxCreateLogicalMatrix(mwSize m, mwSize n) { return mxCreateNumericMatrix(m, n, mxLOGICAL_CLASS, mxREAL); }
+inline mxArray *mxCreateLogicalScalar(bool v) { mxArray *p = mxCreateLogicalMatrix(1, 1); p->Data[0] = v; return p; }
+inline mxArray *mxCreateCharArray(mwSize nd, const mwSize *d) { return mxShimNew(mxCHAR_CLASS, nd, d); }
+inline mxArray *mxCreateCellArray(mwSize nd, const mwSize *d) { return mxShimNew(mxCELL_CLASS, nd, d); }
+inline mxArray *mxCreateCellMatrix(mwSize m, mwSize n) { mwSize d[2] = {m, n}; return mxShimNew(mxCELL_CLASS, 2, d); }
+inline mxArray *mxCreateString(const char *s) {
+    mwSize d[2] = {1, strlen(s)}; mxArray *p = mxShimNew(mxCHAR_CLASS, 2, d);
+    for (mwSize i = 0; i < d[1]; i++) ((mxChar*)p->Data.data())[i] = (unsigned char)s[i];
+    return p;
+}
+inline mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nf, const char **f) {
+    mwSize d[2] = {m, n}; mxArray *p = mxShimNew(mxSTRUCT_CLASS, 2, d);
+    for (int i = 0; i < nf; i++) p->Fields.push_back(f[i]);
+    p->Cells.assign(p->numel() * nf, nullptr); return p;
+}
+inline int mxShimField(const mxArray *p, const char *f) { for (size_t i = 0; i < p->Fields.size(); i++) if (p->Fields[i] == f) return (int)i; return -1; }
+inline void mxSetField(mxArray *p, mwIndex i, const char *f, mxArray *v) { int k = mxShimField(p, f); if (k >= 0) p->Cells[i * p->Fields.size() + k] = v; }
+inline mxArray *mxGetField(const mxArray *p, mwIndex i, const char *f) { int k = mxShimField(p, f); return k < 0 ? nullptr : p->Cells[i * p->Fields.size() + k]; }
+inline int mxGetNumberOfFields(const mxArray *p) { return (int)p->Fields.size(); }
+inline const char *mxGetFieldNameByNumber(const mxArray *p, int k) { return p->Fields[k].c_str(); }
+inline void mxDestroyArray(mxArray *p) { if (!p) return; for (auto c : p->Cells) mxDestroyArray(c); delete p; }
+inline mxArray *mxDuplicateArray(const mxArray *p) { mxArray *q = new mxArray(*p); for (auto &c : q->Cells) if (c) c = mxDuplicateArray(c); return q; }
+
+inline mxClassID mxGetClassID(const mxArray *p) { return p->Class; }
+inline bool mxIsChar(const mxArray *p) { return p && p->Class == mxCHAR_CLASS; }
+inline bool mxIsCell(const mxArray *p) { return p && p->Class == mxCELL_CLASS; }
+inline bool mxIsStruct(const mxArray *p) { return p && p->Class == mxSTRUCT_CLASS; }
+inline bool mxIsDouble(const mxArray *p) { return p && p->Class == mxDOUBLE_CLASS; }
+inline bool mxIsLogical(const mxArray *p) { return p && p->Class == mxLOGICAL_CLASS; }
+inline bool mxIsInt32(const mxArray *p) { return p && p->Class == mxINT32_CLASS; }
+inline bool mxIsUint8(const mxArray *p) { return p && p->Class == mxUINT8_CLASS; }
+inline bool mxIsUint64(const mxArray *p) { return p && p->Class == mxUINT64_CLASS; }
+inline bool mxIsNumeric(const mxArray *p) { return p && p->Class >= mxDOUBLE_CLASS; }
+inline bool mxIsComplex(const mxArray *) { return false; }
+inline bool mxIsEmpty(const mxArray *p) { return p->numel() == 0; }
+inline mwSize mxGetM(const mxArray *p) { return p->Dims[0]; }
+inline mwSize mxGetN(const mxArray *p) { mwSize n = 1; for (size_t i = 1; i < p->Dims.size(); i++) n *= p->Dims[i]; return n; }
+inline void mxSetM(mxArray *p, mwSize m) { p->Dims[0] = m; }
+inline void mxSetN(mxArray *p, mwSize n) { p->Dims.resize(2); p->Dims[1] = n; }
+inline mwSize mxGetNumberOfElements(const mxArray *p) { return p->numel(); }
+inline mwSize mxGetNumberOfDimensions(const mxArray *p) { return p->Dims.size(); }
+inline const mwSize *mxGetDimensions(const mxArray *p) { return p->Dims.data(); }
+inline size_t mxGetElementSize(const mxArray *p) { return mxShimElemSize(p->Class); }
+inline void *mxGetData(const mxArray *p) { return (void*)p->Data.data(); }
+inline double *mxGetPr(const mxArray *p) { return (double*)p->Data.data(); }
+inline double *mxGetDoubles(const mxArray *p) { return (double*)p->Data.data(); }
+inline mxChar *mxGetChars(const mxArray *p) { return (mxChar*)p->Data.data(); }
+inline mxLogical *mxGetLogicals(const mxArray *p) { return (mxLogical*)p->Data.data(); }
+inline mxArray *mxGetCell(const mxArray *p, mwIndex i) { return p->Cells[i]; }
+inline void mxSetCell(mxArray *p, mwIndex i, mxArray *v) { p->Cells[i] = v; }
+inline double mxGetScalar(const mxArray *p) {
+    if (p->numel() == 0) return 0;
+    switch (p->Class) {
+        case mxDOUBLE_CLASS: return *(double*)p->Data.data();
+        case mxCHAR_CLASS: return *(mxChar*)p->Data.data();
+        case mxLOGICAL_CLASS: case mxUINT8_CLASS: return p->Data[0];
+        case mxINT32_CLASS: return *(int32_t*)p->Data.data();
+        case mxUINT64_CLASS: return (double)*(uint64_t*)p->Data.data();
+        default: return 0;
+    }
+}
+inline int mxGetString(const mxArray *p, char *buf, mwSize n) {
+    if (!mxIsChar(p) || n == 0) return 1;
+    mwSize L = p->numel(); mwSize k = L < n - 1 ? L : n - 1;
+    for (mwSize i = 0; i < k; i++) buf[i] = (char)mxGetChars(p)[i];
+    buf[k] = 0; return L < n ? 0 : 1;
+}
+inline char *mxArrayToString(const mxArray *p) { char *b = (char*)malloc(p->numel() + 1); mxGetString(p, b, p->numel() + 1); return b; }
+
+#endif
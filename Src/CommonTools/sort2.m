@@ -80,9 +80,14 @@ elseif DoRowSort && all(cellfun('isclass', List(:), 'char')) %Sorting cells of o
     [SortedList, SortIdx] = sortrows(List, varargin{:});
     return
 else %Sorting char and numbers in a cell array
+    %Label the text and number regions of all chars in one labelRegionMEX call
+    NumLocs = cell(numel(List), 1);
+    CharLoc = cellfun('isclass', List(:), 'char');
+    NumLocs(CharLoc) = cellfun(@getNumLoc, List(CharLoc), 'un', 0);
+    RegLocs = labelRegionMEX(NumLocs);
     SplitCell = cell(numel(List), 1);
     for j = 1:numel(List)
-        SplitCell{j} = splitTextNum(List{j});
+        SplitCell{j} = splitTextNum(List{j}, NumLocs{j}, RegLocs{j});
     end
     MaxNum = max(cellfun('length', SplitCell));
     
@@ -111,15 +116,17 @@ else %Sorting char and numbers in a cell array
     return
 end
 
-function S = splitTextNum(TextNum)
+%Returns the logical index of the digits and decimal points of numbers
+function NumLoc = getNumLoc(TextNum)
+NumLoc = isstrprop(TextNum, 'digit');
+DecimalIdx = regexp(TextNum, '\d\.\d')+1;
+NumLoc(DecimalIdx) = 1;
+
+function S = splitTextNum(TextNum, NumLoc, RegLoc)
 if isnumeric(TextNum)
     S = {TextNum};
     return
 end
-NumLoc = isstrprop(TextNum, 'digit');
-DecimalIdx = regexp(TextNum, '\d\.\d')+1;
-NumLoc(DecimalIdx) = 1;
-RegLoc = labelRegionMEX(NumLoc);
 S = cell(1, max(RegLoc));
 for k = 1:max(RegLoc)
     Loc = RegLoc == k;
@@ -0,0 +1,36 @@
+%compileBenchBRILIA will compile benchBRILIA, the native micro-benchmark
+%of the BRILIA MEX kernels. This does NOT use the mex compiler, since the
+%kernels are linked to the mex.h shim in Src/Benchmark instead of MATLAB.
+%
+%  compileBenchBRILIA
+%
+%  compileBenchBRILIA(Compiler)
+%
+%  INPUT
+%    Compiler ['g++']: C++11 compiler command that accepts g++ options
+%
+%  OUTPUT
+%    Src/Benchmark/benchBRILIA(.exe) program. Run it from Src/Benchmark,
+%    or use "--db <path to Databases>".
+%
+%  EXAMPLE
+%    compileBenchBRILIA
+%    system(fullfile(findRoot, 'Src', 'Benchmark', 'benchBRILIA --json bench.json'));
+%
+function compileBenchBRILIA(Compiler)
+if nargin == 0 || isempty(Compiler)
+    Compiler = 'g++';
+end
+BenchDir = fullfile(findRoot, 'Src', 'Benchmark');
+IncDir = fullfile(findRoot, 'Src', 'MEX', 'Include');
+SrcFiles = [fullfile(BenchDir, {'benchBRILIA.cpp', 'SimTool.cpp'}) ...
+            fullfile(IncDir, {'AlignTool.cpp', 'CpuTool.cpp', 'DgeneTool.cpp', 'HotspotTool.cpp', 'SeqTool.cpp'})];
+OutFile = fullfile(BenchDir, 'benchBRILIA');
+if ispc
+    OutFile = [OutFile '.exe'];
+end
+
+Cmd = sprintf('%s -O2 -std=c++11 -pthread -I"%s" -I"%s" %s -o "%s"', Compiler, BenchDir, IncDir, sprintf('"%s" ', SrcFiles{:}), OutFile);
+[Status, Msg] = system(Cmd);
+assert(Status == 0, '%s: Could not compile benchBRILIA.\n  CMD: %s\n  MSG: %s', mfilename, Cmd, Msg);
+fprintf('%s: Compiled "%s".\n', mfilename, OutFile);
@@ -82,8 +82,8 @@ while ~isempty(AddFiles)
         TmpFiles{j} = extractIncludeFiles(AddFiles{j}, SrcPath);
     end
     TmpFiles = unique([TmpFiles{:}]);
-    IncFiles = unique([IncFiles TmpFiles]);
     AddFiles = setdiff(TmpFiles, IncFiles);
+    IncFiles = unique([IncFiles TmpFiles]);
 end
 
 %extractIncludeFiles will extract the C/H source codes that are referred to
@@ -4,11 +4,30 @@
 %
 %  compileMexBRILIA
 %
-function compileMexBRILIA
+%  compileMexBRILIA('stats')
+%
+%  INPUT
+%    'stats': compile the hot-path counters of the seq kernels, which are
+%      read with briliaStatsMEX. This adds -DBRILIA_STATS.
+%
+%  NOTE
+%    No CPU-specific flags are used. The seq kernels pick their SIMD level
+%    (scalar, SSE4.2, AVX2, AVX-512) at run time, so 1 build runs on any
+%    x86-64 node (see CpuTool).
+%
+function compileMexBRILIA(varargin)
+MexOpt = {};
+if any(strcmpi(varargin, 'stats'))
+    MexOpt{end+1} = '-DBRILIA_STATS';
+end
 RootDir = findRoot;
 MexFiles = dir(fullfile(RootDir, '**', '*MEX.cpp'));
 MexFiles = fullfile({MexFiles.folder}, {MexFiles.name});
+[~, LoadedMex] = inmem;
+for j = 1:length(LoadedMex) %MEX with a thread pool are locked (see ThreadTool)
+    if mislocked(LoadedMex{j}); munlock(LoadedMex{j}); end
+end
 clear mex;  %#ok<CLMEX>  %Just include as otherwise could lead to write permission on compile
 for f = 1:length(MexFiles)
-    compileMex(MexFiles{f}, 'makeMFile', '-outdir', fileparts(MexFiles{f}));
+    compileMex(MexFiles{f}, 'makeMFile', '-outdir', fileparts(MexFiles{f}), MexOpt{:});
 end
\ No newline at end of file
@@ -4,14 +4,15 @@
 %files, the required header names are: 'Seq', 'HSeq', or 'LSeq'. Optional
 %headers are 'SeqName' and 'Template'.
 %
-%  [VDJdata, VDJheader, FileName, FilePath, Map] = convertInput2VDJdata()
+%  [VDJdata, VDJheader, FileName, FilePath, Map, BadLoc] = convertInput2VDJdata()
 %
 %  [VDJdata, VDJheader] = convertInput2VDJdata(FileName)
 %
 %  [VDJdata, VDJheader] = convertInput2VDJdata(FileName, 'FileType', FileType, 'Delimiter', Delimiter)
 %
 %  INPUT
-%    FileName: Full name of input file. If empty, will ask users. 
+%    FileName: Full name of input file. If empty, will ask users. Fasta
+%      and fastq files can be gzip-compressed (ex: .fastq.gz).
 %
 %     Param       Value (* = default)      Details
 %     ----------- ------------------------ --------------------------------
@@ -38,8 +39,11 @@
 %    FileName: file name without hte path
 %    FilePath: file path
 %    Map: structure of BRILIA data index 
+%    BadLoc: Nx1 logical array of fasta/fastq sequences with > 10% non-nt
+%      letters. These are already fixed as done by fixInputSeq. For
+%      delimited files, this is empty, so fixInputSeq must still be used.
 
-function [VDJdata, VDJheader, InFileName, InFilePath, Map] = convertInput2VDJdata(varargin)
+function [VDJdata, VDJheader, InFileName, InFilePath, Map, BadLoc] = convertInput2VDJdata(varargin)
 P = inputParser;
 P.addOptional('FileName',  '',       @(x) isempty(x) || (ischar(x) && ~isempty(dir(x))));
 P.addParameter('Chain',     'H',     @(x) any(strcmpi(x, {'H', 'L', 'HL', 'LH'})));
@@ -65,15 +69,18 @@ end
 
 %Get the file name
 if isempty(FileName)
-    [InFileName, InFilePath] = uigetfile('*.fa*;*.*sv', 'Select the input sequence file', 'MultiSelect', 'off');
+    [InFileName, InFilePath] = uigetfile('*.fa*;*.*sv;*.gz', 'Select the input sequence file', 'MultiSelect', 'off');
     assert(ischar(InFileName), '%s: No file was selected.', mfilename);
     FileName = fullfile(InFilePath, InFileName);
 end
 [InFilePath, InFileName, InFileExt] = parseFileName(FileName);    
+if strcmpi(InFileExt, '.gz') %Use the extension before .gz
+    [~, ~, InFileExt] = fileparts(InFileName(1:end-3));
+end
 
 %Determine the FileType
 if isempty(FileType)
-    if any(strcmpi(InFileExt, {'.fa', 'fasta'}))
+    if any(strcmpi(InFileExt, {'.fa', '.fasta'}))
         FileType = 'fasta';
     elseif strcmpi(InFileExt, '.fastq')
         FileType = 'fastq';
@@ -87,28 +94,16 @@ end
 
 %Determine what data the input files have
 Template = {1};
+BadLoc = [];
 switch lower(FileType)
-    case 'fasta'
-        [SeqName, SeqData] = readFasta(FileName, 'SeqRange', SeqRange);
-        SeqCount = numel(SeqName);
-        Template = repelem({1}, SeqCount, 1);
-
-    case 'fastq'
-        [SeqName, SeqData, Quality] = fastqread(FileName, 'blockread', SeqRange);
-        if ischar(SeqData) %In case the fastq file has only 1 sequence, output would be char.
-            SeqName = {SeqName};
-            SeqData = {SeqData};
-            Quality = {Quality};
+    case {'fasta', 'fastq'} %Reads, masks low-quality nt, and fixes seq in one pass
+        if ~strcmpi(FileType, 'fastq')
+            MinQuality = '';
         end
+        [SeqName, SeqData, OverSeq5, OverSeq3, BadLoc] = readSeqFileMEX(FileName, SeqRange, MinQuality);
         SeqCount = numel(SeqName);
         Template = repelem({1}, SeqCount, 1);
-        
-        %Convert low-quality nt reads as 'N'
-        MinQuality = uint8(MinQuality);
-        parfor j = 1:length(SeqName)
-            SeqData{j}(uint8(Quality{j}) < MinQuality) = 'N'; 
-        end
-        
+
     case 'delimited'
         InHeader = readDlmFile(FileName, 'delimiter', Delimiter, 'LineRange', 1); %For getting the header only
         InHeader = formatStrSame(InHeader); %For string matching below
@@ -175,6 +170,12 @@ for c = 1:numel(Map.Chain)
     C = lower(Map.Chain(c));
     VDJdata(:, Map.([C 'Seq'])) = SeqData(:, c);    
 end
+if ~isempty(BadLoc) %Fasta/fastq seq were fixed by readSeqFileMEX
+    C = lower(Map.Chain(1));
+    VDJdata(:, Map.([C 'OverSeq5'])) = OverSeq5;
+    VDJdata(:, Map.([C 'OverSeq3'])) = OverSeq3;
+    VDJdata(BadLoc, Map.([C 'Funct'])) = {'I'};
+end
 
 %Format string to be same for matching purposes. 
 %EDIT_NOTE: Edit this code if the string matching criteria changes
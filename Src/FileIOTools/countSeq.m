@@ -3,7 +3,7 @@
 %  SeqCount = getSeqCount(FileName)
 %
 %  INPUT
-%    FileName: file name of the sequence file (.csv, .fa*). If empty, will
+%    FileName: file name of the sequence file (.csv, .fa*, .fa*.gz). If empty, will
 %      ask user to select one.
 %
 %  OUTPUT
@@ -11,19 +11,15 @@
 
 function SeqCount = countSeq(FileName)
 if nargin == 0 || isempty(FileName)
-    [InFileName, InFilePath] = uigetfile('*.fa*;*.*sv', 'Select the input sequence file', 'MultiSelect', 'off');
+    [InFileName, InFilePath] = uigetfile('*.fa*;*.*sv;*.gz', 'Select the input sequence file', 'MultiSelect', 'off');
     assert(ischar(InFileName), '%s: No file was selected.', mfilename);
     FileName = fullfile(InFilePath, InFileName);
 else
     assert(exist(FileName, 'file') > 0, '%s: Could not find file "%s".', mfilename, FileName);
 end
 
-if endsWith(FileName, {'.fa', 'fasta'}, 'ignorecase', true)
-    Info = fastainfo(FileName);
-    SeqCount = Info.NumberOfEntries;
-elseif endsWith(FileName, '.fastq', 'ignorecase', true)
-    Info = fastqinfo(FileName);
-    SeqCount = Info.NumberOfEntries;
+if endsWith(FileName, {'.fa', '.fasta', '.fastq', '.gz'}, 'ignorecase', true)
+    SeqCount = countSeqFileMEX(FileName);
 elseif endsWith(FileName, {'.csv', '.tsv', '.ssv'}, 'ignorecase', true)
     [FID, MSG] = fopen(FileName, 'r');
     assert(FID > 0, '%s: Error opening delimited file "%s".\n  %s', mfilename, FileName, MSG);
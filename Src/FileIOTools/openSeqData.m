@@ -10,8 +10,13 @@
 %
 %  [VDJdata, VDJheader, FileName, FilePath, Map] = openSeqData(...)
 %
+%  [...] = openSeqData(FileName, Header1, Header2, ...)
+%
 %  INPUT
-%    FileName: the .csv file from the BRILIA output
+%    FileName: the .csv file from the BRILIA output, or a .bcol checkpoint
+%      file (see writeColFileMEX)
+%    HeaderN: names of the columns to return. Default is all. For .bcol
+%      files, only these columns are read from the disk.
 %
 %  OUTPUT
 %    VDJdata: main BRILIA annotation cell array
@@ -51,25 +56,30 @@ if isempty(FileExt) || isempty(FilePath)
     return
 end
 
-[VDJheader, Delimiter] = readDlmFile(FullFileName, 'LineRange', 1);
+if strcmpi(FileExt, '.bcol') %Binary checkpoint, which keeps the data types
+    [~, VDJheader] = readColFileMEX(FullFileName, []);
+    GetIdx = 1:numel(VDJheader);
+    if ~isempty(varargin) && ~(any(cellfun('isempty', varargin)))
+        [~, GetIdx] = intersect(formatStrSame(VDJheader), formatStrSame(varargin));
+        if isempty(GetIdx); GetIdx = 1:numel(VDJheader); end
+        GetIdx = sort(GetIdx(:)');
+    end
+    VDJdata = readColFileMEX(FullFileName, GetIdx);
+    VDJheader = VDJheader(GetIdx);
+    Map = getVDJmapper(VDJheader);
+    return
+end
+
+[VDJheader, Delimiter] = readDlmFileMEX(FullFileName, '', 1);
 
 %Determine numeric, matrix, and string columns
 [Map, NumIdx] = getVDJmapper(VDJheader);
 MatIdx = find(endsWith(VDJheader, 'MapNum', 'ignorecase', true)); %Determine the 'MapNum' columns, as these require string to matrix conversion. Will be deprecated in future.
 NumIdx = setdiff(NumIdx, MatIdx);
 
-%Setup the pattern search
-StrPat = repelem({'%s'}, 1, length(VDJheader));
-StrPat(NumIdx) = {'%f'};
-StrPat = [StrPat{:}];
-
-%Read in the data and format the columns into a single cell array
-FID = fopen(FullFileName, 'r');
-VDJdata = textscan(FID, StrPat, 'Headerlines', 1, 'Delimiter', Delimiter, 'EndOfLine', '\r\n', 'CollectOutput', false);
-fclose(FID);
-VDJdata(:, NumIdx) = cellfun(@num2cell, VDJdata(:, NumIdx), 'unif', false);
+%Read in the data, converting the numeric columns to double in the MEX
+VDJdata = readDlmFileMEX(FullFileName, Delimiter, [2 Inf], NumIdx);
 VDJdata(:, MatIdx) = cellfun(@convStr2NumMEX, VDJdata(:, MatIdx), 'unif', false);
-VDJdata = [VDJdata{:}];
 
 %Filter for relevant data
 if ~(any(cellfun('isempty', varargin)))
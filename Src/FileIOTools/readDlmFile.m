@@ -89,6 +89,15 @@ if ~exist(InputFileName, 'file')
     return;
 end
 
+%Use the memory-mapped MEX reader if no search filter is needed
+if isempty(SearchFor)
+    if isempty(dir(InputFileName)) %File is on the matlab path (ex: DataHeaderInfo.csv), which the MEX cannot search
+        InputFileName = which(InputFileName);
+    end
+    [CellData, Delimiter] = readDlmFileMEX(InputFileName, Delimiter, LineRange);
+    return
+end
+
 %Determine line count and the first two txt
 [FID, MSG] = fopen(InputFileName, 'r');
 if FID < 0
@@ -6,14 +6,22 @@
 %
 %  saveSeqData(..., 'append')
 %
+%  saveSeqData(..., 'async')
+%
 %  INPUT
 %    VDJdata: BRILIA data table
 %    VDJheader: BRILIA header table for VDJdata
 %    Delimiter: can be ', ' or ';' or '\t'
 %    'append': will append VDJdata after existing file, or create new one.
 %      Note that append can be specified anywhere.
+%    'async': will write the file in a background thread and return
+%      (see writeDlmFileMEX, writeColFileMEX). Use writeDlmFileMEX('flush')
+%      or writeColFileMEX('flush') before reading or moving the file.
 %
 %  NOTE
+%    If FullSaveName ends with .bcol, will save to a binary columnar file
+%    (see writeColFileMEX) instead of a delimited file.
+%
 %    If the delimiter character exists in a string field, it will replace
 %    the delimiter character with '_' to prevent confusion in opening
 %    delimited files later.
@@ -22,10 +30,13 @@ function saveSeqData(FullSaveName, VDJdata, VDJheader, varargin)
 %Parse the input for append mode and delimiter
 AppendThis = 'n';
 Delimiter = ',';
+Options = {};
 for j = 1:length(varargin)
     if ischar(varargin{j}) 
         if ismember(lower(varargin{j}), {'-append', 'append'})
             AppendThis = 'y';
+        elseif strcmpi(varargin{j}, 'async')
+            Options = {'async'};
         elseif strcmpi(varargin{j}, 'Delimiter') && length(varargin) > j+1
             if ismember(lower(varargin{j+1}), {';' ',' '\t'})
                 Delimiter = varargin{j+1};
@@ -35,12 +46,24 @@ for j = 1:length(varargin)
 end
 
 %Write the data
+if endsWith(FullSaveName, '.bcol', 'ignorecase', true)
+    if AppendThis == 'y'
+        writeColFileMEX(VDJdata, VDJheader, FullSaveName, [], 'append', Options{:});
+    else
+        writeColFileMEX(VDJdata, VDJheader, FullSaveName);
+    end
+    return
+end
+
 if AppendThis == 'y'
+    if ~isempty(Options) && exist(FullSaveName, 'file') == 0
+        writeDlmFileMEX('flush'); %The 1st entry could still be in the write queue
+    end
     if exist(FullSaveName, 'file') == 0 %First entry, so include header
-        writeDlmFile([VDJheader; VDJdata], FullSaveName, Delimiter, 'append');    
+        writeDlmFile([VDJheader; VDJdata], FullSaveName, Delimiter, 'append', Options{:});    
     else %Do not include header when appending.
-        writeDlmFile(VDJdata, FullSaveName, Delimiter, 'append');
+        writeDlmFile(VDJdata, FullSaveName, Delimiter, 'append', Options{:});
     end
 else 
-    writeDlmFile([VDJheader; VDJdata], FullSaveName, Delimiter);
+    writeDlmFile([VDJheader; VDJdata], FullSaveName, Delimiter, Options{:});
 end
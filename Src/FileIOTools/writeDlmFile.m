@@ -7,11 +7,15 @@
 %
 %  writeDlmFile(CellData, OutputFile, Delimiter, 'append')
 %
+%  writeDlmFile(..., 'async')
+%
 %  INPUT
 %    CellData: cell array (but must not have a cell in a cell);
 %    OutputFile: full name of the file to be saved to
 %    Delimiter [',' ';' '\t']: Default is ','
 %    'append': appends to the outfile instead of overwriting.
+%    'async': returns while the file is written in the background. Use
+%      writeDlmFileMEX('flush') before reading or moving the file.
 %
 %  See also readDlmFile
 
@@ -22,6 +26,7 @@ end
 
 WriteType = 'w';
 Delimiter = ',';
+Options = {};
 if ~isempty(varargin)   
     AppendLoc = strcmpi(varargin, 'append');
     if any(AppendLoc)
@@ -29,6 +34,12 @@ if ~isempty(varargin)
         varargin = varargin(~AppendLoc);
     end
 
+    AsyncLoc = strcmpi(varargin, 'async');
+    if any(AsyncLoc)
+        Options = {'async'};
+        varargin = varargin(~AsyncLoc);
+    end
+
     if ~isempty(varargin)
         DelimLoc = strcmpi(varargin, {',', ';', '\t'});
         if any(DelimLoc)
@@ -37,21 +48,9 @@ if ~isempty(varargin)
     end
 end
 
-CellData(cellfun('isempty', CellData)) = {''};
-NumLoc = cellfun('isclass', CellData, 'double');
-StrLoc = ~NumLoc;
-
-CellData(NumLoc) = cellfun(@mat2str, CellData(NumLoc), 'un', 0); 
-if contains(Delimiter, '\t') %To \t from becoming tab
-    CellData(StrLoc) = strrep(CellData(StrLoc), '\t', '\\t');
-else %Prevent string with delimiter from messing up delimiter setup
-    CellData(StrLoc) = strrep(CellData(StrLoc), Delimiter, '|');
-end
-
-[FID, MSG] = fopen(OutputFile, WriteType);
-assert(FID > 0, '%s: Could not create/write to file "%s".\n  %s', mfilename, OutputFile, MSG);
-Fmt = [repmat(['%s' Delimiter], 1, size(CellData, 2)-1) '%s\n'];
-for j = 1:size(CellData, 1)
-    fprintf(FID, Fmt, CellData{j, :});
-end
-fclose(FID);
\ No newline at end of file
+%Format and write the whole cell array at once in the MEX
+if WriteType == 'a'
+    writeDlmFileMEX(CellData, OutputFile, Delimiter, 'append', Options{:});
+else
+    writeDlmFileMEX(CellData, OutputFile, Delimiter, Options{:});
+end
\ No newline at end of file
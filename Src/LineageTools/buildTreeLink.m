@@ -110,9 +110,8 @@ end
 Tdata(:, Map.GrpNum) = num2cell(GrpNumStart - 1 + AncMap(:, end));
 
 %Determine the number of children per each sequence
-for k = 1:size(AncMap, 1)
-    Tdata{k, Map.ChildCount} = length(findChild(AncMap, AncMap(k, 1)));
-end
+[~, ~, ChildCount] = ancMapMEX('child', AncMap, []);
+Tdata(:, Map.ChildCount) = num2cell(ChildCount);
 GrpNumStart = GrpNumStart + max(AncMap(:, end));
 
 % The clustering of germline together was a bad idea in the sense that these tend to get grouped randomly, speicailly for shorter CDR3.
@@ -57,21 +57,10 @@ if nargin == 2
     end
 end
 
-%Nearest neighbor linking, starting with shortest distance first
-UnqDist = unique(PairDist(:));
+%Nearest neighbor linking. Each child gets the parent with the shortest
+%distance, and the lowest row on ties. Inf distances are not linked.
 AncMap = [[1:size(PairDist, 1)]' zeros(size(PairDist, 1), 2)]; %#ok<NBRAK> %[SeqNum AncNum Distance]
-Active = ones(size(PairDist, 1), 1, 'logical');                %Keeps track of active col/row
-ActiveNum = size(PairDist, 1);                                 %Keeps track of how many active col/row there are
-k = 1;
-while ActiveNum > 0 && k < length(UnqDist)  %it's k < length(UnqDist), and not "<=", to stop BEFORE linking Inf distances
-    [RIdx, CIdx] = find(PairDist == UnqDist(k));
-    for q = 1:length(CIdx)
-        if Active(CIdx(q)) %Still missing parent
-            AncMap(CIdx(q), 2) = RIdx(q);
-            AncMap(CIdx(q), 3) = PairDist(RIdx(q), CIdx(q));
-            Active(CIdx(q)) = 0;
-            ActiveNum = ActiveNum - 1;
-        end
-    end
-    k = k+1;
-end
\ No newline at end of file
+[MinDist, ParIdx] = min(PairDist, [], 1);
+LinkLoc = isfinite(MinDist(:));
+AncMap(LinkLoc, 2) = ParIdx(LinkLoc);
+AncMap(LinkLoc, 3) = MinDist(LinkLoc);
\ No newline at end of file
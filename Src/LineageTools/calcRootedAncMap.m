@@ -27,29 +27,6 @@ function AncMap = calcRootedAncMap(PairDist)
 if M ~= N
     PairDist = squareform(PairDist, 'tomatrix');
 end
-PairDist(1:size(PairDist, 1)+1:end) = Inf; %Prevent linking to self
 
-%Now link starting from root and working down
-AncMap = [[1:size(PairDist, 1)]' zeros(size(PairDist, 1), 2)]; %#ok<NBRAK> %[Child Par Dist]
-Active = ones(1, size(PairDist, 1), 'logical');
-Active(1) = 0;
-ActiveNum = sum(Active);
-while ActiveNum > 0
-    %Identify the next immediate child for each parent
-    InactiveIdx = find(~Active);
-    ActiveIdx   = find( Active);
-    PairDistT = PairDist(InactiveIdx, ActiveIdx);
-    [R, C] = find(PairDistT == min(PairDistT(:)));
-    RIdx = InactiveIdx(R);
-    CIdx =   ActiveIdx(C);
-    
-   %Assign a parent to each child. If 1 child has > 1 parent, 1st parent wins.
-    for q = 1:length(CIdx)
-        if Active(CIdx(q)) %Still missing parent
-            AncMap(CIdx(q), 2) = RIdx(q);
-            AncMap(CIdx(q), 3) = PairDist(RIdx(q), CIdx(q));
-            Active(CIdx(q)) = 0;
-            ActiveNum = ActiveNum - 1;
-        end
-    end
-end
+%Link starting from root and working down, with the closest seqs first (see ancMapMEX)
+AncMap = ancMapMEX('rooted', PairDist); %[Child Par Dist]
@@ -1,10 +1,9 @@
-%calcTreeCoord is used to calculate the node and leaf coordinates
-%recursively, given AncMap (the ancestry mapping matrix).
+%calcTreeCoord is used to calculate the node and leaf coordinates, given
+%AncMap (the ancestry mapping matrix). The children of every node are found
+%once with ancMapMEX, and the tree is walked depth-first with a stack.
 %  
 %  TreeCoord = calcTreeCoord(AncMap)
 %
-%  TreeCoord = calcTreeCoord(AncMap, TreeCoord, ParentNum)  (For recursion)
-%
 %  INPUT
 %    AncMap: Mx3 ancestry map of [ChildNum ParentNum Par2ChildDist].
 %      Par2ChildDist is either hamming distance or SHM distance from parent
@@ -19,40 +18,40 @@
 %      LeafStatus is 1 if this child ends the tree as a leaf.
 %
 %  NOTE
-%    This uses recursion to fill in TreeCoord, hence TreeCoord is a hidden
-%    input to the function that shouldn't be used by the user.
-
-function TreeCoord = calcTreeCoord(AncMap, varargin)
-if nargin == 1 %Initial summon
-    if any(findTreeCycle(AncMap))
-        error('%s: Cannot have cyclic dependency in AncMap.', mfilename);
-    end
-    AncMap = renumberAncMap(AncMap);
-    TreeCoord = zeros(size(AncMap, 1), 3);
-    ParentNum = max([AncMap(1, 2), 1]);
-elseif nargin == 3 %Recursive summon
-    TreeCoord = varargin{1};
-    ParentNum = varargin{2};
-else
-    error('%s: Incorrect number of inputs.', mfilename);
-end
+%    The leaves get Y = 1, 2, 3, ... in depth-first order, and each node
+%    gets the mid Y of its 1st and last leaf.
+%
+%  See also ancMapMEX
 
+function TreeCoord = calcTreeCoord(AncMap)
 if any(findTreeCycle(AncMap))
-    TreeCoord = [];
-    return
+    error('%s: Cannot have cyclic dependency in AncMap.', mfilename);
 end
+AncMap = renumberAncMap(AncMap);
+TreeCoord = zeros(size(AncMap, 1), 3);
+StartNum = max([AncMap(1, 2), 1]);
+
+[ChildIdx, ChildPtr] = ancMapMEX('child', AncMap, []);
+[~, RootDist] = ancMapMEX('depth', AncMap, []);
 
-%If it is a leaf (no child), update TreeCoord. If not, resummon until you do.
-ChildNum = findChild(AncMap, ParentNum);
-if isempty(ChildNum) %Leaf
-    TreeCoord(ParentNum, 2) = max(TreeCoord(:, 2)) + 1; %Count the Y value
-    TreeCoord(ParentNum, 3) = 1; %Mark as leaf;
-else %Node
-    CurMaxY = max(TreeCoord(:, 2)) + 1; %The Y value that you WOULD have accepted, but must now wait till all childs are added.
-    for j = 1:length(ChildNum)
-        TreeCoord(ChildNum(j), 1) = TreeCoord(ParentNum, 1) + AncMap(ChildNum(j), 3); %Update the X value relative to parent's position
-        TreeCoord = calcTreeCoord(AncMap, TreeCoord, ChildNum(j));                    %Find the child's child to update TreeCoord
+%Negative numbers in Stack mark a node whose children are all done
+FirstLeafY = zeros(size(AncMap, 1), 1);
+LeafCt = 0;
+Stack = StartNum;
+while ~isempty(Stack)
+    ParentNum = Stack(end);
+    Stack(end) = [];
+    if ParentNum < 0 %Node, now take the mid point after all children were processed
+        TreeCoord(-ParentNum, 2) = (FirstLeafY(-ParentNum) + LeafCt) / 2;
+        continue
     end
-    NewMaxY = max(TreeCoord(:, 2));                     %This is the new maximum Y position, after all childen were processed.
-    TreeCoord(ParentNum, 2) = (CurMaxY + NewMaxY) / 2;  %Now take the mid point after all children were processed.
-end
\ No newline at end of file
+    TreeCoord(ParentNum, 1) = RootDist(ParentNum) - RootDist(StartNum);
+    ChildNum = ChildIdx(ChildPtr(ParentNum):ChildPtr(ParentNum+1)-1);
+    if isempty(ChildNum) %Leaf
+        LeafCt = LeafCt + 1;
+        TreeCoord(ParentNum, 2:3) = [LeafCt 1];
+    else
+        FirstLeafY(ParentNum) = LeafCt + 1;
+        Stack = [Stack; -ParentNum; flipud(ChildNum(:))]; %#ok<AGROW>
+    end
+end
@@ -9,6 +9,13 @@
 %
 %  OUTPUT
 %    ChildNum: the child number(s) of the parent
+%
+%  NOTE
+%    This searches the whole AncMap, so use it for a few lookups only. To
+%    walk a tree, get the children of every node at once with
+%    ancMapMEX('child', AncMap, GrpNum).
+%
+%  See also ancMapMEX
 
 function ChildNum = findChild(AncMap, ParentNum)
 ChildNum = AncMap(AncMap(:,2) == ParentNum, 1);
@@ -8,6 +8,13 @@
 %
 %  OUTPUT
 %    ParentNum: the parent number(s) of the child
+%
+%  NOTE
+%    This searches the whole AncMap, so use it for a few lookups only. To
+%    walk a tree, get the parent row of every node at once with
+%    ancMapMEX('renumber', AncMap, GrpNum).
+%
+%  See also ancMapMEX
 
 function ParentNum = findParent(AncMap, ChildNum)
 ParentNum = AncMap(AncMap(:,1) == ChildNum, 2);
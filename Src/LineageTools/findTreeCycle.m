@@ -24,22 +24,5 @@
 %          1
 
 function CycleLoc = findTreeCycle(AncMap)
-%To find a cycle, remove leaves until no more is left.
-CycleLoc = ones(size(AncMap, 1), 1, 'logical');
-CurSumLeaf = length(CycleLoc);
-SumLeaf = 0;
-while SumLeaf ~= CurSumLeaf
-    %Remove those that are leaves
-    for j = 1:size(AncMap, 1)
-        if CycleLoc(j)
-            ChildLoc = AncMap(:, 2) == AncMap(j, 1);
-            if ~any(ChildLoc)
-                AncMap(j, 2) = -AncMap(j, 2); %Set negative to prevent redoing search here
-                CycleLoc(j) = 0;
-            end
-        end
-    end
-    
-    SumLeaf = CurSumLeaf;
-    CurSumLeaf = sum(CycleLoc);
-end
\ No newline at end of file
+%To find a cycle, remove leaves until no more is left (see ancMapMEX).
+CycleLoc = ancMapMEX('cycle', AncMap, []);
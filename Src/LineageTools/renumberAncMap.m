@@ -34,13 +34,4 @@
 %          4     2     5
 %
 function AncMap = renumberAncMap(AncMap)
-%Adjust parent column (#2) first before child column (#1)
-for j = 1:size(AncMap, 1)
-    ParIdx = find(AncMap(j, 2) == AncMap(:, 1), 1);
-    if ~isempty(ParIdx)
-        AncMap(j, 2) = ParIdx;
-    else
-        AncMap(j, 2) = 0;
-    end
-end
-AncMap(:, 1) = 1:size(AncMap, 1); 
\ No newline at end of file
+AncMap = ancMapMEX('renumber', AncMap, []);
@@ -0,0 +1,208 @@
+/*  AlignCacheTool contains the codes for a bounded LRU cache of alignment
+ *  results. Deep repertoires have many identical reads, and each one is
+ *  aligned against the same germline gene set with the same parameters, so
+ *  the results of the 1st copy can be reused.
+ *
+ *  A key has the alignment parameters, a 64-bit hash of the reference seq
+ *  set (see hashSeqSet), and the full query seq. So a hit needs the exact
+ *  same query, and the reference set is matched by hash. A hit must also
+ *  have the same number and lengths of reference seqs, or it is dropped.
+ *
+ *  The reference set is the same gene set for many calls in a row, so its
+ *  hash is not redone for every call. getRefSetInfo keeps a copy of the
+ *  last few sets, and reuses the info of a set with the same seq lengths
+ *  and chars. This compare is much faster than the FNV-1a hash, and is
+ *  safe for a set that was edited in place, or a new temporary cell such
+ *  as DB.Vmap(:, M.Seq). It has its own mutex.
+ *
+ *  The memory limit is from BRILIA_ALIGN_CACHE_MB (default 64 MB). Setting
+ *  it to 0 turns off the cache. All functions are guarded by 1 mutex, so
+ *  they can be called from worker threads.
+ */
+
+#include "AlignCacheTool.hpp"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <stdlib.h>
+#include <string.h>
+
+// cache_value stores the results of a key, and the reference set it used
+struct cache_value {
+    ref_set_ptr RefSet;
+    std::vector<align_info> AI;
+};
+
+// ref_set_memo stores the chars of all seqs of a reference set, and its info
+struct ref_set_memo {
+    std::vector<mxChar> Seq;
+    ref_set_ptr Info;
+};
+
+typedef std::pair<std::string, cache_value> cache_entry;
+
+static const size_t REF_MEMO_SIZE = 8;
+static std::mutex CACHE_MUTEX;
+static std::mutex REF_MEMO_MUTEX;
+static std::list<ref_set_memo> REF_MEMO; //most recently used first
+static std::list<cache_entry> CACHE_LIST; //most recently used first
+static std::unordered_map<std::string, std::list<cache_entry>::iterator> CACHE_MAP;
+static align_cache_stats STATS;
+static bool HAS_LIMIT = false;
+
+static size_t getEntryBytes(const cache_entry &Entry) {
+    return 2*Entry.first.size() + Entry.second.AI.size()*sizeof(align_info) + 112; //112 = list, map, pointer, and vector overhead
+}
+
+// Reads the memory limit once, from BRILIA_ALIGN_CACHE_MB or 64 MB
+static void setCacheLimit() {
+    if (HAS_LIMIT) { return; }
+    const char *pEnv = getenv("BRILIA_ALIGN_CACHE_MB");
+    double MB = pEnv != NULL ? atof(pEnv) : -1;
+    if (MB < 0) { MB = 64; }
+    STATS.MaxBytes = (size_t) (MB * 1048576);
+    HAS_LIMIT = true;
+}
+
+// Returns the FNV-1a hash of a char array or a cell of char arrays
+unsigned long long hashSeqSet(const mxArray *pSeqSet) {
+    unsigned long long Hash = 14695981039346656037ULL;
+    bool IsCell = mxIsCell(pSeqSet);
+    mwSize Num = IsCell ? mxGetNumberOfElements(pSeqSet) : 1;
+    for (mwSize j = 0; j < Num; j++) {
+        const mxArray *pSeq = IsCell ? mxGetCell(pSeqSet, j) : pSeqSet;
+        mwSize Len = pSeq == NULL || !mxIsChar(pSeq) ? 0 : mxGetN(pSeq);
+        const mxChar *pChar = Len > 0 ? mxGetChars(pSeq) : NULL;
+        for (mwSize k = 0; k <= Len; k++) {
+            Hash ^= k < Len ? (unsigned long long) pChar[k] : 0x10000ULL + j; //0x10000 marks the end of each seq
+            Hash *= 1099511628211ULL;
+        }
+    }
+    return Hash;
+}
+
+// Returns the hash and seq lengths of a reference set, reusing the stored
+// info if a set with the same seqs was seen recently
+ref_set_ptr getRefSetInfo(const mxArray *pSeqSet) {
+    bool IsCell = mxIsCell(pSeqSet);
+    mwSize Num = IsCell ? mxGetNumberOfElements(pSeqSet) : 1;
+    std::vector<const mxChar*> pSeqs(Num, NULL);
+    std::vector<mwSize> Lens(Num, 0);
+    size_t TotLen = 0;
+    for (mwSize j = 0; j < Num; j++) {
+        const mxArray *pSeq = IsCell ? mxGetCell(pSeqSet, j) : pSeqSet;
+        if (pSeq == NULL || !mxIsChar(pSeq)) { continue; }
+        Lens[j] = mxGetN(pSeq);
+        pSeqs[j] = Lens[j] > 0 ? mxGetChars(pSeq) : NULL;
+        TotLen += Lens[j];
+    }
+
+    std::lock_guard<std::mutex> Lock(REF_MEMO_MUTEX);
+    for (std::list<ref_set_memo>::iterator Iter = REF_MEMO.begin(); Iter != REF_MEMO.end(); Iter++) {
+        if (Iter->Info->Lens != Lens) { continue; }
+        const mxChar *pMemo = Iter->Seq.data();
+        bool IsSame = true;
+        for (mwSize j = 0; j < Num && IsSame; pMemo += Lens[j++]) {
+            IsSame = Lens[j] == 0 || memcmp(pSeqs[j], pMemo, Lens[j]*sizeof(mxChar)) == 0;
+        }
+        if (IsSame) {
+            REF_MEMO.splice(REF_MEMO.begin(), REF_MEMO, Iter);
+            return REF_MEMO.front().Info;
+        }
+    }
+
+    std::shared_ptr<ref_set_info> Info = std::make_shared<ref_set_info>();
+    Info->Hash = hashSeqSet(pSeqSet);
+    Info->Lens.swap(Lens);
+    REF_MEMO.push_front(ref_set_memo());
+    REF_MEMO.front().Seq.reserve(TotLen);
+    for (mwSize j = 0; j < Num; j++) {
+        if (pSeqs[j] != NULL) { REF_MEMO.front().Seq.insert(REF_MEMO.front().Seq.end(), pSeqs[j], pSeqs[j] + Info->Lens[j]); }
+    }
+    REF_MEMO.front().Info = Info;
+    if (REF_MEMO.size() > REF_MEMO_SIZE) { REF_MEMO.pop_back(); }
+    return Info;
+}
+
+// Returns the cache key of SeqA, the reference set hash, MissRate, and the
+// 6 char options [Alphabet ExactMatch TrimSide PenaltySide PreferSide Output]
+std::string buildAlignKey(const mxChar *pSeqA, mwSize LenA, const ref_set_info &RefSet, double MissRate, const mxChar *pOpt) {
+    unsigned long long RefHash = RefSet.Hash;
+    std::string Key(sizeof(RefHash) + sizeof(MissRate) + (6 + LenA)*sizeof(mxChar), 0);
+    char *pKey = &Key[0];
+    memcpy(pKey, &RefHash, sizeof(RefHash));
+    pKey += sizeof(RefHash);
+    memcpy(pKey, &MissRate, sizeof(MissRate));
+    pKey += sizeof(MissRate);
+    memcpy(pKey, pOpt, 6*sizeof(mxChar));
+    pKey += 6*sizeof(mxChar);
+    if (LenA > 0) { memcpy(pKey, pSeqA, LenA*sizeof(mxChar)); }
+    return Key;
+}
+
+// Returns true and fills AI if the key is stored for the same reference set
+// count and lengths. A stored result of another set with the same hash is
+// removed.
+bool findAlignCache(const std::string &Key, const ref_set_ptr &RefSet, std::vector<align_info> &AI) {
+    std::lock_guard<std::mutex> Lock(CACHE_MUTEX);
+    setCacheLimit();
+    std::unordered_map<std::string, std::list<cache_entry>::iterator>::iterator Iter = CACHE_MAP.find(Key);
+    if (Iter == CACHE_MAP.end()) {
+        STATS.Misses++;
+        return false;
+    }
+    const cache_value &Value = Iter->second->second;
+    if (Value.RefSet != RefSet && Value.RefSet->Lens != RefSet->Lens) {
+        STATS.Bytes -= getEntryBytes(*Iter->second);
+        CACHE_LIST.erase(Iter->second);
+        CACHE_MAP.erase(Iter);
+        STATS.Misses++;
+        return false;
+    }
+    CACHE_LIST.splice(CACHE_LIST.begin(), CACHE_LIST, Iter->second);
+    AI = Value.AI;
+    STATS.Hits++;
+    return true;
+}
+
+// Stores the results of a key, removing the least recently used ones to stay under the limit
+void addAlignCache(const std::string &Key, const ref_set_ptr &RefSet, const std::vector<align_info> &AI) {
+    std::lock_guard<std::mutex> Lock(CACHE_MUTEX);
+    setCacheLimit();
+    if (CACHE_MAP.count(Key) > 0) { return; }
+    cache_entry Entry;
+    Entry.first = Key;
+    Entry.second.RefSet = RefSet;
+    Entry.second.AI = AI;
+    size_t Bytes = getEntryBytes(Entry);
+    if (Bytes > STATS.MaxBytes) { return; }
+    while (STATS.Bytes + Bytes > STATS.MaxBytes && !CACHE_LIST.empty()) {
+        STATS.Bytes -= getEntryBytes(CACHE_LIST.back());
+        CACHE_MAP.erase(CACHE_LIST.back().first);
+        CACHE_LIST.pop_back();
+    }
+    CACHE_LIST.push_front(Entry);
+    CACHE_MAP[Key] = CACHE_LIST.begin();
+    STATS.Bytes += Bytes;
+}
+
+align_cache_stats getAlignCacheStats() {
+    std::lock_guard<std::mutex> Lock(CACHE_MUTEX);
+    setCacheLimit();
+    align_cache_stats Stats = STATS;
+    Stats.Entries = CACHE_MAP.size();
+    return Stats;
+}
+
+// Removes all stored results and reference set info, resets the counters,
+// and rereads the memory limit
+void clearAlignCache() {
+    std::lock_guard<std::mutex> Lock(CACHE_MUTEX);
+    CACHE_MAP.clear();
+    CACHE_LIST.clear();
+    std::lock_guard<std::mutex> MemoLock(REF_MEMO_MUTEX);
+    REF_MEMO.clear();
+    STATS = align_cache_stats();
+    HAS_LIMIT = false;
+}
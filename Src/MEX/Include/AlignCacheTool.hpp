@@ -0,0 +1,35 @@
+#ifndef ALIGN_CACHE_TOOL_HPP
+#define ALIGN_CACHE_TOOL_HPP
+
+#include "mex.h"
+#include "AlignTool.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// align_cache_stats stores the hit/miss counters of the alignment cache
+struct align_cache_stats {
+    unsigned long long Hits = 0;    //Hits: lookups that found a stored result
+    unsigned long long Misses = 0;  //Misses: lookups that had to align
+    size_t Entries = 0;             //Entries: number of stored results
+    size_t Bytes = 0;               //Bytes: approximate memory used by the stored results
+    size_t MaxBytes = 0;            //MaxBytes: memory limit. 0 = cache is off.
+};
+
+// ref_set_info stores the hash and seq lengths of a reference seq set
+struct ref_set_info {
+    unsigned long long Hash = 0;  //Hash: FNV-1a hash of all seqs (see hashSeqSet)
+    std::vector<mwSize> Lens;     //Lens: length of each seq
+};
+
+typedef std::shared_ptr<const ref_set_info> ref_set_ptr;
+
+unsigned long long hashSeqSet(const mxArray*);
+ref_set_ptr getRefSetInfo(const mxArray*);
+std::string buildAlignKey(const mxChar*, mwSize, const ref_set_info&, double, const mxChar*);
+bool findAlignCache(const std::string&, const ref_set_ptr&, std::vector<align_info>&);
+void addAlignCache(const std::string&, const ref_set_ptr&, const std::vector<align_info>&);
+align_cache_stats getAlignCacheStats();
+void clearAlignCache();
+
+#endif
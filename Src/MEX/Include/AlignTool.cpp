@@ -8,13 +8,18 @@
  *   PreferSide: 'l', r', 'm' for tie-breaking alignment score to get left-match, right-match, or middle-match
  *   AllowedMiss: # of 1-gap-miss (101 but not 1001) to NOT be counted as a miss. 
  *  
- * NOTE: speed is faster with lower case options, as these uses if statements to check for parameter.
+ * NOTE: The options are decoded once per call. The offset scan of alignSeq, cmprSeq, trimMatchResults,
+ *   and calcAlignScore are templated on them (see SCAN_ALIGN_SCORE), so the inner loops have no option checks.
+ *   The seq compare picks its SIMD level at run time (see CpuTool).
  */
 
 #include "AlignTool.hpp"
+#include "CpuTool.hpp"
+#include "StatTool.hpp"
 #include <ctype.h>
 #include <math.h>
 #include <limits>
+#include <algorithm>
 
 // Find the first occurence of a 1 (0-based index)
 int findFirstMatch(bool *pMatch, mwSize Len) {
@@ -32,10 +37,84 @@ int findLastMatch(bool *pMatch, mwSize Len) {
     return -1; // no match
 }
 
-// Compute the alignment score from a bool[] alignment result. 
-// Score = sum(ConsecHits^2)-sum(ConsecMiss)^2-LeftMiss^2-RightMiss^2
-double calcAlignScore(bool *pMatch, mwSize Len, double AllowedMiss, mxChar PenaltySide) {
-    double Score = 0, Hits = 0, Miss = 0, PenaltyLHS = 0, PenaltyRHS = 0; // MUST initialize 0, or bugs occur (compiler bug)   
+// Option codes of the templated kernels below. Other option chars act as 'n'.
+enum align_side { SIDE_N = 0, SIDE_L = 1, SIDE_R = 2, SIDE_B = 3 };
+enum align_alphabet { ALPHA_R = 0, ALPHA_N = 1, ALPHA_A = 2 };
+
+static inline int getSideCode(mxChar Side) {
+    switch (tolower(Side)) {
+        case 'l': return SIDE_L;
+        case 'r': return SIDE_R;
+        case 'b': return SIDE_B;
+        default:  return SIDE_N;
+    }
+}
+
+static inline int getAlphabetCode(mxChar Alphabet) {
+    switch (tolower(Alphabet)) {
+        case 'n': return ALPHA_N;
+        case 'a': return ALPHA_A;
+        default:  return ALPHA_R;
+    }
+}
+
+// Same as cmprSeq, for a fixed Alphabet. The compare uses the SIMD level
+// of the CPU (see CpuTool).
+template <int Alpha>
+static inline void cmprSeqT(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, bool *pMatch) {
+    cmprSeqCpu(pSeqA, pSeqB, Len, Alpha == ALPHA_A ? 'X' : 'N', Alpha != ALPHA_R, pMatch);
+}
+
+// Same as trimMatchResults, for a fixed TrimSide
+template <int Trim>
+static inline void trimMatchT(bool *pMatch, mwSize Len) {
+    if (Trim == SIDE_N || Len <= 4) { return; }
+
+    if (Trim == SIDE_L || Trim == SIDE_B) {
+        int Sum = 0, i = 0;
+        for (; i < 4; i++) { //get initial 1st 4 sum
+            Sum += pMatch[i];
+        }
+        for (; i < Len; i++) { //i is 4 and going up
+            if (Sum >= 3) { break; }
+            Sum += pMatch[i];
+            if (pMatch[i-4]) { 
+                Sum--;
+                pMatch[i-4] = false;
+            }
+        }
+        if (i == Len && Sum < 3) { //set all to 0, nothing is good
+            for (i = i-4; i < Len; i++) {
+                pMatch[i] = false;
+            }
+        }
+    }
+
+    if (Trim == SIDE_R || Trim == SIDE_B) {
+        int Sum = 0, i = Len;
+        for (; i > Len-4; i--) { //Initial 1st 4 sum 
+            Sum += pMatch[i-1];
+        }
+        for (; i >= 1; i--) {
+            if (Sum >= 3) { break; }
+            Sum += pMatch[i-1];
+            if (pMatch[i+3]) { 
+                Sum--; 
+                pMatch[i+3] = false; 
+            }
+        }
+        if (i == 0 && Sum < 3) { //set all to 0, nothing is good
+            for (i = 3; i >= 0; i--) {
+                pMatch[i] = false;
+            }
+        }
+    }
+}
+
+// Same as calcAlignScore, for a fixed PenaltySide
+template <int Penalty>
+static inline double calcAlignScoreT(bool *pMatch, mwSize Len, double AllowedMiss) {
+    double Score = 0, Hits = 0, Miss = 0; // MUST initialize 0, or bugs occur (compiler bug)   
     int s = findFirstMatch(pMatch, Len);
     if (s < 0) { return - (double) (Len*Len); } //no need to check e<0 if s<0.
     int e = findLastMatch(pMatch, Len);
@@ -60,27 +139,70 @@ double calcAlignScore(bool *pMatch, mwSize Len, double AllowedMiss, mxChar Penal
         }
     }
     
-    switch (tolower(PenaltySide)) {
-        case 'l':
-            PenaltyLHS = s*s;
-            break;
-        case 'r':
-            PenaltyRHS = (Len-e)*(Len-e);
-            break;
-        case 'b':
-            PenaltyLHS = s*s;
-            PenaltyRHS = (Len-e)*(Len-e);            
-            break;
-    }
+    double PenaltyLHS = Penalty == SIDE_L || Penalty == SIDE_B ? (double) (s*s) : 0;
+    double PenaltyRHS = Penalty == SIDE_R || Penalty == SIDE_B ? (double) ((Len-e)*(Len-e)) : 0;
     return (Score + Hits*Hits - Miss*Miss - PenaltyLHS - PenaltyRHS);
 }
 
+// Scores the nt match of 1 offset, as used by alignSeq to find the best offset
+template <int Trim, int Penalty>
+static inline double scoreOffset(const mxChar *pSeqL, const mxChar *pSeqS, mwSize Len, double MissRate, bool *pMatch) {
+    cmprSeqT<ALPHA_N>(pSeqL, pSeqS, Len, pMatch);
+    trimMatchT<Trim>(pMatch, Len);
+    return calcAlignScoreT<Penalty>(pMatch, Len, round(MissRate * Len));
+}
+
+// Scores all offsets of the shorter SeqS over the longer SeqL into pScore,
+// returning the max score. pScore[P] is for SeqS's 1st nt placed over SeqL
+// position P - LenS + 1.
+template <int Trim, int Penalty>
+static double scanAlignScore(const mxChar *pSeqL, const mxChar *pSeqS, mwSize LenL, mwSize LenS, double MissRate, bool *pMatch, double *pScore) {
+    double MaxScore = -1; //start at -1 because the first, worst you can do is Len = 1, all miss, so Score = - Len^2 = -1. 
+    int NumP = LenL + LenS - 1;
+    for (int P = 0; P < NumP; P++) {
+        int D = P - (int) LenS + 1;
+        int L = D > 0 ? D : 0, S = D < 0 ? -D : 0;
+        pScore[P] = scoreOffset<Trim, Penalty>(&pSeqL[L], &pSeqS[S], std::min(LenL - L, LenS - S), MissRate, pMatch);
+        if (pScore[P] > MaxScore) { MaxScore = pScore[P]; } //only the max score needs to be updated to get highest score
+    }
+    return MaxScore;
+}
+
+// Dispatch table of scanAlignScore, as SCAN_ALIGN_SCORE[TrimSide][PenaltySide]
+typedef double (*scan_align_fn)(const mxChar*, const mxChar*, mwSize, mwSize, double, bool*, double*);
+static const scan_align_fn SCAN_ALIGN_SCORE[4][4] = {
+    {scanAlignScore<0, 0>, scanAlignScore<0, 1>, scanAlignScore<0, 2>, scanAlignScore<0, 3>},
+    {scanAlignScore<1, 0>, scanAlignScore<1, 1>, scanAlignScore<1, 2>, scanAlignScore<1, 3>},
+    {scanAlignScore<2, 0>, scanAlignScore<2, 1>, scanAlignScore<2, 2>, scanAlignScore<2, 3>},
+    {scanAlignScore<3, 0>, scanAlignScore<3, 1>, scanAlignScore<3, 2>, scanAlignScore<3, 3>}
+};
+
+// Compute the alignment score from a bool[] alignment result. 
+// Score = sum(ConsecHits^2)-sum(ConsecMiss)^2-LeftMiss^2-RightMiss^2
+double calcAlignScore(bool *pMatch, mwSize Len, double AllowedMiss, mxChar PenaltySide) {
+    switch (getSideCode(PenaltySide)) {
+        case SIDE_L: return calcAlignScoreT<SIDE_L>(pMatch, Len, AllowedMiss);
+        case SIDE_R: return calcAlignScoreT<SIDE_R>(pMatch, Len, AllowedMiss);
+        case SIDE_B: return calcAlignScoreT<SIDE_B>(pMatch, Len, AllowedMiss);
+        default:     return calcAlignScoreT<SIDE_N>(pMatch, Len, AllowedMiss);
+    }
+}
+
 // Align SeqA and SeqB, returning an alignment information structure.
 void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double MissRate, mxChar Alphabet, mxChar ExactMatch, mxChar TrimSide, mxChar PenaltySide, mxChar PreferSide, align_info &AI) {
     bool pMatch[LenB > LenA ? LenB : LenA]; // only has to be greater of 2 sequence length. recycle array for match tracking.
     alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI, pMatch);
 }
 void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double MissRate, mxChar Alphabet, mxChar ExactMatch, mxChar TrimSide, mxChar PenaltySide, mxChar PreferSide, align_info &AI, bool *pMatch) {
+    alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI, pMatch, false);
+}
+
+// Same as alignSeq, but if ScoreOnly, only AI.Score and AI.BShift are found.
+// AI.Match is NaN and AI.MatchS/E are -1, since the final compare at the
+// best offset is skipped (it is only redone if Alphabet is not 'n', which
+// can change the score).
+void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double MissRate, mxChar Alphabet, mxChar ExactMatch, mxChar TrimSide, mxChar PenaltySide, mxChar PreferSide, align_info &AI, bool *pMatch, bool ScoreOnly) {
+    STAT_TIMER(STAT_ALIGN_SEQ, LenA);
     if (LenA < 1 || LenB < 1) { return; } //Nothing to align 
     double AllowedMiss = 0;
     if (ExactMatch == 'y' || ExactMatch == 'Y') {
@@ -91,6 +213,12 @@ void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double Mis
 
         AI.Score  = calcAlignScore(pMatch, Len, AllowedMiss, PenaltySide);
         AI.BShift = 0;  //Reset in case some other function is recycling align_info
+        if (ScoreOnly) { //calcAlignScore is already -Len^2 if there is no match
+            AI.Match = std::numeric_limits<double>::quiet_NaN();
+            AI.MatchS = -1;
+            AI.MatchE = -1;
+            return;
+        }
         AI.Match  = 0;  
         AI.MatchS = findFirstMatch(pMatch, Len);
         if (AI.MatchS > -1) { 
@@ -118,48 +246,16 @@ void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double Mis
             LenS = LenB;
         }
         
-        double AllowedMiss = 0;  // for determing allowed nt misses in alignment
+        int P = 0;               // pos for pScore array
         mwSize Len = 0;          // overlapping length of SeqL & SeqS
-        int P = LenL + LenS - 2; // pos for pScore array
         double pScore[LenL + LenS - 1];
         
         //Reset align_info in case another program is recylcing AI 
-        AI.Score = -1; //start at -1 because the first, worst you can do is Len = 1, all miss, so Score = - Len^2 = -1. 
         AI.Match =  0;
         AI.BShift = 0;
         AI.MatchS = 0;
         AI.MatchE = 0;
-        
-        //SeqS 1st nt is over the right edge of SeqL
-        int L = LenL-1; //pos for SeqL
-        int S = 0;      //pos for SeqS
-        for (Len = 1; Len < LenS; Len++, L--, P--) {
-            AllowedMiss = round(MissRate * Len);
-            cmprSeq(&pSeqL[L], &pSeqS[S], Len, 'n', pMatch);
-            trimMatchResults(pMatch, Len, TrimSide);
-            pScore[P] = calcAlignScore(pMatch, Len, AllowedMiss, PenaltySide);
-            if (pScore[P] > AI.Score) { AI.Score = pScore[P]; } //only AI.Score needs to be update to get highest score
-        }
-
-        //SeqS is over SeqL. Len should be same as LenS.
-        for (L; L >= 0; L--, P--) {
-            AllowedMiss = round(MissRate * Len);
-            cmprSeq(&pSeqL[L], &pSeqS[S], Len, 'n', pMatch);
-            trimMatchResults(pMatch, Len, TrimSide);
-            pScore[P] = calcAlignScore(pMatch, Len, AllowedMiss, PenaltySide);
-            if (pScore[P] > AI.Score) { AI.Score = pScore[P]; }
-        }
-        
-        //SeqS lst nt is over the left edge of SeqL
-        L = 0;
-        S = 1;
-        for (Len = LenS-1; Len >= 1; Len--, S++, P--) {
-            AllowedMiss = round(MissRate * Len);
-            cmprSeq(&pSeqL[L], &pSeqS[S], Len, 'n', pMatch);
-            trimMatchResults(pMatch, Len, TrimSide);
-            pScore[P] = calcAlignScore(pMatch, Len, AllowedMiss, PenaltySide);
-            if (pScore[P] > AI.Score) { AI.Score = pScore[P]; }
-        }
+        AI.Score = SCAN_ALIGN_SCORE[getSideCode(TrimSide)][getSideCode(PenaltySide)](pSeqL, pSeqS, LenL, LenS, MissRate, pMatch, pScore);
 
         //Find max score location
         if (PreferSide == 'l' || PreferSide == 'L') { //Find left highest
@@ -184,6 +280,12 @@ void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double Mis
         //Determine the AI parameters
         int BShift = (P - (int) LenS + 1);
         AI.BShift = LenB > LenA ? -BShift : BShift;
+        if (ScoreOnly && getAlphabetCode(Alphabet) == ALPHA_N) { //pMatch would be the same as the scan's, so AI.Score is final
+            AI.Match = std::numeric_limits<double>::quiet_NaN();
+            AI.MatchS = -1;
+            AI.MatchE = -1;
+            return;
+        }
 
         if (AI.BShift >= 0) {
             Len = LenA - AI.BShift < LenB ? LenA - AI.BShift : LenB;
@@ -208,73 +310,31 @@ void alignSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize LenA, mwSize LenB, double Mis
             AI.MatchS += fabs(AI.BShift);
             AI.MatchE = -1; //No match default
         }
+        if (ScoreOnly) {
+            AI.Match = std::numeric_limits<double>::quiet_NaN();
+            AI.MatchS = -1;
+            AI.MatchE = -1;
+        }
     }
 } 
 
 // Compares SeqA and SeqB and updates a boolean vector of match/miss.
 void cmprSeq(mxChar *pSeqA, mxChar *pSeqB, mwSize Len, mxChar Alphabet, bool *pMatch) { // overloaded: compare SeqA and SeqB WITHOUT creating a bool *palignment result
-    switch (tolower(Alphabet)) {
-        case 'n':
-            for (mwSize i = 0; i < Len; i++) {
-                pMatch[i] = (pSeqA[i] == pSeqB[i] || pSeqA[i] == 'N' || pSeqB[i] == 'N');
-            }
-            break;
-        case 'a':
-            for (mwSize i = 0; i < Len; i++) {
-                pMatch[i] = (pSeqA[i] == pSeqB[i] || pSeqA[i] == 'X' || pSeqB[i] == 'X');
-            }
-            break;
-        default:
-            for (mwSize i = 0; i < Len; i++) {
-                pMatch[i] = (pSeqA[i] == pSeqB[i]);
-            }        
-            break;
+    STAT_TIMER(STAT_CMPR_SEQ, Len);
+    switch (getAlphabetCode(Alphabet)) {
+        case ALPHA_N: cmprSeqT<ALPHA_N>(pSeqA, pSeqB, Len, pMatch); break;
+        case ALPHA_A: cmprSeqT<ALPHA_A>(pSeqA, pSeqB, Len, pMatch); break;
+        default:      cmprSeqT<ALPHA_R>(pSeqA, pSeqB, Len, pMatch);
     }
 }
 
 // Trims (set to false) bool[] from the left and/or right side until 3/4 matches are found.
 void trimMatchResults(bool *pMatch, mwSize Len, mxChar TrimSide) {
-    TrimSide = tolower(TrimSide);
-    if (Len <= 4 || TrimSide == 'n') { return; }
-    
-    if (TrimSide == 'l' || TrimSide == 'b') {
-        int Sum = 0, i = 0;
-        for (i; i < 4; i++) { //get initial 1st 4 sum
-            if (pMatch[i]) { Sum++; } 
-        }
-        for (i; i < Len; i++) { //i is 4 and going up
-            if (Sum >= 3) { break; }
-            if (pMatch[i]) { Sum++; }
-            if (pMatch[i-4]) { 
-                Sum--;
-                pMatch[i-4] = false;
-            }
-        }
-        if (i == Len && Sum < 3) { //set all to 0, nothing is good
-            for (i = i-4; i < Len; i++) {
-                pMatch[i] = false;
-            }
-        }
-    }
-
-    if (TrimSide == 'r' || TrimSide == 'b') {
-        int Sum = 0, i = Len;
-        for (i; i > Len-4; i--) {//Initial 1st 4 sum 
-            if (pMatch[i-1]) { Sum++; }
-        }
-        for (i; i >= 1; i--) {
-            if (Sum >= 3) { break; }
-            if (pMatch[i-1]) { Sum++; } 
-            if (pMatch[i+3]) { 
-                Sum--; 
-                pMatch[i+3] = false; 
-            }
-        }
-        if (i == 0 && Sum < 3) { //set all to 0, nothing is good
-            for (i = 3; i >= 0; i--) {
-                pMatch[i] = false;
-            }
-        }
+    switch (getSideCode(TrimSide)) {
+        case SIDE_L: trimMatchT<SIDE_L>(pMatch, Len); break;
+        case SIDE_R: trimMatchT<SIDE_R>(pMatch, Len); break;
+        case SIDE_B: trimMatchT<SIDE_B>(pMatch, Len); break;
+        default:     break;
     }
 }
 
@@ -317,4 +377,146 @@ int countMatch(bool *pMatch, mwSize Len) {
         if (pMatch[k]) { Ct++; }
     }
     return Ct;
+}
+
+// Score of 2 nts for the gapped alignment
+static inline double scoreGapNT(mxChar A, mxChar B, const gap_param &GP) {
+    if (A == 'N' || B == 'N') { return GP.Wild; }
+    return A == B ? GP.Match : GP.Miss;
+}
+
+// Banded, affine-gap (Gotoh) local alignment of SeqA to SeqB. Only the
+// 2*Band+1 diagonals around the seed BShift (see align_info.BShift, ex: from
+// an ungapped alignSeq) are filled, so the cost is O(LenA*Band) instead of
+// O(LenA*LenB). Row t-th cell is diagonal (j - i) = -BShift - Band + t.
+void alignGapSeq(const mxChar *pSeqA, const mxChar *pSeqB, mwSize LenA, mwSize LenB, int BShift, const gap_param &GP, gap_align_info &GI) {
+    GI = gap_align_info();
+    if (LenA < 1 || LenB < 1) { return; }
+    const double NEG = -std::numeric_limits<double>::infinity();
+    int Band = std::max(GP.Band, 0);
+    int Kmin = -BShift - Band;
+    int W = 2*Band + 1;
+
+    //Band rows are padded by 1 cell on each side. H row 0 is 0 (local).
+    std::vector<double> Hp(W + 2, 0), Hc(W + 2, NEG), Fp(W + 2, NEG), Fc(W + 2, NEG);
+    Hp[0] = Hp[W+1] = NEG;
+    std::vector<unsigned char> Trace((size_t) LenA * W, 0); //bits 0-1: H from 0 (stop), 1 (diag), 2 (E), 3 (F). bit 2: E extends. bit 3: F extends.
+
+    double Best = 0;
+    int BestI = 0, BestJ = 0, BestT = 0;
+    for (int i = 1; i <= (int) LenA; i++) {
+        double E = NEG;
+        unsigned char *pTrace = &Trace[(size_t) (i-1) * W];
+        for (int t = 0; t < W; t++) {
+            int j = i + Kmin + t;
+            if (j < 1 || j > (int) LenB) {
+                Hc[t+1] = j == 0 ? 0 : NEG; //column 0 is 0 (local)
+                Fc[t+1] = NEG;
+                E = NEG;
+                continue;
+            }
+            unsigned char Tr = 0;
+            double Eopen = Hc[t] - GP.GapOpen, Eext = E - GP.GapExtend; //from (i, j-1)
+            if (Eext > Eopen) { E = Eext; Tr |= 4; } else { E = Eopen; }
+            double F, Fopen = Hp[t+2] - GP.GapOpen, Fext = Fp[t+2] - GP.GapExtend; //from (i-1, j)
+            if (Fext > Fopen) { F = Fext; Tr |= 8; } else { F = Fopen; }
+
+            double H = Hp[t+1] + scoreGapNT(pSeqA[i-1], pSeqB[j-1], GP); //from (i-1, j-1)
+            unsigned char Src = 1;
+            if (E > H) { H = E; Src = 2; }
+            if (F > H) { H = F; Src = 3; }
+            if (H <= 0) { H = 0; Src = 0; }
+            pTrace[t] = Tr | Src;
+            Hc[t+1] = H;
+            Fc[t+1] = F;
+            if (H > Best) {
+                Best = H;
+                BestI = i;
+                BestJ = j;
+                BestT = t;
+            }
+        }
+        std::swap(Hp, Hc);
+        std::swap(Fp, Fc);
+    }
+    if (Best <= 0) { return; }
+
+    //Traceback from the best cell. State 0 = H, 2 = E, 3 = F.
+    int i = BestI, j = BestJ, t = BestT, State = 0;
+    while (i > 0 && j > 0) {
+        unsigned char Tr = Trace[(size_t) (i-1) * W + t];
+        if (State == 0) {
+            State = Tr & 3;
+            if (State == 0) { break; }
+            if (State == 1) {
+                GI.Ops.push_back('M');
+                i--;
+                j--;
+                State = 0;
+            }
+        } else if (State == 2) {
+            GI.Ops.push_back('D');
+            State = (Tr & 4) ? 2 : 0;
+            j--;
+            t--;
+        } else {
+            GI.Ops.push_back('I');
+            State = (Tr & 8) ? 3 : 0;
+            i--;
+            t++;
+        }
+    }
+    std::reverse(GI.Ops.begin(), GI.Ops.end());
+    GI.Score = Best;
+    GI.StartA = i;
+    GI.StartB = j;
+}
+
+// Returns the CIGAR string of a gapped alignment, with the unaligned ends
+// of SeqA as soft clips. Ex: 3S20M1I10M1D5M2S
+std::string buildCigar(const gap_align_info &GI, mwSize LenA) {
+    std::string Cigar;
+    if (GI.StartA < 0) { return Cigar; }
+    char Buf[32];
+    int LenUsed = 0;
+    if (GI.StartA > 0) {
+        snprintf(Buf, sizeof(Buf), "%dS", GI.StartA);
+        Cigar += Buf;
+    }
+    for (size_t k = 0; k < GI.Ops.size(); ) {
+        size_t e = k;
+        while (e < GI.Ops.size() && GI.Ops[e] == GI.Ops[k]) { e++; }
+        snprintf(Buf, sizeof(Buf), "%d%c", (int) (e - k), GI.Ops[k]);
+        Cigar += Buf;
+        if (GI.Ops[k] != 'D') { LenUsed += (int) (e - k); }
+        k = e;
+    }
+    int Clip3 = (int) LenA - GI.StartA - LenUsed;
+    if (Clip3 > 0) {
+        snprintf(Buf, sizeof(Buf), "%dS", Clip3);
+        Cigar += Buf;
+    }
+    return Cigar;
+}
+
+// Fixes the indels of SeqA using a gapped alignment to SeqB. Deleted nts
+// are filled in with SeqB nts, inserted nts are removed, and the unaligned
+// ends of SeqA are kept as is.
+void fixIndelSeq(const mxChar *pSeqA, const mxChar *pSeqB, mwSize LenA, const gap_align_info &GI, std::vector<mxChar> &FixSeq) {
+    FixSeq.clear();
+    if (GI.StartA < 0) {
+        FixSeq.assign(pSeqA, pSeqA + LenA);
+        return;
+    }
+    FixSeq.reserve(LenA + GI.Ops.size());
+    FixSeq.assign(pSeqA, pSeqA + GI.StartA);
+    int a = GI.StartA, b = GI.StartB;
+    for (size_t k = 0; k < GI.Ops.size(); k++) {
+        switch (GI.Ops[k]) {
+            case 'M': FixSeq.push_back(pSeqA[a++]); b++; break;
+            case 'D': FixSeq.push_back(pSeqB[b++]); break;
+            case 'I': a++; break;
+        }
+    }
+    FixSeq.insert(FixSeq.end(), pSeqA + a, pSeqA + LenA);
 }
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include "mex.h"
 #include <math.h>
+#include <string>
+#include <vector>
 
 // align_info will store information of the sequence alignment
 struct align_info {
@@ -13,14 +15,36 @@ struct align_info {
     int MatchE = -1;  //MatchE: last position where SeqA-to-SeqB alignment position matches (1-based index)
 }; 
 
+// gap_param stores the scores of the banded, affine-gap local alignment
+struct gap_param {
+    double Match = 5;       //Match: score of a nt match
+    double Miss = -4;       //Miss: score of a nt mismatch
+    double Wild = -2;       //Wild: score of an N vs any nt
+    double GapOpen = 8;     //GapOpen: penalty of the 1st nt of a gap
+    double GapExtend = 8;   //GapExtend: penalty of each extra nt of a gap
+    int Band = 8;           //Band: # of diagonals to search on each side of the seed diagonal
+};
+
+// gap_align_info stores the banded, affine-gap local alignment results
+struct gap_align_info {
+    double Score = 0;   //Score: local alignment score. 0 if no alignment.
+    int StartA = -1;    //StartA: 1st aligned nt of SeqA (0-based index). -1 if no alignment.
+    int StartB = -1;    //StartB: 1st aligned nt of SeqB (0-based index). -1 if no alignment.
+    std::string Ops;    //Ops: 'M' (match/mismatch), 'I' (SeqA nt not in SeqB), 'D' (SeqB nt not in SeqA) per alignment column
+};
+
 int findFirstMatch(bool*, mwSize);
 int findLastMatch(bool*, mwSize);
 double calcAlignScore(bool*, mwSize, double, mxChar);
 void alignSeq(mxChar*, mxChar*, mwSize, mwSize, double, mxChar, mxChar, mxChar, mxChar, mxChar, align_info&);
 void alignSeq(mxChar*, mxChar*, mwSize, mwSize, double, mxChar, mxChar, mxChar, mxChar, mxChar, align_info&, bool*);
+void alignSeq(mxChar*, mxChar*, mwSize, mwSize, double, mxChar, mxChar, mxChar, mxChar, mxChar, align_info&, bool*, bool);
 void cmprSeq(mxChar*, mxChar*, mwSize, mxChar, bool*);
 void trimMatchResults(bool*, mwSize, mxChar);
 mxArray *buildAlignment(mxChar*, mxChar*, mwSize, mwSize, align_info);
 int countMatch(bool*, mwSize);
+void alignGapSeq(const mxChar*, const mxChar*, mwSize, mwSize, int, const gap_param&, gap_align_info&);
+std::string buildCigar(const gap_align_info&, mwSize);
+void fixIndelSeq(const mxChar*, const mxChar*, mwSize, const gap_align_info&, std::vector<mxChar>&);
 
 #endif
\ No newline at end of file
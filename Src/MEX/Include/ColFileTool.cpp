@@ -0,0 +1,306 @@
+/*  ColFileTool contains the codes for the BRILIA columnar (.bcol) file,
+ *  a binary checkpoint of VDJdata that is appended 1 batch at a time.
+ *
+ *  FILE LAYOUT
+ *    [Batch 1][Footer 1][Batch 2][Footer 2] ... [Batch B][Footer B]
+ *
+ *    Batch: (NumCol+1) uint64 column offsets from the batch start (the
+ *      last one is the batch size), then each column block:
+ *        uint8 Kind = 0 (numeric): NumRow uint8 (0 = [], 1 = value), then
+ *          NumRow double
+ *        uint8 Kind = 1 (string): NumRow uint32 lengths (EMPTY_LEN = []),
+ *          then the 8-bit chars
+ *        uint8 Kind = 2 (any): per row, uint8 class (0 double, 1 char, 2
+ *          logical), uint32 M, uint32 N, then the M*N values
+ *    Footer: "BCOLIDX1", uint32 NumCol, per column (uint32 Len, name),
+ *      uint64 NumBatch, per batch (uint64 BatchStart, uint64 NumRow,
+ *      double LastSeqNum), uint64 FooterStart, "BCOLEND1"
+ *
+ *  Each footer indexes all batches so far, so only the last footer is
+ *  read, and it is found from the last 16 bytes of the file. If a write
+ *  was cut off (ex: the job was stopped), the last complete footer is
+ *  found by searching backwards, and the next append overwrites the
+ *  partial batch.
+ *
+ *  NOTE: Numbers are stored in the byte order of the CPU (little endian on
+ *  x86 and ARM).
+ */
+
+#include "ColFileTool.hpp"
+#include <string.h>
+
+static const char IDX_TAG[8] = {'B', 'C', 'O', 'L', 'I', 'D', 'X', '1'};
+static const char END_TAG[8] = {'B', 'C', 'O', 'L', 'E', 'N', 'D', '1'};
+static const unsigned int EMPTY_LEN = 0xFFFFFFFF;
+
+enum col_kind { COL_NUM = 0, COL_STR = 1, COL_ANY = 2 };
+
+template <typename T>
+static void appendValue(std::string &Buf, T Value) {
+    Buf.append((const char*) &Value, sizeof(T));
+}
+
+template <typename T>
+static T getValue(const char *pData) {
+    T Value;
+    memcpy(&Value, pData, sizeof(T));
+    return Value;
+}
+
+// Returns true if the cell is [] (0x0 double)
+static bool isEmptyDouble(const mxArray *pCell) {
+    return pCell == NULL || (mxIsDouble(pCell) && mxGetM(pCell) == 0 && mxGetN(pCell) == 0);
+}
+
+// Picks the most compact column kind that can store all cells exactly
+static col_kind getColKind(const mxArray *pCellData, mwSize NumRow, size_t Col) {
+    bool IsNum = true, IsStr = true;
+    for (mwSize r = 0; r < NumRow; r++) {
+        const mxArray *pCell = mxGetCell(pCellData, r + Col*NumRow);
+        if (isEmptyDouble(pCell)) { continue; }
+        if (!(mxIsDouble(pCell) && mxGetNumberOfElements(pCell) == 1)) { IsNum = false; }
+        if (!(mxIsChar(pCell) && mxGetM(pCell) <= 1)) {
+            IsStr = false;
+        } else if (IsStr) {
+            const mxChar *pChar = mxGetChars(pCell);
+            for (mwSize j = 0; j < mxGetNumberOfElements(pCell); j++) {
+                if (pChar[j] > 255) {
+                    IsStr = false;
+                    break;
+                }
+            }
+        }
+        if (!mxIsDouble(pCell) && !mxIsChar(pCell) && !mxIsLogical(pCell)) {
+            mexErrMsgIdAndTxt("ColFileTool_encodeColBatch:input", "Column %d has a cell that is not a double, char, or logical.", (int) Col + 1);
+        }
+        if (mxIsComplex(pCell) || mxGetNumberOfDimensions(pCell) > 2) {
+            mexErrMsgIdAndTxt("ColFileTool_encodeColBatch:input", "Column %d has a complex or N-D array.", (int) Col + 1);
+        }
+    }
+    return IsNum ? COL_NUM : (IsStr ? COL_STR : COL_ANY);
+}
+
+static void encodeColumn(const mxArray *pCellData, mwSize NumRow, size_t Col, std::string &Buf) {
+    col_kind Kind = getColKind(pCellData, NumRow, Col);
+    Buf += (char) Kind;
+    switch (Kind) {
+        case COL_NUM:
+            for (mwSize r = 0; r < NumRow; r++) {
+                Buf += (char) !isEmptyDouble(mxGetCell(pCellData, r + Col*NumRow));
+            }
+            for (mwSize r = 0; r < NumRow; r++) {
+                const mxArray *pCell = mxGetCell(pCellData, r + Col*NumRow);
+                appendValue<double>(Buf, isEmptyDouble(pCell) ? 0 : mxGetScalar(pCell));
+            }
+            break;
+        case COL_STR:
+            for (mwSize r = 0; r < NumRow; r++) {
+                const mxArray *pCell = mxGetCell(pCellData, r + Col*NumRow);
+                appendValue<unsigned int>(Buf, isEmptyDouble(pCell) ? EMPTY_LEN : (unsigned int) mxGetNumberOfElements(pCell));
+            }
+            for (mwSize r = 0; r < NumRow; r++) {
+                const mxArray *pCell = mxGetCell(pCellData, r + Col*NumRow);
+                if (isEmptyDouble(pCell)) { continue; }
+                const mxChar *pChar = mxGetChars(pCell);
+                for (mwSize j = 0; j < mxGetNumberOfElements(pCell); j++) {
+                    Buf += (char) pChar[j];
+                }
+            }
+            break;
+        default:
+            for (mwSize r = 0; r < NumRow; r++) {
+                const mxArray *pCell = mxGetCell(pCellData, r + Col*NumRow);
+                if (pCell == NULL) {
+                    Buf += (char) 0;
+                    appendValue<unsigned int>(Buf, 0);
+                    appendValue<unsigned int>(Buf, 0);
+                    continue;
+                }
+                size_t NumElem = mxGetNumberOfElements(pCell);
+                Buf += (char) (mxIsDouble(pCell) ? 0 : (mxIsChar(pCell) ? 1 : 2));
+                appendValue<unsigned int>(Buf, (unsigned int) mxGetM(pCell));
+                appendValue<unsigned int>(Buf, (unsigned int) mxGetN(pCell));
+                size_t ElemSize = mxIsDouble(pCell) ? sizeof(double) : (mxIsChar(pCell) ? sizeof(mxChar) : sizeof(mxLogical));
+                if (NumElem > 0) {
+                    Buf.append((const char*) mxGetData(pCell), NumElem * ElemSize);
+                }
+            }
+            break;
+    }
+}
+
+// Encodes a MxN cell array as 1 batch
+void encodeColBatch(const mxArray *pCellData, std::string &Buf) {
+    mwSize NumRow = mxGetM(pCellData);
+    size_t NumCol = mxGetN(pCellData);
+    size_t Start = Buf.size();
+    Buf.append((NumCol + 1) * sizeof(unsigned long long), '\0');
+    for (size_t c = 0; c < NumCol; c++) {
+        unsigned long long Offset = Buf.size() - Start;
+        memcpy(&Buf[Start + c*sizeof(unsigned long long)], &Offset, sizeof(Offset));
+        encodeColumn(pCellData, NumRow, c, Buf);
+    }
+    unsigned long long Size = Buf.size() - Start;
+    memcpy(&Buf[Start + NumCol*sizeof(unsigned long long)], &Size, sizeof(Size));
+}
+
+// Encodes the footer. BatchStart must already include the new batch.
+void encodeColFooter(const col_index &CI, std::string &Buf) {
+    unsigned long long FooterStart = CI.FooterEnd;
+    Buf.append(IDX_TAG, 8);
+    appendValue<unsigned int>(Buf, (unsigned int) CI.Header.size());
+    for (size_t c = 0; c < CI.Header.size(); c++) {
+        appendValue<unsigned int>(Buf, (unsigned int) CI.Header[c].size());
+        Buf += CI.Header[c];
+    }
+    appendValue<unsigned long long>(Buf, CI.BatchStart.size());
+    for (size_t b = 0; b < CI.BatchStart.size(); b++) {
+        appendValue<unsigned long long>(Buf, CI.BatchStart[b]);
+        appendValue<unsigned long long>(Buf, CI.BatchRows[b]);
+        appendValue<double>(Buf, CI.LastSeqNum[b]);
+    }
+    appendValue<unsigned long long>(Buf, FooterStart);
+    Buf.append(END_TAG, 8);
+}
+
+// Parses the footer that ends right before pEnd. Returns false if invalid.
+static bool parseColFooter(const char *pData, const char *pEnd, col_index &CI) {
+    if (pEnd - pData < 16 || memcmp(pEnd - 8, END_TAG, 8) != 0) { return false; }
+    unsigned long long FooterStart = getValue<unsigned long long>(pEnd - 16);
+    if (FooterStart + 8 > (unsigned long long) (pEnd - 16 - pData)) { return false; }
+    const char *p = pData + FooterStart;
+    const char *pStop = pEnd - 16;
+    if (memcmp(p, IDX_TAG, 8) != 0) { return false; }
+    p += 8;
+
+    col_index New;
+    if (pStop - p < 4) { return false; }
+    unsigned int NumCol = getValue<unsigned int>(p);
+    p += 4;
+    for (unsigned int c = 0; c < NumCol; c++) {
+        if (pStop - p < 4) { return false; }
+        unsigned int Len = getValue<unsigned int>(p);
+        p += 4;
+        if ((unsigned long long) (pStop - p) < Len) { return false; }
+        New.Header.push_back(std::string(p, Len));
+        p += Len;
+    }
+    if (pStop - p < 8) { return false; }
+    unsigned long long NumBatch = getValue<unsigned long long>(p);
+    p += 8;
+    if ((unsigned long long) (pStop - p) != NumBatch * 24) { return false; }
+    for (unsigned long long b = 0; b < NumBatch; b++, p += 24) {
+        unsigned long long Start = getValue<unsigned long long>(p);
+        if (Start >= FooterStart) { return false; }
+        New.BatchStart.push_back(Start);
+        New.BatchRows.push_back(getValue<unsigned long long>(p + 8));
+        New.LastSeqNum.push_back(getValue<double>(p + 16));
+    }
+    New.FooterEnd = pEnd - pData;
+    CI = New;
+    return true;
+}
+
+// Reads the index from the last complete footer. Returns false if none.
+bool readColIndex(const char *pData, size_t Size, col_index &CI) {
+    CI = col_index();
+    if (pData == NULL || Size < 16) { return false; }
+    if (parseColFooter(pData, pData + Size, CI)) { return true; }
+    for (size_t End = Size - 1; End >= 16; End--) { //The last write was cut off
+        if (pData[End-1] == '1' && memcmp(pData + End - 8, END_TAG, 8) == 0 && parseColFooter(pData, pData + End, CI)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Decodes column Col of the batch at pBatch as a NumRow x 1 cell
+mxArray *decodeColumn(const char *pBatch, unsigned long long BatchSize, mwSize NumRow, size_t Col) {
+    unsigned long long Beg = getValue<unsigned long long>(pBatch + Col*8);
+    unsigned long long End = getValue<unsigned long long>(pBatch + (Col+1)*8);
+    if (Beg >= End || End > BatchSize) {
+        mexErrMsgIdAndTxt("ColFileTool_decodeColumn:input", "Column %d has an invalid offset.", (int) Col + 1);
+    }
+    const char *p = pBatch + Beg;
+    const char *pEnd = pBatch + End;
+    col_kind Kind = (col_kind) *p++;
+    mxArray *pOut = mxCreateCellMatrix(NumRow, 1);
+    bool Valid = true;
+    switch (Kind) {
+        case COL_NUM: {
+            if ((unsigned long long) (pEnd - p) != NumRow * 9) {
+                Valid = false;
+                break;
+            }
+            const char *pValue = p + NumRow;
+            for (mwSize r = 0; r < NumRow; r++) {
+                if (p[r]) { mxSetCell(pOut, r, mxCreateDoubleScalar(getValue<double>(pValue + r*8))); }
+            }
+            break;
+        }
+        case COL_STR: {
+            if ((unsigned long long) (pEnd - p) < NumRow * 4) {
+                Valid = false;
+                break;
+            }
+            const char *pChar = p + NumRow * 4;
+            for (mwSize r = 0; r < NumRow && Valid; r++) {
+                unsigned int Len = getValue<unsigned int>(p + r*4);
+                if (Len == EMPTY_LEN) { continue; }
+                if ((unsigned long long) (pEnd - pChar) < Len) {
+                    Valid = false;
+                    break;
+                }
+                mwSize Dims[2] = {(mwSize) (Len > 0), Len};
+                mxArray *pStr = mxCreateCharArray(2, Dims);
+                mxChar *pStrChar = mxGetChars(pStr);
+                for (unsigned int j = 0; j < Len; j++) {
+                    pStrChar[j] = (unsigned char) pChar[j];
+                }
+                pChar += Len;
+                mxSetCell(pOut, r, pStr);
+            }
+            break;
+        }
+        case COL_ANY:
+            for (mwSize r = 0; r < NumRow; r++) {
+                if (pEnd - p < 9) {
+                    Valid = false;
+                    break;
+                }
+                char Class = *p;
+                mwSize Dims[2] = {getValue<unsigned int>(p + 1), getValue<unsigned int>(p + 5)};
+                p += 9;
+                mxArray *pCell;
+                if (Class == 0) {
+                    pCell = mxCreateDoubleMatrix(Dims[0], Dims[1], mxREAL);
+                } else if (Class == 1) {
+                    pCell = mxCreateCharArray(2, Dims);
+                } else {
+                    pCell = mxCreateLogicalMatrix(Dims[0], Dims[1]);
+                }
+                size_t Bytes = Dims[0] * Dims[1] * mxGetElementSize(pCell);
+                if ((size_t) (pEnd - p) < Bytes) {
+                    mxDestroyArray(pCell);
+                    Valid = false;
+                    break;
+                }
+                if (Bytes > 0) { memcpy(mxGetData(pCell), p, Bytes); }
+                p += Bytes;
+                if (Class == 0 && Bytes == 0 && Dims[0] == 0 && Dims[1] == 0) {
+                    mxDestroyArray(pCell); //leave [] as a NULL cell, like the other kinds
+                    continue;
+                }
+                mxSetCell(pOut, r, pCell);
+            }
+            break;
+        default:
+            Valid = false;
+            break;
+    }
+    if (!Valid) {
+        mxDestroyArray(pOut);
+        mexErrMsgIdAndTxt("ColFileTool_decodeColumn:input", "Column %d is corrupted.", (int) Col + 1);
+    }
+    return pOut;
+}
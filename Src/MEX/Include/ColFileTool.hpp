@@ -0,0 +1,22 @@
+#ifndef COL_FILE_TOOL_HPP
+#define COL_FILE_TOOL_HPP
+
+#include "mex.h"
+#include <string>
+#include <vector>
+
+// col_index stores the footer of a BRILIA columnar (.bcol) file
+struct col_index {
+    std::vector<std::string> Header;      //Header: column names
+    std::vector<unsigned long long> BatchStart; //BatchStart: byte offset of each batch
+    std::vector<unsigned long long> BatchRows;  //BatchRows: number of rows in each batch
+    std::vector<double> LastSeqNum;       //LastSeqNum: last SeqNum processed by each batch
+    unsigned long long FooterEnd = 0;     //FooterEnd: byte offset to append the next batch
+};
+
+bool readColIndex(const char*, size_t, col_index&);
+void encodeColBatch(const mxArray*, std::string&);
+void encodeColFooter(const col_index&, std::string&);
+mxArray *decodeColumn(const char*, unsigned long long, mwSize, size_t);
+
+#endif
@@ -0,0 +1,218 @@
+/*  CpuTool contains the codes for picking the SIMD level of the seq kernels
+ *  at run time, so 1 MEX binary runs at full speed on older, AVX2, and
+ *  AVX-512 nodes. The level is found with CPUID on the 1st call, and each
+ *  kernel has a scalar, SSE4.2, AVX2, and AVX-512BW version. GCC/Clang
+ *  build each version with a target attribute, and MSVC allows the
+ *  intrinsics without /arch flags, so no CPU-specific compile flags are
+ *  needed.
+ *
+ *  ENVIRONMENT
+ *    BRILIA_CPU_LEVEL: 'scalar', 'sse42', 'avx2', or 'avx512' to use a
+ *      lower level than the CPU supports. A higher level is ignored.
+ *    BRILIA_CPU_VERIFY: fraction 0 to 1 of kernel calls to redo with the
+ *      scalar code and compare (default 0). See getCpuVerifyStats.
+ *
+ *  NOTE: Both are read once per MEX load. Use "clear mex" to reread them.
+ */
+
+#include "CpuTool.hpp"
+#include <atomic>
+#include <string>
+#include <vector>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CPU_TOOL_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define CPU_TARGET(Name)
+#else
+#define CPU_TARGET(Name) __attribute__((target(Name)))
+#endif
+#endif
+
+static std::atomic<unsigned long long> NUM_CALL(0), NUM_CHECKED(0), NUM_MISMATCH(0);
+static unsigned long long NUM_WARNED = 0; //mismatches already reported by warnCpuMismatch
+
+// Returns the highest level this CPU and OS support
+static int detectCpuLevel() {
+#if defined(CPU_TOOL_X86) && defined(_MSC_VER)
+    int Info[4];
+    __cpuid(Info, 0);
+    int MaxId = Info[0];
+    __cpuid(Info, 1);
+    if (!(Info[2] & (1 << 20))) { return CPU_SCALAR; }  //SSE4.2
+    if (!(Info[2] & (1 << 27)) || MaxId < 7) { return CPU_SSE42; } //OSXSAVE
+    unsigned long long XCR0 = _xgetbv(0);
+    if ((XCR0 & 0x6) != 0x6) { return CPU_SSE42; }     //OS saves the AVX registers
+    __cpuidex(Info, 7, 0);
+    if (!(Info[1] & (1 << 5))) { return CPU_SSE42; }   //AVX2
+    if (!(Info[1] & (1 << 16)) || !(Info[1] & (1 << 30)) || (XCR0 & 0xE6) != 0xE6) { return CPU_AVX2; } //AVX-512F/BW
+    return CPU_AVX512;
+#elif defined(CPU_TOOL_X86)
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("sse4.2")) { return CPU_SCALAR; }
+    if (!__builtin_cpu_supports("avx2")) { return CPU_SSE42; }
+    if (!__builtin_cpu_supports("avx512f") || !__builtin_cpu_supports("avx512bw")) { return CPU_AVX2; }
+    return CPU_AVX512;
+#else
+    return CPU_SCALAR;
+#endif
+}
+
+// Returns the detected level, lowered by BRILIA_CPU_LEVEL
+static int findCpuLevel() {
+    int Level = detectCpuLevel();
+    const char *pEnv = getenv("BRILIA_CPU_LEVEL");
+    if (pEnv == NULL) { return Level; }
+    for (int k = CPU_SCALAR; k <= CPU_AVX512; k++) {
+        const char *pName = getCpuLevelName(k);
+        size_t i = 0;
+        while (pEnv[i] != '\0' && pName[i] != '\0' && tolower(pEnv[i]) == pName[i]) { i++; }
+        if (pEnv[i] == '\0' && pName[i] == '\0') { return k < Level ? k : Level; }
+    }
+    return Level;
+}
+
+// Returns the BRILIA_CPU_VERIFY fraction, from 0 to 1
+static double findVerifyRate() {
+    const char *pEnv = getenv("BRILIA_CPU_VERIFY");
+    double Rate = pEnv != NULL ? atof(pEnv) : 0;
+    return Rate > 0 ? (Rate < 1 ? Rate : 1) : 0;
+}
+
+int getCpuLevel() {
+    static const int LEVEL = findCpuLevel();
+    return LEVEL;
+}
+
+const char *getCpuLevelName(int Level) {
+    switch (Level) {
+        case CPU_SSE42:  return "sse42";
+        case CPU_AVX2:   return "avx2";
+        case CPU_AVX512: return "avx512";
+        default:         return "scalar";
+    }
+}
+
+// Returns true for every 1/VerifyRate-th kernel call
+static inline bool isVerifyCall() {
+    static const double RATE = findVerifyRate();
+    static const unsigned long long EVERY = RATE > 0 ? (unsigned long long) round(1 / RATE) : 0;
+    if (EVERY == 0) { return false; }
+    return NUM_CALL.fetch_add(1, std::memory_order_relaxed) % EVERY == 0;
+}
+
+cpu_verify_stats getCpuVerifyStats() {
+    cpu_verify_stats Stats;
+    Stats.Level = getCpuLevel();
+    Stats.VerifyRate = findVerifyRate();
+    Stats.Checked = NUM_CHECKED.load();
+    Stats.Mismatches = NUM_MISMATCH.load();
+    return Stats;
+}
+
+// Gives a MATLAB warning if there are new mismatches. Call from the main thread only.
+void warnCpuMismatch(const char *pMexName) {
+    unsigned long long Mismatches = NUM_MISMATCH.load();
+    if (Mismatches == NUM_WARNED) { return; }
+    NUM_WARNED = Mismatches;
+    std::string Id = std::string(pMexName) + ":cpu";
+    mexWarnMsgIdAndTxt(Id.c_str(), "%llu of %llu checked kernel calls at the '%s' level did not match the scalar code. Set BRILIA_CPU_LEVEL to 'scalar' to avoid it.",
+        Mismatches, NUM_CHECKED.load(), getCpuLevelName(getCpuLevel()));
+}
+
+// Scalar reference of cmprSeqCpu
+static void cmprSeqScalar(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, mxChar Wild, bool HasWild, bool *pMatch) {
+    if (!HasWild) {
+        for (mwSize i = 0; i < Len; i++) {
+            pMatch[i] = pSeqA[i] == pSeqB[i];
+        }
+        return;
+    }
+    for (mwSize i = 0; i < Len; i++) {
+        mxChar A = pSeqA[i], B = pSeqB[i];
+        pMatch[i] = (A == B) | (A == Wild) | (B == Wild);
+    }
+}
+
+#ifdef CPU_TOOL_X86
+CPU_TARGET("sse4.2")
+static void cmprSeqSSE42(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, mxChar Wild, bool HasWild, bool *pMatch) {
+    const __m128i vWild = _mm_set1_epi16((short) Wild);
+    const __m128i vOne = _mm_set1_epi8(1);
+    mwSize i = 0;
+    for (; i + 16 <= Len; i += 16) {
+        __m128i A0 = _mm_loadu_si128((const __m128i*) &pSeqA[i]), A1 = _mm_loadu_si128((const __m128i*) &pSeqA[i+8]);
+        __m128i B0 = _mm_loadu_si128((const __m128i*) &pSeqB[i]), B1 = _mm_loadu_si128((const __m128i*) &pSeqB[i+8]);
+        __m128i M0 = _mm_cmpeq_epi16(A0, B0), M1 = _mm_cmpeq_epi16(A1, B1);
+        if (HasWild) {
+            M0 = _mm_or_si128(M0, _mm_or_si128(_mm_cmpeq_epi16(A0, vWild), _mm_cmpeq_epi16(B0, vWild)));
+            M1 = _mm_or_si128(M1, _mm_or_si128(_mm_cmpeq_epi16(A1, vWild), _mm_cmpeq_epi16(B1, vWild)));
+        }
+        _mm_storeu_si128((__m128i*) &pMatch[i], _mm_and_si128(_mm_packs_epi16(M0, M1), vOne));
+    }
+    cmprSeqScalar(&pSeqA[i], &pSeqB[i], Len - i, Wild, HasWild, &pMatch[i]);
+}
+
+CPU_TARGET("avx2")
+static void cmprSeqAVX2(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, mxChar Wild, bool HasWild, bool *pMatch) {
+    const __m256i vWild = _mm256_set1_epi16((short) Wild);
+    const __m256i vOne = _mm256_set1_epi8(1);
+    mwSize i = 0;
+    for (; i + 32 <= Len; i += 32) {
+        __m256i A0 = _mm256_loadu_si256((const __m256i*) &pSeqA[i]), A1 = _mm256_loadu_si256((const __m256i*) &pSeqA[i+16]);
+        __m256i B0 = _mm256_loadu_si256((const __m256i*) &pSeqB[i]), B1 = _mm256_loadu_si256((const __m256i*) &pSeqB[i+16]);
+        __m256i M0 = _mm256_cmpeq_epi16(A0, B0), M1 = _mm256_cmpeq_epi16(A1, B1);
+        if (HasWild) {
+            M0 = _mm256_or_si256(M0, _mm256_or_si256(_mm256_cmpeq_epi16(A0, vWild), _mm256_cmpeq_epi16(B0, vWild)));
+            M1 = _mm256_or_si256(M1, _mm256_or_si256(_mm256_cmpeq_epi16(A1, vWild), _mm256_cmpeq_epi16(B1, vWild)));
+        }
+        __m256i M = _mm256_permute4x64_epi64(_mm256_packs_epi16(M0, M1), 0xD8); //packs works per 128-bit lane
+        _mm256_storeu_si256((__m256i*) &pMatch[i], _mm256_and_si256(M, vOne));
+    }
+    cmprSeqScalar(&pSeqA[i], &pSeqB[i], Len - i, Wild, HasWild, &pMatch[i]);
+}
+
+CPU_TARGET("avx512f,avx512bw")
+static void cmprSeqAVX512(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, mxChar Wild, bool HasWild, bool *pMatch) {
+    const __m512i vWild = _mm512_set1_epi16((short) Wild);
+    const __m512i vOne = _mm512_set1_epi8(1);
+    mwSize i = 0;
+    for (; i + 64 <= Len; i += 64) {
+        __m512i A0 = _mm512_loadu_si512((const void*) &pSeqA[i]), A1 = _mm512_loadu_si512((const void*) &pSeqA[i+32]);
+        __m512i B0 = _mm512_loadu_si512((const void*) &pSeqB[i]), B1 = _mm512_loadu_si512((const void*) &pSeqB[i+32]);
+        __mmask32 M0 = _mm512_cmpeq_epi16_mask(A0, B0), M1 = _mm512_cmpeq_epi16_mask(A1, B1);
+        if (HasWild) {
+            M0 |= _mm512_cmpeq_epi16_mask(A0, vWild) | _mm512_cmpeq_epi16_mask(B0, vWild);
+            M1 |= _mm512_cmpeq_epi16_mask(A1, vWild) | _mm512_cmpeq_epi16_mask(B1, vWild);
+        }
+        __mmask64 M = (__mmask64) M0 | ((__mmask64) M1 << 32);
+        _mm512_storeu_si512((void*) &pMatch[i], _mm512_maskz_mov_epi8(M, vOne));
+    }
+    cmprSeqScalar(&pSeqA[i], &pSeqB[i], Len - i, Wild, HasWild, &pMatch[i]);
+}
+#endif
+
+// Compares SeqA and SeqB letter by letter into pMatch (as cmprSeq), using
+// the CPU level. If HasWild, a Wild letter in either seq is a match.
+void cmprSeqCpu(const mxChar *pSeqA, const mxChar *pSeqB, mwSize Len, mxChar Wild, bool HasWild, bool *pMatch) {
+    typedef void (*cmpr_seq_fn)(const mxChar*, const mxChar*, mwSize, mxChar, bool, bool*);
+#ifdef CPU_TOOL_X86
+    static const cmpr_seq_fn FUNC[4] = {cmprSeqScalar, cmprSeqSSE42, cmprSeqAVX2, cmprSeqAVX512};
+    static const cmpr_seq_fn CMPR_SEQ = FUNC[getCpuLevel()];
+#else
+    static const cmpr_seq_fn CMPR_SEQ = cmprSeqScalar;
+#endif
+    CMPR_SEQ(pSeqA, pSeqB, Len, Wild, HasWild, pMatch);
+    if (!isVerifyCall()) { return; }
+
+    std::vector<char> Ref(Len + 1);
+    cmprSeqScalar(pSeqA, pSeqB, Len, Wild, HasWild, (bool*) &Ref[0]);
+    NUM_CHECKED++;
+    if (Len > 0 && memcmp(&Ref[0], pMatch, Len*sizeof(bool)) != 0) { NUM_MISMATCH++; }
+}
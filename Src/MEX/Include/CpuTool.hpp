@@ -0,0 +1,23 @@
+#ifndef CPU_TOOL_HPP
+#define CPU_TOOL_HPP
+
+#include "mex.h"
+
+// cpu_level is the SIMD level used by the seq kernels
+enum cpu_level { CPU_SCALAR = 0, CPU_SSE42 = 1, CPU_AVX2 = 2, CPU_AVX512 = 3 };
+
+// cpu_verify_stats stores the results of the scalar cross-check
+struct cpu_verify_stats {
+    int Level = CPU_SCALAR;              //Level: cpu_level in use
+    double VerifyRate = 0;               //VerifyRate: fraction of kernel calls cross-checked
+    unsigned long long Checked = 0;      //Checked: number of kernel calls cross-checked
+    unsigned long long Mismatches = 0;   //Mismatches: number of checked calls that differ from the scalar code
+};
+
+int getCpuLevel();
+const char *getCpuLevelName(int);
+void cmprSeqCpu(const mxChar*, const mxChar*, mwSize, mxChar, bool, bool*);
+cpu_verify_stats getCpuVerifyStats();
+void warnCpuMismatch(const char*);
+
+#endif
@@ -0,0 +1,237 @@
+/*  DgeneTool contains the codes for finding the best D gene match of a
+ *  short N-D-N seq. It gives the same result as findGeneMatch(Seq, Dmap,
+ *  'D', MissRate), which uses alignSeqMEX with TrimSide = 'b', PenaltySide
+ *  = 'n', and PreferSide = 'n', but D genes are short enough to fit in 1
+ *  64-bit word per nt. So the match/miss of a whole D gene at an offset is
+ *  found with a few shift/AND/OR ops, and the 3-of-4 end trimming and the
+ *  alignment score are done on the bit mask instead of a bool[].
+ *
+ *  NOTE: The inverted D genes (the 'r' genes in DB.Dmap) are stored as
+ *  separate D genes, so scoring all D genes covers both D directions.
+ *
+ *  WARNING: Only ACGTN are compared. N matches anything, and any other
+ *  letter will only match an N.
+ */
+
+#include "DgeneTool.hpp"
+#include <math.h>
+#include <algorithm>
+
+typedef unsigned long long u64;
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline int findFirstBit(u64 Mask) {
+    unsigned long Idx;
+    _BitScanForward64(&Idx, Mask);
+    return (int) Idx;
+}
+static inline int findLastBit(u64 Mask) {
+    unsigned long Idx;
+    _BitScanReverse64(&Idx, Mask);
+    return (int) Idx;
+}
+static inline int countBits(u64 Mask) { return (int) __popcnt64(Mask); }
+#else
+static inline int findFirstBit(u64 Mask) { return __builtin_ctzll(Mask); }
+static inline int findLastBit(u64 Mask) { return 63 - __builtin_clzll(Mask); }
+static inline int countBits(u64 Mask) { return __builtin_popcountll(Mask); }
+#endif
+
+// Returns a mask of the lowest Len bits
+static inline u64 getLowMask(int Len) {
+    return Len >= 64 ? ~0ULL : (1ULL << Len) - 1;
+}
+
+// Returns the mask plane (0-4 for A, C, G, T, N) of a nt, or -1 for others
+static inline int getPlane(mxChar nt) {
+    switch (nt) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': case 'U': return 3;
+        case 'N': return 4;
+        default:  return -1;
+    }
+}
+
+// Returns 64 bits of a packed seq starting at Pos
+static inline u64 getSeqBits(const u64 *pWord, int Pos) {
+    int W = Pos / 64, B = Pos % 64;
+    return B == 0 ? pWord[W] : (pWord[W] >> B) | (pWord[W+1] << (64 - B));
+}
+
+// Same as trimMatchResults(pMatch, Len, 'b'), on a bit mask
+static u64 trimMatchBits(u64 Match, int Len) {
+    if (Len <= 4) { return Match; }
+    u64 Valid = getLowMask(Len - 3); //1 bit per 4-nt window start
+    u64 A = Match, B = Match >> 1, C = Match >> 2, D = Match >> 3;
+    u64 Win = ((A & B & (C | D)) | (C & D & (A | B))) & Valid; //windows with >= 3 of 4 matches
+    if (Win == 0) { return 0; }
+    Match &= ~getLowMask(findFirstBit(Win));
+
+    A = Match; B = Match >> 1; C = Match >> 2; D = Match >> 3;
+    Win = ((A & B & (C | D)) | (C & D & (A | B))) & Valid;
+    return Match & getLowMask(findLastBit(Win) + 4);
+}
+
+// Same as calcAlignScore(pMatch, Len, AllowedMiss, 'n'), on a bit mask
+static double calcAlignScoreBits(u64 Match, int Len, double AllowedMiss) {
+    if (Match == 0) { return - (double) Len * Len; }
+    int e = findLastBit(Match);
+    int i = findFirstBit(Match);
+    double Score = 0, Hits = 0;
+    while (true) {
+        u64 Miss = ~(Match >> i);
+        int H = Miss == 0 ? 64 : findFirstBit(Miss);
+        Hits += H;
+        i += H;
+        if (i > e) { break; }
+        int G = findFirstBit(Match >> i);
+        if (G == 1 && AllowedMiss > 0) {
+            AllowedMiss--;
+        } else {
+            Score += Hits*Hits - (double) G*G;
+            Hits = 0;
+        }
+        i += G;
+    }
+    return Score + Hits*Hits;
+}
+
+// Same as cmprSeq + trimMatchResults(pMatch, Len, 'b') of a D gene whose
+// 1st nt is over seq position Off. Bit 0 is the 1st nt of the overlap.
+static u64 matchDgeneBits(const u64 *pSeqMask, int NumWord, const u64 *pDmask, int Off, int Len) {
+    int D0 = Off < 0 ? -Off : 0;
+    int S0 = Off + D0;
+    u64 Bits = getSeqBits(&pSeqMask[4*NumWord], S0) | (pDmask[4] >> D0);
+    for (int k = 0; k < 4; k++) {
+        Bits |= getSeqBits(&pSeqMask[k*NumWord], S0) & (pDmask[k] >> D0);
+    }
+    return trimMatchBits(Bits & getLowMask(Len), Len);
+}
+
+// Packs the D genes into bit masks. D genes must be <= 64 nt.
+void buildDgeneSet(dgene_set &DS, const std::vector<std::string> &Dseq) {
+    DS.Len.assign(Dseq.size(), 0);
+    DS.Mask.assign(5 * Dseq.size(), 0);
+    for (size_t d = 0; d < Dseq.size(); d++) {
+        if (Dseq[d].size() > 64) {
+            mexErrMsgIdAndTxt("DgeneTool_buildDgeneSet:input", "D gene #%d is longer than 64 nt.", (int) d + 1);
+        }
+        DS.Len[d] = (int) Dseq[d].size();
+        for (int j = 0; j < DS.Len[d]; j++) {
+            int Plane = getPlane(Dseq[d][j]);
+            if (Plane >= 0) { DS.Mask[5*d + Plane] |= 1ULL << j; }
+        }
+    }
+}
+
+// Finds the best D gene match of Seq. Returns false if there is no valid match.
+bool findDmatch(const dgene_set &DS, const mxChar *pSeq, mwSize LenSeq, double MissRate, d_match &DM) {
+    DM = d_match();
+    if (LenSeq < 1) { return false; }
+    MissRate = MissRate != MissRate ? 1 : std::max(std::min(MissRate, 1.0), 0.0); //NaN is 1, as MATLAB min(NaN, 1)
+
+    //Pack the seq, with 1 zero word of padding for getSeqBits
+    int NumWord = (int) (LenSeq / 64) + 2;
+    std::vector<u64> SeqMask(5 * NumWord, 0);
+    for (mwSize j = 0; j < LenSeq; j++) {
+        int Plane = getPlane(pSeq[j]);
+        if (Plane >= 0) { SeqMask[Plane*NumWord + j/64] |= 1ULL << (j % 64); }
+    }
+
+    int NumD = (int) DS.Len.size();
+    int LenS = (int) LenSeq;
+    std::vector<double> Score(NumD, 0), Match(NumD, 0);
+    std::vector<int> LMR(6 * NumD, 0); //[Ls Ms Rs Lg Mg Rg] per D gene
+    std::vector<double> OffScore;
+    double MaxScore = -INFINITY;
+    for (int g = 0; g < NumD; g++) {
+        int LenD = DS.Len[g];
+        if (LenD < 1) {
+            Score[g] = -INFINITY;
+            continue;
+        }
+        const u64 *pDmask = &DS.Mask[5*g];
+
+        //Score all offsets. D gene 1st nt is over seq position Off.
+        int MinOff = -(LenD - 1), MaxOff = LenS - 1;
+        OffScore.resize(MaxOff - MinOff + 1);
+        double BestScore = -1; //Same start as alignSeq
+        for (int Off = MinOff; Off <= MaxOff; Off++) {
+            int Len = std::min(LenD, LenS - Off) - std::max(0, -Off); //overlap length
+            u64 Bits = matchDgeneBits(&SeqMask[0], NumWord, pDmask, Off, Len);
+            OffScore[Off - MinOff] = calcAlignScoreBits(Bits, Len, round(MissRate * Len));
+            if (OffScore[Off - MinOff] > BestScore) { BestScore = OffScore[Off - MinOff]; }
+        }
+
+        //Take the middle best offset, in the same order alignSeq scans them
+        std::vector<int> Ties;
+        for (int Off = MinOff; Off <= MaxOff; Off++) {
+            if (OffScore[Off - MinOff] == BestScore) { Ties.push_back(Off); }
+        }
+        int q = (int) Ties.size();
+        int Off = LenD > LenS ? Ties[q - 1 - q/2] : Ties[q/2];
+
+        //Redo the match at the best offset to get the match positions
+        int Len = std::min(LenD, LenS - Off) - std::max(0, -Off);
+        u64 Bits = matchDgeneBits(&SeqMask[0], NumWord, pDmask, Off, Len);
+
+        //MatchS and MatchE are 0-based alignment columns, as in align_info
+        int Shift = Off < 0 ? -Off : Off;
+        int MatchS = Shift - 1, MatchE = -1;
+        if (Bits != 0) {
+            MatchS = findFirstBit(Bits) + Shift;
+            MatchE = findLastBit(Bits) + Shift;
+            Match[g] = countBits(Bits);
+        } else {
+            BestScore = - (double) Len * Len;
+        }
+        Score[g] = BestScore;
+
+        int S0 = Off < 0 ? -Off : 0; //column of seq 1st nt
+        int G0 = Off > 0 ? Off : 0;  //column of D gene 1st nt
+        int *pLMR = &LMR[6*g];
+        pLMR[0] = MatchS - S0;
+        pLMR[1] = MatchE - MatchS + 1;
+        pLMR[2] = LenS - 1 - (MatchE - S0);
+        pLMR[3] = MatchS - G0;
+        pLMR[4] = pLMR[1];
+        pLMR[5] = LenD - 1 - (MatchE - G0);
+        if (Score[g] > MaxScore) { MaxScore = Score[g]; }
+    }
+    if (MaxScore == -INFINITY) { return false; }
+
+    //Of the best scoring D genes, pick the min of max(5'del, 3'del), then
+    //the lowest [SamLMR RefLMR], as condenseGeneMatch sorts them.
+    int Best = -1;
+    for (int g = 0; g < NumD; g++) {
+        if (Score[g] != MaxScore) { continue; }
+        if (Best < 0) {
+            Best = g;
+            continue;
+        }
+        int *pG = &LMR[6*g], *pB = &LMR[6*Best];
+        int MaxDelG = std::max(pG[3], pG[5]), MaxDelB = std::max(pB[3], pB[5]);
+        if (MaxDelG < MaxDelB || (MaxDelG == MaxDelB && std::lexicographical_compare(pG, pG + 6, pB, pB + 6))) {
+            Best = g;
+        }
+    }
+    for (int g = Best; g < NumD; g++) {
+        if (Score[g] == MaxScore && std::equal(&LMR[6*g], &LMR[6*g] + 6, &LMR[6*Best])) {
+            DM.Num.push_back(g);
+        }
+    }
+
+    int *pB = &LMR[6*Best];
+    if (std::min(pB[0], std::min(pB[1], pB[2])) < 0) { //No match, as findGeneMatch
+        DM.Num.clear();
+        return false;
+    }
+    std::copy(pB, pB + 3, DM.SamLMR);
+    std::copy(pB + 3, pB + 6, DM.RefLMR);
+    DM.Match = Match[Best];
+    DM.Score = MaxScore;
+    return true;
+}
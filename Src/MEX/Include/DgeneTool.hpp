@@ -0,0 +1,26 @@
+#ifndef DGENE_TOOL_HPP
+#define DGENE_TOOL_HPP
+
+#include "mex.h"
+#include <string>
+#include <vector>
+
+// dgene_set stores all D genes as 64-bit masks, 1 bit per nt
+struct dgene_set {
+    std::vector<int> Len;                  //Len: D gene length. 0 for deleted (empty) genes.
+    std::vector<unsigned long long> Mask;  //Mask: 5 masks per D gene for A, C, G, T, N
+};
+
+// d_match stores the best D gene match of a seq, as findGeneMatch would
+struct d_match {
+    std::vector<int> Num;    //Num: 0-based indices of the equivalent best D genes. Empty if no match.
+    int RefLMR[3] = {0};     //RefLMR: [5'del, Dlen, 3'del] of the D gene
+    int SamLMR[3] = {0};     //SamLMR: [Nvd, Dlen, Ndj] of the seq
+    double Match = 0;        //Match: # of nts matched
+    double Score = 0;        //Score: alignment score
+};
+
+void buildDgeneSet(dgene_set&, const std::vector<std::string>&);
+bool findDmatch(const dgene_set&, const mxChar*, mwSize, double, d_match&);
+
+#endif
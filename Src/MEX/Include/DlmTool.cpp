@@ -0,0 +1,299 @@
+/*  DlmTool contains the codes for reading and writing the delimited
+ *  BRILIA files. Files are memory-mapped so that fields are parsed right
+ *  out of the OS file cache, and the delimiter/end-of-line search is done
+ *  16 bytes at a time with SSE2 when available.
+ *
+ *  NOTE: Delimiters are single char: ',' ';' or '\t'. The MATLAB-style
+ *  '\t' (2-char string) is accepted as tab by getDelimiter.
+ */
+
+#include "DlmTool.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define DLM_TOOL_SSE2
+#ifdef _MSC_VER
+#include <intrin.h>
+static inline int findFirstBit(unsigned int Mask) {
+    unsigned long Idx;
+    _BitScanForward(&Idx, Mask);
+    return (int) Idx;
+}
+#else
+static inline int findFirstBit(unsigned int Mask) { return __builtin_ctz(Mask); }
+#endif
+#endif
+
+// Map the whole file into memory. Returns false if the file cannot be opened.
+bool openMappedFile(const char *pFileName, mapped_file &MF) {
+#ifdef _WIN32
+    HANDLE hFile = CreateFileA(pFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) { return false; }
+    LARGE_INTEGER Size;
+    if (!GetFileSizeEx(hFile, &Size)) {
+        CloseHandle(hFile);
+        return false;
+    }
+    MF.hFile = hFile;
+    MF.Size = (size_t) Size.QuadPart;
+    if (MF.Size == 0) { return true; } //Cannot map an empty file, but it is a valid file
+    MF.hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (MF.hMap == NULL) {
+        closeMappedFile(MF);
+        return false;
+    }
+    MF.pData = (const char*) MapViewOfFile(MF.hMap, FILE_MAP_READ, 0, 0, 0);
+    if (MF.pData == NULL) {
+        closeMappedFile(MF);
+        return false;
+    }
+#else
+    MF.FD = open(pFileName, O_RDONLY);
+    if (MF.FD < 0) { return false; }
+    struct stat Info;
+    if (fstat(MF.FD, &Info) != 0) {
+        closeMappedFile(MF);
+        return false;
+    }
+    MF.Size = (size_t) Info.st_size;
+    if (MF.Size == 0) { return true; }
+    void *pMap = mmap(NULL, MF.Size, PROT_READ, MAP_PRIVATE, MF.FD, 0);
+    if (pMap == MAP_FAILED) {
+        closeMappedFile(MF);
+        return false;
+    }
+    madvise(pMap, MF.Size, MADV_SEQUENTIAL);
+    MF.pData = (const char*) pMap;
+#endif
+    return true;
+}
+
+void closeMappedFile(mapped_file &MF) {
+#ifdef _WIN32
+    if (MF.pData != NULL) { UnmapViewOfFile(MF.pData); }
+    if (MF.hMap  != NULL) { CloseHandle(MF.hMap); }
+    if (MF.hFile != NULL) { CloseHandle(MF.hFile); }
+    MF.hMap = NULL;
+    MF.hFile = NULL;
+#else
+    if (MF.pData != NULL) { munmap((void*) MF.pData, MF.Size); }
+    if (MF.FD >= 0) { close(MF.FD); }
+    MF.FD = -1;
+#endif
+    MF.pData = NULL;
+    MF.Size = 0;
+}
+
+// Return pointer to the next Delim or '\n' char, or pEnd if none are found.
+const char *findDelimOrEOL(const char *p, const char *pEnd, char Delim) {
+#ifdef DLM_TOOL_SSE2
+    const __m128i vDelim = _mm_set1_epi8(Delim);
+    const __m128i vEOL   = _mm_set1_epi8('\n');
+    for (; p + 16 <= pEnd; p += 16) {
+        __m128i vChunk = _mm_loadu_si128((const __m128i*) p);
+        __m128i vHit = _mm_or_si128(_mm_cmpeq_epi8(vChunk, vDelim), _mm_cmpeq_epi8(vChunk, vEOL));
+        unsigned int Mask = (unsigned int) _mm_movemask_epi8(vHit);
+        if (Mask) { return p + findFirstBit(Mask); }
+    }
+#endif
+    for (; p < pEnd; p++) {
+        if (*p == Delim || *p == '\n') { return p; }
+    }
+    return pEnd;
+}
+
+// Return pointer to the next '\n' char, or pEnd if none are found.
+const char *findEOL(const char *p, const char *pEnd) {
+    const char *pEOL = (const char*) memchr(p, '\n', pEnd - p);
+    return pEOL == NULL ? pEnd : pEOL;
+}
+
+// Count the number of text lines. A last line without '\n' is counted too.
+size_t countLines(const char *p, const char *pEnd) {
+    size_t Count = 0;
+#ifdef DLM_TOOL_SSE2
+    const __m128i vEOL = _mm_set1_epi8('\n');
+    for (; p + 16 <= pEnd; p += 16) {
+        __m128i vChunk = _mm_loadu_si128((const __m128i*) p);
+        unsigned int Mask = (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(vChunk, vEOL));
+        while (Mask) {
+            Count++;
+            Mask &= Mask - 1;
+        }
+    }
+#endif
+    for (; p < pEnd; p++) {
+        if (*p == '\n') { Count++; }
+    }
+    return Count;
+}
+
+// Determine the delimiter as the most frequent of ',' ';' '\t' that occurs
+// equally in the first two lines (see readDlmFile.m for the same rule).
+char detectDelimiter(const char *p, const char *pEnd) {
+    const char pChoice[3] = {',', ';', '\t'};
+    int pCt1[3] = {0}, pCt2[3] = {0};
+    const char *pEOL1 = findEOL(p, pEnd);
+    const char *pEOL2 = pEOL1 < pEnd ? findEOL(pEOL1 + 1, pEnd) : pEnd;
+    for (int k = 0; k < 3; k++) {
+        for (const char *q = p; q < pEOL1; q++) {
+            if (*q == pChoice[k]) { pCt1[k]++; }
+        }
+        if (pEOL1 + 1 < pEOL2) {
+            for (const char *q = pEOL1 + 1; q < pEOL2; q++) {
+                if (*q == pChoice[k]) { pCt2[k]++; }
+            }
+        } else {
+            pCt2[k] = pCt1[k];
+        }
+    }
+    int Best = 0, BestCt = -1;
+    for (int k = 0; k < 3; k++) {
+        if (pCt1[k] == pCt2[k] && pCt1[k] >= BestCt) {
+            BestCt = pCt1[k];
+            Best = k;
+        }
+    }
+    return pChoice[Best];
+}
+
+// Get the single-char delimiter from a MATLAB char input. Returns 0 if empty (autodetect).
+char getDelimiter(const mxArray *pDelim) {
+    if (pDelim == NULL || mxIsEmpty(pDelim)) { return 0; }
+    if (!mxIsChar(pDelim)) {
+        mexErrMsgIdAndTxt("DlmTool_getDelimiter:input", "Delimiter must be a char ',' ';' or '\\t'.");
+    }
+    mxChar *pStr = mxGetChars(pDelim);
+    mwSize Len = mxGetNumberOfElements(pDelim);
+    if (Len == 2 && pStr[0] == '\\' && pStr[1] == 't') { return '\t'; }
+    if (Len == 1 && (pStr[0] == ',' || pStr[0] == ';' || pStr[0] == '\t')) { return (char) pStr[0]; }
+    mexErrMsgIdAndTxt("DlmTool_getDelimiter:input", "Delimiter must be a char ',' ';' or '\\t'.");
+    return 0;
+}
+
+// Convert a text field to a double. Empty or non-numeric fields are NaN (same as textscan %f).
+double convField2Double(const char *pField, size_t Len) {
+    while (Len > 0 && (*pField == ' ' || *pField == '"')) { pField++; Len--; }
+    while (Len > 0 && (pField[Len-1] == ' ' || pField[Len-1] == '"')) { Len--; }
+    if (Len == 0) { return NAN; }
+
+    //Fast path for plain integers, which are most numeric BRILIA fields
+    size_t j = (pField[0] == '-' || pField[0] == '+') ? 1 : 0;
+    if (j < Len && Len - j <= 15) {
+        double Num = 0;
+        size_t k = j;
+        for (; k < Len && pField[k] >= '0' && pField[k] <= '9'; k++) {
+            Num = Num * 10 + (pField[k] - '0');
+        }
+        if (k == Len) { return pField[0] == '-' ? -Num : Num; }
+    }
+
+    char pBuf[64];
+    if (Len >= sizeof(pBuf)) { return NAN; }
+    memcpy(pBuf, pField, Len);
+    pBuf[Len] = '\0';
+    char *pStop;
+    double Num = strtod(pBuf, &pStop);
+    return (pStop == pBuf + Len) ? Num : NAN;
+}
+
+// Create a 1xN char array from a text field. Empty fields are 0x0 char (same as textscan %s).
+mxArray *convField2Char(const char *pField, size_t Len) {
+    mwSize Dims[2] = {(mwSize) (Len > 0 ? 1 : 0), Len};
+    mxArray *pStr = mxCreateCharArray(2, Dims);
+    mxChar *pChar = mxGetChars(pStr);
+    for (size_t j = 0; j < Len; j++) {
+        pChar[j] = (unsigned char) pField[j];
+    }
+    return pStr;
+}
+
+// Append a number formatted like mat2str (15 significant digits).
+static void appendNumber(std::string &Buf, double Num) {
+    if (Num != Num) {
+        Buf += "NaN";
+    } else if (isinf(Num)) {
+        Buf += Num > 0 ? "Inf" : "-Inf";
+    } else {
+        char pNum[32];
+        int Len = snprintf(pNum, sizeof(pNum), "%.15g", Num == 0 ? 0.0 : Num); //avoids "-0"
+        Buf.append(pNum, Len);
+    }
+}
+
+// Returns the Idx-th element of a numeric array of any class as a double
+static double getNumber(const mxArray *pArray, mwSize Idx) {
+    const void *pData = mxGetData(pArray);
+    switch (mxGetClassID(pArray)) {
+        case mxDOUBLE_CLASS: return ((const double *) pData)[Idx];
+        case mxSINGLE_CLASS: return ((const float *) pData)[Idx];
+        case mxINT8_CLASS:   return ((const int8_T *) pData)[Idx];
+        case mxUINT8_CLASS:  return ((const uint8_T *) pData)[Idx];
+        case mxINT16_CLASS:  return ((const int16_T *) pData)[Idx];
+        case mxUINT16_CLASS: return ((const uint16_T *) pData)[Idx];
+        case mxINT32_CLASS:  return ((const int32_T *) pData)[Idx];
+        case mxUINT32_CLASS: return ((const uint32_T *) pData)[Idx];
+        case mxINT64_CLASS:  return (double) ((const int64_T *) pData)[Idx];
+        case mxUINT64_CLASS: return (double) ((const uint64_T *) pData)[Idx];
+        default:             return NAN;
+    }
+}
+
+// Append the text of a cell value to Buf, like writeDlmFile.m does via mat2str.
+// Any delimiter char inside a string is replaced with '|'.
+void appendCellValue(std::string &Buf, const mxArray *pCell, char Delim) {
+    if (pCell == NULL || mxIsEmpty(pCell)) { return; }
+    if (mxIsChar(pCell)) {
+        mxChar *pStr = mxGetChars(pCell);
+        mwSize Len = mxGetNumberOfElements(pCell);
+        for (mwSize j = 0; j < Len; j++) {
+            char Letter = pStr[j] < 256 ? (char) pStr[j] : '?';
+            Buf += (Letter == Delim || Letter == '\n' || Letter == '\r') ? '|' : Letter;
+        }
+        return;
+    }
+    if (mxIsCell(pCell) || mxIsStruct(pCell)) {
+        mexErrMsgIdAndTxt("DlmTool_appendCellValue:input", "CellData must not have a cell or struct in a cell.");
+    }
+
+    mwSize M = mxGetM(pCell);
+    mwSize N = mxGetN(pCell);
+    bool IsLogical = mxIsLogical(pCell);
+    if (M*N > 1) { Buf += '['; }
+    for (mwSize r = 0; r < M; r++) {
+        if (r > 0) { Buf += ';'; }
+        for (mwSize c = 0; c < N; c++) {
+            if (c > 0) { Buf += ' '; }
+            mwSize Idx = r + c*M;
+            if (IsLogical) {
+                Buf += mxGetLogicals(pCell)[Idx] ? "true" : "false";
+            } else {
+                appendNumber(Buf, getNumber(pCell, Idx));
+            }
+        }
+    }
+    if (M*N > 1) { Buf += ']'; }
+}
+
+// Write the whole buffer at once. Returns false if the file cannot be written.
+bool writeBuffer(const char *pFileName, const std::string &Buf, bool Append) {
+    FILE *pFile = fopen(pFileName, Append ? "ab" : "wb");
+    if (pFile == NULL) { return false; }
+    size_t Count = Buf.empty() ? 0 : fwrite(Buf.data(), 1, Buf.size(), pFile);
+    bool Success = (Count == Buf.size());
+    Success = (fclose(pFile) == 0) && Success;
+    return Success;
+}
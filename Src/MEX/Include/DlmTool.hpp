@@ -0,0 +1,31 @@
+#ifndef DLM_TOOL_HPP
+#define DLM_TOOL_HPP
+
+#include "mex.h"
+#include <string>
+
+// mapped_file stores a read-only, memory-mapped view of a whole file
+struct mapped_file {
+    const char *pData = NULL; //pData: start of the file contents (NOT null-terminated)
+    size_t Size = 0;          //Size: number of bytes in the file
+#ifdef _WIN32
+    void *hFile = NULL;
+    void *hMap = NULL;
+#else
+    int FD = -1;
+#endif
+};
+
+bool openMappedFile(const char*, mapped_file&);
+void closeMappedFile(mapped_file&);
+const char *findDelimOrEOL(const char*, const char*, char);
+const char *findEOL(const char*, const char*);
+size_t countLines(const char*, const char*);
+char detectDelimiter(const char*, const char*);
+char getDelimiter(const mxArray*);
+double convField2Double(const char*, size_t);
+mxArray *convField2Char(const char*, size_t);
+void appendCellValue(std::string&, const mxArray*, char);
+bool writeBuffer(const char*, const std::string&, bool);
+
+#endif
@@ -0,0 +1,361 @@
+/*  GzipTool contains a small, self-contained gzip/deflate decoder (RFC
+ *  1951/1952) so BRILIA can read .gz sequence files without zlib or an
+ *  external decompression step. The decoder only pauses on the output side:
+ *  the whole compressed input must be in memory (use a mapped_file), while
+ *  the output is produced in chunks that reuse the same buffer.
+ *
+ *  Multi-member gzip files (ex: concatenated or BGZF files) are supported.
+ *  Each member's CRC32 and size are checked.
+ *
+ *  NOTE: The decoder makes no mx/mex calls, so it can run in a background
+ *    thread. Invalid data throws a gzip_error, which the caller must catch.
+ */
+
+#include "GzipTool.hpp"
+#include <string.h>
+
+#define GZIP_WINDOW 32768       //max deflate back-reference distance
+#define GZIP_CHUNK  262144      //new output produced per inflateGzipStream call
+#define GZIP_MAXLEN 258         //max bytes produced by one deflate symbol
+#define GZIP_FASTBITS 10
+
+enum gzip_state { GZ_HEADER, GZ_BLOCK, GZ_STORED, GZ_HUFFMAN, GZ_TRAILER, GZ_DONE };
+
+static const short pLEN_BASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const short pLEN_EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const short pDIST_BASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const short pDIST_EXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const short pCLEN_ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+static void errorGzip(const char *pMsg) {
+    throw gzip_error{pMsg};
+}
+
+struct crc_table {
+    uint32_t Table[256];
+};
+
+static void updateCRC(uint32_t &CRC, const unsigned char *p, size_t Len) {
+    static const crc_table CRC_TABLE = []() { //built once, also safe from other threads
+        crc_table T;
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            T.Table[n] = c;
+        }
+        return T;
+    }();
+    const uint32_t *pTable = CRC_TABLE.Table;
+    uint32_t c = CRC ^ 0xFFFFFFFFU;
+    for (size_t j = 0; j < Len; j++) {
+        c = pTable[(c ^ p[j]) & 0xFF] ^ (c >> 8);
+    }
+    CRC = c ^ 0xFFFFFFFFU;
+}
+
+//--------------------------------------------------------------------------
+// Bit reader (deflate bits are LSB first)
+
+static inline void fillBits(gzip_stream &GS) {
+    while (GS.BitCnt <= 56 && GS.InPos < GS.InSize) {
+        GS.BitBuf |= (uint64_t) GS.pIn[GS.InPos++] << GS.BitCnt;
+        GS.BitCnt += 8;
+    }
+}
+
+static inline unsigned int getBits(gzip_stream &GS, int Num) {
+    if (GS.BitCnt < Num) {
+        fillBits(GS);
+        if (GS.BitCnt < Num) { errorGzip("unexpected end of data"); }
+    }
+    unsigned int Val = (unsigned int) (GS.BitBuf & ((1ULL << Num) - 1));
+    GS.BitBuf >>= Num;
+    GS.BitCnt -= Num;
+    return Val;
+}
+
+// Drop the partial byte and give any whole bytes in BitBuf back to the input.
+static void alignToByte(gzip_stream &GS) {
+    GS.BitBuf >>= GS.BitCnt % 8;
+    GS.BitCnt -= GS.BitCnt % 8;
+    GS.InPos -= GS.BitCnt / 8;
+    GS.BitBuf = 0;
+    GS.BitCnt = 0;
+}
+
+static unsigned int getByte(gzip_stream &GS) {
+    if (GS.InPos >= GS.InSize) { errorGzip("unexpected end of data"); }
+    return GS.pIn[GS.InPos++];
+}
+
+//--------------------------------------------------------------------------
+// Huffman codes
+
+static void buildHuffman(huffman_table &H, const short *pLen, int Num) {
+    memset(H.Count, 0, sizeof(H.Count));
+    memset(H.Fast, 0, sizeof(H.Fast));
+    for (int s = 0; s < Num; s++) { H.Count[pLen[s]]++; }
+    if (H.Count[0] == Num) { return; } //no codes. Only an error if used.
+
+    int Left = 1;
+    for (int b = 1; b < 16; b++) {
+        Left = (Left << 1) - H.Count[b];
+        if (Left < 0) { errorGzip("over-subscribed Huffman code"); }
+    }
+
+    short pOffs[16], pNext[16];
+    pOffs[1] = 0;
+    for (int b = 1; b < 15; b++) { pOffs[b+1] = pOffs[b] + H.Count[b]; }
+    int Code = 0;
+    H.Count[0] = 0;
+    for (int b = 1; b < 16; b++) {
+        Code = (Code + H.Count[b-1]) << 1;
+        pNext[b] = (short) Code;
+    }
+    for (int s = 0; s < Num; s++) {
+        int b = pLen[s];
+        if (b == 0) { continue; }
+        H.Symbol[pOffs[b]++] = (short) s;
+        int c = pNext[b]++;
+        if (b > GZIP_FASTBITS) { continue; }
+        int Rev = 0; //codes are stored MSB first in the bit stream
+        for (int k = 0; k < b; k++) { Rev |= ((c >> k) & 1) << (b - 1 - k); }
+        for (int f = Rev; f < (1 << GZIP_FASTBITS); f += 1 << b) {
+            H.Fast[f] = (uint16_t) ((s << 4) | b);
+        }
+    }
+}
+
+static inline int decodeSymbol(gzip_stream &GS, const huffman_table &H) {
+    if (GS.BitCnt < 15) { fillBits(GS); }
+    unsigned int Entry = H.Fast[GS.BitBuf & ((1 << GZIP_FASTBITS) - 1)];
+    if (Entry != 0 && (int) (Entry & 15) <= GS.BitCnt) {
+        GS.BitBuf >>= Entry & 15;
+        GS.BitCnt -= Entry & 15;
+        return (int) (Entry >> 4);
+    }
+    int Code = 0, First = 0, Index = 0; //slow path for long codes
+    for (int b = 1; b < 16; b++) {
+        Code |= getBits(GS, 1);
+        int Count = H.Count[b];
+        if (Code - Count < First) { return H.Symbol[Index + (Code - First)]; }
+        Index += Count;
+        First += Count;
+        First <<= 1;
+        Code <<= 1;
+    }
+    errorGzip("invalid Huffman code");
+    return -1;
+}
+
+static void getFixedTables(const huffman_table *&pLenCode, const huffman_table *&pDistCode) {
+    static const huffman_table FixedLen = []() { //built once, also safe from other threads
+        huffman_table T;
+        short pLen[288];
+        for (int s = 0; s < 288; s++) { pLen[s] = s < 144 ? 8 : (s < 256 ? 9 : (s < 280 ? 7 : 8)); }
+        buildHuffman(T, pLen, 288);
+        return T;
+    }();
+    static const huffman_table FixedDist = []() {
+        huffman_table T;
+        short pLen[30];
+        for (int s = 0; s < 30; s++) { pLen[s] = 5; }
+        buildHuffman(T, pLen, 30);
+        return T;
+    }();
+    pLenCode = &FixedLen;
+    pDistCode = &FixedDist;
+}
+
+static void readDynamicTables(gzip_stream &GS) {
+    int NumLen  = getBits(GS, 5) + 257;
+    int NumDist = getBits(GS, 5) + 1;
+    int NumCode = getBits(GS, 4) + 4;
+    if (NumLen > 286 || NumDist > 30) { errorGzip("bad dynamic block counts"); }
+
+    short pLen[320] = {0};
+    for (int k = 0; k < NumCode; k++) { pLen[pCLEN_ORDER[k]] = (short) getBits(GS, 3); }
+    huffman_table CodeLen;
+    buildHuffman(CodeLen, pLen, 19);
+
+    int k = 0;
+    memset(pLen, 0, sizeof(pLen));
+    while (k < NumLen + NumDist) {
+        int Sym = decodeSymbol(GS, CodeLen);
+        if (Sym < 16) {
+            pLen[k++] = (short) Sym;
+            continue;
+        }
+        short Val = 0;
+        int Rep = 0;
+        if (Sym == 16) {
+            if (k == 0) { errorGzip("repeat with no first length"); }
+            Val = pLen[k-1];
+            Rep = 3 + getBits(GS, 2);
+        } else if (Sym == 17) {
+            Rep = 3 + getBits(GS, 3);
+        } else {
+            Rep = 11 + getBits(GS, 7);
+        }
+        if (k + Rep > NumLen + NumDist) { errorGzip("too many lengths"); }
+        while (Rep--) { pLen[k++] = Val; }
+    }
+    if (pLen[256] == 0) { errorGzip("no end-of-block code"); }
+    buildHuffman(GS.LenCode, pLen, NumLen);
+    buildHuffman(GS.DistCode, pLen + NumLen, NumDist);
+    GS.pLenCode = &GS.LenCode;
+    GS.pDistCode = &GS.DistCode;
+}
+
+//--------------------------------------------------------------------------
+// gzip member header/trailer
+
+static void readMemberHeader(gzip_stream &GS) {
+    if (getByte(GS) != 0x1F || getByte(GS) != 0x8B) { errorGzip("not a gzip file"); }
+    if (getByte(GS) != 8) { errorGzip("unknown compression method"); }
+    unsigned int Flag = getByte(GS);
+    for (int k = 0; k < 6; k++) { getByte(GS); } //MTIME, XFL, OS
+    if (Flag & 4) { //FEXTRA
+        unsigned int Len = getByte(GS);
+        Len |= getByte(GS) << 8;
+        for (unsigned int k = 0; k < Len; k++) { getByte(GS); }
+    }
+    if (Flag & 8)  { while (getByte(GS) != 0); } //FNAME
+    if (Flag & 16) { while (getByte(GS) != 0); } //FCOMMENT
+    if (Flag & 2)  { getByte(GS); getByte(GS); } //FHCRC
+    GS.CRC = 0;
+    GS.MemberSize = 0;
+    GS.LastBlock = false;
+}
+
+static void readMemberTrailer(gzip_stream &GS) {
+    alignToByte(GS);
+    uint32_t CRC = 0, Size = 0;
+    for (int k = 0; k < 4; k++) { CRC  |= getByte(GS) << (8*k); }
+    for (int k = 0; k < 4; k++) { Size |= getByte(GS) << (8*k); }
+    if (CRC != GS.CRC || Size != GS.MemberSize) { errorGzip("CRC or size check failed"); }
+}
+
+//--------------------------------------------------------------------------
+
+// Check for the gzip magic bytes
+bool isGzipData(const unsigned char *pData, size_t Size) {
+    return Size >= 2 && pData[0] == 0x1F && pData[1] == 0x8B;
+}
+
+void initGzipStream(gzip_stream &GS, const unsigned char *pIn, size_t InSize) {
+    GS.pIn = pIn;
+    GS.InSize = InSize;
+    GS.InPos = 0;
+    GS.BitBuf = 0;
+    GS.BitCnt = 0;
+    GS.State = GZ_HEADER;
+    GS.LastBlock = false;
+    GS.StoredLeft = 0;
+    GS.CrcPos = 0;
+    GS.Out.assign(GZIP_WINDOW + GZIP_CHUNK, 0);
+    GS.OutPos = 0;
+}
+
+// Inflate the next chunk. Returns the # of new bytes, which pChunk points to,
+// and 0 when the whole stream is done. pChunk is valid until the next call.
+size_t inflateGzipStream(gzip_stream &GS, const unsigned char *&pChunk) {
+    unsigned char *pOut = GS.Out.data();
+    updateCRC(GS.CRC, pOut + GS.CrcPos, GS.OutPos - GS.CrcPos);
+    if (GS.OutPos > GZIP_WINDOW) { //Keep only the history needed for back-references
+        memmove(pOut, pOut + GS.OutPos - GZIP_WINDOW, GZIP_WINDOW);
+        GS.OutPos = GZIP_WINDOW;
+    }
+    GS.CrcPos = GS.OutPos;
+    size_t Start = GS.OutPos;
+    size_t OutMax = GS.Out.size();
+
+    while (GS.State != GZ_DONE && GS.OutPos + GZIP_MAXLEN <= OutMax) {
+        switch (GS.State) {
+            case GZ_HEADER:
+                readMemberHeader(GS);
+                GS.State = GZ_BLOCK;
+                break;
+
+            case GZ_BLOCK: {
+                if (GS.LastBlock) {
+                    GS.State = GZ_TRAILER;
+                    break;
+                }
+                GS.LastBlock = getBits(GS, 1) == 1;
+                unsigned int Type = getBits(GS, 2);
+                if (Type == 0) {
+                    alignToByte(GS);
+                    unsigned int Len = getByte(GS);
+                    Len |= getByte(GS) << 8;
+                    unsigned int NLen = getByte(GS);
+                    NLen |= getByte(GS) << 8;
+                    if (Len != (~NLen & 0xFFFF)) { errorGzip("stored block length mismatch"); }
+                    GS.StoredLeft = Len;
+                    GS.State = GZ_STORED;
+                } else if (Type == 1) {
+                    getFixedTables(GS.pLenCode, GS.pDistCode);
+                    GS.State = GZ_HUFFMAN;
+                } else if (Type == 2) {
+                    readDynamicTables(GS);
+                    GS.State = GZ_HUFFMAN;
+                } else {
+                    errorGzip("invalid block type");
+                }
+                break;
+            }
+
+            case GZ_STORED: {
+                size_t Len = OutMax - GS.OutPos;
+                if (Len > GS.StoredLeft) { Len = GS.StoredLeft; }
+                if (Len > GS.InSize - GS.InPos) { errorGzip("unexpected end of data"); }
+                memcpy(pOut + GS.OutPos, GS.pIn + GS.InPos, Len);
+                GS.InPos += Len;
+                GS.OutPos += Len;
+                GS.MemberSize += (uint32_t) Len;
+                GS.StoredLeft -= Len;
+                if (GS.StoredLeft == 0) { GS.State = GZ_BLOCK; }
+                break;
+            }
+
+            case GZ_HUFFMAN:
+                while (GS.OutPos + GZIP_MAXLEN <= OutMax) {
+                    int Sym = decodeSymbol(GS, *GS.pLenCode);
+                    if (Sym < 256) {
+                        pOut[GS.OutPos++] = (unsigned char) Sym;
+                        GS.MemberSize++;
+                        continue;
+                    }
+                    if (Sym == 256) {
+                        GS.State = GZ_BLOCK;
+                        break;
+                    }
+                    Sym -= 257;
+                    if (Sym >= 29) { errorGzip("invalid length symbol"); }
+                    int Len = pLEN_BASE[Sym] + getBits(GS, pLEN_EXTRA[Sym]);
+                    int DSym = decodeSymbol(GS, *GS.pDistCode);
+                    if (DSym >= 30) { errorGzip("invalid distance symbol"); }
+                    size_t Dist = pDIST_BASE[DSym] + getBits(GS, pDIST_EXTRA[DSym]);
+                    if (Dist > GS.OutPos) { errorGzip("distance too far back"); }
+                    unsigned char *pDst = pOut + GS.OutPos;
+                    const unsigned char *pSrc = pDst - Dist;
+                    for (int k = 0; k < Len; k++) { pDst[k] = pSrc[k]; } //byte copy, as source may overlap
+                    GS.OutPos += Len;
+                    GS.MemberSize += Len;
+                }
+                break;
+
+            case GZ_TRAILER:
+                updateCRC(GS.CRC, pOut + GS.CrcPos, GS.OutPos - GS.CrcPos);
+                GS.CrcPos = GS.OutPos;
+                readMemberTrailer(GS);
+                GS.State = isGzipData(GS.pIn + GS.InPos, GS.InSize - GS.InPos) ? GZ_HEADER : GZ_DONE;
+                break;
+        }
+    }
+
+    pChunk = pOut + Start;
+    return GS.OutPos - Start;
+}
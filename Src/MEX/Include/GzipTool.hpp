@@ -0,0 +1,46 @@
+#ifndef GZIP_TOOL_HPP
+#define GZIP_TOOL_HPP
+
+#include "mex.h"
+#include <stdint.h>
+#include <vector>
+
+// huffman_table stores a canonical Huffman code for the deflate decoder
+struct huffman_table {
+    short Count[16];        //Count: # of codes of each bit length
+    short Symbol[288];      //Symbol: symbols ordered by code
+    uint16_t Fast[1 << 10]; //Fast: (Symbol << 4 | Len) lookup for codes <= 10 bits, 0 if longer
+};
+
+// gzip_stream will inflate a (multi-member) gzip buffer in chunks, so the
+// whole decompressed file never has to be in memory.
+struct gzip_stream {
+    const unsigned char *pIn = NULL; //pIn: compressed gzip data
+    size_t InSize = 0;               //InSize: # of compressed bytes
+    size_t InPos = 0;                //InPos: next byte of pIn to load into BitBuf
+    uint64_t BitBuf = 0;             //BitBuf: bit buffer, LSB first
+    int BitCnt = 0;                  //BitCnt: # of valid bits in BitBuf
+    int State = 0;                   //State: see GzipTool.cpp
+    bool LastBlock = false;          //LastBlock: current block is the last of the member
+    size_t StoredLeft = 0;           //StoredLeft: bytes left in a stored block
+    uint32_t CRC = 0;                //CRC: running CRC32 of the current member
+    uint32_t MemberSize = 0;         //MemberSize: running size (mod 2^32) of the current member
+    size_t CrcPos = 0;               //CrcPos: end of the output in Out already added to CRC
+    huffman_table LenCode;           //LenCode: dynamic literal/length code
+    huffman_table DistCode;          //DistCode: dynamic distance code
+    const huffman_table *pLenCode = NULL;  //pLenCode: code used for the current block (fixed or dynamic)
+    const huffman_table *pDistCode = NULL; //pDistCode: code used for the current block (fixed or dynamic)
+    std::vector<unsigned char> Out;  //Out: 32 KB history + new output
+    size_t OutPos = 0;               //OutPos: end of the valid output in Out
+};
+
+// gzip_error is thrown by inflateGzipStream for invalid or truncated data
+struct gzip_error {
+    const char *pMsg;
+};
+
+bool isGzipData(const unsigned char*, size_t);
+void initGzipStream(gzip_stream&, const unsigned char*, size_t);
+size_t inflateGzipStream(gzip_stream&, const unsigned char*&);
+
+#endif
@@ -6,6 +6,7 @@
 #include "HotspotTool.hpp"
 #include "SeqTool.hpp"  // Need to fix compileMex.m to be able to search header file dependencies.
 #include "AlignTool.hpp"
+#include "StatTool.hpp"
 
 //row is NACGT initial letter
 //col is NACGT final letter   
@@ -86,6 +87,7 @@ double labelHotspot(mxChar *pSeq, mwSize Len, mwSize Pos) {
 }
 
 double countHotspots(mxChar *pSeq, mwSize Len) {
+    STAT_TIMER(STAT_COUNT_HOTSPOTS, Len);
     double Count = 0;
     for (mwSize j = 0; j < Len; j++) {
         Count += isHotspot(pSeq, Len, j) ? 1 : 0;
@@ -94,6 +96,7 @@ double countHotspots(mxChar *pSeq, mwSize Len) {
 }
 
 double countHotspots(mxChar *pSeq, mwSize Len, double *pLabel) {
+    STAT_TIMER(STAT_COUNT_HOTSPOTS, Len);
     double Count = 0;
     for (mwSize j = 0; j < Len; j++) {
         pLabel[j] = labelHotspot(pSeq, Len, j);
@@ -103,6 +106,7 @@ double countHotspots(mxChar *pSeq, mwSize Len, double *pLabel) {
 }
 
 void calcSeqShmScore(mxChar *pSeqA, mxChar *pSeqB, mwSize Len, double *pScore) {
+    STAT_TIMER(STAT_CALC_SEQ_SHM_SCORE, Len);
 //     Score[0] = 0; //Hamming dist
 //     Score[1] = 0; //A to B hotspot motif count, sum(Motifs), where Motifs = 1 for hotspot, -1 otherwise
 //     Score[2] = 0; //B to A hotspot motif count, sum(Motifs), where Motifs = 1 for hotspot, -1 otherwise
@@ -0,0 +1,241 @@
+/*  RegionTool contains the codes shared by findConsecOnesMEX and
+ *  labelRegionMEX, which label the runs in a vector, each column of a
+ *  matrix, or each vector of a cell. The run starts are found with a
+ *  branch-free compare against the previous element, so that the compiler
+ *  can vectorize it, and then added up into labels. Matrix columns and cell
+ *  elements are labeled in parallel.
+ *
+ *  The Output option picks 'double' labels (default), compact 'int32'
+ *  labels, or 'runs', which are the [Start Length Value] of each run.
+ */
+
+#include "RegionTool.hpp"
+#include "ThreadTool.hpp"
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// region_vec is 1 vector to label, from a vector, a matrix column, or a cell
+struct region_vec {
+    const double *pNum = NULL;      //pNum: double data, or NULL if logical
+    const mxLogical *pBool = NULL;  //pBool: logical data, or NULL if double
+    size_t Len = 0;                 //Len: number of elements
+};
+
+// Labels the runs of nonzero values. For doubles, a run starts at a value
+// > 0 and ends at a 0, and only 1's are labeled (same as the original
+// findConsecOnesMEX), so negative and NaN values do not end a run.
+static void labelConsecOnes(const double *pX, size_t Len, int32_t *pLabel) {
+    int32_t Num = 0;
+    bool InRun = false;
+    for (size_t j = 0; j < Len; j++) {
+        double X = pX[j];
+        bool Start = !InRun && X > 0;
+        InRun = X > 0 ? true : (X == 0 ? false : InRun);
+        Num += Start;
+        pLabel[j] = X == 1 ? Num : 0;
+    }
+}
+
+static void labelConsecOnes(const mxLogical *pX, size_t Len, int32_t *pLabel) {
+    if (Len == 0) { return; }
+    int32_t Num = pX[0] != 0;
+    pLabel[0] = Num;
+    for (size_t j = 1; j < Len; j++) {
+        int32_t On = pX[j] != 0;
+        Num += On & (pX[j-1] == 0);
+        pLabel[j] = Num * On;
+    }
+}
+
+// Labels the runs of equal values. NaN never equals the value before it.
+template <typename T>
+static void labelEqualRuns(const T *pX, size_t Len, int32_t *pLabel) {
+    if (Len == 0) { return; }
+    int32_t Num = 1;
+    pLabel[0] = 1;
+    for (size_t j = 1; j < Len; j++) {
+        Num += pX[j] != pX[j-1];
+        pLabel[j] = Num;
+    }
+}
+
+static void labelVec(const region_vec &V, region_mode Mode, int32_t *pLabel) {
+    if (Mode == REGION_CONSEC_ONES) {
+        if (V.pNum != NULL) {
+            labelConsecOnes(V.pNum, V.Len, pLabel);
+        } else {
+            labelConsecOnes(V.pBool, V.Len, pLabel);
+        }
+    } else {
+        if (V.pNum != NULL) {
+            labelEqualRuns(V.pNum, V.Len, pLabel);
+        } else {
+            labelEqualRuns(V.pBool, V.Len, pLabel);
+        }
+    }
+}
+
+// Appends the [Start Length Value] of each run of the same label, skipping
+// label 0. Value is the label for REGION_CONSEC_ONES, or else the input value.
+static void findRuns(const region_vec &V, region_mode Mode, const int32_t *pLabel, std::vector<double> &Runs) {
+    size_t j = 0;
+    while (j < V.Len) {
+        size_t k = j + 1;
+        while (k < V.Len && pLabel[k] == pLabel[j]) { k++; }
+        if (pLabel[j] != 0) {
+            Runs.push_back((double) j + 1);
+            Runs.push_back((double) (k - j));
+            if (Mode == REGION_CONSEC_ONES) {
+                Runs.push_back(pLabel[j]);
+            } else {
+                Runs.push_back(V.pNum != NULL ? V.pNum[j] : (double) V.pBool[j]);
+            }
+        }
+        j = k;
+    }
+}
+
+static region_vec getRegionVec(const mxArray *pRegion, const char *pName) {
+    region_vec V;
+    if (pRegion == NULL || mxIsEmpty(pRegion)) { return V; }
+    if (mxIsDouble(pRegion) && !mxIsComplex(pRegion)) {
+        V.pNum = mxGetPr(pRegion);
+    } else if (mxIsLogical(pRegion)) {
+        V.pBool = mxGetLogicals(pRegion);
+    } else {
+        mexErrMsgIdAndTxt((std::string(pName) + ":prhs").c_str(), "Input1: Region must be a double or logical matrix, or a cell of them.");
+    }
+    V.Len = mxGetNumberOfElements(pRegion);
+    return V;
+}
+
+// Creates the Rx3 (or Rx4 with the vector number first) matrix of runs
+static mxArray *createRunMatrix(const std::vector<std::vector<double>> &Runs, size_t Beg, size_t End, bool AddVecNum) {
+    size_t NumRun = 0;
+    for (size_t v = Beg; v < End; v++) { NumRun += Runs[v].size() / 3; }
+    size_t NumCol = AddVecNum ? 4 : 3;
+    mxArray *pOut = mxCreateDoubleMatrix(NumRun, NumCol, mxREAL);
+    double *pData = mxGetPr(pOut);
+    size_t r = 0;
+    for (size_t v = Beg; v < End; v++) {
+        for (size_t k = 0; k < Runs[v].size(); k += 3, r++) {
+            size_t c = 0;
+            if (AddVecNum) { pData[r + NumRun*c++] = (double) (v - Beg) + 1; }
+            for (size_t q = 0; q < 3; q++) { pData[r + NumRun*c++] = Runs[v][k+q]; }
+        }
+    }
+    return pOut;
+}
+
+void labelRegionBatch(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[], region_mode Mode, const char *pName) {
+    std::string Name(pName);
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgIdAndTxt((Name + ":nrhs").c_str(), "Incorrect number of inputs. Min is 1. Max is 2.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt((Name + ":nlhs").c_str(), "Too many outputs. Max is 1.");
+    }
+    std::string Output = "double";
+    if (nrhs >= 2) {
+        if (!mxIsChar(prhs[1])) {
+            mexErrMsgIdAndTxt((Name + ":prhs").c_str(), "Input2: Output must be 'double', 'int32', or 'runs'.");
+        }
+        char *pOutput = mxArrayToString(prhs[1]);
+        Output = pOutput;
+        mxFree(pOutput);
+        if (Output != "double" && Output != "int32" && Output != "runs") {
+            mexErrMsgIdAndTxt((Name + ":prhs").c_str(), "Input2: Output must be 'double', 'int32', or 'runs'.");
+        }
+    }
+
+    //Collect the vectors to label: cell elements, matrix columns, or 1 vector
+    const mxArray *pIn = prhs[0];
+    bool IsCell = mxIsCell(pIn);
+    bool IsMatrix = !IsCell && mxGetM(pIn) > 1 && mxGetN(pIn) > 1;
+    std::vector<region_vec> Vec;
+    if (IsCell) {
+        Vec.resize(mxGetNumberOfElements(pIn));
+        for (size_t v = 0; v < Vec.size(); v++) {
+            const mxArray *pCell = mxGetCell(pIn, v);
+            Vec[v] = getRegionVec(pCell, pName);
+            if (pCell != NULL && mxGetM(pCell) > 1 && mxGetN(pCell) > 1) {
+                mexErrMsgIdAndTxt((Name + ":prhs").c_str(), "Input1: each cell must have a 1xN or Mx1 vector.");
+            }
+        }
+    } else {
+        region_vec V = getRegionVec(pIn, pName);
+        size_t NumVec = IsMatrix ? mxGetN(pIn) : 1;
+        size_t Len = IsMatrix ? mxGetM(pIn) : V.Len;
+        Vec.resize(NumVec);
+        for (size_t v = 0; v < NumVec; v++) {
+            Vec[v].pNum = V.pNum != NULL ? V.pNum + v*Len : NULL;
+            Vec[v].pBool = V.pBool != NULL ? V.pBool + v*Len : NULL;
+            Vec[v].Len = V.Len == 0 ? 0 : Len;
+        }
+    }
+
+    //Make the label outputs in the main thread, and point to where each vector's labels go
+    std::vector<int32_t*> pLabel(Vec.size(), NULL);
+    std::vector<std::vector<int32_t>> TmpLabel(Vec.size());
+    std::vector<double*> pDouble(Vec.size(), NULL);
+    mxArray *pOut = NULL;
+    if (Output != "runs") {
+        mxClassID Class = Output == "int32" ? mxINT32_CLASS : mxDOUBLE_CLASS;
+        if (IsCell) {
+            pOut = mxCreateCellArray(mxGetNumberOfDimensions(pIn), mxGetDimensions(pIn));
+            for (size_t v = 0; v < Vec.size(); v++) {
+                const mxArray *pCell = mxGetCell(pIn, v);
+                mxArray *pVec = pCell == NULL ? mxCreateNumericMatrix(0, 0, Class, mxREAL) : mxCreateNumericMatrix(mxGetM(pCell), mxGetN(pCell), Class, mxREAL);
+                mxSetCell(pOut, v, pVec);
+                if (Class == mxINT32_CLASS) {
+                    pLabel[v] = (int32_t*) mxGetData(pVec);
+                } else {
+                    pDouble[v] = mxGetPr(pVec);
+                }
+            }
+        } else {
+            pOut = mxCreateNumericArray(mxGetNumberOfDimensions(pIn), mxGetDimensions(pIn), Class, mxREAL);
+            for (size_t v = 0; v < Vec.size(); v++) {
+                if (Class == mxINT32_CLASS) {
+                    pLabel[v] = (int32_t*) mxGetData(pOut) + v*Vec[v].Len;
+                } else {
+                    pDouble[v] = mxGetPr(pOut) + v*Vec[v].Len;
+                }
+            }
+        }
+    }
+
+    size_t TotalLen = 0;
+    for (size_t v = 0; v < Vec.size(); v++) { TotalLen += Vec[v].Len; }
+    size_t MinBlock = Vec.empty() ? 1 : 16384 / (TotalLen / Vec.size() + 1) + 1;
+    std::vector<std::vector<double>> Runs(Output == "runs" ? Vec.size() : 0);
+    parallelFor(Vec.size(), MinBlock, [&](size_t Beg, size_t End) {
+        for (size_t v = Beg; v < End; v++) {
+            int32_t *pVecLabel = pLabel[v];
+            if (pVecLabel == NULL) {
+                TmpLabel[v].resize(Vec[v].Len);
+                pVecLabel = TmpLabel[v].data();
+            }
+            labelVec(Vec[v], Mode, pVecLabel);
+            if (pDouble[v] != NULL) {
+                for (size_t j = 0; j < Vec[v].Len; j++) { pDouble[v][j] = pVecLabel[j]; }
+            } else if (!Runs.empty()) {
+                findRuns(Vec[v], Mode, pVecLabel, Runs[v]);
+            }
+            std::vector<int32_t>().swap(TmpLabel[v]);
+        }
+    });
+
+    if (Output == "runs") {
+        if (IsCell) {
+            pOut = mxCreateCellArray(mxGetNumberOfDimensions(pIn), mxGetDimensions(pIn));
+            for (size_t v = 0; v < Vec.size(); v++) {
+                mxSetCell(pOut, v, createRunMatrix(Runs, v, v + 1, false));
+            }
+        } else {
+            pOut = createRunMatrix(Runs, 0, Vec.size(), IsMatrix);
+        }
+    }
+    plhs[0] = pOut;
+}
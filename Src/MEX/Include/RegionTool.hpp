@@ -0,0 +1,14 @@
+#ifndef REGION_TOOL_HPP
+#define REGION_TOOL_HPP
+
+#include "mex.h"
+
+// region_mode is the kind of run labeling to do
+enum region_mode {
+    REGION_CONSEC_ONES = 0,  //label runs of nonzero values 1 to N, and 0 elsewhere (findConsecOnesMEX)
+    REGION_LABEL = 1         //label runs of equal values 1 to N (labelRegionMEX)
+};
+
+void labelRegionBatch(int, mxArray**, int, const mxArray**, region_mode, const char*);
+
+#endif
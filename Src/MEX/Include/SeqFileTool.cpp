@@ -0,0 +1,223 @@
+/*  SeqFileTool contains the codes for streaming FASTA/FASTQ records from
+ *  plain or gzip-compressed files, and for fixing the input sequence in
+ *  the same pass (same rules as fixInputSeq.m), so that only the final
+ *  sequences are ever copied into MATLAB.
+ *
+ *  NOTE: FASTQ entries must be 4 lines (@Name, Seq, +, Quality).
+ *
+ *  NOTE: readSeqRecord and fixSeqRecord make no mx/mex calls, so they can
+ *    run in a background thread. A format error is stored in
+ *    seq_reader.ErrMsg (with any gzip_error), and the caller raises it
+ *    with SEQ_FILE_ERR_ID.
+ */
+
+#include "SeqFileTool.hpp"
+#include "DlmTool.hpp"   // compileMex.m only searches the .cpp for dependencies
+#include "GzipTool.hpp"
+#include "SeqTool.hpp"
+#include <string.h>
+#include <stdio.h>
+
+// Load the next chunk of (decompressed) text. Returns false if no more.
+static bool loadNextChunk(seq_reader &SR) {
+    if (SR.IsLastChunk) { return false; }
+    if (!SR.IsGzip) {
+        SR.pChunk = SR.MF.pData;
+        SR.pChunkEnd = SR.MF.pData + SR.MF.Size;
+        SR.IsLastChunk = true;
+        return SR.MF.Size > 0;
+    }
+    const unsigned char *pData;
+    size_t Len;
+    try {
+        Len = inflateGzipStream(SR.GS, pData);
+    } catch (const gzip_error &Err) {
+        SR.ErrMsg = std::string("Invalid or truncated gzip data: ") + Err.pMsg + ".";
+        Len = 0;
+    }
+    if (Len == 0) {
+        SR.IsLastChunk = true;
+        return false;
+    }
+    SR.pChunk = (const char*) pData;
+    SR.pChunkEnd = SR.pChunk + Len;
+    return true;
+}
+
+// Get the next text line, without the '\r\n'. Line is valid until the next call.
+static bool getLine(seq_reader &SR, const char *&pLine, size_t &Len) {
+    if (SR.LineInCarry) {
+        SR.Carry.clear();
+        SR.LineInCarry = false;
+    }
+    while (true) {
+        if (SR.pChunk < SR.pChunkEnd) {
+            const char *pEOL = (const char*) memchr(SR.pChunk, '\n', SR.pChunkEnd - SR.pChunk);
+            if (pEOL != NULL) {
+                if (SR.Carry.empty()) {
+                    pLine = SR.pChunk;
+                    Len = pEOL - SR.pChunk;
+                } else {
+                    SR.Carry.append(SR.pChunk, pEOL - SR.pChunk);
+                    SR.LineInCarry = true;
+                    pLine = SR.Carry.data();
+                    Len = SR.Carry.size();
+                }
+                SR.pChunk = pEOL + 1;
+                if (Len > 0 && pLine[Len-1] == '\r') { Len--; }
+                return true;
+            }
+            SR.Carry.append(SR.pChunk, SR.pChunkEnd - SR.pChunk);
+            SR.pChunk = SR.pChunkEnd;
+        }
+        if (!loadNextChunk(SR)) { //Last line without '\n'
+            if (SR.Carry.empty()) { return false; }
+            SR.LineInCarry = true;
+            pLine = SR.Carry.data();
+            Len = SR.Carry.size();
+            if (Len > 0 && pLine[Len-1] == '\r') { Len--; }
+            return true;
+        }
+    }
+}
+
+// Get the next non-empty line
+static bool getNonEmptyLine(seq_reader &SR, const char *&pLine, size_t &Len) {
+    while (getLine(SR, pLine, Len)) {
+        if (Len > 0) { return true; }
+    }
+    return false;
+}
+
+bool openSeqReader(const char *pFileName, seq_reader &SR) {
+    if (!openMappedFile(pFileName, SR.MF)) { return false; }
+    SR.IsGzip = isGzipData((const unsigned char*) SR.MF.pData, SR.MF.Size);
+    if (SR.IsGzip) {
+        initGzipStream(SR.GS, (const unsigned char*) SR.MF.pData, SR.MF.Size);
+    }
+    SR.pChunk = SR.pChunkEnd = NULL;
+    SR.IsLastChunk = false;
+    SR.Carry.clear();
+    SR.LineInCarry = false;
+    SR.HasNextName = false;
+    SR.Format = 0;
+    SR.NextIdx = 1;
+    SR.ErrMsg.clear();
+    return true;
+}
+
+void closeSeqReader(seq_reader &SR) {
+    closeMappedFile(SR.MF);
+    SR.GS.Out.clear();
+    SR.GS.Out.shrink_to_fit();
+    SR.Carry.clear();
+    SR.pChunk = SR.pChunkEnd = NULL;
+    SR.IsLastChunk = true;
+}
+
+// Stores the error of FASTQ entry # NextIdx and returns false
+static bool setEntryErr(seq_reader &SR, const char *pMsg) {
+    if (!SR.ErrMsg.empty()) { return false; } //keep the gzip error that cut the entry short
+    char pBuf[128];
+    snprintf(pBuf, sizeof(pBuf), "Invalid FASTQ entry #%d. %s", (int) SR.NextIdx, pMsg);
+    SR.ErrMsg = pBuf;
+    return false;
+}
+
+// Read the next FASTA/FASTQ record. Returns false if there are no more
+// records, or if the file is invalid (then SR.ErrMsg is not empty).
+bool readSeqRecord(seq_reader &SR, seq_record &Rec) {
+    const char *pLine;
+    size_t Len;
+    Rec.Seq.clear();
+    Rec.Qual.clear();
+    if (!SR.ErrMsg.empty()) { return false; }
+    if (SR.Format == 0) {
+        if (!getNonEmptyLine(SR, pLine, Len)) { return false; }
+        if (pLine[0] != '>' && pLine[0] != '@') {
+            SR.ErrMsg = "Unrecognized sequence file format. Expected a FASTA (>) or FASTQ (@) file.";
+            return false;
+        }
+        SR.Format = pLine[0];
+        SR.NextName.assign(pLine + 1, Len - 1);
+        SR.HasNextName = true;
+    }
+
+    if (SR.Format == '>') {
+        if (!SR.HasNextName) {
+            do {
+                if (!getNonEmptyLine(SR, pLine, Len)) { return false; }
+            } while (pLine[0] != '>');
+            SR.NextName.assign(pLine + 1, Len - 1);
+        }
+        Rec.Name.clear();
+        for (size_t j = 0; j < SR.NextName.size(); j++) { //same as readFasta, which removes '"'
+            if (SR.NextName[j] != '"') { Rec.Name += SR.NextName[j]; }
+        }
+        SR.HasNextName = false;
+        while (getLine(SR, pLine, Len)) {
+            if (Len > 0 && pLine[0] == '>') {
+                SR.NextName.assign(pLine + 1, Len - 1);
+                SR.HasNextName = true;
+                break;
+            }
+            for (size_t j = 0; j < Len; j++) {
+                if (pLine[j] != ' ') { Rec.Seq += pLine[j]; }
+            }
+        }
+    } else {
+        if (SR.HasNextName) {
+            Rec.Name = SR.NextName;
+            SR.HasNextName = false;
+        } else {
+            if (!getNonEmptyLine(SR, pLine, Len)) { return false; }
+            if (pLine[0] != '@') { return setEntryErr(SR, "Expected a '@' header line."); }
+            Rec.Name.assign(pLine + 1, Len - 1);
+        }
+        if (getLine(SR, pLine, Len)) { Rec.Seq.assign(pLine, Len); }
+        if (!getLine(SR, pLine, Len) || Len == 0 || pLine[0] != '+') {
+            return setEntryErr(SR, "Expected a '+' separator line.");
+        }
+        if (getLine(SR, pLine, Len)) { Rec.Qual.assign(pLine, Len); }
+        if (Rec.Qual.size() != Rec.Seq.size()) {
+            return setEntryErr(SR, "Sequence and quality lengths differ.");
+        }
+    }
+    if (!SR.ErrMsg.empty()) { return false; } //entry was cut short by a gzip error
+    SR.NextIdx++;
+    return true;
+}
+
+// Fix the sequence like fixInputSeq.m, after masking bases whose Phred
+// quality char < MinQuality as N (MinQuality = 0 for no masking).
+// Returns true if the fraction of N in the trimmed sequence > MaxErrRate.
+// An all-N or empty sequence becomes '' with no overhangs and is not bad,
+// as fixInputSeq.m gives a NaN N fraction for it.
+bool fixSeqRecord(seq_record &Rec, char MinQuality, double MaxErrRate) {
+    std::string &Seq = Rec.Seq;
+    size_t Len = Seq.size();
+    fixSeqNT(&Seq[0], Len); //same letter rule as fixSeqDirMEX
+    if (MinQuality > 0 && Rec.Qual.size() == Len) {
+        for (size_t j = 0; j < Len; j++) {
+            if (Rec.Qual[j] < MinQuality) { Seq[j] = 'N'; }
+        }
+    }
+
+    size_t S = 0, E = Len;
+    while (S < E && Seq[S] == 'N') { S++; }
+    while (E > S && Seq[E-1] == 'N') { E--; }
+    if (S == Len) { //all N
+        Rec.Over5.clear();
+        Rec.Over3.clear();
+        Seq.clear();
+        return false;
+    }
+    Rec.Over5.assign(Seq, 0, S);
+    Rec.Over3.assign(Seq, E, Len - E);
+    size_t MissCt = 0;
+    for (size_t j = S; j < E; j++) {
+        if (Seq[j] == 'N') { MissCt++; }
+    }
+    Seq = Seq.substr(S, E - S);
+    return (double) MissCt / (double) Seq.size() > MaxErrRate;
+}
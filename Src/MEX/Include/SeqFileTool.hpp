@@ -0,0 +1,43 @@
+#ifndef SEQ_FILE_TOOL_HPP
+#define SEQ_FILE_TOOL_HPP
+
+#include "mex.h"
+#include "DlmTool.hpp"
+#include "GzipTool.hpp"
+#include <string>
+
+// seq_record stores one FASTA/FASTQ entry
+struct seq_record {
+    std::string Name;  //Name: header text without the '>' or '@'
+    std::string Seq;   //Seq: nt sequence
+    std::string Qual;  //Qual: Phred quality string (FASTQ only)
+    std::string Over5; //Over5: 5' N overhang trimmed off by fixSeqRecord
+    std::string Over3; //Over3: 3' N overhang trimmed off by fixSeqRecord
+};
+
+// seq_reader streams records from a plain or gzip-compressed FASTA/FASTQ file
+struct seq_reader {
+    mapped_file MF;
+    bool IsGzip = false;
+    gzip_stream GS;
+    const char *pChunk = NULL;    //pChunk: unread part of the current decompressed chunk
+    const char *pChunkEnd = NULL;
+    bool IsLastChunk = false;
+    std::string Carry;            //Carry: a line that spans 2 chunks
+    bool LineInCarry = false;
+    std::string NextName;         //NextName: FASTA header already read for the next record
+    bool HasNextName = false;
+    char Format = 0;              //Format: '>' for FASTA, '@' for FASTQ, 0 if unknown
+    size_t NextIdx = 1;           //NextIdx: 1-based index of the next record to read
+    std::string ErrMsg;           //ErrMsg: why readSeqRecord returned false, or empty if end of file
+};
+
+// Error ID for raising seq_reader.ErrMsg
+#define SEQ_FILE_ERR_ID "SeqFileTool_readSeqRecord:input"
+
+bool openSeqReader(const char*, seq_reader&);
+void closeSeqReader(seq_reader&);
+bool readSeqRecord(seq_reader&, seq_record&);
+bool fixSeqRecord(seq_record&, char, double);
+
+#endif
@@ -4,6 +4,7 @@
  */
 
 #include "SeqTool.hpp"
+#include <math.h>
 
 int nt2int(mxChar nt) {
     switch (nt) {
@@ -29,40 +30,237 @@ mxChar int2nt(int nt) {
     }
 }
 
-void fixSeqDNA(char *pSeq) {
-    for (size_t j = 0; j < std::char_traits<char>::length(pSeq); j++) {
-        switch (pSeq[j]) {
-            case 'A': break;
-            case 'C': break;
-            case 'G': break;
-            case 'T': break;
-            case 'N': break;
-            case 'a': pSeq[j] = 'A'; break;
-            case 'c': pSeq[j] = 'C'; break;
-            case 'g': pSeq[j] = 'G'; break;
-            case 't': pSeq[j] = 'T'; break;
-            case 'u': pSeq[j] = 'T'; break;
-            case 'U': pSeq[j] = 'T'; break;
-            default: pSeq[j] = 'N'; break;
+// Lookup tables for fixing nt letters. Index is the char code (< 256).
+//   DNA: uppercase ACGT, U -> T, others -> N
+//   RNA: uppercase ACGU, T -> U, others -> N
+//   NT:  uppercase ACGTU, others -> N (the input seq rule of fixInputSeq)
+//   RC:  complement of the DNA letter, or A for U
+struct nt_tables {
+    char DNA[256];
+    char RNA[256];
+    char NT[256];
+    char RC[256];
+    nt_tables() {
+        for (int j = 0; j < 256; j++) {
+            DNA[j] = 'N';
+            RNA[j] = 'N';
+            NT[j]  = 'N';
+            RC[j]  = 'N';
+        }
+        const char *pFrom = "ACGTUacgtu";
+        const char *pDNA  = "ACGTTACGTT";
+        const char *pRNA  = "ACGUUACGUU";
+        const char *pNT   = "ACGTUACGTU";
+        for (int j = 0; j < 10; j++) {
+            DNA[(unsigned char) pFrom[j]] = pDNA[j];
+            RNA[(unsigned char) pFrom[j]] = pRNA[j];
+            NT[(unsigned char) pFrom[j]]  = pNT[j];
+        }
+        RC['A'] = 'T';
+        RC['C'] = 'G';
+        RC['G'] = 'C';
+        RC['T'] = 'A';
+        RC['U'] = 'A';
+    }
+};
+
+// Lookup tables for amino acid letters. Index is the char code (< 256).
+//   Prop:  property code (see convAA2PropMEX), X for lower case
+//   Hydro: Kyte-Doolittle hydropathy index (see calcHPI.m), 0 for lower case
+struct aa_tables {
+    char Prop[256];
+    double Hydro[256];
+    aa_tables() {
+        for (int j = 0; j < 256; j++) {
+            Prop[j] = 'X';
+            Hydro[j] = 0;
+        }
+        const char *pAA[7]  = {"AILV", "RHK", "DE", "NQ", "ST", "CM", "PWYGF"};
+        const char  pCode[] = "HBANOS";
+        for (int k = 0; k < 7; k++) {
+            for (const char *p = pAA[k]; *p != '\0'; p++) {
+                char Code = k < 6 ? pCode[k] : *p;
+                Prop[(unsigned char) *p] = Code;
+            }
+        }
+        const char *pHydroAA = "ARNDCQEGHILKMFPSTWYV";
+        const double pHydro[20] = {1.8, -4.5, -3.5, -3.5, 2.5, -3.5, -3.5, -0.4, -3.2, 4.5,
+                                   3.8, -3.9,  1.9,  2.8, -1.6, -0.8, -0.7, -0.9, -1.3, 4.2};
+        for (int k = 0; k < 20; k++) {
+            Hydro[(unsigned char) pHydroAA[k]] = pHydro[k];
         }
     }
+};
+
+static const aa_tables AA_TABLE;
+
+// Standard codon table, indexed by 16*nt1 + 4*nt2 + nt3 for A=0,C=1,G=2,T=3
+static const char CODON_TABLE[] = "KNKNTTTTRSRSIIMIQHQHPPPPRRRRLLLLEDEDAAAAGGGGVVVV*Y*YSSSS*CWCLFLF";
+
+static const nt_tables NT_TABLE;
+
+// 2-bit code of ACGT (U = T), or -1 for N
+static int nt2bit(mxChar nt) {
+    switch (nt) {
+        case 'A': return 0;
+        case 'C': return 1;
+        case 'G': return 2;
+        case 'T': return 3;
+        case 'U': return 3;
+        default:  return -1;
+    }
+}
+
+void fixSeqDNA(char *pSeq) {
+    for (; *pSeq != '\0'; pSeq++) {
+        *pSeq = NT_TABLE.DNA[(unsigned char) *pSeq];
+    }
 }
 
 void fixSeqRNA(char *pSeq) {
-    for (size_t j = 0; j < std::char_traits<char>::length(pSeq); j++) {
-        switch (pSeq[j]) {
-            case 'A': break;
-            case 'C': break;
-            case 'G': break;
-            case 'U': break;
-            case 'N': break;
-            case 'a': pSeq[j] = 'A'; break;
-            case 'c': pSeq[j] = 'C'; break;
-            case 'g': pSeq[j] = 'G'; break;
-            case 'u': pSeq[j] = 'U'; break;
-            case 't': pSeq[j] = 'U'; break;
-            case 'T': pSeq[j] = 'U'; break;
-            default: pSeq[j] = 'N'; break;
+    for (; *pSeq != '\0'; pSeq++) {
+        *pSeq = NT_TABLE.RNA[(unsigned char) *pSeq];
+    }
+}
+
+// Same as fixSeqDNA, but for mxChar seq of known length. pOut can be pSeq.
+void fixSeqDNA(const mxChar *pSeq, mwSize Len, mxChar *pOut) {
+    for (mwSize j = 0; j < Len; j++) {
+        pOut[j] = pSeq[j] < 256 ? NT_TABLE.DNA[pSeq[j]] : 'N';
+    }
+}
+
+// Fixes input seq letters like fixInputSeq: uppercase, keeps U, and sets
+// non-ACGTU to N. Used by fixSeqDirMEX and readSeqFileMEX, so both give
+// the same seq. This makes no mex calls.
+void fixSeqNT(char *pSeq, size_t Len) {
+    for (size_t j = 0; j < Len; j++) {
+        pSeq[j] = NT_TABLE.NT[(unsigned char) pSeq[j]];
+    }
+}
+
+// Same as fixSeqNT, but for mxChar seq. pOut can be pSeq.
+void fixSeqNT(const mxChar *pSeq, mwSize Len, mxChar *pOut) {
+    for (mwSize j = 0; j < Len; j++) {
+        pOut[j] = pSeq[j] < 256 ? NT_TABLE.NT[pSeq[j]] : 'N';
+    }
+}
+
+// Reverse complement of a fixed seq (ACGTUN only). pOut cannot be pSeq.
+void rcompSeqDNA(const mxChar *pSeq, mwSize Len, mxChar *pOut) {
+    for (mwSize j = 0; j < Len; j++) {
+        pOut[Len-1-j] = NT_TABLE.RC[pSeq[j] & 0xFF];
+    }
+}
+
+// Stores all k-mers without N of the RefSeq into a 4^K bit set. K = 1 to 13.
+void buildKmerSet(kmer_set &KS, const std::vector<std::string> &RefSeq, int K) {
+    if (K < 1 || K > 13) {
+        mexErrMsgIdAndTxt("SeqTool_buildKmerSet:input", "K must be between 1 to 13.");
+    }
+    KS.K = K;
+    KS.Bits.assign(((size_t) 1 << (2*K)) / 64 + 1, 0);
+    size_t Mask = ((size_t) 1 << (2*K)) - 1;
+    for (size_t r = 0; r < RefSeq.size(); r++) {
+        size_t Code = 0;
+        int ValidCt = 0;
+        for (size_t j = 0; j < RefSeq[r].size(); j++) {
+            int B = nt2bit(NT_TABLE.DNA[(unsigned char) RefSeq[r][j]]);
+            if (B < 0) {
+                ValidCt = 0;
+                continue;
+            }
+            Code = ((Code << 2) | B) & Mask;
+            if (++ValidCt >= K) {
+                KS.Bits[Code >> 6] |= 1ULL << (Code & 63);
+            }
+        }
+    }
+}
+
+// Counts how many k-mers of a fixed DNA seq are in the kmer_set
+mwSize countKmerHits(const kmer_set &KS, const mxChar *pSeq, mwSize Len) {
+    size_t Mask = ((size_t) 1 << (2*KS.K)) - 1;
+    size_t Code = 0;
+    int ValidCt = 0;
+    mwSize HitCt = 0;
+    for (mwSize j = 0; j < Len; j++) {
+        int B = nt2bit(pSeq[j]);
+        if (B < 0) {
+            ValidCt = 0;
+            continue;
+        }
+        Code = ((Code << 2) | B) & Mask;
+        if (++ValidCt >= KS.K && (KS.Bits[Code >> 6] >> (Code & 63) & 1)) {
+            HitCt++;
+        }
+    }
+    return HitCt;
+}
+
+// Translates 3 nt to an amino acid. Codons with non-ACGTU nt return 'X'.
+mxChar codon2aa(const mxChar *pCodon) {
+    int Idx = 0;
+    for (int k = 0; k < 3; k++) {
+        int B = nt2bit(pCodon[k] < 256 ? NT_TABLE.DNA[pCodon[k]] : 'N');
+        if (B < 0) { return 'X'; }
+        Idx = 4*Idx + B;
+    }
+    return CODON_TABLE[Idx];
+}
+
+// Same as codon2aa, but a codon with N is resolved to an AA if all of its
+// possible codons give the same AA, as nt2aa(..., 'ACGTonly', false) does.
+mxChar codon2aaN(const mxChar *pCodon) {
+    mxChar AA = codon2aa(pCodon);
+    if (AA != 'X') { return AA; }
+    int NumN = 0;
+    for (int k = 0; k < 3; k++) {
+        if (pCodon[k] == 'N' || pCodon[k] == 'n') { NumN++; }
+    }
+    if (NumN == 0 || NumN == 3) { return 'X'; }
+    const mxChar NT[4] = {'A', 'C', 'G', 'T'};
+    mxChar Test[3];
+    AA = 0;
+    for (int Opt = 0; Opt < (1 << (2*NumN)); Opt++) {
+        for (int k = 0, q = 0; k < 3; k++) {
+            Test[k] = (pCodon[k] == 'N' || pCodon[k] == 'n') ? NT[(Opt >> (2*q++)) & 3] : pCodon[k];
         }
+        mxChar TestAA = codon2aa(Test);
+        if (TestAA == 'X' || (AA != 0 && TestAA != AA)) { return 'X'; }
+        AA = TestAA;
+    }
+    return AA;
+}
+
+// Returns true if there is a stop codon in frame 1 of the Len nts of pSeq
+bool hasStopCodon(const mxChar *pSeq, int Len) {
+    for (int k = 0; k + 3 <= Len; k += 3) {
+        if (codon2aaN(pSeq + k) == '*') { return true; }
+    }
+    return false;
+}
+
+mxChar aa2prop(mxChar AA) {
+    return AA < 256 ? AA_TABLE.Prop[AA] : 'X';
+}
+
+double aa2hydro(mxChar AA) {
+    return AA < 256 ? AA_TABLE.Hydro[AA] : 0;
+}
+
+// Fills a 256-element table of the partial charge of each amino acid side
+// chain at a pH, using the EMBOSS pKa values (same as calcCharge.m, which
+// also counts lower case letters).
+void getAAChargeTable(double pH, double *pCharge) {
+    for (int j = 0; j < 256; j++) { pCharge[j] = 0; }
+    const char *pAA = "CDEHKRY";
+    const double pKa[7]  = {8.5, 3.9, 4.1, 6.5, 10.8, 12.5, 10.1};
+    const int    pSign[7] = { -1,  -1,  -1,   1,    1,    1,   -1};
+    for (int k = 0; k < 7; k++) {
+        double T = pow(10.0, pH - pKa[k]);
+        double Charge = pSign[k] > 0 ? 1 / (1 + T) : -T / (1 + T);
+        pCharge[(unsigned char) pAA[k]] = Charge;
+        pCharge[(unsigned char) pAA[k] + 32] = Charge;
     }
-}
\ No newline at end of file
+}
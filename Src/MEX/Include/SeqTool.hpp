@@ -3,10 +3,29 @@
 
 #include "mex.h"
 #include <string>
+#include <vector>
+
+// kmer_set is a bit set of all k-mers found in a set of reference nt seq
+struct kmer_set {
+    int K = 0;
+    std::vector<unsigned long long> Bits;
+};
 
 int nt2int(mxChar); 
 mxChar int2nt(int);
 void fixSeqDNA(char*);
 void fixSeqRNA(char*);
+void fixSeqDNA(const mxChar*, mwSize, mxChar*);
+void fixSeqNT(char*, size_t);
+void fixSeqNT(const mxChar*, mwSize, mxChar*);
+void rcompSeqDNA(const mxChar*, mwSize, mxChar*);
+void buildKmerSet(kmer_set&, const std::vector<std::string>&, int);
+mwSize countKmerHits(const kmer_set&, const mxChar*, mwSize);
+mxChar codon2aa(const mxChar*);
+mxChar codon2aaN(const mxChar*);
+bool hasStopCodon(const mxChar*, int);
+mxChar aa2prop(mxChar);
+double aa2hydro(mxChar);
+void getAAChargeTable(double, double*);
 
 #endif
\ No newline at end of file
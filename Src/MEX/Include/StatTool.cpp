@@ -0,0 +1,234 @@
+/*  StatTool contains the hot-path counters of the seq kernels, which are
+ *  read by briliaStatsMEX. Each kernel call adds its length and time to the
+ *  slot of its thread with relaxed atomics, and each slot is on its own
+ *  cache lines, so threads do not slow each other down.
+ *
+ *  A slot belongs to 1 OS thread, whose id is saved in the block. So a
+ *  thread uses the same slot in every MEX file, even though each MEX file
+ *  has its own thread pool and thread_local variables (see ThreadTool).
+ *  Threads past the 63rd share the last slot. The OS can reuse the id of
+ *  an ended thread, so a new thread may add to the slot of an old one.
+ *
+ *  Each MEX file is its own library with its own static variables, so the
+ *  slots are kept in 1 block per MATLAB process. The 1st MEX file that
+ *  needs it maps the block and saves "<process id>:<address>" in the
+ *  BRILIA_STATS_BLOCK environment variable, which the other MEX files
+ *  read. The block is never unmapped, so it stays valid after "clear mex".
+ *  The process id keeps child processes, which inherit the environment,
+ *  from using the address of their parent.
+ *
+ *  NOTE: The kernels only call these with -DBRILIA_STATS (see StatTool.hpp).
+ */
+
+#include "StatTool.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// stat_slot stores the counters of the threads that use 1 slot
+struct alignas(64) stat_slot {
+    std::atomic<uint64_t> Calls[NUM_STAT_KERNEL];
+    std::atomic<uint64_t> Elements[NUM_STAT_KERNEL];
+    std::atomic<uint64_t> Nanosec[NUM_STAT_KERNEL];
+    std::atomic<uint64_t> LenHist[NUM_STAT_KERNEL][NUM_STAT_BIN];
+    std::atomic<uint64_t> RefHist[NUM_STAT_KERNEL][NUM_STAT_BIN];
+};
+
+// stat_block stores the slots of all threads of this process
+struct stat_block {
+    uint64_t Magic;                   //Magic: STAT_MAGIC, to check the address is a stat_block
+    uint64_t Size;                    //Size: sizeof(stat_block), which changes if the layout changes
+    std::atomic<uint32_t> NextSlot;   //NextSlot: slot number of the next new thread
+    std::atomic<uint64_t> SlotThread[NUM_STAT_SLOT]; //SlotThread: OS thread id of each slot. 0 = not used yet.
+    stat_slot Slot[NUM_STAT_SLOT];
+};
+
+static const uint64_t STAT_MAGIC = 0x4252494C49415354ULL; //"BRILIAST"
+static const char *STAT_ENV = "BRILIA_STATS_BLOCK";
+
+static unsigned long getProcessId() {
+#ifdef _WIN32
+    return (unsigned long) GetCurrentProcessId();
+#else
+    return (unsigned long) getpid();
+#endif
+}
+
+static uint64_t getThreadId() {
+#ifdef _WIN32
+    return (uint64_t) GetCurrentThreadId();
+#else
+    return (uint64_t) (uintptr_t) pthread_self();
+#endif
+}
+
+// Returns the block saved in BRILIA_STATS_BLOCK by this process, or NULL
+static stat_block *readStatEnv() {
+    char Buf[64] = {0};
+#ifdef _WIN32
+    DWORD Len = GetEnvironmentVariableA(STAT_ENV, Buf, sizeof(Buf));
+    if (Len == 0 || Len >= sizeof(Buf)) { return NULL; }
+#else
+    const char *pEnv = getenv(STAT_ENV);
+    if (pEnv == NULL) { return NULL; }
+    snprintf(Buf, sizeof(Buf), "%s", pEnv);
+#endif
+    char *pEnd = NULL;
+    unsigned long Pid = strtoul(Buf, &pEnd, 10);
+    if (pEnd == NULL || *pEnd != ':' || Pid != getProcessId()) { return NULL; }
+    stat_block *pBlock = (stat_block*) (uintptr_t) strtoull(pEnd + 1, NULL, 16);
+    if (pBlock == NULL || pBlock->Magic != STAT_MAGIC || pBlock->Size != sizeof(stat_block)) { return NULL; }
+    return pBlock;
+}
+
+// Maps a new zeroed block and saves its address in BRILIA_STATS_BLOCK
+static stat_block *makeStatBlock() {
+#ifdef _WIN32
+    void *pMem = VirtualAlloc(NULL, sizeof(stat_block), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void *pMem = mmap(NULL, sizeof(stat_block), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pMem == MAP_FAILED) { pMem = NULL; }
+#endif
+    if (pMem == NULL) { return NULL; }
+    stat_block *pBlock = new (pMem) stat_block();
+    pBlock->Magic = STAT_MAGIC;
+    pBlock->Size = sizeof(stat_block);
+
+    char Buf[64];
+    snprintf(Buf, sizeof(Buf), "%lu:%llx", getProcessId(), (unsigned long long) (uintptr_t) pBlock);
+#ifdef _WIN32
+    SetEnvironmentVariableA(STAT_ENV, Buf);
+#else
+    setenv(STAT_ENV, Buf, 1);
+#endif
+    return pBlock;
+}
+
+// Returns the block of this process, making it if needed. NULL if it cannot be mapped.
+static stat_block *getStatBlock() {
+    static std::atomic<stat_block*> pBLOCK(NULL);
+    static std::mutex MUTEX;
+    stat_block *pBlock = pBLOCK.load(std::memory_order_acquire);
+    if (pBlock != NULL) { return pBlock; }
+    std::lock_guard<std::mutex> Lock(MUTEX);
+    pBlock = pBLOCK.load(std::memory_order_relaxed);
+    if (pBlock == NULL) {
+        pBlock = readStatEnv();
+        if (pBlock == NULL) { pBlock = makeStatBlock(); }
+        pBLOCK.store(pBlock, std::memory_order_release);
+    }
+    return pBlock;
+}
+
+// Returns the slot of this OS thread, which is picked on its 1st call from
+// any MEX file. SLOT only saves the search in this MEX file.
+static stat_slot &getStatSlot(stat_block *pBlock) {
+    static thread_local int SLOT = -1;
+    if (SLOT >= 0) { return pBlock->Slot[SLOT]; }
+    uint64_t Tid = getThreadId();
+    int NumUsed = getStatSlotCount();
+    for (int s = 0; s < NumUsed && SLOT < 0; s++) {
+        if (pBlock->SlotThread[s].load(std::memory_order_relaxed) == Tid) { SLOT = s; }
+    }
+    if (SLOT < 0) {
+        uint32_t NewSlot = pBlock->NextSlot.fetch_add(1, std::memory_order_relaxed);
+        if (NewSlot < (uint32_t) NUM_STAT_SLOT - 1) {
+            SLOT = (int) NewSlot;
+            pBlock->SlotThread[SLOT].store(Tid, std::memory_order_relaxed);
+        } else {
+            SLOT = NUM_STAT_SLOT - 1;
+        }
+    }
+    return pBlock->Slot[SLOT];
+}
+
+// Returns the histogram bin of N: 0 for 0, else floor(log2(N)) + 1, up to NUM_STAT_BIN-1
+int getStatBin(uint64_t N) {
+    int Bin = 0;
+    while (N > 0 && Bin < NUM_STAT_BIN - 1) {
+        N >>= 1;
+        Bin++;
+    }
+    return Bin;
+}
+
+void recordStat(int Kernel, uint64_t Len, uint64_t Nanosec) {
+    stat_block *pBlock = getStatBlock();
+    if (pBlock == NULL || Kernel < 0 || Kernel >= NUM_STAT_KERNEL) { return; }
+    stat_slot &S = getStatSlot(pBlock);
+    S.Calls[Kernel].fetch_add(1, std::memory_order_relaxed);
+    S.Elements[Kernel].fetch_add(Len, std::memory_order_relaxed);
+    S.Nanosec[Kernel].fetch_add(Nanosec, std::memory_order_relaxed);
+    S.LenHist[Kernel][getStatBin(Len)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void recordRefSet(int Kernel, uint64_t Size) {
+    stat_block *pBlock = getStatBlock();
+    if (pBlock == NULL || Kernel < 0 || Kernel >= NUM_STAT_KERNEL) { return; }
+    getStatSlot(pBlock).RefHist[Kernel][getStatBin(Size)].fetch_add(1, std::memory_order_relaxed);
+}
+
+stat_total getStatTotal(int Kernel) {
+    stat_total T;
+    stat_block *pBlock = getStatBlock();
+    if (pBlock == NULL || Kernel < 0 || Kernel >= NUM_STAT_KERNEL) { return T; }
+    for (int s = 0; s < NUM_STAT_SLOT; s++) {
+        stat_slot &S = pBlock->Slot[s];
+        T.Calls += S.Calls[Kernel].load(std::memory_order_relaxed);
+        T.Elements += S.Elements[Kernel].load(std::memory_order_relaxed);
+        T.SlotNanosec[s] = S.Nanosec[Kernel].load(std::memory_order_relaxed);
+        T.Nanosec += T.SlotNanosec[s];
+        for (int b = 0; b < NUM_STAT_BIN; b++) {
+            T.LenHist[b] += S.LenHist[Kernel][b].load(std::memory_order_relaxed);
+            T.RefHist[b] += S.RefHist[Kernel][b].load(std::memory_order_relaxed);
+        }
+    }
+    return T;
+}
+
+// Returns the number of slots used so far
+int getStatSlotCount() {
+    stat_block *pBlock = getStatBlock();
+    if (pBlock == NULL) { return 0; }
+    uint32_t Count = pBlock->NextSlot.load(std::memory_order_relaxed);
+    return Count < (uint32_t) NUM_STAT_SLOT ? (int) Count : NUM_STAT_SLOT;
+}
+
+// Zeroes all counters. Threads keep their slots.
+void resetStat() {
+    stat_block *pBlock = getStatBlock();
+    if (pBlock == NULL) { return; }
+    for (int s = 0; s < NUM_STAT_SLOT; s++) {
+        stat_slot &S = pBlock->Slot[s];
+        for (int k = 0; k < NUM_STAT_KERNEL; k++) {
+            S.Calls[k].store(0, std::memory_order_relaxed);
+            S.Elements[k].store(0, std::memory_order_relaxed);
+            S.Nanosec[k].store(0, std::memory_order_relaxed);
+            for (int b = 0; b < NUM_STAT_BIN; b++) {
+                S.LenHist[k][b].store(0, std::memory_order_relaxed);
+                S.RefHist[k][b].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+const char *getStatKernelName(int Kernel) {
+    switch (Kernel) {
+        case STAT_ALIGN_SEQ:          return "alignSeq";
+        case STAT_CALC_SEQ_SHM_SCORE: return "calcSeqShmScore";
+        case STAT_COUNT_HOTSPOTS:     return "countHotspots";
+        case STAT_CMPR_SEQ:           return "cmprSeq";
+        case STAT_CONV_STR_TO_MATRIX: return "convStrToMatrix";
+        default:                      return "";
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef STAT_TOOL_HPP
+#define STAT_TOOL_HPP
+
+#include "mex.h"
+#include <chrono>
+#include <stdint.h>
+
+// stat_kernel is a kernel with hot-path counters (see briliaStatsMEX)
+enum stat_kernel {
+    STAT_ALIGN_SEQ = 0,
+    STAT_CALC_SEQ_SHM_SCORE,
+    STAT_COUNT_HOTSPOTS,
+    STAT_CMPR_SEQ,
+    STAT_CONV_STR_TO_MATRIX,
+    NUM_STAT_KERNEL
+};
+
+const int NUM_STAT_BIN = 32;   //histogram bins: 0, 1, 2-3, 4-7, ..., >= 2^30
+const int NUM_STAT_SLOT = 64;  //per-thread slots. Threads past the 63rd share the last slot.
+
+// stat_total stores the counters of 1 kernel, summed over all slots
+struct stat_total {
+    uint64_t Calls = 0;                      //Calls: number of kernel calls
+    uint64_t Elements = 0;                   //Elements: sum of the seq lengths given to the kernel
+    uint64_t Nanosec = 0;                    //Nanosec: total time in the kernel
+    uint64_t LenHist[NUM_STAT_BIN] = {0};    //LenHist: calls per seq length bin
+    uint64_t RefHist[NUM_STAT_BIN] = {0};    //RefHist: calls per reference set size bin
+    uint64_t SlotNanosec[NUM_STAT_SLOT] = {0}; //SlotNanosec: time of each thread, in the order they 1st called a kernel
+};
+
+int getStatBin(uint64_t);
+void recordStat(int, uint64_t, uint64_t);
+void recordRefSet(int, uint64_t);
+stat_total getStatTotal(int);
+int getStatSlotCount();
+void resetStat();
+const char *getStatKernelName(int);
+
+// stat_timer records the call, length, and time of a kernel when it goes out of scope
+struct stat_timer {
+    int Kernel;
+    uint64_t Len;
+    std::chrono::steady_clock::time_point T0;
+    stat_timer(int K, uint64_t L) : Kernel(K), Len(L), T0(std::chrono::steady_clock::now()) {}
+    ~stat_timer() {
+        recordStat(Kernel, Len, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - T0).count());
+    }
+};
+
+// The counters are only compiled in with -DBRILIA_STATS (see compileMexBRILIA)
+#ifdef BRILIA_STATS
+#define STAT_TIMER(Kernel, Len) stat_timer StatTimer_(Kernel, (uint64_t) (Len))
+#define STAT_REF_SET(Kernel, Size) recordRefSet(Kernel, (uint64_t) (Size))
+#else
+#define STAT_TIMER(Kernel, Len)
+#define STAT_REF_SET(Kernel, Size)
+#endif
+
+#endif
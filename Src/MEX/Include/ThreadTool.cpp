@@ -0,0 +1,202 @@
+/*  ThreadTool contains the codes for splitting a loop over independent
+ *  items (ex: sequences in a cell array) across CPU threads.
+ *
+ *  The threads are kept in a pool that is made on the first parallelFor
+ *  call and reused by all later calls, so a kernel called once per batch
+ *  does not pay the thread start-up cost every time. The MEX file is
+ *  locked (mexLock) while the pool exists. Use munlock('nameMEX') before
+ *  clear or recompiling, which will stop the threads via mexAtExit.
+ *
+ *  MATLAB keeps only 1 mexAtExit function per MEX file, so a MEX file that
+ *  uses ThreadTool must register its own clean-up with addExitFunc instead
+ *  of mexAtExit. Otherwise, either the pool or the clean-up is skipped.
+ *
+ *  The pool size is the BRILIA_NUM_THREADS environment variable if set
+ *  (see setCores), or the number of logical CPUs. The loop is cut into
+ *  more blocks than threads, and each thread takes the next free block, so
+ *  uneven blocks (ex: the rows of a triangular pair matrix) are balanced.
+ *
+ *  Each MEX file is compiled with its own copy of ThreadTool, so each MEX
+ *  file has its own pool, and so does each parpool worker process. A MEX
+ *  kernel called inside a parfor would use workers x threads, which is why
+ *  setCores sets BRILIA_NUM_THREADS to 1 on the pool workers.
+ *
+ *  WARNING: The loop body must NOT call any mx* or mex* function, since
+ *  the MATLAB API is not thread-safe. Create all outputs in the main
+ *  thread first, and let the threads only fill in the data. A parallelFor
+ *  inside a loop body runs serially.
+ *
+ *  EXAMPLE
+ *    parallelFor(NumSeq, 256, [&](size_t Beg, size_t End) {
+ *        for (size_t j = Beg; j < End; j++) { ... }
+ *    });
+ */
+
+#include "ThreadTool.hpp"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <stdlib.h>
+
+// thread_pool keeps NumWorker threads waiting for tasks between calls
+class thread_pool {
+public:
+    explicit thread_pool(int NumWorker) {
+        for (int t = 0; t < NumWorker; t++) {
+            Workers.emplace_back(&thread_pool::work, this);
+        }
+    }
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            Stop = true;
+        }
+        WakeCV.notify_all();
+        for (size_t t = 0; t < Workers.size(); t++) {
+            Workers[t].join();
+        }
+    }
+
+    int size() const { return (int) Workers.size(); }
+
+    // Runs Task(0) to Task(NumTask-1) on the workers and the calling thread
+    void run(size_t NumTask, const std::function<void(size_t)> &Task) {
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            pTask = &Task;
+            TaskCt = NumTask;
+            NextTask = 0;
+            Busy = (int) Workers.size();
+            Epoch++;
+        }
+        WakeCV.notify_all();
+        doTasks();
+        std::unique_lock<std::mutex> Lock(Mutex);
+        DoneCV.wait(Lock, [this] { return Busy == 0; });
+        pTask = NULL;
+    }
+
+private:
+    std::vector<std::thread> Workers;
+    std::mutex Mutex;
+    std::condition_variable WakeCV, DoneCV;
+    const std::function<void(size_t)> *pTask = NULL;
+    std::atomic<size_t> NextTask{0};
+    size_t TaskCt = 0;
+    int Busy = 0;
+    unsigned int Epoch = 0;
+    bool Stop = false;
+
+    void doTasks() {
+        for (size_t t = NextTask++; t < TaskCt; t = NextTask++) {
+            (*pTask)(t);
+        }
+    }
+
+    void work() {
+        InPool = true;
+        unsigned int LastEpoch = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> Lock(Mutex);
+                WakeCV.wait(Lock, [&] { return Stop || Epoch != LastEpoch; });
+                if (Stop) { return; }
+                LastEpoch = Epoch;
+            }
+            doTasks();
+            {
+                std::lock_guard<std::mutex> Lock(Mutex);
+                Busy--;
+            }
+            DoneCV.notify_one();
+        }
+    }
+
+public:
+    static thread_local bool InPool; //true in the worker threads
+};
+
+thread_local bool thread_pool::InPool = false;
+
+static thread_pool *pPool = NULL;
+static std::mutex PoolMutex; //1 parallelFor at a time uses the pool
+
+static std::vector<void (*)(void)> EXIT_FUNCS; //clean-up of the MEX file, see addExitFunc
+
+static void deletePool() {
+    delete pPool;
+    pPool = NULL;
+}
+
+// The single mexAtExit function: runs the added clean-ups, then stops the pool
+static void runExitFuncs() {
+    for (size_t k = EXIT_FUNCS.size(); k > 0; k--) { EXIT_FUNCS[k-1](); }
+    EXIT_FUNCS.clear();
+    deletePool();
+}
+
+// Adds a clean-up function to run when the MEX file is cleared, in place of
+// mexAtExit(Func). Adding the same function again does nothing.
+void addExitFunc(void (*Func)(void)) {
+    if (std::find(EXIT_FUNCS.begin(), EXIT_FUNCS.end(), Func) == EXIT_FUNCS.end()) {
+        EXIT_FUNCS.push_back(Func);
+    }
+    mexAtExit(runExitFuncs);
+}
+
+// Returns the max number of threads, from BRILIA_NUM_THREADS or the CPU
+int getMaxThreads() {
+    const char *pEnv = getenv("BRILIA_NUM_THREADS");
+    int MaxThreads = pEnv != NULL ? atoi(pEnv) : 0;
+    if (MaxThreads < 1) { MaxThreads = (int) std::thread::hardware_concurrency(); }
+    return MaxThreads < 1 ? 1 : MaxThreads;
+}
+
+// Returns the number of threads to use for N items, such that each thread
+// gets at least MinBlock items.
+int getNumThreads(size_t N, size_t MinBlock) {
+    size_t NumBlock = N / std::max(MinBlock, (size_t) 1);
+    return (int) std::max((size_t) 1, std::min((size_t) getMaxThreads(), NumBlock));
+}
+
+// Runs Func(Beg, End) over [0, N) in contiguous blocks of >= MinBlock items,
+// using the thread pool.
+void parallelFor(size_t N, size_t MinBlock, const std::function<void(size_t, size_t)> &Func) {
+    int NumThreads = getNumThreads(N, MinBlock);
+    std::unique_lock<std::mutex> Lock(PoolMutex, std::defer_lock);
+    if (NumThreads == 1 || thread_pool::InPool || !Lock.try_lock()) {
+        Func(0, N);
+        return;
+    }
+
+    int MaxThreads = getMaxThreads();
+    if (pPool == NULL || pPool->size() != MaxThreads - 1) {
+        if (pPool == NULL) {
+            mexLock(); //Keep the MEX in memory while the threads exist
+            mexAtExit(runExitFuncs);
+        }
+        deletePool();
+        pPool = new thread_pool(MaxThreads - 1);
+    }
+
+    //Use up to 4 blocks per thread for load balancing
+    size_t NumBlock = std::min(N / std::max(MinBlock, (size_t) 1), (size_t) NumThreads * 4);
+    size_t Block = (N + NumBlock - 1) / NumBlock;
+    NumBlock = (N + Block - 1) / Block;
+    pPool->run(NumBlock, [&](size_t b) {
+        Func(b * Block, std::min(N, (b + 1) * Block));
+    });
+}
+
+// Returns the max bytes of data that a background read or write stage may
+// hold (see readSeqFileMEX, writeDlmFileMEX), from BRILIA_PIPE_MB or 256 MB.
+size_t getPipeBudget() {
+    const char *pEnv = getenv("BRILIA_PIPE_MB");
+    double MB = pEnv != NULL ? atof(pEnv) : -1;
+    if (MB < 0) { MB = 256; }
+    return (size_t) (MB * 1048576);
+}
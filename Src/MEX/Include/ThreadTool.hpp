@@ -0,0 +1,13 @@
+#ifndef THREAD_TOOL_HPP
+#define THREAD_TOOL_HPP
+
+#include "mex.h"
+#include <functional>
+
+int getMaxThreads();
+int getNumThreads(size_t, size_t);
+void parallelFor(size_t, size_t, const std::function<void(size_t, size_t)>&);
+size_t getPipeBudget();
+void addExitFunc(void (*)(void));
+
+#endif
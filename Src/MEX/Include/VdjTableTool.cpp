@@ -0,0 +1,337 @@
+/*  VdjTableTool contains the codes for storing VDJdata as typed columns
+ *  instead of a cell array, where every cell is its own mxArray (~100
+ *  bytes of overhead each, even for a scalar).
+ *
+ *  COLUMN KINDS
+ *    VDJ_NUM: real double scalars or [], stored as a double + 1 byte flag
+ *    VDJ_DICT: strings with many repeats (ex: gene names, Functional),
+ *      interned as a uint32 code into a dictionary of unique strings
+ *    VDJ_STR: mostly unique strings (ex: sequences), stored as 8-bit chars
+ *      in 1 contiguous arena per column, with a uint64 offset + uint32
+ *      length per row
+ *    VDJ_ANY: everything else, stored as a persistent mxArray per row
+ *
+ *  The kind is picked from the data when the table is built. If a new
+ *  value does not fit the kind (ex: a string set into a numeric column),
+ *  the column is promoted to VDJ_ANY, except that an all-empty numeric
+ *  column becomes a string column.
+ *
+ *  The tables are kept by vdjTableMEX. Other MEX files are separate
+ *  libraries and cannot reach them, so the pipeline kernels still take
+ *  cell arrays.
+ *
+ *  WARNING: These are not thread-safe since VDJ_ANY uses mx* functions.
+ */
+
+#include "VdjTableTool.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include <string.h>
+#include <ctype.h>
+
+enum cell_kind { CELL_EMPTY, CELL_NUM, CELL_STR, CELL_ANY };
+
+// Returns how a cell can be stored
+static cell_kind getCellKind(const mxArray *pCell) {
+    if (pCell == NULL || (mxIsDouble(pCell) && mxGetM(pCell) == 0 && mxGetN(pCell) == 0)) {
+        return CELL_EMPTY;
+    }
+    if (mxIsDouble(pCell) && !mxIsComplex(pCell) && mxGetNumberOfElements(pCell) == 1) {
+        return CELL_NUM;
+    }
+    if (mxIsChar(pCell) && mxGetM(pCell) <= 1 && mxGetNumberOfDimensions(pCell) == 2) {
+        const mxChar *pChar = mxGetChars(pCell);
+        for (mwSize j = 0; j < mxGetNumberOfElements(pCell); j++) {
+            if (pChar[j] > 255) { return CELL_ANY; }
+        }
+        return CELL_STR;
+    }
+    return CELL_ANY;
+}
+
+// Returns a 8-bit copy of a char cell
+static std::string getCellStr(const mxArray *pCell) {
+    const mxChar *pChar = mxGetChars(pCell);
+    std::string Str(mxGetNumberOfElements(pCell), 0);
+    for (size_t j = 0; j < Str.size(); j++) {
+        Str[j] = (char) pChar[j];
+    }
+    return Str;
+}
+
+// Creates a 1xLen char array, or a 0x0 one if Len = 0
+static mxArray *createChar8(const char *pStr, size_t Len) {
+    mwSize Dims[2] = {(mwSize) (Len > 0 ? 1 : 0), (mwSize) Len};
+    mxArray *pOut = mxCreateCharArray(2, Dims);
+    mxChar *pChar = mxGetChars(pOut);
+    for (size_t j = 0; j < Len; j++) {
+        pChar[j] = (unsigned char) pStr[j];
+    }
+    return pOut;
+}
+
+static size_t getColRows(const vdj_column &C) {
+    switch (C.Kind) {
+        case VDJ_NUM:  return C.Num.size();
+        case VDJ_DICT: return C.Code.size();
+        case VDJ_STR:  return C.Len.size();
+        default:       return C.Any.size();
+    }
+}
+
+// Resizes a column, filling new rows with []
+static void resizeColumn(vdj_column &C, size_t NumRow) {
+    switch (C.Kind) {
+        case VDJ_NUM:
+            C.Num.resize(NumRow, 0);
+            C.Has.resize(NumRow, 0);
+            break;
+        case VDJ_DICT:
+            C.Code.resize(NumRow, 0);
+            break;
+        case VDJ_STR:
+            C.Off.resize(NumRow, 0);
+            C.Len.resize(NumRow, VDJ_EMPTY_LEN);
+            break;
+        default:
+            C.Any.resize(NumRow, NULL);
+    }
+}
+
+// Changes the column kind, keeping the values
+static void convertColumn(vdj_column &C, vdj_kind Kind) {
+    size_t NumRow = getColRows(C);
+    std::vector<mxArray*> Cells(NumRow, NULL);
+    for (size_t r = 0; r < NumRow; r++) {
+        Cells[r] = getVdjCell(C, r);
+    }
+    std::string Name = C.Name;
+    for (size_t r = 0; r < C.Any.size(); r++) {
+        if (C.Any[r] != NULL) { mxDestroyArray(C.Any[r]); }
+    }
+    C = vdj_column();
+    C.Name = Name;
+    C.Kind = Kind;
+    resizeColumn(C, NumRow);
+    for (size_t r = 0; r < NumRow; r++) {
+        setVdjCell(C, r, Cells[r]);
+        mxDestroyArray(Cells[r]);
+    }
+}
+
+// Removes the unused bytes of a string column arena
+static void compactArena(vdj_column &C) {
+    std::string Arena;
+    Arena.reserve(C.Arena.size() - C.Waste);
+    for (size_t r = 0; r < C.Len.size(); r++) {
+        if (C.Len[r] == VDJ_EMPTY_LEN) { continue; }
+        unsigned long long Off = Arena.size();
+        Arena.append(C.Arena, C.Off[r], C.Len[r]);
+        C.Off[r] = Off;
+    }
+    C.Arena.swap(Arena);
+    C.Waste = 0;
+}
+
+// Builds a table from a MxN VDJdata cell and 1xN VDJheader cell
+void buildVdjTable(const mxArray *pCellData, const mxArray *pHeader, vdj_table &VT) {
+    clearVdjTable(VT);
+    if (!mxIsCell(pCellData) || mxGetNumberOfDimensions(pCellData) > 2) {
+        mexErrMsgIdAndTxt("VdjTableTool_buildVdjTable:input", "VDJdata must be a MxN cell array.");
+    }
+    if (!mxIsCell(pHeader) || mxGetNumberOfElements(pHeader) != mxGetN(pCellData)) {
+        mexErrMsgIdAndTxt("VdjTableTool_buildVdjTable:input", "VDJheader must be a 1xN cell with 1 name per VDJdata column.");
+    }
+    size_t NumRow = mxGetM(pCellData);
+    size_t NumCol = mxGetN(pCellData);
+    VT.NumRow = NumRow;
+    VT.Col.resize(NumCol);
+    for (size_t c = 0; c < NumCol; c++) {
+        vdj_column &C = VT.Col[c];
+        const mxArray *pName = mxGetCell(pHeader, c);
+        if (pName == NULL || !mxIsChar(pName)) {
+            mexErrMsgIdAndTxt("VdjTableTool_buildVdjTable:input", "VDJheader column %d is not a char.", (int) c + 1);
+        }
+        C.Name = getCellStr(pName);
+
+        bool HasNum = false, HasStr = false, HasAny = false;
+        std::unordered_set<std::string> Unique;
+        size_t NumStr = 0;
+        for (size_t r = 0; r < NumRow && !HasAny; r++) {
+            const mxArray *pCell = mxGetCell(pCellData, r + c*NumRow);
+            switch (getCellKind(pCell)) {
+                case CELL_NUM: HasNum = true; break;
+                case CELL_STR:
+                    HasStr = true;
+                    NumStr++;
+                    Unique.insert(getCellStr(pCell));
+                    break;
+                case CELL_ANY: HasAny = true; break;
+                default: break;
+            }
+        }
+        if (HasAny || (HasNum && HasStr)) {
+            C.Kind = VDJ_ANY;
+        } else if (HasStr) {
+            C.Kind = Unique.size()*2 <= NumStr ? VDJ_DICT : VDJ_STR;
+        } else {
+            C.Kind = VDJ_NUM;
+        }
+        resizeColumn(C, NumRow);
+        for (size_t r = 0; r < NumRow; r++) {
+            setVdjCell(C, r, mxGetCell(pCellData, r + c*NumRow));
+        }
+    }
+}
+
+// Appends the rows of a MxN VDJdata cell to the table
+void appendVdjRows(const mxArray *pCellData, vdj_table &VT) {
+    if (!mxIsCell(pCellData) || mxGetNumberOfDimensions(pCellData) > 2 || mxGetN(pCellData) != VT.Col.size()) {
+        mexErrMsgIdAndTxt("VdjTableTool_appendVdjRows:input", "VDJdata must be a MxN cell with the same number of columns as the table.");
+    }
+    size_t NumRow = mxGetM(pCellData);
+    for (size_t c = 0; c < VT.Col.size(); c++) {
+        resizeColumn(VT.Col[c], VT.NumRow + NumRow);
+        for (size_t r = 0; r < NumRow; r++) {
+            setVdjCell(VT.Col[c], VT.NumRow + r, mxGetCell(pCellData, r + c*NumRow));
+        }
+    }
+    VT.NumRow += NumRow;
+}
+
+// Frees all memory of the table, including the persistent mxArrays
+void clearVdjTable(vdj_table &VT) {
+    for (size_t c = 0; c < VT.Col.size(); c++) {
+        for (size_t r = 0; r < VT.Col[c].Any.size(); r++) {
+            if (VT.Col[c].Any[r] != NULL) { mxDestroyArray(VT.Col[c].Any[r]); }
+        }
+    }
+    VT = vdj_table();
+}
+
+// Returns the approximate number of bytes used by the table
+size_t getVdjBytes(const vdj_table &VT) {
+    size_t Bytes = sizeof(vdj_table);
+    for (size_t c = 0; c < VT.Col.size(); c++) {
+        const vdj_column &C = VT.Col[c];
+        Bytes += sizeof(vdj_column) + C.Name.capacity();
+        Bytes += C.Num.capacity()*sizeof(double) + C.Has.capacity();
+        Bytes += C.Code.capacity()*sizeof(unsigned int);
+        for (size_t j = 0; j < C.Dict.size(); j++) {
+            Bytes += 2*(sizeof(std::string) + C.Dict[j].capacity()) + 2*sizeof(void*); //Dict + DictIdx
+        }
+        Bytes += C.Off.capacity()*sizeof(unsigned long long) + C.Len.capacity()*sizeof(unsigned int) + C.Arena.capacity();
+        Bytes += C.Any.capacity()*sizeof(mxArray*);
+        for (size_t r = 0; r < C.Any.size(); r++) {
+            if (C.Any[r] != NULL) {
+                Bytes += 104 + mxGetNumberOfElements(C.Any[r])*mxGetElementSize(C.Any[r]); //104 = mxArray header
+            }
+        }
+    }
+    return Bytes;
+}
+
+// Returns the 0-based index of a column name (case-insensitive), or -1
+int findVdjColumn(const vdj_table &VT, const char *pName) {
+    size_t Len = strlen(pName);
+    for (size_t c = 0; c < VT.Col.size(); c++) {
+        const std::string &Name = VT.Col[c].Name;
+        if (Name.size() != Len) { continue; }
+        size_t j = 0;
+        while (j < Len && tolower(Name[j]) == tolower(pName[j])) { j++; }
+        if (j == Len) { return (int) c; }
+    }
+    return -1;
+}
+
+// Returns a new mxArray of a cell, as it would be in VDJdata
+mxArray *getVdjCell(const vdj_column &C, size_t Row) {
+    switch (C.Kind) {
+        case VDJ_NUM:
+            return C.Has[Row] ? mxCreateDoubleScalar(C.Num[Row]) : mxCreateDoubleMatrix(0, 0, mxREAL);
+        case VDJ_DICT:
+            if (C.Code[Row] == 0) { return mxCreateDoubleMatrix(0, 0, mxREAL); }
+            return createChar8(C.Dict[C.Code[Row]-1].data(), C.Dict[C.Code[Row]-1].size());
+        case VDJ_STR:
+            if (C.Len[Row] == VDJ_EMPTY_LEN) { return mxCreateDoubleMatrix(0, 0, mxREAL); }
+            return createChar8(C.Arena.data() + C.Off[Row], C.Len[Row]);
+        default:
+            return C.Any[Row] == NULL ? mxCreateDoubleMatrix(0, 0, mxREAL) : mxDuplicateArray(C.Any[Row]);
+    }
+}
+
+// Sets a cell, promoting the column kind if the value does not fit
+void setVdjCell(vdj_column &C, size_t Row, const mxArray *pCell) {
+    cell_kind Kind = getCellKind(pCell);
+    if (C.Kind == VDJ_NUM && Kind == CELL_STR && std::find(C.Has.begin(), C.Has.end(), 1) == C.Has.end()) {
+        convertColumn(C, VDJ_STR);
+    } else if (C.Kind != VDJ_ANY && (Kind == CELL_ANY || (C.Kind == VDJ_NUM && Kind == CELL_STR) || (C.Kind != VDJ_NUM && Kind == CELL_NUM))) {
+        convertColumn(C, VDJ_ANY);
+    }
+
+    switch (C.Kind) {
+        case VDJ_NUM:
+            C.Has[Row] = Kind == CELL_NUM;
+            C.Num[Row] = Kind == CELL_NUM ? mxGetScalar(pCell) : 0;
+            break;
+        case VDJ_DICT: {
+            if (Kind == CELL_EMPTY) {
+                C.Code[Row] = 0;
+                break;
+            }
+            std::string Str = getCellStr(pCell);
+            std::unordered_map<std::string, unsigned int>::iterator Iter = C.DictIdx.find(Str);
+            if (Iter == C.DictIdx.end()) {
+                C.Dict.push_back(Str);
+                Iter = C.DictIdx.insert(std::make_pair(Str, (unsigned int) C.Dict.size())).first;
+            }
+            C.Code[Row] = Iter->second;
+            break;
+        }
+        case VDJ_STR: {
+            unsigned int OldLen = C.Len[Row] == VDJ_EMPTY_LEN ? 0 : C.Len[Row];
+            if (Kind == CELL_EMPTY) {
+                C.Len[Row] = VDJ_EMPTY_LEN;
+                C.Waste += OldLen;
+                break;
+            }
+            size_t Len = mxGetNumberOfElements(pCell);
+            const mxChar *pChar = mxGetChars(pCell);
+            if (Len > OldLen) { //Does not fit in place
+                C.Waste += OldLen;
+                C.Off[Row] = C.Arena.size();
+                C.Arena.resize(C.Arena.size() + Len);
+            } else {
+                C.Waste += OldLen - Len;
+            }
+            for (size_t j = 0; j < Len; j++) {
+                C.Arena[C.Off[Row] + j] = (char) pChar[j];
+            }
+            C.Len[Row] = (unsigned int) Len;
+            if (C.Waste > 65536 && C.Waste*2 > C.Arena.size()) { compactArena(C); }
+            break;
+        }
+        default:
+            if (C.Any[Row] != NULL) { mxDestroyArray(C.Any[Row]); }
+            C.Any[Row] = NULL;
+            if (Kind != CELL_EMPTY) {
+                C.Any[Row] = mxDuplicateArray(pCell);
+                mexMakeArrayPersistent(C.Any[Row]);
+            }
+    }
+}
+
+// Returns a pointer to the 8-bit chars of a DICT or STR cell, or NULL for []
+const char *getVdjStr(const vdj_column &C, size_t Row, unsigned int &Len) {
+    Len = 0;
+    if (C.Kind == VDJ_DICT && C.Code[Row] > 0) {
+        const std::string &Str = C.Dict[C.Code[Row]-1];
+        Len = (unsigned int) Str.size();
+        return Str.data();
+    }
+    if (C.Kind == VDJ_STR && C.Len[Row] != VDJ_EMPTY_LEN) {
+        Len = C.Len[Row];
+        return C.Arena.data() + C.Off[Row];
+    }
+    return NULL;
+}
@@ -0,0 +1,44 @@
+#ifndef VDJ_TABLE_TOOL_HPP
+#define VDJ_TABLE_TOOL_HPP
+
+#include "mex.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+enum vdj_kind { VDJ_NUM = 0, VDJ_DICT = 1, VDJ_STR = 2, VDJ_ANY = 3 };
+
+// vdj_column stores 1 VDJdata column in the most compact typed form
+struct vdj_column {
+    std::string Name;                       //Name: column name from VDJheader
+    vdj_kind Kind = VDJ_NUM;                //Kind: storage type of this column
+    std::vector<double> Num;                //NUM: value of each row
+    std::vector<unsigned char> Has;         //NUM: 0 for an empty [] cell, 1 for a value
+    std::vector<unsigned int> Code;         //DICT: 1-based index of each row in Dict. 0 for [].
+    std::vector<std::string> Dict;          //DICT: unique strings (ex: gene names)
+    std::unordered_map<std::string, unsigned int> DictIdx; //DICT: string to Code
+    std::vector<unsigned long long> Off;    //STR: start of each row in Arena
+    std::vector<unsigned int> Len;          //STR: length of each row. VDJ_EMPTY_LEN for [].
+    std::string Arena;                      //STR: 8-bit chars of all rows (ex: sequences)
+    unsigned long long Waste = 0;           //STR: bytes in Arena no longer used by any row
+    std::vector<mxArray*> Any;              //ANY: persistent copy of each cell
+};
+
+// vdj_table stores a VDJdata cell array as typed columns
+struct vdj_table {
+    std::vector<vdj_column> Col;            //Col: 1 per VDJheader column
+    size_t NumRow = 0;                      //NumRow: number of sequences
+};
+
+const unsigned int VDJ_EMPTY_LEN = 0xFFFFFFFF;
+
+void buildVdjTable(const mxArray*, const mxArray*, vdj_table&);
+void appendVdjRows(const mxArray*, vdj_table&);
+void clearVdjTable(vdj_table&);
+size_t getVdjBytes(const vdj_table&);
+int findVdjColumn(const vdj_table&, const char*);
+mxArray *getVdjCell(const vdj_column&, size_t);
+void setVdjCell(vdj_column&, size_t, const mxArray*);
+const char *getVdjStr(const vdj_column&, size_t, unsigned int&);
+
+#endif
@@ -17,6 +17,14 @@ reference for BRILIA.
 
   ... = alignSeqMEX(SeqA, SeqB, MissRate, Alphabet, ExactMatch, TrimSide,
           PenaltySide, PreferSide)
+
+  ... = alignSeqMEX(..., PreferSide, Output)
+
+  Stats = alignSeqMEX('cache')
+
+  alignSeqMEX('clearcache')
+
+  Cpu = alignSeqMEX('cpu')
   
   INPUTS
     SeqA: Character sequence. X = wildcard match. Z = do not match.
@@ -36,6 +44,13 @@ reference for BRILIA.
       Penalty is (unused nt)^2.
     PreferSide ['n' 'l' 'r']: If a tie alignment is found, will favor the
       alignment closers to this side of SeqA.
+    Output ['full' 'score' 'best']: Which outputs to make.
+      'full': all outputs (default).
+      'score': only Score(2, :) and StartAt. Score(1, :) and MatchAt are
+        NaN, and there is no Alignment. Skips the final match of the best
+        offset, for screening passes that only rank or place SeqB.
+      'best': all outputs, but Alignment is only made for the SeqB with
+        the highest Score(2, :). Others are [].
 
   OUTPUTS
     Score: 2x1 matrix, Score(1) is the # of hits, and Score(2) is the
@@ -51,6 +66,23 @@ reference for BRILIA.
     Alignment: 3xM char matrix showing the alignment results of SeqA and
       SeqB. '|' in the 2nd char row marks locations of matches, while ' '
       in the 1st and 3rd row are unmatched letters.
+    Stats: structure of the alignment cache with Hits, Misses, Entries,
+      Bytes, and MaxBytes
+    Cpu: structure of the SIMD level in use (Level), the fraction of seq
+      compares redone with the scalar code (VerifyRate), and the number of
+      Checked compares and Mismatches
+
+  NOTE
+    The results of each SeqA vs SeqB set are kept in a LRU cache (see
+    AlignCacheTool), so repeated reads aligned to the same gene set with
+    the same options are not realigned. The cache size is set by the
+    BRILIA_ALIGN_CACHE_MB environment variable (default 64, 0 = off) when
+    the cache is first used or after 'clearcache'.
+
+    The seq compare uses the best SIMD level of the CPU (see CpuTool). Set
+    BRILIA_CPU_LEVEL to 'scalar', 'sse42', 'avx2', or 'avx512' to use a
+    lower level, and BRILIA_CPU_VERIFY to a fraction 0 to 1 to redo that
+    many compares with the scalar code. Mismatches give a warning.
 
 --------------------------------------------------------------------------
   EXAMPLES
@@ -146,12 +178,46 @@ reference for BRILIA.
 */
 
 #include "AlignTool.hpp"
+#include "AlignCacheTool.hpp"
+#include "CpuTool.hpp"
+#include "StatTool.hpp"
+#include <vector>
+#include <string>
+#include <ctype.h>
         
 void mexFunction(int nlhs,        mxArray *plhs[],
                  int nrhs, const  mxArray *prhs[]) {
     
-    if (nrhs < 2 || nrhs > 8) {
-        mexErrMsgIdAndTxt("alignSeqMEX:nrhs", "Incorrect number of inputs. Min is 2. Max is 8.");\
+    if (nrhs == 1 && mxIsChar(prhs[0])) {
+        char *pCmd = mxArrayToString(prhs[0]);
+        std::string Cmd(pCmd);
+        mxFree(pCmd);
+        if (Cmd == "cache") {
+            align_cache_stats Stats = getAlignCacheStats();
+            const char *Fields[5] = {"Hits", "Misses", "Entries", "Bytes", "MaxBytes"};
+            plhs[0] = mxCreateStructMatrix(1, 1, 5, Fields);
+            mxSetField(plhs[0], 0, "Hits", mxCreateDoubleScalar((double) Stats.Hits));
+            mxSetField(plhs[0], 0, "Misses", mxCreateDoubleScalar((double) Stats.Misses));
+            mxSetField(plhs[0], 0, "Entries", mxCreateDoubleScalar((double) Stats.Entries));
+            mxSetField(plhs[0], 0, "Bytes", mxCreateDoubleScalar((double) Stats.Bytes));
+            mxSetField(plhs[0], 0, "MaxBytes", mxCreateDoubleScalar((double) Stats.MaxBytes));
+            return;
+        } else if (Cmd == "clearcache") {
+            clearAlignCache();
+            return;
+        } else if (Cmd == "cpu") {
+            cpu_verify_stats Stats = getCpuVerifyStats();
+            const char *Fields[4] = {"Level", "VerifyRate", "Checked", "Mismatches"};
+            plhs[0] = mxCreateStructMatrix(1, 1, 4, Fields);
+            mxSetField(plhs[0], 0, "Level", mxCreateString(getCpuLevelName(Stats.Level)));
+            mxSetField(plhs[0], 0, "VerifyRate", mxCreateDoubleScalar(Stats.VerifyRate));
+            mxSetField(plhs[0], 0, "Checked", mxCreateDoubleScalar((double) Stats.Checked));
+            mxSetField(plhs[0], 0, "Mismatches", mxCreateDoubleScalar((double) Stats.Mismatches));
+            return;
+        }
+    }
+    if (nrhs < 2 || nrhs > 9) {
+        mexErrMsgIdAndTxt("alignSeqMEX:nrhs", "Incorrect number of inputs. Min is 2. Max is 9.");
     }
     if (nlhs > 4) {
         mexErrMsgIdAndTxt("alignSeqMEX:nlhs", "Too many outputs. Max is 4.");
@@ -163,6 +229,7 @@ void mexFunction(int nlhs,        mxArray *plhs[],
     mxChar TrimSide    = 'n';
     mxChar PenaltySide = 'n';
     mxChar PreferSide  = 'n';
+    mxChar Output      = 'f';
     if (nrhs >= 3) {
         if (!mxIsDouble(prhs[2])) { mexErrMsgIdAndTxt("alignSeqMEX:prhs", "Input3: MissRate must be a scalar between 0.0 to 1.0."); }
         MissRate = mxGetScalar(prhs[2]);
@@ -181,6 +248,12 @@ void mexFunction(int nlhs,        mxArray *plhs[],
                         if (nrhs >= 8) {
                             if(!mxIsChar(prhs[7])) { mexErrMsgIdAndTxt("alignSeqMEX:prhs", "Input8: PreferSide must be a char 'n' (none), 'l' (left), 'r' (right)."); }
                             PreferSide = *mxGetChars(prhs[7]);
+                            if (nrhs >= 9) {
+                                if (!mxIsChar(prhs[8]) || mxGetNumberOfElements(prhs[8]) < 1) { mexErrMsgIdAndTxt("alignSeqMEX:prhs", "Input9: Output must be 'full', 'score', or 'best'."); }
+                                Output = tolower(*mxGetChars(prhs[8]));
+                                if (Output != 'f' && Output != 's' && Output != 'b') { mexErrMsgIdAndTxt("alignSeqMEX:prhs", "Input9: Output must be 'full', 'score', or 'best'."); }
+                                if (Output == 's' && nlhs >= 4) { mexErrMsgIdAndTxt("alignSeqMEX:nlhs", "Output 'score' has no Alignment output. Max is 3."); }
+                            }
                         }
                     }
                 }
@@ -199,7 +272,13 @@ void mexFunction(int nlhs,        mxArray *plhs[],
     }
     
     mwSize Z = mxIsCell(prhs[1]) ? mxGetNumberOfElements(prhs[1]) : 1;
-    align_info AI[Z];
+    std::vector<align_info> AI(Z);
+    bool ScoreOnly = Output == 's';
+    mxChar Opt[6] = {Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, (mxChar) (ScoreOnly ? 's' : 'f')}; //'best' has the same AI as 'full'
+    ref_set_ptr RefSet = getRefSetInfo(prhs[1]);
+    std::string Key = buildAlignKey(pSeqA, LenA, *RefSet, MissRate, Opt);
+    bool IsCached = findAlignCache(Key, RefSet, AI);
+    if (!IsCached) { STAT_REF_SET(STAT_ALIGN_SEQ, Z); }
     if (mxIsCell(prhs[1])) {
         mwSize MaxN = 0, CurN = 0;
         for (mwSize j = 0; j < Z; j++) {
@@ -207,19 +286,21 @@ void mexFunction(int nlhs,        mxArray *plhs[],
             if (CurN > MaxN) { MaxN = CurN; }
         }
         bool pMatch[MaxN > LenA ? MaxN : LenA];
-        for (mwSize j = 0; j < Z; j++) {
+        for (mwSize j = 0; j < Z && !IsCached; j++) {
             pSeqB = mxGetChars(mxGetCell(prhs[1], j));
             LenB = mxGetN(mxGetCell(prhs[1], j));
-            alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI[j], pMatch); 
+            alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI[j], pMatch, ScoreOnly); 
         }
     } else {
         pSeqB = mxGetChars(prhs[1]);
         LenB = mxGetN(prhs[1]);
         bool pMatch[LenB > LenA ? LenB : LenA];
-        alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI[0], pMatch); 
+        if (!IsCached) {
+            alignSeq(pSeqA, pSeqB, LenA, LenB, MissRate, Alphabet, ExactMatch, TrimSide, PenaltySide, PreferSide, AI[0], pMatch, ScoreOnly); 
+        }
     }
+    if (!IsCached) { addAlignCache(Key, RefSet, AI); }
 
-    int q = 0; //generic counter
     if (nlhs >= 1) {
         plhs[0] = mxCreateDoubleMatrix(2, Z, mxREAL);
         double *pScore = mxGetPr(plhs[0]);
@@ -242,15 +323,20 @@ void mexFunction(int nlhs,        mxArray *plhs[],
         plhs[2] = mxCreateDoubleMatrix(2, Z, mxREAL);
         double *pMatchAt = mxGetPr(plhs[2]);
         for (mwSize z = 0; z < Z; z++) {
-            pMatchAt[2*z]   = AI[z].MatchS + 1;
-            pMatchAt[2*z+1] = AI[z].MatchE + 1;
+            pMatchAt[2*z]   = ScoreOnly ? mxGetNaN() : AI[z].MatchS + 1;
+            pMatchAt[2*z+1] = ScoreOnly ? mxGetNaN() : AI[z].MatchE + 1;
         }
     }
 
     if (nlhs >= 4) { //Make the alignment
         if (mxIsCell(prhs[1])) {
             plhs[3] = mxCreateCellArray(2, mxGetDimensions(prhs[1]));
+            double MaxScore = -INFINITY;
             for (mwSize z = 0; z < Z; z++) {
+                if (AI[z].Score > MaxScore) { MaxScore = AI[z].Score; }
+            }
+            for (mwSize z = 0; z < Z; z++) {
+                if (Output == 'b' && AI[z].Score < MaxScore) { continue; }
                 pSeqB = mxGetChars(mxGetCell(prhs[1], z));
                 LenB = mxGetN(mxGetCell(prhs[1], z));
                 mxSetCell(plhs[3], z, buildAlignment(pSeqA, pSeqB, LenA, LenB, AI[z]));
@@ -259,4 +345,6 @@ void mexFunction(int nlhs,        mxArray *plhs[],
             plhs[3] = buildAlignment(pSeqA, pSeqB, LenA, LenB, AI[0]);
         }
     }
+
+    warnCpuMismatch("alignSeqMEX");
 }
\ No newline at end of file
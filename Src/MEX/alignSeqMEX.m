@@ -16,6 +16,14 @@
 %
 %  ... = alignSeqMEX(SeqA, SeqB, MissRate, Alphabet, ExactMatch, TrimSide,
 %          PenaltySide, PreferSide)
+%
+%  ... = alignSeqMEX(..., PreferSide, Output)
+%
+%  Stats = alignSeqMEX('cache')
+%
+%  alignSeqMEX('clearcache')
+%
+%  Cpu = alignSeqMEX('cpu')
 %  
 %  INPUTS
 %    SeqA: Character sequence. X = wildcard match. Z = do not match.
@@ -35,6 +43,13 @@
 %      Penalty is (unused nt)^2.
 %    PreferSide ['n' 'l' 'r']: If a tie alignment is found, will favor the
 %      alignment closers to this side of SeqA.
+%    Output ['full' 'score' 'best']: Which outputs to make.
+%      'full': all outputs (default).
+%      'score': only Score(2, :) and StartAt. Score(1, :) and MatchAt are
+%        NaN, and there is no Alignment. Skips the final match of the best
+%        offset, for screening passes that only rank or place SeqB.
+%      'best': all outputs, but Alignment is only made for the SeqB with
+%        the highest Score(2, :). Others are [].
 %
 %  OUTPUTS
 %    Score: 2x1 matrix, Score(1) is the # of hits, and Score(2) is the
@@ -50,6 +65,23 @@
 %    Alignment: 3xM char matrix showing the alignment results of SeqA and
 %      SeqB. '|' in the 2nd char row marks locations of matches, while ' '
 %      in the 1st and 3rd row are unmatched letters.
+%    Stats: structure of the alignment cache with Hits, Misses, Entries,
+%      Bytes, and MaxBytes
+%    Cpu: structure of the SIMD level in use (Level), the fraction of seq
+%      compares redone with the scalar code (VerifyRate), and the number of
+%      Checked compares and Mismatches
+%
+%  NOTE
+%    The results of each SeqA vs SeqB set are kept in a LRU cache (see
+%    AlignCacheTool), so repeated reads aligned to the same gene set with
+%    the same options are not realigned. The cache size is set by the
+%    BRILIA_ALIGN_CACHE_MB environment variable (default 64, 0 = off) when
+%    the cache is first used or after 'clearcache'.
+%
+%    The seq compare uses the best SIMD level of the CPU (see CpuTool). Set
+%    BRILIA_CPU_LEVEL to 'scalar', 'sse42', 'avx2', or 'avx512' to use a
+%    lower level, and BRILIA_CPU_VERIFY to a fraction 0 to 1 to redo that
+%    many compares with the scalar code. Mismatches give a warning.
 %
 %--------------------------------------------------------------------------
 %  EXAMPLES
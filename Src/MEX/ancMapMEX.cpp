@@ -0,0 +1,448 @@
+/*
+ancMapMEX will do the tree and graph operations on an AncMap (the
+ancestry map of [ChildNum ParentNum Par2ChildDist ...]) in linear time,
+for every group of a file at once. The parent of each row is found once
+with a hash table, so no command searches the whole AncMap per node. Each
+group is done in its own thread.
+
+  CycleLoc = ancMapMEX('cycle', AncMap, GrpNum)
+
+  ClustNum = ancMapMEX('clust', AncMap, GrpNum)
+
+  AncMap = ancMapMEX('renumber', AncMap, GrpNum)
+
+  [ChildIdx, ChildPtr, ChildCount] = ancMapMEX('child', AncMap, GrpNum)
+
+  [Depth, RootDist, RootIdx] = ancMapMEX('depth', AncMap, GrpNum)
+
+  [TreeStat, UnqGrpNum] = ancMapMEX('stat', AncMap, GrpNum)
+
+  AncMap = ancMapMEX('rooted', PairDist)
+
+  INPUT
+    AncMap: MxK ancestry map, where col 1 is the child number, col 2 is
+      the parent number (0 for none), and col 3 is the parent to child
+      distance. Other columns are kept as is.
+    GrpNum: Mx1 group number of each row, such that parents are only
+      searched within the same group (ex: clonotype GrpNum). Rows of a
+      group do not need to be next to each other. Use [] for 1 group.
+    PairDist: MxM distance matrix, where row is the parent and col is the
+      child, and row 1 and col 1 are the root (see calcRootedAncMap)
+
+  OUTPUT
+    CycleLoc: Mx1 logical marking rows in a parent-child cycle
+    ClustNum: Mx1 number of the connected tree of each row, numbered from 1
+      in each group in the order of the 1st row of each tree
+    AncMap: for 'renumber', AncMap where col 1 is 1 to Mg and col 2 is the
+      relative row of the parent in each group of Mg rows (0 if none). For
+      'rooted', the Mx3 AncMap made by calcRootedAncMap.
+    ChildIdx: Cx1 row numbers of the children of all rows, such that the
+      children of row j are ChildIdx(ChildPtr(j):ChildPtr(j+1)-1)
+    ChildPtr: (M+1)x1 start of the children of each row in ChildIdx
+    ChildCount: Mx1 number of children of each row
+    Depth: Mx1 number of links from the root to each row (0 for roots)
+    RootDist: Mx1 sum of col 3 from the root to each row, not counting the
+      root's own col 3. Same as Depth if AncMap has no col 3.
+    RootIdx: Mx1 row number of the root of each row
+      NOTE: Depth, RootDist, and RootIdx are NaN for rows in or under a cycle.
+    TreeStat: Gx5 matrix of [NumNode NumLeaf MaxDepth Height TrunkLen] of
+      each group, where Height is the max RootDist and TrunkLen is the sum
+      of col 3 from the 1st root of the group down to the 1st node that
+      does not have exactly 1 child
+    UnqGrpNum: Gx1 group numbers of TreeStat, in the order they appear
+
+  NOTE
+    The child numbers in col 1 should be unique within a group. If not, the
+    1st row with that number is the parent.
+
+    'rooted' gives the same results as the MATLAB-only calcRootedAncMap,
+    but uses O(M^2) time instead of O(M^3).
+
+  EXAMPLE
+    AncMap = [
+          1     0     2;
+          3     1     1;
+          5     3     4;
+          7     3     5];
+    [ChildIdx, ChildPtr] = ancMapMEX('child', AncMap, []);
+    [Depth, RootDist] = ancMapMEX('depth', AncMap, [])
+    Depth =
+         0
+         1
+         2
+         2
+    RootDist =
+         0
+         1
+         5
+         6
+
+  See also calcAncMap, calcRootedAncMap, findTreeCycle, findTreeClust,
+  renumberAncMap, calcTreeCoord, getTrunkData, getTreeLenDist
+*/
+
+#include "ThreadTool.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <math.h>
+
+// anc_groups stores the rows of each group and the relative row of each row's parent
+struct anc_groups {
+    std::vector<double> GrpNum;            //GrpNum: group number of each group, in order of appearance
+    std::vector<std::vector<int>> Row;     //Row: rows of each group, in row order
+    std::vector<std::vector<int>> Par;     //Par: relative row in the group of each row's parent, or -1
+};
+
+// Groups the rows by GrpNum, and finds the parent of each row within its group
+static void buildAncGroups(const double *pAncMap, mwSize M, const mxArray *pGrpNum, anc_groups &AG) {
+    if (pGrpNum == NULL || mxIsEmpty(pGrpNum)) {
+        AG.GrpNum.assign(1, 1);
+        AG.Row.assign(1, std::vector<int>(M));
+        std::iota(AG.Row[0].begin(), AG.Row[0].end(), 0);
+    } else {
+        const double *pGrp = mxGetPr(pGrpNum);
+        std::unordered_map<double, int> GrpMap;
+        int NaNGrp = -1;
+        for (mwSize j = 0; j < M; j++) {
+            int g;
+            if (pGrp[j] != pGrp[j]) {
+                if (NaNGrp < 0) {
+                    NaNGrp = (int) AG.GrpNum.size();
+                    AG.GrpNum.push_back(pGrp[j]);
+                    AG.Row.push_back(std::vector<int>());
+                }
+                g = NaNGrp;
+            } else {
+                auto Iter = GrpMap.insert(std::make_pair(pGrp[j], (int) AG.GrpNum.size()));
+                if (Iter.second) {
+                    AG.GrpNum.push_back(pGrp[j]);
+                    AG.Row.push_back(std::vector<int>());
+                }
+                g = Iter.first->second;
+            }
+            AG.Row[g].push_back((int) j);
+        }
+    }
+
+    const double *pChild = pAncMap;
+    const double *pParent = pAncMap + M;
+    AG.Par.resize(AG.Row.size());
+    parallelFor(AG.Row.size(), 1, [&](size_t Beg, size_t End) {
+        for (size_t g = Beg; g < End; g++) {
+            const std::vector<int> &Row = AG.Row[g];
+            std::unordered_map<double, int> First;
+            First.reserve(Row.size());
+            for (size_t i = 0; i < Row.size(); i++) {
+                double Num = pChild[Row[i]];
+                if (Num == Num) { First.insert(std::make_pair(Num, (int) i)); }
+            }
+            std::vector<int> &Par = AG.Par[g];
+            Par.assign(Row.size(), -1);
+            for (size_t i = 0; i < Row.size(); i++) {
+                auto Iter = First.find(pParent[Row[i]]);
+                if (Iter != First.end()) { Par[i] = Iter->second; }
+            }
+        }
+    });
+}
+
+// Marks the rows in a cycle by removing leaves until none are left
+static void findCycle(const std::vector<int> &Par, std::vector<bool> &InCycle) {
+    size_t N = Par.size();
+    std::vector<int> NumChild(N, 0), Leaf;
+    for (size_t i = 0; i < N; i++) {
+        if (Par[i] >= 0) { NumChild[Par[i]]++; }
+    }
+    InCycle.assign(N, true);
+    for (size_t i = 0; i < N; i++) {
+        if (NumChild[i] == 0) { Leaf.push_back((int) i); }
+    }
+    while (!Leaf.empty()) {
+        int i = Leaf.back();
+        Leaf.pop_back();
+        InCycle[i] = false;
+        if (Par[i] >= 0 && --NumChild[Par[i]] == 0) { Leaf.push_back(Par[i]); }
+    }
+}
+
+// Returns the root of Idx, halving the path along the way
+static int findRoot(std::vector<int> &Link, int Idx) {
+    while (Link[Idx] != Idx) {
+        Link[Idx] = Link[Link[Idx]];
+        Idx = Link[Idx];
+    }
+    return Idx;
+}
+
+// Finds the depth, root distance, and relative root of each row. -1 root for rows in or under a cycle.
+static void findDepth(const std::vector<int> &Par, const double *pDist, const std::vector<int> &Row,
+                      std::vector<int> &Depth, std::vector<double> &RootDist, std::vector<int> &Root) {
+    size_t N = Par.size();
+    std::vector<char> State(N, 0); //0 = new, 1 = on path, 2 = done
+    Depth.assign(N, 0);
+    RootDist.assign(N, 0);
+    Root.assign(N, -1);
+    std::vector<int> Path;
+    for (size_t s = 0; s < N; s++) {
+        if (State[s] == 2) { continue; }
+        Path.clear();
+        int i = (int) s;
+        while (i >= 0 && State[i] == 0) {
+            State[i] = 1;
+            Path.push_back(i);
+            i = Par[i];
+        }
+        //i is -1 (past a root), a done row, or a row on the path (a cycle)
+        bool Cyclic = i >= 0 && (State[i] == 1 || Root[i] < 0);
+        for (size_t k = Path.size(); k-- > 0; ) {
+            int j = Path[k];
+            State[j] = 2;
+            if (Cyclic) { continue; }
+            if (Par[j] < 0) {
+                Root[j] = j;
+            } else {
+                Root[j] = Root[Par[j]];
+                Depth[j] = Depth[Par[j]] + 1;
+                RootDist[j] = RootDist[Par[j]] + (pDist != NULL ? pDist[Row[j]] : 1);
+            }
+        }
+    }
+}
+
+// Links the PairDist rows to the root like calcRootedAncMap, adding the
+// closest (lowest row on ties) unlinked cols in rounds, with O(M) per round.
+static void linkRooted(const double *pDist, mwSize M, double *pAncMap) {
+    std::vector<bool> Active(M, true);
+    std::vector<double> Best(M, std::numeric_limits<double>::quiet_NaN());
+    std::vector<int> BestRow(M, -1);
+    std::vector<int> NewRow;
+    for (mwSize c = 0; c < M; c++) {
+        pAncMap[c] = (double) c + 1;
+        pAncMap[c + M] = 0;
+        pAncMap[c + 2*M] = 0;
+    }
+    if (M == 0) { return; }
+    Active[0] = false;
+    NewRow.push_back(0);
+    mwSize NumActive = M - 1;
+    while (NumActive > 0) {
+        //Update the closest linked row of each unlinked col with the rows linked last round
+        for (mwSize c = 0; c < M; c++) {
+            if (!Active[c]) { continue; }
+            for (size_t k = 0; k < NewRow.size(); k++) {
+                int r = NewRow[k];
+                double Dist = pDist[r + c*M];
+                if (Dist != Dist) { continue; }
+                if (BestRow[c] < 0 || Dist < Best[c] || (Dist == Best[c] && r < BestRow[c])) {
+                    Best[c] = Dist;
+                    BestRow[c] = r;
+                }
+            }
+        }
+
+        double MinDist = INFINITY;
+        bool HasMin = false;
+        for (mwSize c = 0; c < M; c++) {
+            if (Active[c] && BestRow[c] >= 0 && (!HasMin || Best[c] < MinDist)) {
+                MinDist = Best[c];
+                HasMin = true;
+            }
+        }
+        if (!HasMin) { break; } //only NaN distances left
+
+        NewRow.clear();
+        for (mwSize c = 0; c < M; c++) {
+            if (Active[c] && BestRow[c] >= 0 && Best[c] == MinDist) {
+                pAncMap[c + M] = (double) BestRow[c] + 1;
+                pAncMap[c + 2*M] = Best[c];
+                NewRow.push_back((int) c);
+            }
+        }
+        for (size_t k = 0; k < NewRow.size(); k++) {
+            Active[NewRow[k]] = false;
+        }
+        NumActive -= NewRow.size();
+    }
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || !mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("ancMapMEX:nrhs", "Need a command string and an AncMap.");
+    }
+    char *pCmd = mxArrayToString(prhs[0]);
+    std::string Cmd(pCmd);
+    mxFree(pCmd);
+
+    if (!mxIsDouble(prhs[1]) || mxGetNumberOfDimensions(prhs[1]) > 2) {
+        mexErrMsgIdAndTxt("ancMapMEX:prhs", "Input2: must be a double matrix.");
+    }
+    const double *pAncMap = mxGetPr(prhs[1]);
+    mwSize M = mxGetM(prhs[1]);
+    mwSize K = mxGetN(prhs[1]);
+
+    if (Cmd == "rooted") {
+        if (M != K) {
+            mexErrMsgIdAndTxt("ancMapMEX:prhs", "Input2: PairDist must be a MxM matrix.");
+        }
+        plhs[0] = mxCreateDoubleMatrix(M, 3, mxREAL);
+        linkRooted(pAncMap, M, mxGetPr(plhs[0]));
+        return;
+    }
+
+    if (M > 0 && K < 2) {
+        mexErrMsgIdAndTxt("ancMapMEX:prhs", "Input2: AncMap must have at least 2 columns.");
+    }
+    if (nrhs < 3) {
+        mexErrMsgIdAndTxt("ancMapMEX:nrhs", "Need a GrpNum, or [] for 1 group.");
+    }
+    if (!mxIsEmpty(prhs[2]) && (!mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != M)) {
+        mexErrMsgIdAndTxt("ancMapMEX:prhs", "Input3: GrpNum must be a Mx1 double matrix or [].");
+    }
+    anc_groups AG;
+    buildAncGroups(pAncMap, M, prhs[2], AG);
+    size_t NumGrp = AG.Row.size();
+    const double *pDist = K >= 3 ? pAncMap + 2*M : NULL;
+
+    if (Cmd == "cycle") {
+        plhs[0] = mxCreateLogicalMatrix(M, 1);
+        mxLogical *pOut = mxGetLogicals(plhs[0]);
+        parallelFor(NumGrp, 1, [&](size_t Beg, size_t End) {
+            std::vector<bool> InCycle;
+            for (size_t g = Beg; g < End; g++) {
+                findCycle(AG.Par[g], InCycle);
+                for (size_t i = 0; i < InCycle.size(); i++) { pOut[AG.Row[g][i]] = InCycle[i]; }
+            }
+        });
+
+    } else if (Cmd == "clust") {
+        plhs[0] = mxCreateDoubleMatrix(M, 1, mxREAL);
+        double *pOut = mxGetPr(plhs[0]);
+        parallelFor(NumGrp, 1, [&](size_t Beg, size_t End) {
+            for (size_t g = Beg; g < End; g++) {
+                const std::vector<int> &Par = AG.Par[g];
+                std::vector<int> Link(Par.size()), Num(Par.size(), 0);
+                std::iota(Link.begin(), Link.end(), 0);
+                for (size_t i = 0; i < Par.size(); i++) {
+                    if (Par[i] < 0) { continue; }
+                    int A = findRoot(Link, (int) i), B = findRoot(Link, Par[i]);
+                    if (A != B) { Link[std::max(A, B)] = std::min(A, B); }
+                }
+                int NumClust = 0;
+                for (size_t i = 0; i < Par.size(); i++) {
+                    int &ClustNum = Num[findRoot(Link, (int) i)];
+                    if (ClustNum == 0) { ClustNum = ++NumClust; }
+                    pOut[AG.Row[g][i]] = ClustNum;
+                }
+            }
+        });
+
+    } else if (Cmd == "renumber") {
+        plhs[0] = mxDuplicateArray(prhs[1]);
+        double *pOut = mxGetPr(plhs[0]);
+        parallelFor(NumGrp, 1, [&](size_t Beg, size_t End) {
+            for (size_t g = Beg; g < End; g++) {
+                for (size_t i = 0; i < AG.Row[g].size(); i++) {
+                    pOut[AG.Row[g][i]] = (double) i + 1;
+                    pOut[AG.Row[g][i] + M] = (double) AG.Par[g][i] + 1;
+                }
+            }
+        });
+
+    } else if (Cmd == "child") {
+        std::vector<size_t> NumChild(M + 1, 0);
+        for (size_t g = 0; g < NumGrp; g++) {
+            for (size_t i = 0; i < AG.Row[g].size(); i++) {
+                if (AG.Par[g][i] >= 0) { NumChild[AG.Row[g][AG.Par[g][i]]]++; }
+            }
+        }
+        std::vector<size_t> Ptr(M + 1, 0);
+        for (mwSize j = 0; j < M; j++) { Ptr[j+1] = Ptr[j] + NumChild[j]; }
+        plhs[0] = mxCreateDoubleMatrix(Ptr[M], 1, mxREAL);
+        double *pChildIdx = mxGetPr(plhs[0]);
+        std::vector<size_t> Fill(Ptr.begin(), Ptr.end() - 1);
+        for (size_t g = 0; g < NumGrp; g++) {
+            for (size_t i = 0; i < AG.Row[g].size(); i++) {
+                if (AG.Par[g][i] >= 0) { pChildIdx[Fill[AG.Row[g][AG.Par[g][i]]]++] = AG.Row[g][i] + 1; }
+            }
+        }
+        if (nlhs >= 2) {
+            plhs[1] = mxCreateDoubleMatrix(M + 1, 1, mxREAL);
+            for (mwSize j = 0; j <= M; j++) { mxGetPr(plhs[1])[j] = (double) Ptr[j] + 1; }
+        }
+        if (nlhs >= 3) {
+            plhs[2] = mxCreateDoubleMatrix(M, 1, mxREAL);
+            for (mwSize j = 0; j < M; j++) { mxGetPr(plhs[2])[j] = (double) NumChild[j]; }
+        }
+
+    } else if (Cmd == "depth") {
+        const double NaN = std::numeric_limits<double>::quiet_NaN();
+        plhs[0] = mxCreateDoubleMatrix(M, 1, mxREAL);
+        plhs[1] = mxCreateDoubleMatrix(M, 1, mxREAL);
+        plhs[2] = mxCreateDoubleMatrix(M, 1, mxREAL);
+        double *pDepth = mxGetPr(plhs[0]), *pRootDist = mxGetPr(plhs[1]), *pRootIdx = mxGetPr(plhs[2]);
+        parallelFor(NumGrp, 1, [&](size_t Beg, size_t End) {
+            std::vector<int> Depth, Root;
+            std::vector<double> RootDist;
+            for (size_t g = Beg; g < End; g++) {
+                const std::vector<int> &Row = AG.Row[g];
+                findDepth(AG.Par[g], pDist, Row, Depth, RootDist, Root);
+                for (size_t i = 0; i < Row.size(); i++) {
+                    bool Valid = Root[i] >= 0;
+                    pDepth[Row[i]] = Valid ? Depth[i] : NaN;
+                    pRootDist[Row[i]] = Valid ? RootDist[i] : NaN;
+                    pRootIdx[Row[i]] = Valid ? Row[Root[i]] + 1 : NaN;
+                }
+            }
+        });
+
+    } else if (Cmd == "stat") {
+        plhs[0] = mxCreateDoubleMatrix(NumGrp, 5, mxREAL);
+        double *pStat = mxGetPr(plhs[0]);
+        parallelFor(NumGrp, 1, [&](size_t Beg, size_t End) {
+            std::vector<int> Depth, Root;
+            std::vector<double> RootDist;
+            for (size_t g = Beg; g < End; g++) {
+                const std::vector<int> &Par = AG.Par[g];
+                const std::vector<int> &Row = AG.Row[g];
+                findDepth(Par, pDist, Row, Depth, RootDist, Root);
+                std::vector<int> NumChild(Par.size(), 0), OnlyChild(Par.size(), -1);
+                for (size_t i = 0; i < Par.size(); i++) {
+                    if (Par[i] >= 0) {
+                        NumChild[Par[i]]++;
+                        OnlyChild[Par[i]] = (int) i;
+                    }
+                }
+                double NumLeaf = 0, MaxDepth = 0, Height = 0, TrunkLen = 0;
+                int FirstRoot = -1;
+                for (size_t i = 0; i < Par.size(); i++) {
+                    if (NumChild[i] == 0) { NumLeaf++; }
+                    if (Root[i] < 0) { continue; }
+                    MaxDepth = std::max(MaxDepth, (double) Depth[i]);
+                    Height = std::max(Height, RootDist[i]);
+                    if (FirstRoot < 0 && Par[i] < 0) { FirstRoot = (int) i; }
+                }
+                for (int i = FirstRoot; i >= 0 && NumChild[i] == 1; i = OnlyChild[i]) {
+                    TrunkLen += pDist != NULL ? pDist[Row[OnlyChild[i]]] : 1;
+                }
+                pStat[g] = (double) Par.size();
+                pStat[g + NumGrp] = NumLeaf;
+                pStat[g + 2*NumGrp] = MaxDepth;
+                pStat[g + 3*NumGrp] = Height;
+                pStat[g + 4*NumGrp] = TrunkLen;
+            }
+        });
+        if (nlhs >= 2) {
+            plhs[1] = mxCreateDoubleMatrix(NumGrp, 1, mxREAL);
+            std::copy(AG.GrpNum.begin(), AG.GrpNum.end(), mxGetPr(plhs[1]));
+        }
+
+    } else {
+        mexErrMsgIdAndTxt("ancMapMEX:prhs", "Input1: Unknown command '%s'.", Cmd.c_str());
+    }
+}
@@ -0,0 +1,82 @@
+%ancMapMEX will do the tree and graph operations on an AncMap (the
+%ancestry map of [ChildNum ParentNum Par2ChildDist ...]) in linear time,
+%for every group of a file at once. The parent of each row is found once
+%with a hash table, so no command searches the whole AncMap per node. Each
+%group is done in its own thread.
+%
+%  CycleLoc = ancMapMEX('cycle', AncMap, GrpNum)
+%
+%  ClustNum = ancMapMEX('clust', AncMap, GrpNum)
+%
+%  AncMap = ancMapMEX('renumber', AncMap, GrpNum)
+%
+%  [ChildIdx, ChildPtr, ChildCount] = ancMapMEX('child', AncMap, GrpNum)
+%
+%  [Depth, RootDist, RootIdx] = ancMapMEX('depth', AncMap, GrpNum)
+%
+%  [TreeStat, UnqGrpNum] = ancMapMEX('stat', AncMap, GrpNum)
+%
+%  AncMap = ancMapMEX('rooted', PairDist)
+%
+%  INPUT
+%    AncMap: MxK ancestry map, where col 1 is the child number, col 2 is
+%      the parent number (0 for none), and col 3 is the parent to child
+%      distance. Other columns are kept as is.
+%    GrpNum: Mx1 group number of each row, such that parents are only
+%      searched within the same group (ex: clonotype GrpNum). Rows of a
+%      group do not need to be next to each other. Use [] for 1 group.
+%    PairDist: MxM distance matrix, where row is the parent and col is the
+%      child, and row 1 and col 1 are the root (see calcRootedAncMap)
+%
+%  OUTPUT
+%    CycleLoc: Mx1 logical marking rows in a parent-child cycle
+%    ClustNum: Mx1 number of the connected tree of each row, numbered from 1
+%      in each group in the order of the 1st row of each tree
+%    AncMap: for 'renumber', AncMap where col 1 is 1 to Mg and col 2 is the
+%      relative row of the parent in each group of Mg rows (0 if none). For
+%      'rooted', the Mx3 AncMap made by calcRootedAncMap.
+%    ChildIdx: Cx1 row numbers of the children of all rows, such that the
+%      children of row j are ChildIdx(ChildPtr(j):ChildPtr(j+1)-1)
+%    ChildPtr: (M+1)x1 start of the children of each row in ChildIdx
+%    ChildCount: Mx1 number of children of each row
+%    Depth: Mx1 number of links from the root to each row (0 for roots)
+%    RootDist: Mx1 sum of col 3 from the root to each row, not counting the
+%      root's own col 3. Same as Depth if AncMap has no col 3.
+%    RootIdx: Mx1 row number of the root of each row
+%      NOTE: Depth, RootDist, and RootIdx are NaN for rows in or under a cycle.
+%    TreeStat: Gx5 matrix of [NumNode NumLeaf MaxDepth Height TrunkLen] of
+%      each group, where Height is the max RootDist and TrunkLen is the sum
+%      of col 3 from the 1st root of the group down to the 1st node that
+%      does not have exactly 1 child
+%    UnqGrpNum: Gx1 group numbers of TreeStat, in the order they appear
+%
+%  NOTE
+%    The child numbers in col 1 should be unique within a group. If not, the
+%    1st row with that number is the parent.
+%
+%    'rooted' gives the same results as the MATLAB-only calcRootedAncMap,
+%    but uses O(M^2) time instead of O(M^3).
+%
+%  EXAMPLE
+%    AncMap = [
+%          1     0     2;
+%          3     1     1;
+%          5     3     4;
+%          7     3     5];
+%    [ChildIdx, ChildPtr] = ancMapMEX('child', AncMap, []);
+%    [Depth, RootDist] = ancMapMEX('depth', AncMap, [])
+%    Depth =
+%         0
+%         1
+%         2
+%         2
+%    RootDist =
+%         0
+%         1
+%         5
+%         6
+%
+%  See also calcAncMap, calcRootedAncMap, findTreeCycle, findTreeClust,
+%  renumberAncMap, calcTreeCoord, getTrunkData, getTreeLenDist
+%
+%
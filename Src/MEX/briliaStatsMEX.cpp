@@ -0,0 +1,120 @@
+/*
+briliaStatsMEX returns the hot-path counters of the seq kernels alignSeq,
+calcSeqShmScore, countHotspots, cmprSeq, and convStrToMatrix, which are
+used by alignSeqMEX, calcPairDistMEX, cmprSeqMEX, countHotspotsMEX,
+convStr2NumMEX, fixIndelMEX, and seedCDR3MEX. The counters are kept in
+per-thread slots that are shared by all MEX files of this MATLAB process,
+so they show where the kernel time goes without a profiler.
+
+  Stats = briliaStatsMEX('get')
+
+  [Stats, BinEdge] = briliaStatsMEX('get')
+
+  briliaStatsMEX('reset')
+
+  OUTPUT
+    Stats: 5x1 structure of each kernel with these fields:
+      Name: kernel name
+      Calls: number of calls
+      Elements: sum of the seq lengths given to the kernel. This is the
+        SeqA length for alignSeq.
+      Nanosec: total time in the kernel, summed over all threads
+      MeanNs: Nanosec / Calls
+      LenHist: 1x32 number of calls per seq length bin
+      RefHist: 1x32 number of alignSeqMEX calls per reference set size
+        bin (number of SeqB). Only for alignSeq.
+      ThreadNanosec: 1xT time of each thread, in the order they 1st
+        called a kernel, to see how evenly the threads are loaded. A
+        thread has 1 slot for all MEX files. Threads past the 63rd are
+        summed in the last one.
+    BinEdge: 1x32 lower edge of each bin: 0, 1, 2, 4, 8, ..., 2^30
+
+  NOTE
+    The counters are only in MEX files compiled with -DBRILIA_STATS, as
+    done by compileMexBRILIA('stats'). Otherwise, all counts stay 0. Each
+    counted call costs about 2 clock reads.
+
+    Times are inclusive. cmprSeq also counts the calls made by alignSeq
+    and calcSeqShmScore.
+
+    Parallel pool workers are separate processes with their own counters.
+    Use parfevalOnAll(@briliaStatsMEX, 1, 'get') to get theirs.
+
+  EXAMPLE
+    compileMexBRILIA('stats')
+    briliaStatsMEX('reset');
+    Score = alignSeqMEX('ACGTACGT', {'ACGTTCGT', 'ACG'});
+    [Stats, BinEdge] = briliaStatsMEX('get');
+    Stats(1)
+      ans =
+             Name: 'alignSeq'
+            Calls: 2
+         Elements: 16
+              ...
+    bar(Stats(1).LenHist)
+
+  See also alignSeqMEX, compileMexBRILIA, benchPipeline
+*/
+
+#include "StatTool.hpp"
+#include <string>
+
+static mxArray *createRowVector(const uint64_t *pCount, int Len) {
+    mxArray *pOut = mxCreateDoubleMatrix(1, Len, mxREAL);
+    double *pData = mxGetPr(pOut);
+    for (int j = 0; j < Len; j++) {
+        pData[j] = (double) pCount[j];
+    }
+    return pOut;
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs != 1) {
+        mexErrMsgIdAndTxt("briliaStatsMEX:nrhs", "Incorrect number of inputs. Expected 1.");
+    }
+    if (!mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("briliaStatsMEX:prhs", "Input1: Command must be 'get' or 'reset'.");
+    }
+    char *pCmd = mxArrayToString(prhs[0]);
+    std::string Cmd(pCmd);
+    mxFree(pCmd);
+
+    if (Cmd == "reset") {
+        if (nlhs > 0) {
+            mexErrMsgIdAndTxt("briliaStatsMEX:nlhs", "Too many outputs. 'reset' has no output.");
+        }
+        resetStat();
+        return;
+    }
+    if (Cmd != "get") {
+        mexErrMsgIdAndTxt("briliaStatsMEX:prhs", "Input1: Command must be 'get' or 'reset'.");
+    }
+    if (nlhs > 2) {
+        mexErrMsgIdAndTxt("briliaStatsMEX:nlhs", "Too many outputs. Max is 2.");
+    }
+
+    const char *pField[] = {"Name", "Calls", "Elements", "Nanosec", "MeanNs", "LenHist", "RefHist", "ThreadNanosec"};
+    plhs[0] = mxCreateStructMatrix(NUM_STAT_KERNEL, 1, 8, pField);
+    int NumSlot = getStatSlotCount();
+    for (int k = 0; k < NUM_STAT_KERNEL; k++) {
+        stat_total T = getStatTotal(k);
+        mxSetField(plhs[0], k, "Name", mxCreateString(getStatKernelName(k)));
+        mxSetField(plhs[0], k, "Calls", mxCreateDoubleScalar((double) T.Calls));
+        mxSetField(plhs[0], k, "Elements", mxCreateDoubleScalar((double) T.Elements));
+        mxSetField(plhs[0], k, "Nanosec", mxCreateDoubleScalar((double) T.Nanosec));
+        mxSetField(plhs[0], k, "MeanNs", mxCreateDoubleScalar(T.Calls > 0 ? (double) T.Nanosec / T.Calls : 0));
+        mxSetField(plhs[0], k, "LenHist", createRowVector(T.LenHist, NUM_STAT_BIN));
+        mxSetField(plhs[0], k, "RefHist", createRowVector(T.RefHist, NUM_STAT_BIN));
+        mxSetField(plhs[0], k, "ThreadNanosec", createRowVector(T.SlotNanosec, NumSlot));
+    }
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateDoubleMatrix(1, NUM_STAT_BIN, mxREAL);
+        double *pEdge = mxGetPr(plhs[1]);
+        for (int b = 0; b < NUM_STAT_BIN; b++) {
+            pEdge[b] = b == 0 ? 0 : (double) (1ULL << (b - 1));
+        }
+    }
+}
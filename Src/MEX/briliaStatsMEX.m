@@ -0,0 +1,57 @@
+%briliaStatsMEX returns the hot-path counters of the seq kernels alignSeq,
+%calcSeqShmScore, countHotspots, cmprSeq, and convStrToMatrix, which are
+%used by alignSeqMEX, calcPairDistMEX, cmprSeqMEX, countHotspotsMEX,
+%convStr2NumMEX, fixIndelMEX, and seedCDR3MEX. The counters are kept in
+%per-thread slots that are shared by all MEX files of this MATLAB process,
+%so they show where the kernel time goes without a profiler.
+%
+%  Stats = briliaStatsMEX('get')
+%
+%  [Stats, BinEdge] = briliaStatsMEX('get')
+%
+%  briliaStatsMEX('reset')
+%
+%  OUTPUT
+%    Stats: 5x1 structure of each kernel with these fields:
+%      Name: kernel name
+%      Calls: number of calls
+%      Elements: sum of the seq lengths given to the kernel. This is the
+%        SeqA length for alignSeq.
+%      Nanosec: total time in the kernel, summed over all threads
+%      MeanNs: Nanosec / Calls
+%      LenHist: 1x32 number of calls per seq length bin
+%      RefHist: 1x32 number of alignSeqMEX calls per reference set size
+%        bin (number of SeqB). Only for alignSeq.
+%      ThreadNanosec: 1xT time of each thread, in the order they 1st
+%        called a kernel, to see how evenly the threads are loaded. A
+%        thread has 1 slot for all MEX files. Threads past the 63rd are
+%        summed in the last one.
+%    BinEdge: 1x32 lower edge of each bin: 0, 1, 2, 4, 8, ..., 2^30
+%
+%  NOTE
+%    The counters are only in MEX files compiled with -DBRILIA_STATS, as
+%    done by compileMexBRILIA('stats'). Otherwise, all counts stay 0. Each
+%    counted call costs about 2 clock reads.
+%
+%    Times are inclusive. cmprSeq also counts the calls made by alignSeq
+%    and calcSeqShmScore.
+%
+%    Parallel pool workers are separate processes with their own counters.
+%    Use parfevalOnAll(@briliaStatsMEX, 1, 'get') to get theirs.
+%
+%  EXAMPLE
+%    compileMexBRILIA('stats')
+%    briliaStatsMEX('reset');
+%    Score = alignSeqMEX('ACGTACGT', {'ACGTTCGT', 'ACG'});
+%    [Stats, BinEdge] = briliaStatsMEX('get');
+%    Stats(1)
+%      ans =
+%             Name: 'alignSeq'
+%            Calls: 2
+%         Elements: 16
+%              ...
+%    bar(Stats(1).LenHist)
+%
+%  See also alignSeqMEX, compileMexBRILIA, benchPipeline
+%
+%
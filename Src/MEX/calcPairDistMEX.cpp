@@ -65,6 +65,8 @@ T | 0 -1  0 -1  0   T -> N A C G -
 
 #include "mex.h"
 #include "HotspotTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
 
 void mexFunction(int nlhs,        mxArray *plhs[],
                  int nrhs, const  mxArray *prhs[]) {
@@ -109,45 +111,56 @@ void mexFunction(int nlhs,        mxArray *plhs[],
         pShmDist = mxGetPr(plhs[4]);
     }
 
-    for (int j = 0; j < NumSeq; j++) {
-        mxArray *pCellA = mxGetCell(prhs[0], j);
-        if (!mxIsChar(pCellA)) { continue; }
-        mxChar *pSeqA = mxGetChars(pCellA);
-        mwSize LenA = mxGetN(pCellA);
+    //Gather the inputs here, since mx* is not thread-safe
+    std::vector<mxChar*> pSeqs(NumSeq, NULL);
+    std::vector<mwSize> SeqLens(NumSeq, 0);
+    for (mwSize j = 0; j < NumSeq; j++) {
+        mxArray *pCell = mxGetCell(prhs[0], j);
+        if (pCell == NULL || !mxIsChar(pCell)) { continue; }
+        pSeqs[j] = mxGetChars(pCell);
+        SeqLens[j] = mxGetN(pCell);
+    }
+
+    //Each row j fills (j, k<j) and (k<j, j), so rows do not overlap
+    parallelFor(NumSeq, 16, [&](size_t Beg, size_t End) {
+        for (mwSize j = Beg; j < End; j++) {
+            if (pSeqs[j] == NULL) { continue; }
+            mxChar *pSeqA = pSeqs[j];
+            mwSize LenA = SeqLens[j];
 
-        for (int k = 0; k < j; k++) {
-            mxArray *pCellB = mxGetCell(prhs[0], k);
-            if (!mxIsChar(pCellB)) { continue; }
-            mxChar *pSeqB = mxGetChars(pCellB);
-            mwSize LenB = mxGetN(pCellB);
+            for (mwSize k = 0; k < j; k++) {
+                if (pSeqs[k] == NULL) { continue; }
+                mxChar *pSeqB = pSeqs[k];
+                mwSize LenB = SeqLens[k];
 
-            mwSize Len = LenA < LenB ? LenA : LenB;
-            int Idx1 = j + k*NumSeq;
-            int Idx2 = k + j*NumSeq;
-            double pScore[6] = {0};
-            calcSeqShmScore(pSeqA, pSeqB, Len, pScore);
-            pHamDist[Idx1] = pScore[0];
-            pHamDist[Idx2] = pScore[0];
+                mwSize Len = LenA < LenB ? LenA : LenB;
+                mwSize Idx1 = j + k*NumSeq;
+                mwSize Idx2 = k + j*NumSeq;
+                double pScore[6] = {0};
+                calcSeqShmScore(pSeqA, pSeqB, Len, pScore);
+                pHamDist[Idx1] = pScore[0];
+                pHamDist[Idx2] = pScore[0];
             
-            if (nlhs >= 2) {
-                pValidMotif[Idx1] = pScore[1];
-                pValidMotif[Idx2] = pScore[2];
+                if (nlhs >= 2) {
+                    pValidMotif[Idx1] = pScore[1];
+                    pValidMotif[Idx2] = pScore[2];
                 
-                if (nlhs >= 3) {
-                    pValidMut[Idx1] = pScore[3];
-                    pValidMut[Idx2] = pScore[4];
+                    if (nlhs >= 3) {
+                        pValidMut[Idx1] = pScore[3];
+                        pValidMut[Idx2] = pScore[4];
                     
-                    if (nlhs >= 4) {
-                        pPenalty[Idx1] = pScore[5];
-                        pPenalty[Idx2] = pScore[5];
+                        if (nlhs >= 4) {
+                            pPenalty[Idx1] = pScore[5];
+                            pPenalty[Idx2] = pScore[5];
                         
-                        if (nlhs >= 5) {
-                            pShmDist[Idx1] = pScore[0] - (pScore[1] + pScore[3])/4 + pScore[5];
-                            pShmDist[Idx2] = pScore[0] - (pScore[2] + pScore[4])/4 + pScore[5];
+                            if (nlhs >= 5) {
+                                pShmDist[Idx1] = pScore[0] - (pScore[1] + pScore[3])/4 + pScore[5];
+                                pShmDist[Idx2] = pScore[0] - (pScore[2] + pScore[4])/4 + pScore[5];
+                            }
                         }
                     }
                 }
             }
         }
-    }
+    });
 }
\ No newline at end of file
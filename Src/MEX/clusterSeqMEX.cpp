@@ -0,0 +1,252 @@
+/*
+clusterSeqMEX will cluster sequences of the same length that differ by at
+most K letters, such as the CDR3s of many samples when looking for
+convergent clonotypes. Identical sequences are merged with a hash table.
+For K > 0, the letter positions are split into K+1 segments, and only
+sequences that share an identical segment are compared (pigeonhole
+principle), so it does not compare all pairs. Positions that are the same
+in all sequences of a length, such as the conserved C and W/F of CDR3s,
+are left out of the segments, and the other positions are spread so that
+each segment is about as diverse as the others. Clusters are single-linkage,
+so A and C are in the same cluster if A~B and B~C, even if A and C differ
+by more than K letters. Each sequence length is done in its own thread.
+
+  [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq)
+
+  [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq, K)
+
+  INPUT
+    Seq: Mx1 cell of sequences of any letters (ex: aa, property codes).
+      Letter case matters. Non-char cells are treated as ''.
+    K [0]: max number of mismatched letters between linked sequences.
+      Sequences of different lengths are never linked.
+
+  OUTPUT
+    ClustNum: Mx1 cluster number of each sequence, numbered in the order
+      their 1st sequence appears in Seq
+    ClustSeq: Cx1 cell of the 1st sequence of each cluster
+    ClustSize: Cx1 number of sequences in each cluster
+
+  NOTE
+    To get the sample x cluster matrix of sequences pooled from S samples,
+    where SampleNum is the Mx1 sample number of each sequence:
+      Incidence = sparse(SampleNum, ClustNum, 1, S, max(ClustNum));
+
+    A segment with no positions (ex: fewer than K+1 positions vary) puts all
+    sequences of that length in 1 bucket, so they are compared to each other.
+
+  EXAMPLE
+    Seq = {'CARDYW'; 'CARDFW'; 'CTTW'; 'CARDYW'; 'CAKEFW'};
+    [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq, 1)
+    ClustNum =
+         1
+         1
+         2
+         1
+         3
+    ClustSeq =
+      3x1 cell array
+        {'CARDYW'}
+        {'CTTW'  }
+        {'CAKEFW'}
+    ClustSize =
+         3
+         1
+         1
+
+  See also findConvCDR3, calcConvMatrix, findUniqueSeqMEX
+*/
+
+#include "ThreadTool.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include <math.h>
+
+// Returns the root of Idx, halving the path along the way
+static int findRoot(std::vector<int> &Parent, int Idx) {
+    while (Parent[Idx] != Idx) {
+        Parent[Idx] = Parent[Parent[Idx]];
+        Idx = Parent[Idx];
+    }
+    return Idx;
+}
+
+// Returns true if A and B of length Len differ by at most K letters
+static bool isWithinK(const std::string &A, const std::string &B, size_t Len, int K) {
+    int Miss = 0;
+    for (size_t j = 0; j < Len; j++) {
+        if (A[j] != B[j] && ++Miss > K) { return false; }
+    }
+    return true;
+}
+
+// Splits the letter positions of the same-length seqs in UnqIdx into NumSeg
+// segments for the pigeonhole search. Positions where all seqs have the same
+// letter, such as the conserved CDR3 anchors, cannot hold a mismatch and are
+// left out. The others go from the most to the least diverse into the
+// segment with the lowest total entropy, so that no segment is made of only
+// low-diversity positions and makes a huge bucket.
+static void splitSegments(const std::vector<std::string> &UnqSeq, const std::vector<int> &UnqIdx, size_t Len, size_t NumSeg, std::vector<std::vector<size_t>> &Segment) {
+    std::vector<std::pair<double, size_t>> Entropy; //(entropy, position) of the positions that vary
+    std::vector<size_t> Count(256);
+    for (size_t j = 0; j < Len; j++) {
+        std::fill(Count.begin(), Count.end(), 0);
+        for (size_t u = 0; u < UnqIdx.size(); u++) {
+            Count[(unsigned char) UnqSeq[UnqIdx[u]][j]]++;
+        }
+        double Sum = 0;
+        for (size_t c = 0; c < Count.size(); c++) {
+            if (Count[c] == 0) { continue; }
+            double P = (double) Count[c] / UnqIdx.size();
+            Sum -= P * log(P);
+        }
+        if (Sum > 0) { Entropy.push_back(std::make_pair(Sum, j)); }
+    }
+    std::sort(Entropy.begin(), Entropy.end(), [](const std::pair<double, size_t> &A, const std::pair<double, size_t> &B) {
+        return A.first > B.first || (A.first == B.first && A.second < B.second);
+    });
+    Segment.assign(NumSeg, std::vector<size_t>());
+    std::vector<double> SegSum(NumSeg, 0);
+    for (size_t k = 0; k < Entropy.size(); k++) {
+        size_t s = std::min_element(SegSum.begin(), SegSum.end()) - SegSum.begin();
+        Segment[s].push_back(Entropy[k].second);
+        SegSum[s] += Entropy[k].first;
+    }
+}
+
+// Links the unique seqs in UnqIdx, which all have the same length, that differ by <= K letters
+static void linkSameLength(const std::vector<std::string> &UnqSeq, const std::vector<int> &UnqIdx, int K, std::vector<int> &Root) {
+    size_t N = UnqIdx.size();
+    std::vector<int> Parent(N);
+    std::iota(Parent.begin(), Parent.end(), 0);
+    size_t Len = UnqSeq[UnqIdx[0]].size();
+
+    if (K > 0 && N > 1) {
+        std::vector<std::vector<size_t>> Segment;
+        splitSegments(UnqSeq, UnqIdx, Len, (size_t)K + 1, Segment);
+        std::string Key;
+        for (size_t s = 0; s < Segment.size(); s++) {
+            std::unordered_map<std::string, std::vector<int>> Bucket;
+            Bucket.reserve(N);
+            for (size_t j = 0; j < N; j++) {
+                Key.clear();
+                for (size_t k = 0; k < Segment[s].size(); k++) {
+                    Key += UnqSeq[UnqIdx[j]][Segment[s][k]];
+                }
+                Bucket[Key].push_back((int)j);
+            }
+            for (auto &Item : Bucket) {
+                const std::vector<int> &Member = Item.second;
+                for (size_t a = 1; a < Member.size(); a++) {
+                    for (size_t b = 0; b < a; b++) {
+                        int RootA = findRoot(Parent, Member[a]);
+                        int RootB = findRoot(Parent, Member[b]);
+                        if (RootA == RootB) { continue; }
+                        if (isWithinK(UnqSeq[UnqIdx[Member[a]]], UnqSeq[UnqIdx[Member[b]]], Len, K)) {
+                            Parent[std::max(RootA, RootB)] = std::min(RootA, RootB);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //Root is the unique seq of the group that appears 1st, since UnqIdx is sorted
+    for (size_t j = 0; j < N; j++) {
+        Root[UnqIdx[j]] = UnqIdx[findRoot(Parent, (int)j)];
+    }
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgIdAndTxt("clusterSeqMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 2.");
+    }
+    if (nlhs > 3) {
+        mexErrMsgIdAndTxt("clusterSeqMEX:nlhs", "Too many outputs. Max is 3.");
+    }
+    if (!mxIsCell(prhs[0])) {
+        mexErrMsgIdAndTxt("clusterSeqMEX:prhs", "Input1: Seq must be a Mx1 cell of sequences.");
+    }
+    int K = 0;
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1])) {
+        if (!mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[1]) != 1 || mxGetScalar(prhs[1]) < 0) {
+            mexErrMsgIdAndTxt("clusterSeqMEX:prhs", "Input2: K must be a scalar >= 0.");
+        }
+        K = (int)mxGetScalar(prhs[1]);
+    }
+
+    //Merge identical seqs, keeping the order of 1st appearance
+    mwSize NumSeq = mxGetNumberOfElements(prhs[0]);
+    std::vector<std::string> UnqSeq;
+    std::vector<int> UnqNum(NumSeq);
+    std::unordered_map<std::string, int> UnqMap;
+    UnqMap.reserve(NumSeq);
+    for (mwSize j = 0; j < NumSeq; j++) {
+        std::string Key;
+        mxArray *pCell = mxGetCell(prhs[0], j);
+        if (pCell != NULL && mxIsChar(pCell)) {
+            const mxChar *pChar = mxGetChars(pCell);
+            Key.assign(pChar, pChar + mxGetNumberOfElements(pCell));
+        }
+        auto Iter = UnqMap.insert(std::make_pair(Key, (int)UnqSeq.size()));
+        if (Iter.second) { UnqSeq.push_back(Key); }
+        UnqNum[j] = Iter.first->second;
+    }
+
+    //Link the unique seqs of each length in parallel
+    std::map<size_t, std::vector<int>> LenMap;
+    for (size_t u = 0; u < UnqSeq.size(); u++) {
+        LenMap[UnqSeq[u].size()].push_back((int)u);
+    }
+    std::vector<const std::vector<int>*> LenGroup;
+    for (auto &Item : LenMap) {
+        LenGroup.push_back(&Item.second);
+    }
+    std::vector<int> Root(UnqSeq.size());
+    parallelFor(LenGroup.size(), 1, [&](size_t Beg, size_t End) {
+        for (size_t g = Beg; g < End; g++) {
+            linkSameLength(UnqSeq, *LenGroup[g], K, Root);
+        }
+    });
+
+    //Number the clusters in the order they appear
+    std::vector<int> ClustOfRoot(UnqSeq.size(), 0);
+    std::vector<int> FirstUnq;
+    std::vector<double> Size;
+    plhs[0] = mxCreateDoubleMatrix(NumSeq, 1, mxREAL);
+    double *pClustNum = mxGetPr(plhs[0]);
+    for (mwSize j = 0; j < NumSeq; j++) {
+        int &Clust = ClustOfRoot[Root[UnqNum[j]]];
+        if (Clust == 0) {
+            FirstUnq.push_back(UnqNum[j]);
+            Size.push_back(0);
+            Clust = (int)FirstUnq.size();
+        }
+        pClustNum[j] = Clust;
+        Size[Clust - 1]++;
+    }
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateCellMatrix(FirstUnq.size(), 1);
+        for (size_t c = 0; c < FirstUnq.size(); c++) {
+            const std::string &Str = UnqSeq[FirstUnq[c]];
+            mwSize Dims[2] = {1, Str.size()};
+            mxArray *pStr = mxCreateCharArray(2, Dims);
+            mxChar *pChar = mxGetChars(pStr);
+            for (size_t k = 0; k < Str.size(); k++) {
+                pChar[k] = (unsigned char)Str[k];
+            }
+            mxSetCell(plhs[1], c, pStr);
+        }
+    }
+    if (nlhs >= 3) {
+        plhs[2] = mxCreateDoubleMatrix(Size.size(), 1, mxREAL);
+        std::copy(Size.begin(), Size.end(), mxGetPr(plhs[2]));
+    }
+}
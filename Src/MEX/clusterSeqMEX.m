@@ -0,0 +1,58 @@
+%clusterSeqMEX will cluster sequences of the same length that differ by at
+%most K letters, such as the CDR3s of many samples when looking for
+%convergent clonotypes. Identical sequences are merged with a hash table.
+%For K > 0, the letter positions are split into K+1 segments, and only
+%sequences that share an identical segment are compared (pigeonhole
+%principle), so it does not compare all pairs. Positions that are the same
+%in all sequences of a length, such as the conserved C and W/F of CDR3s,
+%are left out of the segments, and the other positions are spread so that
+%each segment is about as diverse as the others. Clusters are single-linkage,
+%so A and C are in the same cluster if A~B and B~C, even if A and C differ
+%by more than K letters. Each sequence length is done in its own thread.
+%
+%  [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq)
+%
+%  [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq, K)
+%
+%  INPUT
+%    Seq: Mx1 cell of sequences of any letters (ex: aa, property codes).
+%      Letter case matters. Non-char cells are treated as ''.
+%    K [0]: max number of mismatched letters between linked sequences.
+%      Sequences of different lengths are never linked.
+%
+%  OUTPUT
+%    ClustNum: Mx1 cluster number of each sequence, numbered in the order
+%      their 1st sequence appears in Seq
+%    ClustSeq: Cx1 cell of the 1st sequence of each cluster
+%    ClustSize: Cx1 number of sequences in each cluster
+%
+%  NOTE
+%    To get the sample x cluster matrix of sequences pooled from S samples,
+%    where SampleNum is the Mx1 sample number of each sequence:
+%      Incidence = sparse(SampleNum, ClustNum, 1, S, max(ClustNum));
+%
+%    A segment with no positions (ex: fewer than K+1 positions vary) puts all
+%    sequences of that length in 1 bucket, so they are compared to each other.
+%
+%  EXAMPLE
+%    Seq = {'CARDYW'; 'CARDFW'; 'CTTW'; 'CARDYW'; 'CAKEFW'};
+%    [ClustNum, ClustSeq, ClustSize] = clusterSeqMEX(Seq, 1)
+%    ClustNum =
+%         1
+%         1
+%         2
+%         1
+%         3
+%    ClustSeq =
+%      3x1 cell array
+%        {'CARDYW'}
+%        {'CTTW'  }
+%        {'CAKEFW'}
+%    ClustSize =
+%         3
+%         1
+%         1
+%
+%  See also findConvCDR3, calcConvMatrix, findUniqueSeqMEX
+%
+%
@@ -18,27 +18,11 @@ tranlation between amino acid letter and its property code.
        'HBNASNAGBHHBSFPOOWYHX'
 */
 
-#include "StringTool.hpp"
+#include "SeqTool.hpp"
 
 void convAA2Prop(mxChar *pSeq, mwSize Len, mxChar *pProp) {
     for (mwSize j = 0; j < Len; j++) {
-        if        (containsChar(pSeq[j], "AILV")){
-            pProp[j] = 'H';
-        } else if (containsChar(pSeq[j], "RHK")){
-            pProp[j] = 'B';
-        } else if (containsChar(pSeq[j], "DE")){
-            pProp[j] = 'A';
-        } else if (containsChar(pSeq[j], "NQ")){
-            pProp[j] = 'N';
-        } else if (containsChar(pSeq[j], "ST")){
-            pProp[j] = 'O';
-        } else if (containsChar(pSeq[j], "CM")){
-            pProp[j] = 'S';
-        } else if (containsChar(pSeq[j], "PWYGF")){
-            pProp[j] = pSeq[j];
-        } else {
-            pProp[j] = 'X';
-        }
+        pProp[j] = aa2prop(pSeq[j]);
     }
 }
 
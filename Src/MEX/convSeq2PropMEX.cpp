@@ -0,0 +1,189 @@
+/*
+convSeq2PropMEX will compute, in one pass, the amino acid property code,
+net charge, and hydropathy of a cell of amino acid or nucleotide
+sequences. Nucleotide sequences are translated first. The work is split
+across CPU threads for large cell arrays.
+
+  PropCode = convSeq2PropMEX(Seq)
+
+  [PropCode, AAseq, Charge, HPI, Profile, ProfileIdx] = convSeq2PropMEX(Seq, Alphabet, Frame, pH)
+
+  INPUT
+    Seq: Mx1 cell of sequences, or a 1xN char
+    Alphabet ['aa' or 'nt']: the sequence letter type
+    Frame [1, 2, or 3]: reading frame for translating nt sequences
+    pH [7.2]: pH, or 1xP vector of pH, used to compute the side chain
+      charges. All pH are done in the same pass.
+
+  OUTPUT
+    PropCode: Mx1 cell (or 1xN char) of property codes (see convAA2PropMEX)
+    AAseq: Mx1 cell (or 1xN char) of amino acid sequences. A codon with N
+      is 'X', unless all of its possible codons give the same amino acid
+      (same as nt2aa(..., 'ACGTonly', false)). Stop codons are '*'.
+    Charge: MxP net charge of the side chains at each pH, no terminus (see
+      calcCharge)
+    HPI: Mx1 summed Kyte-Doolittle hydropathy index (see calcHPI)
+    Profile: 2xT matrix of the per-residue charge at the 1st pH (row 1)
+      and hydropathy (row 2) of all sequences, packed one after another
+    ProfileIdx: Mx2 matrix of the [first last] column of Profile for each
+      sequence. Empty sequences have last = first - 1.
+
+  NOTE
+    Lower case aa letters are X in PropCode and 0 in HPI, like
+    convAA2PropMEX and calcHPI, but are charged like upper case ones, like
+    calcCharge.
+
+  EXAMPLE
+    Seq = {'CARDYW'; 'TGTGCAAGA'};
+    [PropCode, AAseq, Charge] = convSeq2PropMEX(Seq(1))
+    PropCode =
+      1x1 cell array
+        {'SHBAYW'}
+    AAseq =
+      1x1 cell array
+        {'CARDYW'}
+    Charge =
+       -0.0485
+
+    [PropCode, AAseq] = convSeq2PropMEX(Seq(2), 'nt')
+    PropCode =
+      1x1 cell array
+        {'SHB'}
+    AAseq =
+      1x1 cell array
+        {'CAR'}
+
+    [~, ~, Charge] = convSeq2PropMEX(Seq(1), 'aa', 1, [7 6 5])
+    Charge =
+       -0.0307    0.0046    0.0733
+
+  See also convAA2PropMEX, calcCharge, calcHPI
+*/
+
+#include "SeqTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <algorithm>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 1 || nrhs > 4) {
+        mexErrMsgIdAndTxt("convSeq2PropMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 4.");
+    }
+    if (nlhs > 6) {
+        mexErrMsgIdAndTxt("convSeq2PropMEX:nlhs", "Too many outputs. Max is 6.");
+    }
+    if (!(mxIsCell(prhs[0]) || mxIsChar(prhs[0]))) {
+        mexErrMsgIdAndTxt("convSeq2PropMEX:prhs", "Input1: Seq must be a cell of char or a char.");
+    }
+
+    bool IsNT = false;
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1])) {
+        if (!mxIsChar(prhs[1])) {
+            mexErrMsgIdAndTxt("convSeq2PropMEX:prhs", "Input2: Alphabet must be 'aa' or 'nt'.");
+        }
+        mxChar Alphabet = mxGetChars(prhs[1])[0];
+        IsNT = Alphabet == 'n' || Alphabet == 'N';
+    }
+
+    mwSize Frame = 1;
+    if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        Frame = (mwSize) mxGetScalar(prhs[2]);
+        if (Frame < 1 || Frame > 3) {
+            mexErrMsgIdAndTxt("convSeq2PropMEX:prhs", "Input3: Frame must be 1, 2, or 3.");
+        }
+    }
+
+    std::vector<double> pH(1, 7.2);
+    if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        if (!mxIsDouble(prhs[3])) {
+            mexErrMsgIdAndTxt("convSeq2PropMEX:prhs", "Input4: pH must be a scalar or a vector.");
+        }
+        pH.assign(mxGetPr(prhs[3]), mxGetPr(prhs[3]) + mxGetNumberOfElements(prhs[3]));
+    }
+    mwSize NumPH = pH.size();
+    std::vector<double> ChargeTable(256 * NumPH); //1 table of 256 per pH
+    for (mwSize p = 0; p < NumPH; p++) {
+        getAAChargeTable(pH[p], &ChargeTable[256*p]);
+    }
+
+    //Gather the inputs and make the outputs here, since mx* is not thread-safe
+    bool IsCell = mxIsCell(prhs[0]);
+    mwSize NumSeq = IsCell ? mxGetNumberOfElements(prhs[0]) : 1;
+    std::vector<const mxChar*> pSeqs(NumSeq, NULL);
+    std::vector<mwSize> SeqLens(NumSeq, 0), AALens(NumSeq, 0), Offset(NumSeq + 1, 0);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        const mxArray *pCell = IsCell ? mxGetCell(prhs[0], s) : prhs[0];
+        if (pCell != NULL && mxIsChar(pCell)) {
+            pSeqs[s] = mxGetChars(pCell);
+            SeqLens[s] = mxGetNumberOfElements(pCell);
+        }
+        if (IsNT) {
+            AALens[s] = SeqLens[s] >= Frame + 2 ? (SeqLens[s] - Frame + 1) / 3 : 0;
+        } else {
+            AALens[s] = SeqLens[s];
+        }
+        Offset[s+1] = Offset[s] + AALens[s];
+    }
+
+    bool GetAA = nlhs >= 2;
+    std::vector<mxChar*> pProps(NumSeq), pAAs(NumSeq, NULL);
+    mxArray *pPropOut = IsCell ? mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0])) : NULL;
+    mxArray *pAAOut   = IsCell && GetAA ? mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0])) : NULL;
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mwSize Dims[2] = {(mwSize) (AALens[s] > 0 ? 1 : 0), AALens[s]};
+        mxArray *pProp = mxCreateCharArray(2, Dims);
+        pProps[s] = mxGetChars(pProp);
+        if (IsCell) { mxSetCell(pPropOut, s, pProp); } else { pPropOut = pProp; }
+        if (GetAA) {
+            mxArray *pAA = mxCreateCharArray(2, Dims);
+            pAAs[s] = mxGetChars(pAA);
+            if (IsCell) { mxSetCell(pAAOut, s, pAA); } else { pAAOut = pAA; }
+        }
+    }
+    mxArray *pChargeOut  = mxCreateDoubleMatrix(NumSeq, NumPH, mxREAL);
+    mxArray *pHPIOut     = mxCreateDoubleMatrix(NumSeq, 1, mxREAL);
+    mxArray *pProfileOut = mxCreateDoubleMatrix(2, nlhs >= 5 ? Offset[NumSeq] : 0, mxREAL);
+    double *pCharge  = mxGetPr(pChargeOut);
+    double *pHPI     = mxGetPr(pHPIOut);
+    double *pProfile = nlhs >= 5 ? mxGetPr(pProfileOut) : NULL;
+
+    parallelFor(NumSeq, 512, [&](size_t Beg, size_t End) {
+        std::vector<double> SumCharge(NumPH);
+        for (size_t s = Beg; s < End; s++) {
+            std::fill(SumCharge.begin(), SumCharge.end(), 0.0);
+            double SumHydro = 0;
+            for (mwSize j = 0; j < AALens[s]; j++) {
+                mxChar AA = IsNT ? codon2aaN(pSeqs[s] + Frame - 1 + 3*j) : pSeqs[s][j];
+                double Hydro = aa2hydro(AA);
+                pProps[s][j] = aa2prop(AA);
+                if (pAAs[s] != NULL) { pAAs[s][j] = AA; }
+                if (AA < 256) {
+                    for (mwSize p = 0; p < NumPH; p++) { SumCharge[p] += ChargeTable[256*p + AA]; }
+                }
+                if (pProfile != NULL) {
+                    pProfile[2*(Offset[s] + j)]     = AA < 256 ? ChargeTable[AA] : 0;
+                    pProfile[2*(Offset[s] + j) + 1] = Hydro;
+                }
+                SumHydro += Hydro;
+            }
+            for (mwSize p = 0; p < NumPH; p++) { pCharge[s + NumSeq*p] = SumCharge[p]; }
+            pHPI[s] = SumHydro;
+        }
+    });
+
+    plhs[0] = pPropOut;
+    if (GetAA)     { plhs[1] = pAAOut; }
+    if (nlhs >= 3) { plhs[2] = pChargeOut; } else { mxDestroyArray(pChargeOut); }
+    if (nlhs >= 4) { plhs[3] = pHPIOut;    } else { mxDestroyArray(pHPIOut); }
+    if (nlhs >= 5) { plhs[4] = pProfileOut; } else { mxDestroyArray(pProfileOut); }
+    if (nlhs >= 6) {
+        plhs[5] = mxCreateDoubleMatrix(NumSeq, 2, mxREAL);
+        double *pIdx = mxGetPr(plhs[5]);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            pIdx[s] = (double) Offset[s] + 1;
+            pIdx[s + NumSeq] = (double) Offset[s+1];
+        }
+    }
+}
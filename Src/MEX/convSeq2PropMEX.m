@@ -0,0 +1,61 @@
+%convSeq2PropMEX will compute, in one pass, the amino acid property code,
+%net charge, and hydropathy of a cell of amino acid or nucleotide
+%sequences. Nucleotide sequences are translated first. The work is split
+%across CPU threads for large cell arrays.
+%
+%  PropCode = convSeq2PropMEX(Seq)
+%
+%  [PropCode, AAseq, Charge, HPI, Profile, ProfileIdx] = convSeq2PropMEX(Seq, Alphabet, Frame, pH)
+%
+%  INPUT
+%    Seq: Mx1 cell of sequences, or a 1xN char
+%    Alphabet ['aa' or 'nt']: the sequence letter type
+%    Frame [1, 2, or 3]: reading frame for translating nt sequences
+%    pH [7.2]: pH, or 1xP vector of pH, used to compute the side chain
+%      charges. All pH are done in the same pass.
+%
+%  OUTPUT
+%    PropCode: Mx1 cell (or 1xN char) of property codes (see convAA2PropMEX)
+%    AAseq: Mx1 cell (or 1xN char) of amino acid sequences. A codon with N
+%      is 'X', unless all of its possible codons give the same amino acid
+%      (same as nt2aa(..., 'ACGTonly', false)). Stop codons are '*'.
+%    Charge: MxP net charge of the side chains at each pH, no terminus (see
+%      calcCharge)
+%    HPI: Mx1 summed Kyte-Doolittle hydropathy index (see calcHPI)
+%    Profile: 2xT matrix of the per-residue charge at the 1st pH (row 1)
+%      and hydropathy (row 2) of all sequences, packed one after another
+%    ProfileIdx: Mx2 matrix of the [first last] column of Profile for each
+%      sequence. Empty sequences have last = first - 1.
+%
+%  NOTE
+%    Lower case aa letters are X in PropCode and 0 in HPI, like
+%    convAA2PropMEX and calcHPI, but are charged like upper case ones, like
+%    calcCharge.
+%
+%  EXAMPLE
+%    Seq = {'CARDYW'; 'TGTGCAAGA'};
+%    [PropCode, AAseq, Charge] = convSeq2PropMEX(Seq(1))
+%    PropCode =
+%      1x1 cell array
+%        {'SHBAYW'}
+%    AAseq =
+%      1x1 cell array
+%        {'CARDYW'}
+%    Charge =
+%       -0.0485
+%
+%    [PropCode, AAseq] = convSeq2PropMEX(Seq(2), 'nt')
+%    PropCode =
+%      1x1 cell array
+%        {'SHB'}
+%    AAseq =
+%      1x1 cell array
+%        {'CAR'}
+%
+%    [~, ~, Charge] = convSeq2PropMEX(Seq(1), 'aa', 1, [7 6 5])
+%    Charge =
+%       -0.0307    0.0046    0.0733
+%
+%  See also convAA2PropMEX, calcCharge, calcHPI
+%
+%
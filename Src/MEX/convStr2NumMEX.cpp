@@ -24,6 +24,7 @@ string to a group of cell with number/string
 
 
 #include "mex.h"
+#include "StatTool.hpp"
 #include <string>
 #include <math.h>
 
@@ -158,6 +159,7 @@ double convStrToDouble(mxChar *pStr, mwSize Len, int *pStart) {
 }
 
 mxArray *convStrToMatrix(mxChar *pStr, mwSize Len) {
+    STAT_TIMER(STAT_CONV_STR_TO_MATRIX, Len);
     double Values[Len];
     int k = 0;
     int Start = 0;
@@ -19,6 +19,8 @@ Partial motifs at the sequence edge will NOT be considered a hotspot.
 */
 
 #include "HotspotTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
 
 void mexFunction(int nlhs,        mxArray *plhs[],
                  int nrhs, const  mxArray *prhs[]) {
@@ -43,20 +45,32 @@ void mexFunction(int nlhs,        mxArray *plhs[],
             plhs[1] = mxCreateCellMatrix(pDim[0], pDim[1]);
         }
         
-        for (int j = 0; j < NumSeq; j++) {
+        //Gather the inputs and make the outputs here, since mx* is not thread-safe
+        std::vector<mxChar*> pSeqs(NumSeq, NULL);
+        std::vector<mwSize> SeqLens(NumSeq, 0);
+        std::vector<double*> pLocs(NumSeq, NULL);
+        for (mwSize j = 0; j < NumSeq; j++) {
             mxArray *pCell = mxGetCell(prhs[0], j);
             if (!mxIsChar(pCell)) { 
                 mexErrMsgIdAndTxt("countHotspotsMEX:input", "Input: Not all cells are strings.");
             }
-            mxChar *pSeq = mxGetChars(pCell);
-            mwSize Len = mxGetN(pCell);
-            if (nlhs == 1) {
-                pCount[j] = countHotspots(pSeq, Len);
-            } else {
-                mxSetCell(plhs[1], j, mxCreateDoubleMatrix(1, Len, mxREAL));
-                pCount[j] = countHotspots(pSeq, Len, mxGetPr(mxGetCell(plhs[1], j)));
+            pSeqs[j] = mxGetChars(pCell);
+            SeqLens[j] = mxGetN(pCell);
+            if (nlhs == 2) {
+                mxSetCell(plhs[1], j, mxCreateDoubleMatrix(1, SeqLens[j], mxREAL));
+                pLocs[j] = mxGetPr(mxGetCell(plhs[1], j));
             }
         }
+
+        parallelFor(NumSeq, 256, [&](size_t Beg, size_t End) {
+            for (size_t j = Beg; j < End; j++) {
+                if (nlhs == 1) {
+                    pCount[j] = countHotspots(pSeqs[j], SeqLens[j]);
+                } else {
+                    pCount[j] = countHotspots(pSeqs[j], SeqLens[j], pLocs[j]);
+                }
+            }
+        });
     } else {
         mxChar *pSeq = mxGetChars(prhs[0]);
         mwSize Len = mxGetN(prhs[0]);
@@ -0,0 +1,54 @@
+/*
+countSeqFileMEX will count the number of sequences in a FASTA or FASTQ
+file, which can be gzip-compressed (ex: .fastq.gz).
+
+  SeqCount = countSeqFileMEX(FileName)
+
+  INPUT
+    FileName: full name of a .fa/.fasta/.fastq file, or a .gz of these
+
+  OUTPUT
+    SeqCount: number of sequence entries in the file
+
+  EXAMPLE
+    SeqCount = countSeqFileMEX('Reads.fastq.gz');
+
+  See also readSeqFileMEX, countSeq
+*/
+
+#include "SeqFileTool.hpp"
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs != 1) {
+        mexErrMsgIdAndTxt("countSeqFileMEX:nrhs", "Incorrect number of inputs. Expected 1.");
+    }
+    if (nlhs > 1) {
+        mexErrMsgIdAndTxt("countSeqFileMEX:nlhs", "Too many outputs. Max is 1.");
+    }
+    if (!mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("countSeqFileMEX:prhs", "Input1: FileName must be a char array.");
+    }
+
+    char *pFileName = mxArrayToString(prhs[0]);
+    seq_reader *pReader = new seq_reader;
+    bool Success = openSeqReader(pFileName, *pReader);
+    mxFree(pFileName);
+    if (!Success) {
+        delete pReader;
+        mexErrMsgIdAndTxt("countSeqFileMEX:prhs", "Could not open the file.");
+    }
+
+    seq_record Rec;
+    double SeqCount = 0;
+    while (readSeqRecord(*pReader, Rec)) { SeqCount++; }
+    std::string ErrMsg = pReader->ErrMsg;
+    closeSeqReader(*pReader);
+    delete pReader;
+    if (!ErrMsg.empty()) {
+        mexErrMsgIdAndTxt(SEQ_FILE_ERR_ID, "%s", ErrMsg.c_str());
+    }
+
+    plhs[0] = mxCreateDoubleScalar(SeqCount);
+}
@@ -0,0 +1,17 @@
+%countSeqFileMEX will count the number of sequences in a FASTA or FASTQ
+%file, which can be gzip-compressed (ex: .fastq.gz).
+%
+%  SeqCount = countSeqFileMEX(FileName)
+%
+%  INPUT
+%    FileName: full name of a .fa/.fasta/.fastq file, or a .gz of these
+%
+%  OUTPUT
+%    SeqCount: number of sequence entries in the file
+%
+%  EXAMPLE
+%    SeqCount = countSeqFileMEX('Reads.fastq.gz');
+%
+%  See also readSeqFileMEX, countSeq
+%
+%
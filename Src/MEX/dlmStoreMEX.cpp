@@ -0,0 +1,460 @@
+/*
+dlmStoreMEX will keep BRILIA output files memory-mapped behind numeric
+handles, so that columns can be read many times without parsing the whole
+file again. The row offsets are found once when the file is opened, and the
+field offsets of a column are found the 1st time it is used, so only the
+columns that are asked for are parsed. It can also count rows and sum
+numeric columns per unique key (ex: gene name) over many files at once,
+using all CPU threads.
+
+  H = dlmStoreMEX('open', FileName)
+
+  H = dlmStoreMEX('open', FileName, Delimiter)
+
+  CellData = dlmStoreMEX('read', H, Col)
+
+  CellData = dlmStoreMEX('read', H, Col, NumIdx)
+
+  [GrpNum, Key, Count, Sum] = dlmStoreMEX('groupby', H, KeyCol, SumCol, FileGrpNum)
+
+  Info = dlmStoreMEX('info', H)
+
+  dlmStoreMEX('close', H)
+
+  INPUT
+    FileName: full name of the delimited file, where line 1 is the header
+    Delimiter ['' ',' ';' '\t']: delimiter of the file. If empty, will
+      autodetect it like readDlmFileMEX.
+    H: file handle (a double scalar) returned by 'open'. For 'groupby' and
+      'close', can be a 1xF matrix of handles.
+    Col: 1xK column numbers, or a 1xK cell of header names (case-insensitive)
+    NumIdx: column numbers of the FILE that should be converted to double.
+      Empty or non-numeric fields become NaN. Use getVDJmapper to get these.
+    KeyCol: 1xK column numbers or header names whose text is the group key
+    SumCol: 1xS column numbers or header names to sum as numbers, skipping
+      NaN. Can be empty.
+    FileGrpNum: 1xF group number of each file. Default is 1:F. Files of the
+      same group number are pooled.
+
+  OUTPUT
+    H: file handle. The file is kept mapped until it is closed or this MEX
+      file is cleared.
+    CellData: MxK cell of the data rows (line 2 onward). Rows with fewer
+      columns are padded with '' (or NaN).
+    GrpNum: Ux1 group number of each unique key, sorted by GrpNum then Key
+    Key: UxK cell of the unique keys
+    Count: Ux1 number of rows with each key
+    Sum: UxS sum of the SumCol values of each key
+    Info: structure with FileName, Header, NumRow, Delimiter, Indexed (1xN
+      logical of the columns with field offsets), and Bytes (approximate
+      memory used by the offsets)
+
+  NOTE
+    Names in Col are matched to the header of the file, so files with
+    columns in different orders can be grouped by name together.
+
+    The file must not be changed while it is open. Use 'close' and then
+    'open' again to see the changes.
+
+  EXAMPLE
+    H = dlmStoreMEX('open', 'MouseH.BRILIAv3.csv');
+    Info = dlmStoreMEX('info', H);
+    [Map, NumIdx] = getVDJmapper(Info.Header);
+    Data = dlmStoreMEX('read', H, {'SeqNum', 'hGeneName'}, NumIdx);
+    [~, Key, Count] = dlmStoreMEX('groupby', H, {'hGeneName'}, []);
+    dlmStoreMEX('close', H);
+
+  See also readDlmFileMEX, BRILIADatastore
+*/
+
+#include "DlmTool.hpp"
+#include "ThreadTool.hpp"
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <mutex>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <math.h>
+
+// field_span is the location of 1 field, relative to the start of its row
+struct field_span {
+    uint32_t Off = 0;  //Off: bytes from the row start to the field
+    uint32_t Len = 0;  //Len: number of bytes in the field
+};
+
+// dlm_store stores a mapped file, its row offsets, and the field offsets of used columns
+struct dlm_store {
+    std::string FileName;
+    mapped_file MF;
+    char Delim = ',';
+    std::vector<std::string> Header;
+    std::vector<size_t> RowBeg;                   //RowBeg: offset of each data row
+    std::vector<uint32_t> RowLen;                 //RowLen: bytes in each data row, without "\r\n"
+    std::vector<std::vector<field_span>> Span;    //Span: per column, empty until indexed
+};
+
+// group_sum stores the number of rows and sums of 1 group key
+struct group_sum {
+    double Count = 0;
+    std::vector<double> Sum;
+};
+
+static std::map<int, dlm_store*> STORES;
+static int NEXT_HANDLE = 1;
+
+static void closeStore(dlm_store *pDS) {
+    closeMappedFile(pDS->MF);
+    delete pDS;
+}
+
+static void deleteStores() {
+    for (std::map<int, dlm_store*>::iterator Iter = STORES.begin(); Iter != STORES.end(); ++Iter) {
+        closeStore(Iter->second);
+    }
+    STORES.clear();
+}
+
+static dlm_store &getStore(double Handle) {
+    std::map<int, dlm_store*>::iterator Iter = STORES.find((int) Handle);
+    if (Iter == STORES.end()) {
+        mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input2: H = %g is not an open file handle.", Handle);
+    }
+    return *Iter->second;
+}
+
+// Finds the row offsets of the whole file, splitting the file into blocks for the threads
+static void indexRows(dlm_store &DS) {
+    if (DS.MF.Size == 0) { return; }
+    const char *pBeg = DS.MF.pData;
+    const char *pEnd = pBeg + DS.MF.Size;
+    const size_t BLOCK_BYTES = 1 << 22;
+    size_t NumBlock = DS.MF.Size / BLOCK_BYTES + 1;
+    std::vector<std::vector<size_t>> BlockEOL(NumBlock);
+    parallelFor(NumBlock, 1, [&](size_t Beg, size_t End) {
+        for (size_t b = Beg; b < End; b++) {
+            const char *p = pBeg + b * BLOCK_BYTES;
+            const char *pStop = std::min(p + BLOCK_BYTES, pEnd);
+            while ((p = findEOL(p, pStop)) < pStop) {
+                BlockEOL[b].push_back(p - pBeg);
+                p++;
+            }
+        }
+    });
+
+    //Line 1 is the header, and a last line without '\n' is a row too
+    std::vector<size_t> EOL;
+    for (size_t b = 0; b < NumBlock; b++) {
+        EOL.insert(EOL.end(), BlockEOL[b].begin(), BlockEOL[b].end());
+    }
+    if (DS.MF.Size > 0 && pEnd[-1] != '\n') { EOL.push_back(DS.MF.Size); }
+    size_t NumRow = EOL.size() > 1 ? EOL.size() - 1 : 0;
+    DS.RowBeg.resize(NumRow);
+    DS.RowLen.resize(NumRow);
+    for (size_t r = 0; r < NumRow; r++) {
+        size_t Beg = EOL[r] + 1, Stop = EOL[r+1];
+        if (Stop > Beg && pBeg[Stop-1] == '\r') { Stop--; }
+        DS.RowBeg[r] = Beg;
+        DS.RowLen[r] = (uint32_t) (Stop - Beg);
+    }
+
+    //Header
+    const char *p = pBeg;
+    const char *pEOL = EOL.empty() ? pEnd : pBeg + EOL[0];
+    if (pEOL > p && pEOL[-1] == '\r') { pEOL--; }
+    while (true) {
+        const char *pStop = findDelimOrEOL(p, pEOL, DS.Delim);
+        DS.Header.push_back(std::string(p, pStop));
+        if (pStop == pEOL) { break; }
+        p = pStop + 1;
+    }
+    DS.Span.resize(DS.Header.size());
+}
+
+// Finds the field offsets of the columns in Cols that are not indexed yet, in 1 pass
+static void indexColumns(dlm_store &DS, const std::vector<size_t> &Cols) {
+    std::vector<bool> Need(DS.Header.size(), false);
+    size_t MaxCol = 0;
+    bool HasNeed = false;
+    for (size_t j = 0; j < Cols.size(); j++) {
+        if (DS.Span[Cols[j]].empty() && !DS.RowBeg.empty()) {
+            Need[Cols[j]] = true;
+            MaxCol = std::max(MaxCol, Cols[j]);
+            HasNeed = true;
+        }
+    }
+    if (!HasNeed) { return; }
+    for (size_t c = 0; c <= MaxCol; c++) {
+        if (Need[c]) { DS.Span[c].resize(DS.RowBeg.size()); }
+    }
+
+    parallelFor(DS.RowBeg.size(), 4096, [&](size_t Beg, size_t End) {
+        for (size_t r = Beg; r < End; r++) {
+            const char *pRow = DS.MF.pData + DS.RowBeg[r];
+            const char *pEOL = pRow + DS.RowLen[r];
+            const char *p = pRow;
+            for (size_t c = 0; c <= MaxCol; c++) {
+                const char *pStop = findDelimOrEOL(p, pEOL, DS.Delim);
+                if (Need[c]) {
+                    DS.Span[c][r].Off = (uint32_t) (p - pRow);
+                    DS.Span[c][r].Len = (uint32_t) (pStop - p);
+                }
+                if (pStop == pEOL) { break; } //missing columns keep Len = 0
+                p = pStop + 1;
+            }
+        }
+    });
+}
+
+// Returns the 0-based column numbers from a matrix of numbers or a cell of header names
+static void getColIdx(const dlm_store &DS, const mxArray *pCol, int Arg, std::vector<size_t> &Cols) {
+    Cols.clear();
+    if (pCol == NULL || mxIsEmpty(pCol)) { return; }
+    if (mxIsDouble(pCol)) {
+        const double *pNum = mxGetPr(pCol);
+        for (mwSize j = 0; j < mxGetNumberOfElements(pCol); j++) {
+            if (!(pNum[j] >= 1 && pNum[j] <= (double) DS.Header.size())) {
+                mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input%d: column %g is outside 1 to %d.", Arg + 1, pNum[j], (int) DS.Header.size());
+            }
+            Cols.push_back((size_t) pNum[j] - 1);
+        }
+        return;
+    }
+    if (!mxIsCell(pCol) && !mxIsChar(pCol)) {
+        mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input%d: must be column numbers or a cell of header names.", Arg + 1);
+    }
+    mwSize NumCol = mxIsChar(pCol) ? 1 : mxGetNumberOfElements(pCol);
+    for (mwSize j = 0; j < NumCol; j++) {
+        const mxArray *pName = mxIsChar(pCol) ? pCol : mxGetCell(pCol, j);
+        char *pStr = pName != NULL && mxIsChar(pName) ? mxArrayToString(pName) : NULL;
+        size_t c = 0;
+        for (; pStr != NULL && c < DS.Header.size(); c++) {
+            if (DS.Header[c].size() == strlen(pStr) && std::equal(DS.Header[c].begin(), DS.Header[c].end(), pStr,
+                    [](char A, char B) { return tolower((unsigned char) A) == tolower((unsigned char) B); })) { break; }
+        }
+        if (pStr == NULL || c == DS.Header.size()) {
+            mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input%d: \"%s\" is not a column of \"%s\".", Arg + 1, pStr == NULL ? "" : pStr, DS.FileName.c_str());
+        }
+        mxFree(pStr);
+        Cols.push_back(c);
+    }
+}
+
+// Returns the handles from a double matrix
+static void getHandles(const mxArray *pH, std::vector<double> &Handles) {
+    if (!mxIsDouble(pH)) {
+        mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input2: H must be file handles from dlmStoreMEX('open', ...).");
+    }
+    Handles.assign(mxGetPr(pH), mxGetPr(pH) + mxGetNumberOfElements(pH));
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || !mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("dlmStoreMEX:nrhs", "Need a command string and a file name or handle.");
+    }
+    char *pCmd = mxArrayToString(prhs[0]);
+    std::string Cmd(pCmd);
+    mxFree(pCmd);
+
+    if (Cmd == "open") {
+        if (nrhs > 3 || !mxIsChar(prhs[1])) {
+            mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "'open' needs a FileName and an optional Delimiter.");
+        }
+        dlm_store *pDS = new dlm_store;
+        char *pFileName = mxArrayToString(prhs[1]);
+        pDS->FileName = pFileName;
+        mxFree(pFileName);
+        if (!openMappedFile(pDS->FileName.c_str(), pDS->MF)) {
+            std::string FileName = pDS->FileName;
+            delete pDS;
+            mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Could not open the file \"%s\".", FileName.c_str());
+        }
+        char Delim = nrhs >= 3 ? getDelimiter(prhs[2]) : 0;
+        pDS->Delim = Delim != 0 ? Delim : detectDelimiter(pDS->MF.pData, pDS->MF.pData + pDS->MF.Size);
+        indexRows(*pDS);
+        if (STORES.empty()) {
+            mexLock(); //keeps the files mapped until they are closed
+            addExitFunc(deleteStores); //not mexAtExit, which would drop the pool's clean-up
+        }
+        STORES[NEXT_HANDLE] = pDS;
+        plhs[0] = mxCreateDoubleScalar(NEXT_HANDLE++);
+        return;
+    }
+
+    std::vector<double> Handles;
+    getHandles(prhs[1], Handles);
+
+    if (Cmd == "close") {
+        for (size_t f = 0; f < Handles.size(); f++) {
+            std::map<int, dlm_store*>::iterator Iter = STORES.find((int) Handles[f]);
+            if (Iter == STORES.end()) { continue; }
+            closeStore(Iter->second);
+            STORES.erase(Iter);
+        }
+        if (STORES.empty() && mexIsLocked()) { mexUnlock(); }
+        return;
+    }
+
+    if (Cmd == "info") {
+        dlm_store &DS = getStore(mxGetScalar(prhs[1]));
+        const char *pField[6] = {"FileName", "Header", "NumRow", "Delimiter", "Indexed", "Bytes"};
+        plhs[0] = mxCreateStructMatrix(1, 1, 6, pField);
+        mxArray *pHeader = mxCreateCellMatrix(1, DS.Header.size());
+        mxArray *pIndexed = mxCreateLogicalMatrix(1, DS.Header.size());
+        double Bytes = (double) DS.RowBeg.size() * (sizeof(size_t) + sizeof(uint32_t));
+        for (size_t c = 0; c < DS.Header.size(); c++) {
+            mxSetCell(pHeader, c, mxCreateString(DS.Header[c].c_str()));
+            mxGetLogicals(pIndexed)[c] = !DS.Span[c].empty();
+            Bytes += (double) DS.Span[c].size() * sizeof(field_span);
+        }
+        mxSetField(plhs[0], 0, "FileName", mxCreateString(DS.FileName.c_str()));
+        mxSetField(plhs[0], 0, "Header", pHeader);
+        mxSetField(plhs[0], 0, "NumRow", mxCreateDoubleScalar((double) DS.RowBeg.size()));
+        mxSetField(plhs[0], 0, "Delimiter", mxCreateString(DS.Delim == '\t' ? "\\t" : (DS.Delim == ';' ? ";" : ",")));
+        mxSetField(plhs[0], 0, "Indexed", pIndexed);
+        mxSetField(plhs[0], 0, "Bytes", mxCreateDoubleScalar(Bytes));
+        return;
+    }
+
+    if (Cmd == "read") {
+        if (nrhs < 3 || nrhs > 4) {
+            mexErrMsgIdAndTxt("dlmStoreMEX:nrhs", "'read' needs H, Col, and an optional NumIdx.");
+        }
+        dlm_store &DS = getStore(mxGetScalar(prhs[1]));
+        std::vector<size_t> Cols;
+        getColIdx(DS, prhs[2], 2, Cols);
+        std::vector<bool> IsNum(DS.Header.size(), false);
+        if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+            if (!mxIsDouble(prhs[3])) {
+                mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input4: NumIdx must be a double matrix of column indices.");
+            }
+            const double *pNumIdx = mxGetPr(prhs[3]);
+            for (mwSize j = 0; j < mxGetNumberOfElements(prhs[3]); j++) {
+                if (pNumIdx[j] >= 1 && pNumIdx[j] <= DS.Header.size()) { IsNum[(size_t) pNumIdx[j] - 1] = true; }
+            }
+        }
+        indexColumns(DS, Cols);
+
+        size_t NumRow = DS.RowBeg.size();
+        plhs[0] = mxCreateCellMatrix(NumRow, Cols.size());
+        for (size_t k = 0; k < Cols.size(); k++) {
+            const std::vector<field_span> &Span = DS.Span[Cols[k]];
+            for (size_t r = 0; r < NumRow; r++) {
+                const char *pField = DS.MF.pData + DS.RowBeg[r] + Span[r].Off;
+                mxSetCell(plhs[0], r + k*NumRow, IsNum[Cols[k]] ? mxCreateDoubleScalar(convField2Double(pField, Span[r].Len)) : convField2Char(pField, Span[r].Len));
+            }
+        }
+        return;
+    }
+
+    if (Cmd == "groupby") {
+        if (nrhs < 3 || nrhs > 5) {
+            mexErrMsgIdAndTxt("dlmStoreMEX:nrhs", "'groupby' needs H, KeyCol, an optional SumCol, and an optional FileGrpNum.");
+        }
+        std::vector<double> FileGrpNum(Handles.size());
+        for (size_t f = 0; f < Handles.size(); f++) { FileGrpNum[f] = (double) f + 1; }
+        if (nrhs >= 5 && !mxIsEmpty(prhs[4])) {
+            if (!mxIsDouble(prhs[4]) || mxGetNumberOfElements(prhs[4]) != Handles.size()) {
+                mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input5: FileGrpNum must be a 1xF matrix, with 1 number per handle.");
+            }
+            FileGrpNum.assign(mxGetPr(prhs[4]), mxGetPr(prhs[4]) + Handles.size());
+        }
+
+        //Resolve and index the columns of each file in the main thread
+        std::vector<dlm_store*> pStore(Handles.size());
+        std::vector<std::vector<size_t>> KeyCols(Handles.size()), SumCols(Handles.size());
+        for (size_t f = 0; f < Handles.size(); f++) {
+            pStore[f] = &getStore(Handles[f]);
+            getColIdx(*pStore[f], prhs[2], 2, KeyCols[f]);
+            getColIdx(*pStore[f], nrhs >= 4 ? prhs[3] : NULL, 3, SumCols[f]);
+            if (KeyCols[f].size() != KeyCols[0].size() || SumCols[f].size() != SumCols[0].size()) {
+                mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input3: KeyCol and SumCol must give the same number of columns for all files.");
+            }
+            std::vector<size_t> Cols(KeyCols[f]);
+            Cols.insert(Cols.end(), SumCols[f].begin(), SumCols[f].end());
+            indexColumns(*pStore[f], Cols);
+        }
+        size_t NumKey = KeyCols.empty() ? 0 : KeyCols[0].size();
+        size_t NumSum = SumCols.empty() ? 0 : SumCols[0].size();
+
+        //Each block counts into its own table, which is then merged
+        //The key is the group number bytes, then the key fields joined by '\0'
+        std::unordered_map<std::string, group_sum> Groups;
+        std::mutex MergeMutex;
+        for (size_t f = 0; f < Handles.size(); f++) {
+            const dlm_store &DS = *pStore[f];
+            std::string GrpKey((const char*) &FileGrpNum[f], sizeof(double));
+            parallelFor(DS.RowBeg.size(), 4096, [&](size_t Beg, size_t End) {
+                std::unordered_map<std::string, group_sum> Local;
+                std::string Key;
+                for (size_t r = Beg; r < End; r++) {
+                    const char *pRow = DS.MF.pData + DS.RowBeg[r];
+                    Key = GrpKey;
+                    for (size_t k = 0; k < NumKey; k++) {
+                        const field_span &S = DS.Span[KeyCols[f][k]][r];
+                        Key.append(pRow + S.Off, S.Len);
+                        Key += '\0';
+                    }
+                    group_sum &G = Local[Key];
+                    if (G.Sum.empty()) { G.Sum.assign(NumSum, 0); }
+                    G.Count++;
+                    for (size_t s = 0; s < NumSum; s++) {
+                        const field_span &S = DS.Span[SumCols[f][s]][r];
+                        double Num = convField2Double(pRow + S.Off, S.Len);
+                        if (Num == Num) { G.Sum[s] += Num; }
+                    }
+                }
+                std::lock_guard<std::mutex> Lock(MergeMutex);
+                for (auto &Item : Local) {
+                    group_sum &G = Groups[Item.first];
+                    if (G.Sum.empty()) { G.Sum.assign(NumSum, 0); }
+                    G.Count += Item.second.Count;
+                    for (size_t s = 0; s < NumSum; s++) { G.Sum[s] += Item.second.Sum[s]; }
+                }
+            });
+        }
+
+        //Sort by group number, then key text
+        std::vector<std::pair<double, const std::string*>> Order;
+        Order.reserve(Groups.size());
+        for (auto &Item : Groups) {
+            double Num;
+            memcpy(&Num, Item.first.data(), sizeof(double));
+            Order.push_back(std::make_pair(Num, &Item.first));
+        }
+        std::sort(Order.begin(), Order.end(), [](const std::pair<double, const std::string*> &A, const std::pair<double, const std::string*> &B) {
+            return A.first != B.first ? A.first < B.first : A.second->compare(sizeof(double), std::string::npos, *B.second, sizeof(double), std::string::npos) < 0;
+        });
+
+        size_t NumUnq = Order.size();
+        plhs[0] = mxCreateDoubleMatrix(NumUnq, 1, mxREAL);
+        if (nlhs >= 2) { plhs[1] = mxCreateCellMatrix(NumUnq, NumKey); }
+        if (nlhs >= 3) { plhs[2] = mxCreateDoubleMatrix(NumUnq, 1, mxREAL); }
+        if (nlhs >= 4) { plhs[3] = mxCreateDoubleMatrix(NumUnq, NumSum, mxREAL); }
+        for (size_t u = 0; u < NumUnq; u++) {
+            const std::string &Key = *Order[u].second;
+            const group_sum &G = Groups[Key];
+            mxGetPr(plhs[0])[u] = Order[u].first;
+            if (nlhs >= 2) {
+                size_t Pos = sizeof(double);
+                for (size_t k = 0; k < NumKey; k++) {
+                    size_t Stop = Key.find('\0', Pos);
+                    mxSetCell(plhs[1], u + k*NumUnq, convField2Char(Key.data() + Pos, Stop - Pos));
+                    Pos = Stop + 1;
+                }
+            }
+            if (nlhs >= 3) { mxGetPr(plhs[2])[u] = G.Count; }
+            if (nlhs >= 4) {
+                for (size_t s = 0; s < NumSum; s++) { mxGetPr(plhs[3])[u + s*NumUnq] = G.Sum[s]; }
+            }
+        }
+        return;
+    }
+
+    mexErrMsgIdAndTxt("dlmStoreMEX:prhs", "Input1: Unknown command '%s'.", Cmd.c_str());
+}
@@ -0,0 +1,68 @@
+%dlmStoreMEX will keep BRILIA output files memory-mapped behind numeric
+%handles, so that columns can be read many times without parsing the whole
+%file again. The row offsets are found once when the file is opened, and the
+%field offsets of a column are found the 1st time it is used, so only the
+%columns that are asked for are parsed. It can also count rows and sum
+%numeric columns per unique key (ex: gene name) over many files at once,
+%using all CPU threads.
+%
+%  H = dlmStoreMEX('open', FileName)
+%
+%  H = dlmStoreMEX('open', FileName, Delimiter)
+%
+%  CellData = dlmStoreMEX('read', H, Col)
+%
+%  CellData = dlmStoreMEX('read', H, Col, NumIdx)
+%
+%  [GrpNum, Key, Count, Sum] = dlmStoreMEX('groupby', H, KeyCol, SumCol, FileGrpNum)
+%
+%  Info = dlmStoreMEX('info', H)
+%
+%  dlmStoreMEX('close', H)
+%
+%  INPUT
+%    FileName: full name of the delimited file, where line 1 is the header
+%    Delimiter ['' ',' ';' '\t']: delimiter of the file. If empty, will
+%      autodetect it like readDlmFileMEX.
+%    H: file handle (a double scalar) returned by 'open'. For 'groupby' and
+%      'close', can be a 1xF matrix of handles.
+%    Col: 1xK column numbers, or a 1xK cell of header names (case-insensitive)
+%    NumIdx: column numbers of the FILE that should be converted to double.
+%      Empty or non-numeric fields become NaN. Use getVDJmapper to get these.
+%    KeyCol: 1xK column numbers or header names whose text is the group key
+%    SumCol: 1xS column numbers or header names to sum as numbers, skipping
+%      NaN. Can be empty.
+%    FileGrpNum: 1xF group number of each file. Default is 1:F. Files of the
+%      same group number are pooled.
+%
+%  OUTPUT
+%    H: file handle. The file is kept mapped until it is closed or this MEX
+%      file is cleared.
+%    CellData: MxK cell of the data rows (line 2 onward). Rows with fewer
+%      columns are padded with '' (or NaN).
+%    GrpNum: Ux1 group number of each unique key, sorted by GrpNum then Key
+%    Key: UxK cell of the unique keys
+%    Count: Ux1 number of rows with each key
+%    Sum: UxS sum of the SumCol values of each key
+%    Info: structure with FileName, Header, NumRow, Delimiter, Indexed (1xN
+%      logical of the columns with field offsets), and Bytes (approximate
+%      memory used by the offsets)
+%
+%  NOTE
+%    Names in Col are matched to the header of the file, so files with
+%    columns in different orders can be grouped by name together.
+%
+%    The file must not be changed while it is open. Use 'close' and then
+%    'open' again to see the changes.
+%
+%  EXAMPLE
+%    H = dlmStoreMEX('open', 'MouseH.BRILIAv3.csv');
+%    Info = dlmStoreMEX('info', H);
+%    [Map, NumIdx] = getVDJmapper(Info.Header);
+%    Data = dlmStoreMEX('read', H, {'SeqNum', 'hGeneName'}, NumIdx);
+%    [~, Key, Count] = dlmStoreMEX('groupby', H, {'hGeneName'}, []);
+%    dlmStoreMEX('close', H);
+%
+%  See also readDlmFileMEX, BRILIADatastore
+%
+%
@@ -0,0 +1,240 @@
+/*
+findCDRMEX will locate the CDR1, CDR2, and CDR3 of many sequences in one
+call, using the V and J gene assignments and the germline CDR and anchor
+positions. It also returns the CDR3 nt sequence, reading frame, and stop
+codon status. The work is split across CPU threads for large cell arrays.
+This is the kernel used by findCDR.
+
+  [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(Seq, GeneNum, LenDel, Vseq, Vinfo, Janchor)
+
+  [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(..., UseIMGT)
+
+  INPUT
+    Seq: Mx1 cell of nt sequences
+    GeneNum: Mx2 matrix of the [V J] gene numbers in Vseq/Vinfo and
+      Janchor. Use J = 0 to skip the CDR3.
+    LenDel: Mx4 matrix of [Vlen V3'del Jlen J5'del] of each seq
+    Vseq: Px1 cell of germline V gene nt sequences, ex: DB.Vmap(:, M.Seq)
+    Vinfo: Px5 matrix of [CDR1s CDR1e CDR2s CDR2e Anchor] of each V gene,
+      where Anchor is the nt distance of the 104C 1st nt from the V 3' end.
+      Use 0 for unknown positions.
+    Janchor: Qx1 matrix of the 118W/F 1st nt position of each J gene
+    UseIMGT [false]: true to use the IMGT CDR3, which EXCLUDES the 104C and
+      118W/F codons
+
+  OUTPUT
+    CDR1: Mx4 cell of {AminoAcid Length Start End} of the CDR1. AA that
+      differ from the germline are lower case. Uses the germline AA if the
+      CDR1 is not in Seq. Empty if the germline CDR1 is unknown.
+    CDR2: Mx4 cell, same as CDR1, for the CDR2
+    CDR3: Mx4 cell of {AminoAcid Length Start End} of the CDR3. AminoAcid
+      is empty if the CDR3 is not fully in Seq. All empty if J = 0.
+    CDR3nt: Mx1 cell of CDR3 nt sequences
+    Status: Mx4 matrix of [Frame InFrame CDR3Stop SeqStop], where Frame is
+      the Seq reading frame (1, 2, or 3) of the CDR3 start, InFrame is 1 if
+      the CDR3 length is a multiple of 3, CDR3Stop is 1 if the CDR3 has a
+      stop codon, and SeqStop is 1 if Seq has a stop codon in that frame.
+      All 0 if the CDR3 is not fully in Seq.
+
+  EXAMPLE
+    Seq = {'TGTGCAAGAGGGTACTGGGGC'};
+    Vseq = {'AAATGTGCAAGA'};
+    Vinfo = [1 3 4 6 9];
+    [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(Seq, [1 1], [6 3 9 0], Vseq, Vinfo, 4)
+    CDR1 =
+      1x4 cell array
+        {'K'}    {[1]}    {[-2]}    {[0]}
+    CDR2 =
+      1x4 cell array
+        {'C'}    {[1]}    {[1]}    {[3]}
+    CDR3 =
+      1x4 cell array
+        {'CARGYW'}    {[6]}    {[1]}    {[18]}
+    CDR3nt =
+      1x1 cell array
+        {'TGTGCAAGAGGGTACTGG'}
+    Status =
+         1     1     0     0
+
+  See also findCDR, labelSeqQuality
+*/
+
+#include "SeqTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <ctype.h>
+
+typedef std::vector<mxChar> mx_seq;
+
+// cdr_info stores the location and AA seq of one CDR
+struct cdr_info {
+    bool Valid = false;  //Valid: false to return all empty values
+    bool HasAA = false;  //HasAA: false to return an empty AA
+    mx_seq AA;
+    int S = 0, E = 0;    //S, E: 1-based start and end nt positions
+};
+
+// Translates the Len nts of pSeq, without the incomplete last codon
+static void translateSeq(const mxChar *pSeq, int Len, mx_seq &AA) {
+    AA.resize(Len >= 3 ? Len / 3 : 0);
+    for (size_t k = 0; k < AA.size(); k++) {
+        AA[k] = codon2aaN(pSeq + 3*k);
+    }
+}
+
+static mxArray *createCharRow(const mx_seq &Seq) {
+    mwSize Dims[2] = {(mwSize) (Seq.empty() ? 0 : 1), Seq.size()};
+    mxArray *pOut = mxCreateCharArray(2, Dims);
+    std::copy(Seq.begin(), Seq.end(), mxGetChars(pOut));
+    return pOut;
+}
+
+static void setCDRCell(mxArray *pOut, mwSize s, mwSize NumSeq, const cdr_info &CI) {
+    if (!CI.Valid) {
+        for (int k = 0; k < 4; k++) {
+            mxSetCell(pOut, s + k*NumSeq, mxCreateDoubleMatrix(0, 0, mxREAL));
+        }
+        return;
+    }
+    mxSetCell(pOut, s, CI.HasAA ? createCharRow(CI.AA) : mxCreateDoubleMatrix(0, 0, mxREAL));
+    mxSetCell(pOut, s + NumSeq,   mxCreateDoubleScalar((CI.E - CI.S + 1) / 3.0));
+    mxSetCell(pOut, s + 2*NumSeq, mxCreateDoubleScalar(CI.S));
+    mxSetCell(pOut, s + 3*NumSeq, mxCreateDoubleScalar(CI.E));
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 6 || nrhs > 7) {
+        mexErrMsgIdAndTxt("findCDRMEX:nrhs", "Incorrect number of inputs. Min is 6. Max is 7.");
+    }
+    if (nlhs > 5) {
+        mexErrMsgIdAndTxt("findCDRMEX:nlhs", "Too many outputs. Max is 5.");
+    }
+    if (!mxIsCell(prhs[0])) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input1: Seq must be a cell of char.");
+    }
+    mwSize NumSeq = mxGetNumberOfElements(prhs[0]);
+    if (!mxIsDouble(prhs[1]) || mxGetM(prhs[1]) != NumSeq || mxGetN(prhs[1]) != 2) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input2: GeneNum must be a Mx2 matrix.");
+    }
+    if (!mxIsDouble(prhs[2]) || mxGetM(prhs[2]) != NumSeq || mxGetN(prhs[2]) != 4) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input3: LenDel must be a Mx4 matrix.");
+    }
+    if (!mxIsCell(prhs[3])) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input4: Vseq must be a cell of char.");
+    }
+    mwSize NumV = mxGetNumberOfElements(prhs[3]);
+    if (!mxIsDouble(prhs[4]) || mxGetM(prhs[4]) != NumV || mxGetN(prhs[4]) != 5) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input5: Vinfo must be a Px5 matrix, where P is the number of Vseq.");
+    }
+    if (!mxIsDouble(prhs[5])) {
+        mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input6: Janchor must be a Qx1 matrix.");
+    }
+    bool UseIMGT = nrhs >= 7 && !mxIsEmpty(prhs[6]) && mxGetScalar(prhs[6]) != 0;
+
+    double *pGeneNum = mxGetPr(prhs[1]);
+    double *pLenDel  = mxGetPr(prhs[2]);
+    double *pVinfo   = mxGetPr(prhs[4]);
+    double *pJanchor = mxGetPr(prhs[5]);
+    mwSize NumJ = mxGetNumberOfElements(prhs[5]);
+
+    //Gather the inputs here, since mx* is not thread-safe
+    std::vector<const mxChar*> pVseqs(NumV, NULL);
+    std::vector<int> VseqLens(NumV, 0);
+    for (mwSize v = 0; v < NumV; v++) {
+        mxArray *pCell = mxGetCell(prhs[3], v);
+        if (pCell != NULL && mxIsChar(pCell)) {
+            pVseqs[v] = mxGetChars(pCell);
+            VseqLens[v] = (int) mxGetNumberOfElements(pCell);
+        }
+    }
+    std::vector<const mxChar*> pSeqs(NumSeq, NULL);
+    std::vector<int> SeqLens(NumSeq, 0);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mxArray *pCell = mxGetCell(prhs[0], s);
+        if (pCell != NULL && mxIsChar(pCell)) {
+            pSeqs[s] = mxGetChars(pCell);
+            SeqLens[s] = (int) mxGetNumberOfElements(pCell);
+        }
+        double Vnum = pGeneNum[s], Jnum = pGeneNum[s + NumSeq];
+        if (Vnum < 1 || Vnum > NumV || Jnum < 0 || Jnum > NumJ) {
+            mexErrMsgIdAndTxt("findCDRMEX:prhs", "Input2: GeneNum of Seq #%d is out of range.", (int) s + 1);
+        }
+    }
+
+    std::vector<cdr_info> CDR(3 * NumSeq);
+    std::vector<mx_seq> CDR3nt(NumSeq);
+    std::vector<double> Status(4 * NumSeq, 0);
+    parallelFor(NumSeq, 256, [&](size_t Beg, size_t End) {
+        mx_seq RefAA;
+        for (size_t s = Beg; s < End; s++) {
+            int v = (int) pGeneNum[s] - 1;
+            int j = (int) pGeneNum[s + NumSeq] - 1;
+            int Vlen = (int) pLenDel[s], Vdel = (int) pLenDel[s + NumSeq];
+            int Jlen = (int) pLenDel[s + 2*NumSeq], Jdel = (int) pLenDel[s + 3*NumSeq];
+            int SeqLen = SeqLens[s], RefVLen = VseqLens[v];
+
+            //CDR1 and CDR2 are shifted from the germline V positions
+            for (int n = 0; n < 2; n++) {
+                int RefS = (int) pVinfo[v + 2*n*NumV], RefE = (int) pVinfo[v + (2*n+1)*NumV];
+                if (RefS < 1 || RefE < RefS || RefE > RefVLen) { continue; }
+                cdr_info &CI = CDR[3*s + n];
+                CI.Valid = CI.HasAA = true;
+                translateSeq(pVseqs[v] + RefS - 1, RefE - RefS + 1, RefAA);
+                int Vshift = Vlen + Vdel - RefVLen;
+                CI.S = Vshift + RefS;
+                CI.E = Vshift + RefE;
+                if (CI.S > 0 && CI.E <= SeqLen) {
+                    translateSeq(pSeqs[s] + CI.S - 1, CI.E - CI.S + 1, CI.AA);
+                    for (size_t k = 0; k < CI.AA.size(); k++) {
+                        if (CI.AA[k] != RefAA[k] && CI.AA[k] < 128) { CI.AA[k] = tolower(CI.AA[k]); }
+                    }
+                } else {
+                    CI.AA = RefAA;
+                }
+            }
+
+            //CDR3 is from the 104C 1st nt to the 118W/F 3rd nt
+            if (j < 0) { continue; }
+            cdr_info &CI = CDR[3*s + 2];
+            CI.Valid = true;
+            CI.S = Vlen + Vdel - (int) pVinfo[v + 4*NumV] + 1;
+            CI.E = SeqLen - (Jlen + Jdel) + (int) pJanchor[j] + 2;
+            if (UseIMGT) {
+                CI.S += 3;
+                CI.E -= 3;
+            }
+            if (CI.S < 1 || CI.E < 1 || CI.E > SeqLen) { continue; }
+            CI.HasAA = true;
+            translateSeq(pSeqs[s] + CI.S - 1, CI.E - CI.S + 1, CI.AA);
+            if (CI.E >= CI.S) {
+                CDR3nt[s].assign(pSeqs[s] + CI.S - 1, pSeqs[s] + CI.E);
+            }
+
+            int Frame = (CI.S - 1) % 3;
+            Status[s] = Frame + 1;
+            Status[s + NumSeq] = (CI.E - CI.S + 1) % 3 == 0;
+            Status[s + 2*NumSeq] = hasStopCodon(pSeqs[s] + CI.S - 1, CI.E - CI.S + 1);
+            Status[s + 3*NumSeq] = hasStopCodon(pSeqs[s] + Frame, SeqLen - Frame);
+        }
+    });
+
+    for (int n = 0; n < 3; n++) {
+        plhs[n] = mxCreateCellMatrix(NumSeq, 4);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            setCDRCell(plhs[n], s, NumSeq, CDR[3*s + n]);
+        }
+        if (nlhs <= n + 1) { break; }
+    }
+    if (nlhs >= 4) {
+        plhs[3] = mxCreateCellMatrix(NumSeq, 1);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            mxSetCell(plhs[3], s, createCharRow(CDR3nt[s]));
+        }
+    }
+    if (nlhs >= 5) {
+        plhs[4] = mxCreateDoubleMatrix(NumSeq, 4, mxREAL);
+        std::copy(Status.begin(), Status.end(), mxGetPr(plhs[4]));
+    }
+}
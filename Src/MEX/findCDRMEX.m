@@ -0,0 +1,60 @@
+%findCDRMEX will locate the CDR1, CDR2, and CDR3 of many sequences in one
+%call, using the V and J gene assignments and the germline CDR and anchor
+%positions. It also returns the CDR3 nt sequence, reading frame, and stop
+%codon status. The work is split across CPU threads for large cell arrays.
+%This is the kernel used by findCDR.
+%
+%  [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(Seq, GeneNum, LenDel, Vseq, Vinfo, Janchor)
+%
+%  [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(..., UseIMGT)
+%
+%  INPUT
+%    Seq: Mx1 cell of nt sequences
+%    GeneNum: Mx2 matrix of the [V J] gene numbers in Vseq/Vinfo and
+%      Janchor. Use J = 0 to skip the CDR3.
+%    LenDel: Mx4 matrix of [Vlen V3'del Jlen J5'del] of each seq
+%    Vseq: Px1 cell of germline V gene nt sequences, ex: DB.Vmap(:, M.Seq)
+%    Vinfo: Px5 matrix of [CDR1s CDR1e CDR2s CDR2e Anchor] of each V gene,
+%      where Anchor is the nt distance of the 104C 1st nt from the V 3' end.
+%      Use 0 for unknown positions.
+%    Janchor: Qx1 matrix of the 118W/F 1st nt position of each J gene
+%    UseIMGT [false]: true to use the IMGT CDR3, which EXCLUDES the 104C and
+%      118W/F codons
+%
+%  OUTPUT
+%    CDR1: Mx4 cell of {AminoAcid Length Start End} of the CDR1. AA that
+%      differ from the germline are lower case. Uses the germline AA if the
+%      CDR1 is not in Seq. Empty if the germline CDR1 is unknown.
+%    CDR2: Mx4 cell, same as CDR1, for the CDR2
+%    CDR3: Mx4 cell of {AminoAcid Length Start End} of the CDR3. AminoAcid
+%      is empty if the CDR3 is not fully in Seq. All empty if J = 0.
+%    CDR3nt: Mx1 cell of CDR3 nt sequences
+%    Status: Mx4 matrix of [Frame InFrame CDR3Stop SeqStop], where Frame is
+%      the Seq reading frame (1, 2, or 3) of the CDR3 start, InFrame is 1 if
+%      the CDR3 length is a multiple of 3, CDR3Stop is 1 if the CDR3 has a
+%      stop codon, and SeqStop is 1 if Seq has a stop codon in that frame.
+%      All 0 if the CDR3 is not fully in Seq.
+%
+%  EXAMPLE
+%    Seq = {'TGTGCAAGAGGGTACTGGGGC'};
+%    Vseq = {'AAATGTGCAAGA'};
+%    Vinfo = [1 3 4 6 9];
+%    [CDR1, CDR2, CDR3, CDR3nt, Status] = findCDRMEX(Seq, [1 1], [6 3 9 0], Vseq, Vinfo, 4)
+%    CDR1 =
+%      1x4 cell array
+%        {'K'}    {[1]}    {[-2]}    {[0]}
+%    CDR2 =
+%      1x4 cell array
+%        {'C'}    {[1]}    {[1]}    {[3]}
+%    CDR3 =
+%      1x4 cell array
+%        {'CARGYW'}    {[6]}    {[1]}    {[18]}
+%    CDR3nt =
+%      1x1 cell array
+%        {'TGTGCAAGAGGGTACTGG'}
+%    Status =
+%         1     1     0     0
+%
+%  See also findCDR, labelSeqQuality
+%
+%
@@ -1,86 +1,53 @@
 /*  
 findConsecOnesMEX will get a 1xN or Mx1 vector and label form 1 to N the
-number of consecutive-matched ones.
+number of consecutive-matched ones. It can also label each column of a
+matrix or each vector of a cell in one call, across threads, and return
+either the labels or the run-length [Start Length Label] of each run.
 
   Label = findConsecOnesMEX(Region)
+
+  Label = findConsecOnesMEX(Region, Output)
     
   INPUT
-    Region: 1xN or Mx1 vector like [0 0 1 1 1 1 0 0 0 0 1 1]
+    Region: 1xN or Mx1 vector like [0 0 1 1 1 1 0 0 0 0 1 1], MxN matrix
+      to label each column, or a cell of vectors. Can be double or logical.
+    Output ['double', 'int32', 'runs']: the output format
+      'double' - double labels of size(Region)
+      'int32'  - int32 labels of size(Region), which use half the memory
+      'runs'   - Rx3 matrix of [Start Length Label] of each run, Rx4 matrix
+                 of [Col Start Length Label] for a matrix, or cell of Rx3
+                 matrices for a cell
     
   OUTPUT
-    Label: vector of size(Region) of regions 1 to N
+    Label: vector of size(Region) of regions 1 to N, or the runs. A cell
+      Region returns a cell of the same size.
+
+  NOTE
+    For double inputs, only values of 1 are labeled, and negative or NaN
+    values do not end a run of 1's.
 
   EXAMPLE
     Region = [0 0 1 1 1 1 0 0 0 0 1 1];
     Label  = findConsecOnesMEX(Region)
     Label  = 
              [0 0 1 1 1 1 0 0 0 0 2 2]
-*/
 
-#include "mex.h"
+    Runs = findConsecOnesMEX(Region, 'runs')
+    Runs =
+             3     4     1
+            11     2     2
 
-void findConsecOnes(double *MatI, mwSize M, double *MatO) {
-    mwSize i;
-    double j = 0;
-    bool b = false;
-    for (i = 0; i < M; i++) {
-        if (!b && MatI[i] > 0) {
-            b = true;
-            j++;
-        } else if (b && MatI[i] == 0) {
-            b = false;
-        }
-        if (MatI[i] == 1) {
-            MatO[i] = j;
-        }
-    }
-}
+    Label = findConsecOnesMEX({[1 0 1], [0 1 1]}, 'int32')
+    Label =
+      1x2 cell array
+        {1x3 int32}    {1x3 int32}
 
-void findConsecOnes(bool *MatI, mwSize M, double *MatO) {
-    mwSize i;
-    double j = 0;
-    bool b = false;
-    for (i = 0; i < M; i++) {
-        if (!b && MatI[i]) {
-            b = true;
-            j++;
-        } else if (b && !MatI[i]) {
-            b = false;
-        }
-        if (MatI[i]) {
-            MatO[i] = j;
-        }
-    }
-}
+  See also labelRegionMEX, findConsecLoc
+*/
+
+#include "RegionTool.hpp"
 
 void mexFunction(int nlhs,        mxArray *plhs[],
                  int nrhs, const  mxArray *prhs[]) {
-
-    if (nrhs != 1) {
-        mexErrMsgIdAndTxt("mxFindConsecOnes:nrhs", "Incorrect number of inputs. Expected 1.");
-    }
-    if (nlhs != 1) {
-        mexErrMsgIdAndTxt("mxFindConsecOnes:nlhs", "Incorrect number of inputs. Expected 1.");
-    }
-    if (mxGetN(prhs[0]) > 1 && mxGetM(prhs[0]) > 1) {
-        mexErrMsgIdAndTxt("mxFindConsecONes:prhs", "Input must be a 1xN or Mx1 vector.");
-    }
-
-    mwSize M = mxGetM(prhs[0]);
-    mwSize N = mxGetN(prhs[0]);
-    mwSize P = M > N ? M : N;
-    double *MatO;
-    plhs[0] = mxCreateDoubleMatrix(M, N, mxREAL);
-    MatO = mxGetPr(plhs[0]);
-
-    if (mxIsDouble(prhs[0])) {
-        double *MatI; 
-        MatI = mxGetPr(prhs[0]);
-        findConsecOnes(MatI, P, MatO);
-    } else if (mxIsLogical(prhs[0])) {
-        bool *MatI;
-        MatI = mxGetLogicals(prhs[0]);
-        findConsecOnes(MatI, P, MatO);
-    }
+    labelRegionBatch(nlhs, plhs, nrhs, prhs, REGION_CONSEC_ONES, "findConsecOnesMEX");
 }
-
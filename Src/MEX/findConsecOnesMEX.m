@@ -1,13 +1,29 @@
 %findConsecOnesMEX will get a 1xN or Mx1 vector and label form 1 to N the
-%number of consecutive-matched ones.
+%number of consecutive-matched ones. It can also label each column of a
+%matrix or each vector of a cell in one call, across threads, and return
+%either the labels or the run-length [Start Length Label] of each run.
 %
 %  Label = findConsecOnesMEX(Region)
+%
+%  Label = findConsecOnesMEX(Region, Output)
 %    
 %  INPUT
-%    Region: 1xN or Mx1 vector like [0 0 1 1 1 1 0 0 0 0 1 1]
+%    Region: 1xN or Mx1 vector like [0 0 1 1 1 1 0 0 0 0 1 1], MxN matrix
+%      to label each column, or a cell of vectors. Can be double or logical.
+%    Output ['double', 'int32', 'runs']: the output format
+%      'double' - double labels of size(Region)
+%      'int32'  - int32 labels of size(Region), which use half the memory
+%      'runs'   - Rx3 matrix of [Start Length Label] of each run, Rx4 matrix
+%                 of [Col Start Length Label] for a matrix, or cell of Rx3
+%                 matrices for a cell
 %    
 %  OUTPUT
-%    Label: vector of size(Region) of regions 1 to N
+%    Label: vector of size(Region) of regions 1 to N, or the runs. A cell
+%      Region returns a cell of the same size.
+%
+%  NOTE
+%    For double inputs, only values of 1 are labeled, and negative or NaN
+%    values do not end a run of 1's.
 %
 %  EXAMPLE
 %    Region = [0 0 1 1 1 1 0 0 0 0 1 1];
@@ -15,4 +31,16 @@
 %    Label  = 
 %             [0 0 1 1 1 1 0 0 0 0 2 2]
 %
+%    Runs = findConsecOnesMEX(Region, 'runs')
+%    Runs =
+%             3     4     1
+%            11     2     2
+%
+%    Label = findConsecOnesMEX({[1 0 1], [0 1 1]}, 'int32')
+%    Label =
+%      1x2 cell array
+%        {1x3 int32}    {1x3 int32}
+%
+%  See also labelRegionMEX, findConsecLoc
+%
 %
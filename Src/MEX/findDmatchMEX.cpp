@@ -0,0 +1,125 @@
+/*
+findDmatchMEX will find the best D gene match of many N-D-N sequences in
+one call. It gives the same result as findGeneMatch(Seq, Dmap, 'D',
+MissRate) for each sequence, but all D genes at all offsets are scored
+with bit masks, and the sequences are split across CPU threads.
+
+  [GeneNum, RefLMR, SamLMR, Score] = findDmatchMEX(Seq, Dseq, MissRate)
+
+  INPUT
+    Seq: Mx1 cell of N-D-N nt sequences, or a 1xN char
+    Dseq: Px1 cell of D gene nt sequences, ex: DB.Dmap(:, 1). Empty ones
+      are skipped. Each must be <= 64 nt.
+    MissRate [0]: scalar or Mx1 matrix of the point mutations per nt
+      allowed during alignment, from 0.00 to 1.00 (see findGeneMatch)
+
+  OUTPUT
+    GeneNum: Mx1 cell of the 1xQ D gene numbers with the same best match.
+      Empty if there is no match.
+    RefLMR: Mx3 matrix of [5'del, Dlen, 3'del] of the D gene
+    SamLMR: Mx3 matrix of [Nvd, Dlen, Ndj] lengths of the seq
+    Score: Mx2 matrix of [(# of matches) AlignmentScore]
+
+  EXAMPLE
+    Dseq = {'GGTAGCTAC'; 'TCTACTATGG'};
+    [GeneNum, RefLMR, SamLMR, Score] = findDmatchMEX({'CCGTAGCTACAA'}, Dseq, 0)
+    GeneNum =
+      1x1 cell array
+        {[1]}
+    RefLMR =
+         1     8     0
+    SamLMR =
+         2     8     2
+    Score =
+         8    64
+
+  See also findGeneMatch, findBetterD, findVDJmatch
+*/
+
+#include "DgeneTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || nrhs > 3) {
+        mexErrMsgIdAndTxt("findDmatchMEX:nrhs", "Incorrect number of inputs. Min is 2. Max is 3.");
+    }
+    if (nlhs > 4) {
+        mexErrMsgIdAndTxt("findDmatchMEX:nlhs", "Too many outputs. Max is 4.");
+    }
+    if (!(mxIsCell(prhs[0]) || mxIsChar(prhs[0]))) {
+        mexErrMsgIdAndTxt("findDmatchMEX:prhs", "Input1: Seq must be a cell of char or a char.");
+    }
+    if (!mxIsCell(prhs[1])) {
+        mexErrMsgIdAndTxt("findDmatchMEX:prhs", "Input2: Dseq must be a cell of char.");
+    }
+
+    bool IsCell = mxIsCell(prhs[0]);
+    mwSize NumSeq = IsCell ? mxGetNumberOfElements(prhs[0]) : 1;
+    mwSize NumRate = nrhs >= 3 ? mxGetNumberOfElements(prhs[2]) : 0;
+    if (nrhs >= 3 && (!mxIsDouble(prhs[2]) || (NumRate > 1 && NumRate != NumSeq))) {
+        mexErrMsgIdAndTxt("findDmatchMEX:prhs", "Input3: MissRate must be a scalar or Mx1 matrix between 0.0 to 1.0.");
+    }
+    double *pRate = NumRate > 0 ? mxGetPr(prhs[2]) : NULL;
+
+    mwSize NumD = mxGetNumberOfElements(prhs[1]);
+    std::vector<std::string> Dseq(NumD);
+    for (mwSize d = 0; d < NumD; d++) {
+        mxArray *pCell = mxGetCell(prhs[1], d);
+        if (pCell == NULL || !mxIsChar(pCell)) { continue; }
+        mxChar *pD = mxGetChars(pCell);
+        Dseq[d].resize(mxGetNumberOfElements(pCell));
+        for (mwSize j = 0; j < Dseq[d].size(); j++) {
+            Dseq[d][j] = pD[j] < 256 ? (char) pD[j] : 'X';
+        }
+    }
+    dgene_set DS;
+    buildDgeneSet(DS, Dseq);
+
+    //Gather the inputs here, since mx* is not thread-safe
+    std::vector<const mxChar*> pSeqs(NumSeq, NULL);
+    std::vector<mwSize> SeqLens(NumSeq, 0);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        const mxArray *pCell = IsCell ? mxGetCell(prhs[0], s) : prhs[0];
+        if (pCell != NULL && mxIsChar(pCell)) {
+            pSeqs[s] = mxGetChars(pCell);
+            SeqLens[s] = mxGetNumberOfElements(pCell);
+        }
+    }
+
+    std::vector<d_match> DM(NumSeq);
+    parallelFor(NumSeq, 64, [&](size_t Beg, size_t End) {
+        for (size_t s = Beg; s < End; s++) {
+            double MissRate = pRate == NULL ? 0 : pRate[NumRate > 1 ? s : 0];
+            findDmatch(DS, pSeqs[s], SeqLens[s], MissRate, DM[s]);
+        }
+    });
+
+    plhs[0] = mxCreateCellMatrix(NumSeq, 1);
+    mxArray *pRefOut = mxCreateDoubleMatrix(NumSeq, 3, mxREAL);
+    mxArray *pSamOut = mxCreateDoubleMatrix(NumSeq, 3, mxREAL);
+    mxArray *pScoreOut = mxCreateDoubleMatrix(NumSeq, 2, mxREAL);
+    double *pRef = mxGetPr(pRefOut);
+    double *pSam = mxGetPr(pSamOut);
+    double *pScore = mxGetPr(pScoreOut);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mxArray *pNum = mxCreateDoubleMatrix(DM[s].Num.empty() ? 0 : 1, DM[s].Num.size(), mxREAL);
+        double *pN = mxGetPr(pNum);
+        for (size_t k = 0; k < DM[s].Num.size(); k++) {
+            pN[k] = DM[s].Num[k] + 1;
+        }
+        mxSetCell(plhs[0], s, pNum);
+        for (int k = 0; k < 3; k++) {
+            pRef[s + k*NumSeq] = DM[s].RefLMR[k];
+            pSam[s + k*NumSeq] = DM[s].SamLMR[k];
+        }
+        pScore[s] = DM[s].Match;
+        pScore[s + NumSeq] = DM[s].Score;
+    }
+
+    if (nlhs >= 2) { plhs[1] = pRefOut;   } else { mxDestroyArray(pRefOut); }
+    if (nlhs >= 3) { plhs[2] = pSamOut;   } else { mxDestroyArray(pSamOut); }
+    if (nlhs >= 4) { plhs[3] = pScoreOut; } else { mxDestroyArray(pScoreOut); }
+}
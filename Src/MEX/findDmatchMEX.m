@@ -0,0 +1,37 @@
+%findDmatchMEX will find the best D gene match of many N-D-N sequences in
+%one call. It gives the same result as findGeneMatch(Seq, Dmap, 'D',
+%MissRate) for each sequence, but all D genes at all offsets are scored
+%with bit masks, and the sequences are split across CPU threads.
+%
+%  [GeneNum, RefLMR, SamLMR, Score] = findDmatchMEX(Seq, Dseq, MissRate)
+%
+%  INPUT
+%    Seq: Mx1 cell of N-D-N nt sequences, or a 1xN char
+%    Dseq: Px1 cell of D gene nt sequences, ex: DB.Dmap(:, 1). Empty ones
+%      are skipped. Each must be <= 64 nt.
+%    MissRate [0]: scalar or Mx1 matrix of the point mutations per nt
+%      allowed during alignment, from 0.00 to 1.00 (see findGeneMatch)
+%
+%  OUTPUT
+%    GeneNum: Mx1 cell of the 1xQ D gene numbers with the same best match.
+%      Empty if there is no match.
+%    RefLMR: Mx3 matrix of [5'del, Dlen, 3'del] of the D gene
+%    SamLMR: Mx3 matrix of [Nvd, Dlen, Ndj] lengths of the seq
+%    Score: Mx2 matrix of [(# of matches) AlignmentScore]
+%
+%  EXAMPLE
+%    Dseq = {'GGTAGCTAC'; 'TCTACTATGG'};
+%    [GeneNum, RefLMR, SamLMR, Score] = findDmatchMEX({'CCGTAGCTACAA'}, Dseq, 0)
+%    GeneNum =
+%      1x1 cell array
+%        {[1]}
+%    RefLMR =
+%         1     8     0
+%    SamLMR =
+%         2     8     2
+%    Score =
+%         8    64
+%
+%  See also findGeneMatch, findBetterD, findVDJmatch
+%
+%
@@ -0,0 +1,181 @@
+/*
+findUniqueSeqMEX will find the unique rows of a cell array of sequences
+using a hash table, ignoring letter case. It is used to annotate only 1
+copy of identical reads, such as PCR duplicates. It can also remember the
+sequences of past batches, so that their annotations can be reused.
+
+  [UnqIdx, GrpIdx, Count] = findUniqueSeqMEX(Seq)
+
+  KnownNum = findUniqueSeqMEX(Seq, 'find')
+
+  findUniqueSeqMEX(Seq, 'add', KnownNum)
+
+  findUniqueSeqMEX('clear')
+
+  INPUT
+    Seq: MxK cell of sequences. Each row is 1 read, and the K columns are
+      the chain sequences (ex: heavy and light chain). Non-char cells are
+      treated as ''.
+    'find': returns the number given to each row by a past 'add'
+    'add': remembers the number of each row. Rows already known are kept.
+    KnownNum: Mx1 numbers > 0 to remember each row by
+    'clear': forgets all rows that were added
+
+  OUTPUT
+    UnqIdx: Ux1 row index of the 1st copy of each unique row, in the order
+      they appear in Seq
+    GrpIdx: Mx1 index of each row in UnqIdx, such that Seq(UnqIdx(GrpIdx),
+      :) is Seq (ignoring case)
+    Count: Ux1 number of copies of each unique row
+    KnownNum: Mx1 number given to each row by 'add', or 0 if unknown
+
+  EXAMPLE
+    Seq = {'ACGT'; 'AAAA'; 'acgt'; 'ACGT'};
+    [UnqIdx, GrpIdx, Count] = findUniqueSeqMEX(Seq)
+    UnqIdx =
+         1
+         2
+    GrpIdx =
+         1
+         2
+         1
+         1
+    Count =
+         3
+         1
+
+    findUniqueSeqMEX(Seq(UnqIdx), 'add', [10; 20]);
+    KnownNum = findUniqueSeqMEX({'AAAA'; 'CCCC'}, 'find')
+    KnownNum =
+        20
+         0
+
+  See also collapseVDJdata, expandVDJdata
+*/
+
+#include "ThreadTool.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+static std::unordered_map<std::string, double> KNOWN; //remembered rows of past batches
+
+// Builds the key of each row, which is the uppercase seqs joined by '\0'
+static void buildSeqKeys(const mxArray *pSeq, std::vector<std::string> &Keys) {
+    mwSize NumRow = mxGetM(pSeq), NumCol = mxGetN(pSeq);
+    std::vector<const mxChar*> pChars(NumRow*NumCol, NULL);
+    std::vector<mwSize> Lens(NumRow*NumCol, 0);
+    for (mwSize j = 0; j < NumRow*NumCol; j++) {
+        mxArray *pCell = mxGetCell(pSeq, j);
+        if (pCell != NULL && mxIsChar(pCell)) {
+            pChars[j] = mxGetChars(pCell);
+            Lens[j] = mxGetNumberOfElements(pCell);
+        }
+    }
+
+    Keys.assign(NumRow, std::string());
+    parallelFor(NumRow, 1024, [&](size_t Beg, size_t End) {
+        for (size_t r = Beg; r < End; r++) {
+            std::string &Key = Keys[r];
+            for (mwSize c = 0; c < NumCol; c++) {
+                const mxChar *pChar = pChars[r + c*NumRow];
+                for (mwSize k = 0; k < Lens[r + c*NumRow]; k++) {
+                    mxChar Letter = pChar[k];
+                    Key += (char) (Letter >= 'a' && Letter <= 'z' ? Letter - 32 : Letter);
+                }
+                Key += '\0';
+            }
+        }
+    });
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs == 1 && mxIsChar(prhs[0])) {
+        char *pCmd = mxArrayToString(prhs[0]);
+        std::string Cmd(pCmd);
+        mxFree(pCmd);
+        if (Cmd != "clear") {
+            mexErrMsgIdAndTxt("findUniqueSeqMEX:prhs", "Input1: Unknown command '%s'.", Cmd.c_str());
+        }
+        std::unordered_map<std::string, double>().swap(KNOWN);
+        return;
+    }
+    if (nrhs < 1 || nrhs > 3) {
+        mexErrMsgIdAndTxt("findUniqueSeqMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 3.");
+    }
+    if (!mxIsCell(prhs[0]) || mxGetNumberOfDimensions(prhs[0]) > 2) {
+        mexErrMsgIdAndTxt("findUniqueSeqMEX:prhs", "Input1: Seq must be a MxK cell of sequences.");
+    }
+    std::string Cmd;
+    if (nrhs >= 2) {
+        if (!mxIsChar(prhs[1])) {
+            mexErrMsgIdAndTxt("findUniqueSeqMEX:prhs", "Input2: must be 'find' or 'add'.");
+        }
+        char *pCmd = mxArrayToString(prhs[1]);
+        Cmd = pCmd;
+        mxFree(pCmd);
+        if (Cmd != "find" && Cmd != "add") {
+            mexErrMsgIdAndTxt("findUniqueSeqMEX:prhs", "Input2: must be 'find' or 'add'.");
+        }
+    }
+    if (Cmd == "add" && (nrhs != 3 || !mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != mxGetM(prhs[0]))) {
+        mexErrMsgIdAndTxt("findUniqueSeqMEX:prhs", "Input3: KnownNum must be a Mx1 double matrix for 'add'.");
+    }
+
+    mwSize NumRow = mxGetM(prhs[0]);
+    std::vector<std::string> Keys;
+    buildSeqKeys(prhs[0], Keys);
+
+    if (Cmd == "find") {
+        plhs[0] = mxCreateDoubleMatrix(NumRow, 1, mxREAL);
+        double *pKnown = mxGetPr(plhs[0]);
+        if (KNOWN.empty()) { return; }
+        for (mwSize r = 0; r < NumRow; r++) {
+            std::unordered_map<std::string, double>::iterator Iter = KNOWN.find(Keys[r]);
+            if (Iter != KNOWN.end()) { pKnown[r] = Iter->second; }
+        }
+        return;
+    }
+
+    if (Cmd == "add") {
+        const double *pKnown = mxGetPr(prhs[2]);
+        for (mwSize r = 0; r < NumRow; r++) {
+            if (pKnown[r] > 0) { KNOWN.insert(std::make_pair(Keys[r], pKnown[r])); }
+        }
+        return;
+    }
+
+    std::unordered_map<std::string, mwSize> UnqMap;
+    UnqMap.reserve(NumRow);
+    std::vector<mwSize> UnqIdx, Count;
+    std::vector<double> GrpIdx(NumRow, 0);
+    for (mwSize r = 0; r < NumRow; r++) {
+        std::pair<std::unordered_map<std::string, mwSize>::iterator, bool> Ins = UnqMap.insert(std::make_pair(Keys[r], UnqIdx.size()));
+        if (Ins.second) {
+            UnqIdx.push_back(r);
+            Count.push_back(0);
+        }
+        GrpIdx[r] = (double) Ins.first->second + 1;
+        Count[Ins.first->second]++;
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(UnqIdx.size(), 1, mxREAL);
+    double *pUnqIdx = mxGetPr(plhs[0]);
+    for (size_t u = 0; u < UnqIdx.size(); u++) {
+        pUnqIdx[u] = (double) UnqIdx[u] + 1;
+    }
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateDoubleMatrix(NumRow, 1, mxREAL);
+        std::copy(GrpIdx.begin(), GrpIdx.end(), mxGetPr(plhs[1]));
+    }
+    if (nlhs >= 3) {
+        plhs[2] = mxCreateDoubleMatrix(UnqIdx.size(), 1, mxREAL);
+        double *pCount = mxGetPr(plhs[2]);
+        for (size_t u = 0; u < Count.size(); u++) {
+            pCount[u] = (double) Count[u];
+        }
+    }
+}
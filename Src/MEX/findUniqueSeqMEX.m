@@ -0,0 +1,54 @@
+%findUniqueSeqMEX will find the unique rows of a cell array of sequences
+%using a hash table, ignoring letter case. It is used to annotate only 1
+%copy of identical reads, such as PCR duplicates. It can also remember the
+%sequences of past batches, so that their annotations can be reused.
+%
+%  [UnqIdx, GrpIdx, Count] = findUniqueSeqMEX(Seq)
+%
+%  KnownNum = findUniqueSeqMEX(Seq, 'find')
+%
+%  findUniqueSeqMEX(Seq, 'add', KnownNum)
+%
+%  findUniqueSeqMEX('clear')
+%
+%  INPUT
+%    Seq: MxK cell of sequences. Each row is 1 read, and the K columns are
+%      the chain sequences (ex: heavy and light chain). Non-char cells are
+%      treated as ''.
+%    'find': returns the number given to each row by a past 'add'
+%    'add': remembers the number of each row. Rows already known are kept.
+%    KnownNum: Mx1 numbers > 0 to remember each row by
+%    'clear': forgets all rows that were added
+%
+%  OUTPUT
+%    UnqIdx: Ux1 row index of the 1st copy of each unique row, in the order
+%      they appear in Seq
+%    GrpIdx: Mx1 index of each row in UnqIdx, such that Seq(UnqIdx(GrpIdx),
+%      :) is Seq (ignoring case)
+%    Count: Ux1 number of copies of each unique row
+%    KnownNum: Mx1 number given to each row by 'add', or 0 if unknown
+%
+%  EXAMPLE
+%    Seq = {'ACGT'; 'AAAA'; 'acgt'; 'ACGT'};
+%    [UnqIdx, GrpIdx, Count] = findUniqueSeqMEX(Seq)
+%    UnqIdx =
+%         1
+%         2
+%    GrpIdx =
+%         1
+%         2
+%         1
+%         1
+%    Count =
+%         3
+%         1
+%
+%    findUniqueSeqMEX(Seq(UnqIdx), 'add', [10; 20]);
+%    KnownNum = findUniqueSeqMEX({'AAAA'; 'CCCC'}, 'find')
+%    KnownNum =
+%        20
+%         0
+%
+%  See also collapseVDJdata, expandVDJdata
+%
+%
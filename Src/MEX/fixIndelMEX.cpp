@@ -0,0 +1,172 @@
+/*
+fixIndelMEX will find and fix the insertion/deletion (indel) errors of a
+batch of sequences, such as V gene segments, against their reference
+sequences. Each Seq is first aligned without gaps (see alignSeqMEX), and
+the best shift seeds a banded, affine-gap local alignment that searches
+only a few diagonals around it. Deleted nts are then filled in with the
+RefSeq nts, and inserted nts are removed. The work is split across CPU
+threads for large cell arrays.
+
+  FixSeq = fixIndelMEX(Seq, RefSeq)
+
+  [FixSeq, Cigar, IndelCt, StartAt, Score] = fixIndelMEX(Seq, RefSeq, Band, GapPenalty)
+
+  INPUT
+    Seq: Mx1 cell of nt sequences
+    RefSeq: Mx1 cell of the reference nt sequence of each Seq
+    Band [8]: # of diagonals to search on each side of the ungapped
+      alignment diagonal. Indels that shift the alignment by more than
+      this are not found.
+    GapPenalty [8 8]: [GapOpen GapExtend] penalties. A gap of length L
+      costs GapOpen + (L-1)*GapExtend. Scores are 5 for a match, -4 for a
+      mismatch, and -2 for an N.
+
+  OUTPUT
+    FixSeq: Mx1 cell of Seq with the indels fixed. The unaligned 5' and 3'
+      ends of Seq are kept as is.
+    Cigar: Mx1 cell of CIGAR strings of the local alignment of Seq, where
+      M = match/mismatch, I = nt in Seq only, D = nt in RefSeq only, and
+      S = unaligned Seq ends. Empty if there is no alignment.
+    IndelCt: Mx3 matrix of [(# of inserted nt) (# of deleted nt) (longest
+      indel length)]
+    StartAt: Mx2 matrix of the [Seq RefSeq] positions where the local
+      alignment starts. [0 0] if there is no alignment.
+    Score: Mx1 local alignment score
+
+  EXAMPLE
+    Seq = {'ACGTTAGCAGTCCATGG'; 'ACGTTAGCTGAGTCCATGG'};
+    RefSeq = {'ACGTTAGCTAGTCCATGG'; 'ACGTTAGCTAGTCCATGG'};
+    [FixSeq, Cigar, IndelCt] = fixIndelMEX(Seq, RefSeq)
+    FixSeq =
+      2x1 cell array
+        {'ACGTTAGCTAGTCCATGG'}
+        {'ACGTTAGCTAGTCCATGG'}
+    Cigar =
+      2x1 cell array
+        {'8M1D9M'}
+        {'9M1I9M'}
+    IndelCt =
+         0     1     1
+         1     0     1
+
+  See also fixGeneIndel, alignSeqMEX
+*/
+
+#include "AlignTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <string>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || nrhs > 4) {
+        mexErrMsgIdAndTxt("fixIndelMEX:nrhs", "Incorrect number of inputs. Min is 2. Max is 4.");
+    }
+    if (nlhs > 5) {
+        mexErrMsgIdAndTxt("fixIndelMEX:nlhs", "Too many outputs. Max is 5.");
+    }
+    if (!mxIsCell(prhs[0]) || !mxIsCell(prhs[1])) {
+        mexErrMsgIdAndTxt("fixIndelMEX:prhs", "Input1 and Input2: Seq and RefSeq must be cells of char.");
+    }
+    mwSize NumSeq = mxGetNumberOfElements(prhs[0]);
+    if (mxGetNumberOfElements(prhs[1]) != NumSeq) {
+        mexErrMsgIdAndTxt("fixIndelMEX:prhs", "Input2: RefSeq must have the same number of elements as Seq.");
+    }
+
+    gap_param GP;
+    if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        if (!mxIsDouble(prhs[2]) || mxGetScalar(prhs[2]) < 0) {
+            mexErrMsgIdAndTxt("fixIndelMEX:prhs", "Input3: Band must be a scalar >= 0.");
+        }
+        GP.Band = (int) mxGetScalar(prhs[2]);
+    }
+    if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        if (!mxIsDouble(prhs[3]) || mxGetNumberOfElements(prhs[3]) != 2) {
+            mexErrMsgIdAndTxt("fixIndelMEX:prhs", "Input4: GapPenalty must be a 1x2 matrix of [GapOpen GapExtend].");
+        }
+        GP.GapOpen = mxGetPr(prhs[3])[0];
+        GP.GapExtend = mxGetPr(prhs[3])[1];
+    }
+
+    //Gather the inputs here, since mx* is not thread-safe
+    std::vector<mxChar*> pSeqs(NumSeq, NULL), pRefs(NumSeq, NULL);
+    std::vector<mwSize> SeqLens(NumSeq, 0), RefLens(NumSeq, 0);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mxArray *pSeq = mxGetCell(prhs[0], s);
+        mxArray *pRef = mxGetCell(prhs[1], s);
+        if (pSeq != NULL && mxIsChar(pSeq)) {
+            pSeqs[s] = mxGetChars(pSeq);
+            SeqLens[s] = mxGetNumberOfElements(pSeq);
+        }
+        if (pRef != NULL && mxIsChar(pRef)) {
+            pRefs[s] = mxGetChars(pRef);
+            RefLens[s] = mxGetNumberOfElements(pRef);
+        }
+    }
+
+    std::vector<gap_align_info> GI(NumSeq);
+    std::vector<std::vector<mxChar> > FixSeq(NumSeq);
+    parallelFor(NumSeq, 64, [&](size_t Beg, size_t End) {
+        for (size_t s = Beg; s < End; s++) {
+            if (SeqLens[s] > 0 && RefLens[s] > 0) {
+                align_info AI;
+                bool pMatch[SeqLens[s] > RefLens[s] ? SeqLens[s] : RefLens[s]];
+                alignSeq(pSeqs[s], pRefs[s], SeqLens[s], RefLens[s], 0, 'n', 'n', 'n', 'n', 'n', AI, pMatch, true); //only BShift is needed
+                alignGapSeq(pSeqs[s], pRefs[s], SeqLens[s], RefLens[s], AI.BShift, GP, GI[s]);
+            }
+            if (SeqLens[s] > 0) {
+                fixIndelSeq(pSeqs[s], pRefs[s], SeqLens[s], GI[s], FixSeq[s]);
+            }
+        }
+    });
+
+    plhs[0] = mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0]));
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mwSize Dims[2] = {(mwSize) (FixSeq[s].empty() ? 0 : 1), FixSeq[s].size()};
+        mxArray *pOut = mxCreateCharArray(2, Dims);
+        std::copy(FixSeq[s].begin(), FixSeq[s].end(), mxGetChars(pOut));
+        mxSetCell(plhs[0], s, pOut);
+    }
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0]));
+        for (mwSize s = 0; s < NumSeq; s++) {
+            mxSetCell(plhs[1], s, mxCreateString(buildCigar(GI[s], SeqLens[s]).c_str()));
+        }
+    }
+
+    if (nlhs >= 3) {
+        plhs[2] = mxCreateDoubleMatrix(NumSeq, 3, mxREAL);
+        double *pIndel = mxGetPr(plhs[2]);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            const std::string &Ops = GI[s].Ops;
+            for (size_t k = 0; k < Ops.size(); ) {
+                size_t e = k;
+                while (e < Ops.size() && Ops[e] == Ops[k]) { e++; }
+                if (Ops[k] != 'M') {
+                    pIndel[s + (Ops[k] == 'I' ? 0 : NumSeq)] += (double) (e - k);
+                    if ((double) (e - k) > pIndel[s + 2*NumSeq]) { pIndel[s + 2*NumSeq] = (double) (e - k); }
+                }
+                k = e;
+            }
+        }
+    }
+
+    if (nlhs >= 4) {
+        plhs[3] = mxCreateDoubleMatrix(NumSeq, 2, mxREAL);
+        double *pStartAt = mxGetPr(plhs[3]);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            pStartAt[s] = GI[s].StartA + 1;
+            pStartAt[s + NumSeq] = GI[s].StartB + 1;
+        }
+    }
+
+    if (nlhs >= 5) {
+        plhs[4] = mxCreateDoubleMatrix(NumSeq, 1, mxREAL);
+        double *pScore = mxGetPr(plhs[4]);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            pScore[s] = GI[s].Score;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+%fixIndelMEX will find and fix the insertion/deletion (indel) errors of a
+%batch of sequences, such as V gene segments, against their reference
+%sequences. Each Seq is first aligned without gaps (see alignSeqMEX), and
+%the best shift seeds a banded, affine-gap local alignment that searches
+%only a few diagonals around it. Deleted nts are then filled in with the
+%RefSeq nts, and inserted nts are removed. The work is split across CPU
+%threads for large cell arrays.
+%
+%  FixSeq = fixIndelMEX(Seq, RefSeq)
+%
+%  [FixSeq, Cigar, IndelCt, StartAt, Score] = fixIndelMEX(Seq, RefSeq, Band, GapPenalty)
+%
+%  INPUT
+%    Seq: Mx1 cell of nt sequences
+%    RefSeq: Mx1 cell of the reference nt sequence of each Seq
+%    Band [8]: # of diagonals to search on each side of the ungapped
+%      alignment diagonal. Indels that shift the alignment by more than
+%      this are not found.
+%    GapPenalty [8 8]: [GapOpen GapExtend] penalties. A gap of length L
+%      costs GapOpen + (L-1)*GapExtend. Scores are 5 for a match, -4 for a
+%      mismatch, and -2 for an N.
+%
+%  OUTPUT
+%    FixSeq: Mx1 cell of Seq with the indels fixed. The unaligned 5' and 3'
+%      ends of Seq are kept as is.
+%    Cigar: Mx1 cell of CIGAR strings of the local alignment of Seq, where
+%      M = match/mismatch, I = nt in Seq only, D = nt in RefSeq only, and
+%      S = unaligned Seq ends. Empty if there is no alignment.
+%    IndelCt: Mx3 matrix of [(# of inserted nt) (# of deleted nt) (longest
+%      indel length)]
+%    StartAt: Mx2 matrix of the [Seq RefSeq] positions where the local
+%      alignment starts. [0 0] if there is no alignment.
+%    Score: Mx1 local alignment score
+%
+%  EXAMPLE
+%    Seq = {'ACGTTAGCAGTCCATGG'; 'ACGTTAGCTGAGTCCATGG'};
+%    RefSeq = {'ACGTTAGCTAGTCCATGG'; 'ACGTTAGCTAGTCCATGG'};
+%    [FixSeq, Cigar, IndelCt] = fixIndelMEX(Seq, RefSeq)
+%    FixSeq =
+%      2x1 cell array
+%        {'ACGTTAGCTAGTCCATGG'}
+%        {'ACGTTAGCTAGTCCATGG'}
+%    Cigar =
+%      2x1 cell array
+%        {'8M1D9M'}
+%        {'9M1I9M'}
+%    IndelCt =
+%         0     1     1
+%         1     0     1
+%
+%  See also fixGeneIndel, alignSeqMEX
+%
+%
@@ -0,0 +1,132 @@
+/*
+fixSeqDirMEX will fix a batch of nt sequences in one pass: letters are
+capitalized, U is kept (same as readSeqFileMEX), and non-ACGTU letters are
+set to N. If germline reference sequences are given, it will also reverse
+complement the sequences that share more k-mers with the references in the
+reverse direction than in the forward direction (U counts as T). The output
+sequences are ready to be used by the aligners (alignSeqMEX).
+
+  Seq = fixSeqDirMEX(Seq)
+
+  [Seq, IsRev, HitCt] = fixSeqDirMEX(Seq, RefSeq)
+
+  [Seq, IsRev, HitCt] = fixSeqDirMEX(Seq, RefSeq, K)
+
+  INPUT
+    Seq: Mx1 cell of nt sequences, or a 1xN char
+    RefSeq: Px1 cell of germline nt sequences (ex: all V genes). If empty,
+      will only fix the letters.
+    K [9]: k-mer length used to compare Seq to RefSeq (1 to 13)
+
+  OUTPUT
+    Seq: Mx1 cell (or 1xN char) of fixed sequences in the best direction
+    IsRev: Mx1 logical array of sequences that were reverse complemented
+    HitCt: Mx2 matrix of k-mer hit counts for the [forward reverse] seq
+
+  EXAMPLE
+    Seq = {'acgUxx'; 'TTTTT'};
+    Seq = fixSeqDirMEX(Seq)
+    Seq =
+      2x1 cell array
+        {'ACGUNN'}
+        {'TTTTT' }
+
+    RefSeq = {'GATTACAGGCTTAC'};
+    [Seq, IsRev] = fixSeqDirMEX({'GTAAGCCTG'; 'ACAGGCTTA'}, RefSeq, 4)
+    Seq =
+      2x1 cell array
+        {'CAGGCTTAC'}
+        {'ACAGGCTTA'}
+    IsRev =
+      2x1 logical array
+       1
+       0
+
+  See also fixInputSeq, seedCDR3position
+*/
+
+#include "SeqTool.hpp"
+#include <vector>
+#include <algorithm>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 1 || nrhs > 3) {
+        mexErrMsgIdAndTxt("fixSeqDirMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 3.");
+    }
+    if (nlhs > 3) {
+        mexErrMsgIdAndTxt("fixSeqDirMEX:nlhs", "Too many outputs. Max is 3.");
+    }
+    if (!(mxIsCell(prhs[0]) || mxIsChar(prhs[0]))) {
+        mexErrMsgIdAndTxt("fixSeqDirMEX:prhs", "Input1: Seq must be a cell of char or a char.");
+    }
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1]) && !mxIsCell(prhs[1])) {
+        mexErrMsgIdAndTxt("fixSeqDirMEX:prhs", "Input2: RefSeq must be a cell of char.");
+    }
+    if (nrhs >= 3 && (!mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) != 1)) {
+        mexErrMsgIdAndTxt("fixSeqDirMEX:prhs", "Input3: K must be a scalar between 1 to 13.");
+    }
+
+    int K = nrhs >= 3 ? (int) mxGetScalar(prhs[2]) : 9;
+    bool CheckDir = nrhs >= 2 && !mxIsEmpty(prhs[1]);
+    kmer_set KS;
+    if (CheckDir) {
+        mwSize NumRef = mxGetNumberOfElements(prhs[1]);
+        std::vector<std::string> RefSeq(NumRef);
+        for (mwSize r = 0; r < NumRef; r++) {
+            mxArray *pCell = mxGetCell(prhs[1], r);
+            if (pCell == NULL || !mxIsChar(pCell)) { continue; }
+            mxChar *pRef = mxGetChars(pCell);
+            mwSize RefLen = mxGetNumberOfElements(pCell);
+            RefSeq[r].resize(RefLen);
+            for (mwSize j = 0; j < RefLen; j++) {
+                RefSeq[r][j] = pRef[j] < 256 ? (char) pRef[j] : 'N';
+            }
+        }
+        buildKmerSet(KS, RefSeq, K);
+    }
+
+    bool IsCell = mxIsCell(prhs[0]);
+    mwSize NumSeq = IsCell ? mxGetNumberOfElements(prhs[0]) : 1;
+    if (IsCell) {
+        plhs[0] = mxCreateCellArray(mxGetNumberOfDimensions(prhs[0]), mxGetDimensions(prhs[0]));
+    }
+    mxArray *pIsRev = mxCreateLogicalMatrix(NumSeq, 1);
+    mxArray *pHitCt = mxCreateDoubleMatrix(NumSeq, 2, mxREAL);
+    mxLogical *pRev = mxGetLogicals(pIsRev);
+    double *pHit = mxGetPr(pHitCt);
+
+    std::vector<mxChar> SeqR;
+    for (mwSize s = 0; s < NumSeq; s++) {
+        const mxArray *pCell = IsCell ? mxGetCell(prhs[0], s) : prhs[0];
+        if (pCell == NULL || !mxIsChar(pCell)) {
+            if (IsCell) { mxSetCell(plhs[0], s, mxCreateString("")); }
+            continue;
+        }
+        mwSize Len = mxGetNumberOfElements(pCell);
+        mxArray *pOut = mxCreateCharArray(mxGetNumberOfDimensions(pCell), mxGetDimensions(pCell));
+        mxChar *pSeq = mxGetChars(pOut);
+        fixSeqNT(mxGetChars(pCell), Len, pSeq);
+
+        if (CheckDir) {
+            SeqR.resize(Len);
+            rcompSeqDNA(pSeq, Len, SeqR.data());
+            pHit[s] = (double) countKmerHits(KS, pSeq, Len);
+            pHit[s + NumSeq] = (double) countKmerHits(KS, SeqR.data(), Len);
+            if (pHit[s + NumSeq] > pHit[s]) {
+                pRev[s] = true;
+                std::copy(SeqR.begin(), SeqR.end(), pSeq);
+            }
+        }
+
+        if (IsCell) {
+            mxSetCell(plhs[0], s, pOut);
+        } else {
+            plhs[0] = pOut;
+        }
+    }
+
+    if (nlhs >= 2) { plhs[1] = pIsRev; } else { mxDestroyArray(pIsRev); }
+    if (nlhs >= 3) { plhs[2] = pHitCt; } else { mxDestroyArray(pHitCt); }
+}
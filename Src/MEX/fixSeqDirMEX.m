@@ -0,0 +1,46 @@
+%fixSeqDirMEX will fix a batch of nt sequences in one pass: letters are
+%capitalized, U is kept (same as readSeqFileMEX), and non-ACGTU letters are
+%set to N. If germline reference sequences are given, it will also reverse
+%complement the sequences that share more k-mers with the references in the
+%reverse direction than in the forward direction (U counts as T). The output
+%sequences are ready to be used by the aligners (alignSeqMEX).
+%
+%  Seq = fixSeqDirMEX(Seq)
+%
+%  [Seq, IsRev, HitCt] = fixSeqDirMEX(Seq, RefSeq)
+%
+%  [Seq, IsRev, HitCt] = fixSeqDirMEX(Seq, RefSeq, K)
+%
+%  INPUT
+%    Seq: Mx1 cell of nt sequences, or a 1xN char
+%    RefSeq: Px1 cell of germline nt sequences (ex: all V genes). If empty,
+%      will only fix the letters.
+%    K [9]: k-mer length used to compare Seq to RefSeq (1 to 13)
+%
+%  OUTPUT
+%    Seq: Mx1 cell (or 1xN char) of fixed sequences in the best direction
+%    IsRev: Mx1 logical array of sequences that were reverse complemented
+%    HitCt: Mx2 matrix of k-mer hit counts for the [forward reverse] seq
+%
+%  EXAMPLE
+%    Seq = {'acgUxx'; 'TTTTT'};
+%    Seq = fixSeqDirMEX(Seq)
+%    Seq =
+%      2x1 cell array
+%        {'ACGUNN'}
+%        {'TTTTT' }
+%
+%    RefSeq = {'GATTACAGGCTTAC'};
+%    [Seq, IsRev] = fixSeqDirMEX({'GTAAGCCTG'; 'ACAGGCTTA'}, RefSeq, 4)
+%    Seq =
+%      2x1 cell array
+%        {'CAGGCTTAC'}
+%        {'ACAGGCTTA'}
+%    IsRev =
+%      2x1 logical array
+%       1
+%       0
+%
+%  See also fixInputSeq, seedCDR3position
+%
+%
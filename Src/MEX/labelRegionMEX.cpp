@@ -1,76 +1,56 @@
 /*  
 labelRegionMEX will get a 1xN or Mx1 vector and label form 1 to N the 
-number of consecutive-matched numbers.
+number of consecutive-matched numbers. It can also label each column of a
+matrix or each vector of a cell in one call, across threads, and return
+either the labels or the run-length [Start Length Value] of each region.
     
   Label = labelRegionMEX(Region)
 
+  Label = labelRegionMEX(Region, Output)
+
   INPUT
-    Region: 1xN or Mx1 vector like [0 0 1 1 2 2 2 2 0 0 1 1]
+    Region: 1xN or Mx1 vector like [0 0 1 1 2 2 2 2 0 0 1 1], MxN matrix
+      to label each column, or a cell of vectors. Can be double or logical.
+    Output ['double', 'int32', 'runs']: the output format
+      'double' - double labels of size(Region)
+      'int32'  - int32 labels of size(Region), which use half the memory
+      'runs'   - Rx3 matrix of [Start Length Value] of each region, Rx4
+                 matrix of [Col Start Length Value] for a matrix, or cell of
+                 Rx3 matrices for a cell
     
   OUTPUT
-    Label: vector of size(Region) of regions 1 to N
+    Label: vector of size(Region) of regions 1 to N, or the runs. A cell
+      Region returns a cell of the same size.
+
+  NOTE
+    Each NaN is its own region, since NaN ~= NaN.
 
   EXAMPLE
     Region = [0 0 1 1 2 2 2 2 0 0 1 1];
     Label  = labelRegionMEX(Region)
     Label  = 
              [1 1 2 2 3 3 3 3 4 4 5 5]
-*/
 
-#include "mex.h"
-
-void labelDoubleRegion(double *pMat, mwSize Len, double *pLabel) {
-    int k = 0;
-    double Num = 1;
-    for (mwSize j = 0; j < Len; j++) {
-        if (pMat[j] == pMat[k]) {
-            pLabel[j] = Num;
-        } else {
-            pLabel[j] = ++Num;
-            k = j;
-        }
-    }
-}
+    Runs = labelRegionMEX(Region, 'runs')
+    Runs =
+             1     2     0
+             3     2     1
+             5     4     2
+             9     2     0
+            11     2     1
+
+    Label = labelRegionMEX([0 0; 1 0; 1 1])
+    Label =
+             1     1
+             2     1
+             2     2
+
+  See also findConsecOnesMEX, sort2
+*/
 
-void labelBoolRegion(bool *pMat, mwSize Len, double *pLabel) {
-    int k = 0;
-    double Num = 1;
-    for (mwSize j = 0; j < Len; j++) {
-        if (pMat[j] == pMat[k]) {
-            pLabel[j] = Num;
-        } else {
-            pLabel[j] = ++Num;
-            k = j;
-        }
-    }
-}
+#include "RegionTool.hpp"
 
 void mexFunction(int nlhs,        mxArray *plhs[],
                  int nrhs, const  mxArray *prhs[]) {
-
-    if (nrhs != 1) {
-        mexErrMsgIdAndTxt("mxFindConsecOnes:nrhs", "Incorrect number of inputs. Expected 1.");
-    }
-    if (nlhs != 1) {
-        mexErrMsgIdAndTxt("mxFindConsecOnes:nlhs", "Incorrect number of outputs. Expected 1.");
-    }
-    if (mxGetN(prhs[0]) > 1 && mxGetM(prhs[0]) > 1) {
-        mexErrMsgIdAndTxt("mxFindConsecOnes:prhs", "Input must be a 1xN or Mx1 vector.");
-    }
-
-    mwSize M = mxGetM(prhs[0]);
-    mwSize N = mxGetN(prhs[0]);
-    mwSize Len = M > N ? M : N;
-    plhs[0] = mxCreateDoubleMatrix(M, N, mxREAL);
-    
-    if (M == 0 || N == 0) { return; }
-
-    double *pLabel = mxGetPr(plhs[0]);
-    if (mxIsDouble(prhs[0])) {
-        double *pMat = mxGetPr(prhs[0]);
-        labelDoubleRegion(pMat, Len, pLabel);
-    } else if (mxIsLogical(prhs[0])) {
-        bool *pMat = mxGetLogicals(prhs[0]);
-        labelBoolRegion(pMat, Len, pLabel);
-    }
-}
\ No newline at end of file
+    labelRegionBatch(nlhs, plhs, nrhs, prhs, REGION_LABEL, "labelRegionMEX");
+}
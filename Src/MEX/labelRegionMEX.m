@@ -1,13 +1,28 @@
 %labelRegionMEX will get a 1xN or Mx1 vector and label form 1 to N the 
-%number of consecutive-matched numbers.
+%number of consecutive-matched numbers. It can also label each column of a
+%matrix or each vector of a cell in one call, across threads, and return
+%either the labels or the run-length [Start Length Value] of each region.
 %    
 %  Label = labelRegionMEX(Region)
 %
+%  Label = labelRegionMEX(Region, Output)
+%
 %  INPUT
-%    Region: 1xN or Mx1 vector like [0 0 1 1 2 2 2 2 0 0 1 1]
+%    Region: 1xN or Mx1 vector like [0 0 1 1 2 2 2 2 0 0 1 1], MxN matrix
+%      to label each column, or a cell of vectors. Can be double or logical.
+%    Output ['double', 'int32', 'runs']: the output format
+%      'double' - double labels of size(Region)
+%      'int32'  - int32 labels of size(Region), which use half the memory
+%      'runs'   - Rx3 matrix of [Start Length Value] of each region, Rx4
+%                 matrix of [Col Start Length Value] for a matrix, or cell of
+%                 Rx3 matrices for a cell
 %    
 %  OUTPUT
-%    Label: vector of size(Region) of regions 1 to N
+%    Label: vector of size(Region) of regions 1 to N, or the runs. A cell
+%      Region returns a cell of the same size.
+%
+%  NOTE
+%    Each NaN is its own region, since NaN ~= NaN.
 %
 %  EXAMPLE
 %    Region = [0 0 1 1 2 2 2 2 0 0 1 1];
@@ -15,4 +30,20 @@
 %    Label  = 
 %             [1 1 2 2 3 3 3 3 4 4 5 5]
 %
+%    Runs = labelRegionMEX(Region, 'runs')
+%    Runs =
+%             1     2     0
+%             3     2     1
+%             5     4     2
+%             9     2     0
+%            11     2     1
+%
+%    Label = labelRegionMEX([0 0; 1 0; 1 1])
+%    Label =
+%             1     1
+%             2     1
+%             2     2
+%
+%  See also findConsecOnesMEX, sort2
+%
 %
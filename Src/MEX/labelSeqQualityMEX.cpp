@@ -0,0 +1,203 @@
+/*
+labelSeqQualityMEX will label the functionality of a batch of annotated
+V(D)J sequences in one pass, as labelSeqQuality does per row. The numeric
+VDJdata columns are given as matrices where NaN marks an empty cell, and
+the sequences are split across CPU threads.
+
+  [Funct, Reason] = labelSeqQualityMEX(Seq, RefSeq, VMDNJ, Del, CDR3, HasGene)
+
+  [Funct, Reason] = labelSeqQualityMEX(..., ThreshHold)
+
+  INPUT
+    Seq: Mx1 cell of nt sequences
+    RefSeq: Mx1 cell of the germline nt sequence of each Seq. Empty ones
+      skip the mismatch check.
+    VMDNJ: MxK matrix of the segment lengths. NaN values are skipped.
+    Del: MxL matrix of the deletion lengths. NaN values are skipped.
+    CDR3: Mx3 matrix of the pre-IMGT CDR3 [Length Start End]. NaN if empty.
+    HasGene: Mx1 logical array of rows with a V gene number and name
+    ThreshHold [0.4]: max fraction of mismatches to RefSeq that is allowed
+      in the whole seq, and in the 20 nts of FR3 and FR4 near the CDR3
+
+  OUTPUT
+    Funct: Mx1 cell of labels 'Y', 'N', 'M', or 'I' (see labelSeqQuality)
+    Reason: Mx1 matrix of the reason code of each label
+       0 = 'Y', fully translatable and all annotation values exist
+       1 = 'I', missing annotation values
+       2 = 'I', invalid lengths, CDR3 positions, CDR3 length, or deletions
+       3 = 'I', too many mismatches with RefSeq
+       4 = 'N', CDR3 is out of frame
+       5 = 'N', stop codon in the CDR3
+       6 = 'M', stop codon in the V or J
+
+  EXAMPLE
+    Seq = {'TGTGCAAGAGGGGGGTACTGGGGC'; 'TGTGCATAGGGGGGGTACTGGGGC'};
+    RefSeq = Seq;
+    VMDNJ = [9 6 9; 9 6 9];
+    Del = [0 0; 0 0];
+    CDR3 = [7 1 21; 7 1 21];
+    [Funct, Reason] = labelSeqQualityMEX(Seq, RefSeq, VMDNJ, Del, CDR3, [true; true])
+    Funct =
+      2x1 cell array
+        {'Y'}
+        {'N'}
+    Reason =
+         0
+         5
+
+  See also labelSeqQuality, findCDRMEX
+*/
+
+#include "SeqTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <algorithm>
+
+// Row-major view of one row of a column-major MxN double matrix
+struct num_row {
+    const double *pData;
+    mwSize Stride, Len;
+    double operator[](mwSize k) const { return pData[k * Stride]; }
+};
+
+// Labels 1 seq. Returns the reason code.
+static int labelSeq(const mxChar *pSeq, mwSize SeqLen, const mxChar *pRef, mwSize RefLen,
+                    const num_row &VMDNJ, const num_row &Del, const num_row &CDR3,
+                    bool HasGene, double ThreshHold) {
+    if (SeqLen == 0 || !HasGene) { return 1; }
+    for (int k = 0; k < 3; k++) {
+        if (CDR3[k] != CDR3[k]) { return 1; }
+    }
+    double MaxDel = -1;
+    for (mwSize k = 0; k < Del.Len; k++) {
+        if (Del[k] == Del[k] && Del[k] > MaxDel) { MaxDel = Del[k]; }
+    }
+    if (MaxDel < 0) { return 1; } //All empty
+
+    //Make sure info makes sense. CDR3Len includes 104C and 118W.
+    double MinLen = 0, SumLen = 0;
+    bool HasLen = false;
+    for (mwSize k = 0; k < VMDNJ.Len; k++) {
+        if (VMDNJ[k] != VMDNJ[k]) { continue; }
+        MinLen = HasLen ? std::min(MinLen, VMDNJ[k]) : VMDNJ[k];
+        SumLen += VMDNJ[k];
+        HasLen = true;
+    }
+    double CDR3Len = CDR3[0];
+    long long S = (long long) CDR3[1], E = (long long) CDR3[2];
+    if (!HasLen || MinLen < 0 || SumLen != SeqLen || S < 1 || E > (long long) SeqLen || CDR3Len < (5+2) || CDR3Len > (30+2) || MaxDel > 15) {
+        return 2;
+    }
+
+    //Make sure there aren't too many mismatches overall and 20 nts near the CDR3
+    if (RefLen > 0) {
+        mwSize Len = std::min(SeqLen, RefLen);
+        std::vector<int> CumMatch(Len + 1, 0);
+        for (mwSize i = 0; i < Len; i++) {
+            bool Match = pSeq[i] == pRef[i] || pSeq[i] == 'N' || pRef[i] == 'N';
+            CumMatch[i+1] = CumMatch[i] + Match;
+        }
+        auto sumMatch = [&](long long A, long long B) { //1-based, inclusive
+            A = std::max(A, 1LL);
+            B = std::min(B, (long long) Len);
+            return B >= A ? CumMatch[B] - CumMatch[A-1] : 0;
+        };
+        double MinScore = (double) CumMatch[Len] / RefLen;
+        long long FR3S = std::max(S - 20 + 1, 1LL);
+        long long FR4E = std::min(E + 20, (long long) RefLen);
+        if (S > FR3S) { //0/0 is NaN, which min ignores
+            MinScore = std::min(MinScore, (double) sumMatch(FR3S, S - 1) / (S - FR3S));
+        }
+        if (FR4E != E) {
+            MinScore = std::min(MinScore, (double) sumMatch(E + 1, FR4E) / (FR4E - E));
+        }
+        if (MinScore < 1 - ThreshHold) { return 3; }
+    }
+
+    //CDR3 nt length must be a multiple of 3 for an in-frame junction
+    long long CDR3nt = E - S + 1;
+    if (((CDR3nt % 3) + 3) % 3 > 0) { return 4; }
+    if (CDR3nt > 0 && hasStopCodon(pSeq + S - 1, (int) CDR3nt)) { return 5; }
+
+    //Stop codons in V/J could be a sequencing error or a pseudogene
+    int Frame = (int) ((S - 1) % 3);
+    if (hasStopCodon(pSeq + Frame, (int) SeqLen - Frame)) { return 6; }
+    return 0;
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 6 || nrhs > 7) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:nrhs", "Incorrect number of inputs. Min is 6. Max is 7.");
+    }
+    if (nlhs > 2) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:nlhs", "Too many outputs. Max is 2.");
+    }
+    if (!mxIsCell(prhs[0]) || !mxIsCell(prhs[1])) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:prhs", "Input1 and Input2: Seq and RefSeq must be cells of char.");
+    }
+    mwSize NumSeq = mxGetNumberOfElements(prhs[0]);
+    if (mxGetNumberOfElements(prhs[1]) != NumSeq) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:prhs", "Input2: RefSeq must have the same number of elements as Seq.");
+    }
+    for (int k = 2; k <= 4; k++) {
+        if (!mxIsDouble(prhs[k]) || mxGetM(prhs[k]) != NumSeq) {
+            mexErrMsgIdAndTxt("labelSeqQualityMEX:prhs", "Input%d: must be a double matrix with M rows.", k + 1);
+        }
+    }
+    if (mxGetN(prhs[4]) != 3) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:prhs", "Input5: CDR3 must be a Mx3 matrix of [Length Start End].");
+    }
+    if (!mxIsLogical(prhs[5]) || mxGetNumberOfElements(prhs[5]) != NumSeq) {
+        mexErrMsgIdAndTxt("labelSeqQualityMEX:prhs", "Input6: HasGene must be a Mx1 logical array.");
+    }
+    double ThreshHold = nrhs >= 7 && !mxIsEmpty(prhs[6]) ? mxGetScalar(prhs[6]) : 0.4;
+
+    //Gather the inputs here, since mx* is not thread-safe
+    std::vector<mxChar*> pSeqs(NumSeq, NULL), pRefs(NumSeq, NULL);
+    std::vector<mwSize> SeqLens(NumSeq, 0), RefLens(NumSeq, 0);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        mxArray *pSeq = mxGetCell(prhs[0], s);
+        mxArray *pRef = mxGetCell(prhs[1], s);
+        if (pSeq != NULL && mxIsChar(pSeq)) {
+            pSeqs[s] = mxGetChars(pSeq);
+            SeqLens[s] = mxGetNumberOfElements(pSeq);
+        }
+        if (pRef != NULL && mxIsChar(pRef)) {
+            pRefs[s] = mxGetChars(pRef);
+            RefLens[s] = mxGetNumberOfElements(pRef);
+        }
+    }
+    const double *pVMDNJ = mxGetPr(prhs[2]);
+    const double *pDel = mxGetPr(prhs[3]);
+    const double *pCDR3 = mxGetPr(prhs[4]);
+    const mxLogical *pHasGene = mxGetLogicals(prhs[5]);
+    mwSize NumLen = mxGetN(prhs[2]), NumDel = mxGetN(prhs[3]);
+
+    std::vector<int> Reason(NumSeq, 0);
+    parallelFor(NumSeq, 256, [&](size_t Beg, size_t End) {
+        for (size_t s = Beg; s < End; s++) {
+            num_row VMDNJ = {pVMDNJ + s, NumSeq, NumLen};
+            num_row Del = {pDel + s, NumSeq, NumDel};
+            num_row CDR3 = {pCDR3 + s, NumSeq, 3};
+            Reason[s] = labelSeq(pSeqs[s], SeqLens[s], pRefs[s], RefLens[s], VMDNJ, Del, CDR3, pHasGene[s], ThreshHold);
+        }
+    });
+
+    const char Label[7] = {'Y', 'I', 'I', 'I', 'N', 'N', 'M'};
+    char Funct[2] = {0, 0};
+    plhs[0] = mxCreateCellMatrix(NumSeq, 1);
+    for (mwSize s = 0; s < NumSeq; s++) {
+        Funct[0] = Label[Reason[s]];
+        mxSetCell(plhs[0], s, mxCreateString(Funct));
+    }
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateDoubleMatrix(NumSeq, 1, mxREAL);
+        double *pReason = mxGetPr(plhs[1]);
+        for (mwSize s = 0; s < NumSeq; s++) {
+            pReason[s] = Reason[s];
+        }
+    }
+}
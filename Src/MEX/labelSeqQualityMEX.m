@@ -0,0 +1,49 @@
+%labelSeqQualityMEX will label the functionality of a batch of annotated
+%V(D)J sequences in one pass, as labelSeqQuality does per row. The numeric
+%VDJdata columns are given as matrices where NaN marks an empty cell, and
+%the sequences are split across CPU threads.
+%
+%  [Funct, Reason] = labelSeqQualityMEX(Seq, RefSeq, VMDNJ, Del, CDR3, HasGene)
+%
+%  [Funct, Reason] = labelSeqQualityMEX(..., ThreshHold)
+%
+%  INPUT
+%    Seq: Mx1 cell of nt sequences
+%    RefSeq: Mx1 cell of the germline nt sequence of each Seq. Empty ones
+%      skip the mismatch check.
+%    VMDNJ: MxK matrix of the segment lengths. NaN values are skipped.
+%    Del: MxL matrix of the deletion lengths. NaN values are skipped.
+%    CDR3: Mx3 matrix of the pre-IMGT CDR3 [Length Start End]. NaN if empty.
+%    HasGene: Mx1 logical array of rows with a V gene number and name
+%    ThreshHold [0.4]: max fraction of mismatches to RefSeq that is allowed
+%      in the whole seq, and in the 20 nts of FR3 and FR4 near the CDR3
+%
+%  OUTPUT
+%    Funct: Mx1 cell of labels 'Y', 'N', 'M', or 'I' (see labelSeqQuality)
+%    Reason: Mx1 matrix of the reason code of each label
+%       0 = 'Y', fully translatable and all annotation values exist
+%       1 = 'I', missing annotation values
+%       2 = 'I', invalid lengths, CDR3 positions, CDR3 length, or deletions
+%       3 = 'I', too many mismatches with RefSeq
+%       4 = 'N', CDR3 is out of frame
+%       5 = 'N', stop codon in the CDR3
+%       6 = 'M', stop codon in the V or J
+%
+%  EXAMPLE
+%    Seq = {'TGTGCAAGAGGGGGGTACTGGGGC'; 'TGTGCATAGGGGGGGTACTGGGGC'};
+%    RefSeq = Seq;
+%    VMDNJ = [9 6 9; 9 6 9];
+%    Del = [0 0; 0 0];
+%    CDR3 = [7 1 21; 7 1 21];
+%    [Funct, Reason] = labelSeqQualityMEX(Seq, RefSeq, VMDNJ, Del, CDR3, [true; true])
+%    Funct =
+%      2x1 cell array
+%        {'Y'}
+%        {'N'}
+%    Reason =
+%         0
+%         5
+%
+%  See also labelSeqQuality, findCDRMEX
+%
+%
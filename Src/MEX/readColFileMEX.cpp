@@ -0,0 +1,120 @@
+/*
+readColFileMEX will read all or some columns of a BRILIA columnar (.bcol)
+file made by writeColFileMEX. The file is memory-mapped, so only the
+columns that are asked for are read from the disk, and the batch index is
+read from the file footer without going through the data.
+
+  [CellData, Header, Info] = readColFileMEX(FileName)
+
+  [CellData, Header, Info] = readColFileMEX(FileName, ColIdx)
+
+  INPUT
+    FileName: full name of the .bcol file
+    ColIdx: 1xK column numbers to read. Default is all. If empty, will only
+      read the Header and Info.
+
+  OUTPUT
+    CellData: MxK cell array of all batches, in the order they were written
+    Header: 1xN cell of all column names
+    Info: structure of the batch index
+      BatchRows: Bx1 matrix of the number of rows in each batch
+      LastSeqNum: Bx1 matrix of the LastSeqNum of each batch (see
+        writeColFileMEX)
+
+  EXAMPLE
+    [~, ~, Info] = readColFileMEX('Test.Tmp.bcol', []);
+    ResumeAt = max([0; Info.LastSeqNum]) + 1;
+
+  See also writeColFileMEX, openSeqData
+*/
+
+#include "ColFileTool.hpp"
+#include "DlmTool.hpp"
+#include <vector>
+#include <string>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 1 || nrhs > 2) {
+        mexErrMsgIdAndTxt("readColFileMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 2.");
+    }
+    if (nlhs > 3) {
+        mexErrMsgIdAndTxt("readColFileMEX:nlhs", "Too many outputs. Max is 3.");
+    }
+    if (!mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("readColFileMEX:prhs", "Input1: FileName must be a char array.");
+    }
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1]) && !mxIsDouble(prhs[1])) {
+        mexErrMsgIdAndTxt("readColFileMEX:prhs", "Input2: ColIdx must be a 1xK double matrix.");
+    }
+
+    char *pFileName = mxArrayToString(prhs[0]);
+    std::string FileName(pFileName);
+    mxFree(pFileName);
+    mapped_file MF;
+    if (!openMappedFile(FileName.c_str(), MF)) {
+        mexErrMsgIdAndTxt("readColFileMEX:read", "Could not open the file \"%s\".", FileName.c_str());
+    }
+    col_index CI;
+    if (!readColIndex(MF.pData, MF.Size, CI)) {
+        closeMappedFile(MF);
+        mexErrMsgIdAndTxt("readColFileMEX:read", "Could not find the index of \"%s\". It is not a .bcol file.", FileName.c_str());
+    }
+
+    size_t NumCol = CI.Header.size();
+    std::vector<size_t> ColIdx;
+    if (nrhs < 2) {
+        for (size_t c = 0; c < NumCol; c++) { ColIdx.push_back(c); }
+    } else {
+        double *pIdx = mxIsEmpty(prhs[1]) ? NULL : mxGetPr(prhs[1]);
+        for (mwSize k = 0; k < mxGetNumberOfElements(prhs[1]); k++) {
+            if (pIdx[k] < 1 || pIdx[k] > NumCol || pIdx[k] != (size_t) pIdx[k]) {
+                closeMappedFile(MF);
+                mexErrMsgIdAndTxt("readColFileMEX:prhs", "Input2: ColIdx must be integers from 1 to %d.", (int) NumCol);
+            }
+            ColIdx.push_back((size_t) pIdx[k] - 1);
+        }
+    }
+
+    mwSize NumRow = 0;
+    for (size_t b = 0; b < CI.BatchRows.size(); b++) { NumRow += (mwSize) CI.BatchRows[b]; }
+    plhs[0] = mxCreateCellMatrix(NumRow, ColIdx.size());
+    mwSize Row0 = 0;
+    for (size_t b = 0; b < CI.BatchStart.size(); b++) {
+        unsigned long long BatchEnd = b + 1 < CI.BatchStart.size() ? CI.BatchStart[b+1] : CI.FooterEnd;
+        const char *pBatch = MF.pData + CI.BatchStart[b];
+        mwSize BatchRows = (mwSize) CI.BatchRows[b];
+        for (size_t k = 0; k < ColIdx.size(); k++) {
+            mxArray *pCol = decodeColumn(pBatch, BatchEnd - CI.BatchStart[b], BatchRows, ColIdx[k]);
+            for (mwSize r = 0; r < BatchRows; r++) { //move the cells without copying
+                mxSetCell(plhs[0], Row0 + r + k*NumRow, mxGetCell(pCol, r));
+                mxSetCell(pCol, r, NULL);
+            }
+            mxDestroyArray(pCol);
+        }
+        Row0 += BatchRows;
+    }
+    closeMappedFile(MF);
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateCellMatrix(1, NumCol);
+        for (size_t c = 0; c < NumCol; c++) {
+            mxSetCell(plhs[1], c, mxCreateString(CI.Header[c].c_str()));
+        }
+    }
+
+    if (nlhs >= 3) {
+        const char *Fields[2] = {"BatchRows", "LastSeqNum"};
+        plhs[2] = mxCreateStructMatrix(1, 1, 2, Fields);
+        size_t NumBatch = CI.BatchStart.size();
+        mxArray *pRows = mxCreateDoubleMatrix(NumBatch, 1, mxREAL);
+        mxArray *pLast = mxCreateDoubleMatrix(NumBatch, 1, mxREAL);
+        for (size_t b = 0; b < NumBatch; b++) {
+            mxGetPr(pRows)[b] = (double) CI.BatchRows[b];
+            mxGetPr(pLast)[b] = CI.LastSeqNum[b];
+        }
+        mxSetField(plhs[2], 0, "BatchRows", pRows);
+        mxSetField(plhs[2], 0, "LastSeqNum", pLast);
+    }
+}
@@ -0,0 +1,29 @@
+%readColFileMEX will read all or some columns of a BRILIA columnar (.bcol)
+%file made by writeColFileMEX. The file is memory-mapped, so only the
+%columns that are asked for are read from the disk, and the batch index is
+%read from the file footer without going through the data.
+%
+%  [CellData, Header, Info] = readColFileMEX(FileName)
+%
+%  [CellData, Header, Info] = readColFileMEX(FileName, ColIdx)
+%
+%  INPUT
+%    FileName: full name of the .bcol file
+%    ColIdx: 1xK column numbers to read. Default is all. If empty, will only
+%      read the Header and Info.
+%
+%  OUTPUT
+%    CellData: MxK cell array of all batches, in the order they were written
+%    Header: 1xN cell of all column names
+%    Info: structure of the batch index
+%      BatchRows: Bx1 matrix of the number of rows in each batch
+%      LastSeqNum: Bx1 matrix of the LastSeqNum of each batch (see
+%        writeColFileMEX)
+%
+%  EXAMPLE
+%    [~, ~, Info] = readColFileMEX('Test.Tmp.bcol', []);
+%    ResumeAt = max([0; Info.LastSeqNum]) + 1;
+%
+%  See also writeColFileMEX, openSeqData
+%
+%
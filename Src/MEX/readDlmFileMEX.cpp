@@ -0,0 +1,142 @@
+/*
+readDlmFileMEX will read a delimited file into a cell array of strings,
+with selected columns converted directly into doubles. The file is
+memory-mapped and parsed in one pass, which is much faster than the
+line-by-line parsing of readDlmFile or textscan for large BRILIA files.
+
+  CellData = readDlmFileMEX(FileName)
+
+  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter)
+
+  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter, LineRange)
+
+  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter, LineRange, NumIdx)
+
+  INPUT
+    FileName: full name of the delimited file
+    Delimiter ['' ',' ';' '\t']: delimiter of the file. If empty, will
+      autodetect as the most frequent of ',' ';' '\t' that occurs equally
+      in the first 2 lines.
+    LineRange [1 Inf]: 1x2 matrix of the start and end lines to extract.
+      Line 1 is the header line.
+    NumIdx: column indices that should be converted to double. Empty or
+      non-numeric fields become NaN. Use getVDJmapper to get these for
+      BRILIA files.
+
+  OUTPUT
+    CellData: MxN cell array, where N is the number of columns in the 1st
+      line. Rows with fewer columns are padded with '' (or NaN), and extra
+      columns are ignored.
+    Delimiter: the delimiter used, with tab returned as '\t'
+
+  EXAMPLE
+    Header = readDlmFileMEX('MouseH.BRILIAv3.csv', '', 1);
+    [Map, NumIdx] = getVDJmapper(Header);
+    VDJdata = readDlmFileMEX('MouseH.BRILIAv3.csv', ',', [2 Inf], NumIdx);
+
+  See also readDlmFile, writeDlmFileMEX
+*/
+
+#include "DlmTool.hpp"
+#include <vector>
+#include <math.h>
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 1 || nrhs > 4) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 4.");
+    }
+    if (nlhs > 2) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:nlhs", "Too many outputs. Max is 2.");
+    }
+    if (!mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:prhs", "Input1: FileName must be a char array.");
+    }
+    if (nrhs >= 3 && !mxIsEmpty(prhs[2]) && (!mxIsDouble(prhs[2]) || mxGetNumberOfElements(prhs[2]) > 2)) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:prhs", "Input3: LineRange must be a 1x2 double matrix.");
+    }
+    if (nrhs >= 4 && !mxIsEmpty(prhs[3]) && !mxIsDouble(prhs[3])) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:prhs", "Input4: NumIdx must be a double matrix of column indices.");
+    }
+
+    char *pFileName = mxArrayToString(prhs[0]);
+    mapped_file MF;
+    bool Success = openMappedFile(pFileName, MF);
+    mxFree(pFileName);
+    if (!Success) {
+        mexErrMsgIdAndTxt("readDlmFileMEX:prhs", "Could not open the file.");
+    }
+    const char *pBeg = MF.pData;
+    const char *pEnd = MF.pData + MF.Size;
+
+    char Delim = nrhs >= 2 ? getDelimiter(prhs[1]) : 0;
+    if (Delim == 0) { Delim = detectDelimiter(pBeg, pEnd); }
+
+    //Determine the line range, 0-based [Line0, Line1)
+    size_t NumLines = countLines(pBeg, pEnd);
+    if (MF.Size > 0 && pEnd[-1] != '\n') { NumLines++; }
+    double pRange[2] = {1, INFINITY};
+    if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        pRange[0] = mxGetPr(prhs[2])[0];
+        pRange[1] = mxGetNumberOfElements(prhs[2]) > 1 ? mxGetPr(prhs[2])[1] : pRange[0];
+    }
+    size_t Line0 = pRange[0] < 1 ? 0 : (size_t) pRange[0] - 1;
+    size_t Line1 = pRange[1] > NumLines ? NumLines : (size_t) pRange[1];
+    size_t NumRows = Line1 > Line0 ? Line1 - Line0 : 0;
+
+    //Column count is based on the 1st line
+    size_t NumCols = 0;
+    if (MF.Size > 0) {
+        const char *p = pBeg;
+        while (true) {
+            NumCols++;
+            p = findDelimOrEOL(p, pEnd, Delim);
+            if (p == pEnd || *p == '\n') { break; }
+            p++;
+        }
+    }
+
+    std::vector<bool> IsNum(NumCols, false);
+    if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        double *pNumIdx = mxGetPr(prhs[3]);
+        for (mwSize j = 0; j < mxGetNumberOfElements(prhs[3]); j++) {
+            if (pNumIdx[j] >= 1 && pNumIdx[j] <= NumCols) { IsNum[(size_t) pNumIdx[j] - 1] = true; }
+        }
+    }
+
+    //Skip to the first line
+    const char *p = pBeg;
+    for (size_t k = 0; k < Line0 && p < pEnd; k++) {
+        p = findEOL(p, pEnd);
+        if (p < pEnd) { p++; }
+    }
+
+    plhs[0] = mxCreateCellMatrix(NumRows, NumCols);
+    for (size_t r = 0; r < NumRows; r++) {
+        const char *pEOL = findEOL(p, pEnd);
+        size_t c = 0;
+        while (c < NumCols) {
+            const char *pStop = findDelimOrEOL(p, pEOL, Delim);
+            size_t Len = pStop - p;
+            if (pStop == pEOL && Len > 0 && p[Len-1] == '\r') { Len--; }
+            if (IsNum[c]) {
+                mxSetCell(plhs[0], r + c*NumRows, mxCreateDoubleScalar(convField2Double(p, Len)));
+            } else {
+                mxSetCell(plhs[0], r + c*NumRows, convField2Char(p, Len));
+            }
+            c++;
+            if (pStop == pEOL) { break; }
+            p = pStop + 1;
+        }
+        for (; c < NumCols; c++) { //Pad the missing columns
+            mxSetCell(plhs[0], r + c*NumRows, IsNum[c] ? mxCreateDoubleScalar(NAN) : convField2Char(NULL, 0));
+        }
+        p = pEOL < pEnd ? pEOL + 1 : pEnd;
+    }
+    closeMappedFile(MF);
+
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateString(Delim == '\t' ? "\\t" : (Delim == ';' ? ";" : ","));
+    }
+}
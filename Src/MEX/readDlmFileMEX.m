@@ -0,0 +1,38 @@
+%readDlmFileMEX will read a delimited file into a cell array of strings,
+%with selected columns converted directly into doubles. The file is
+%memory-mapped and parsed in one pass, which is much faster than the
+%line-by-line parsing of readDlmFile or textscan for large BRILIA files.
+%
+%  CellData = readDlmFileMEX(FileName)
+%
+%  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter)
+%
+%  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter, LineRange)
+%
+%  [CellData, Delimiter] = readDlmFileMEX(FileName, Delimiter, LineRange, NumIdx)
+%
+%  INPUT
+%    FileName: full name of the delimited file
+%    Delimiter ['' ',' ';' '\t']: delimiter of the file. If empty, will
+%      autodetect as the most frequent of ',' ';' '\t' that occurs equally
+%      in the first 2 lines.
+%    LineRange [1 Inf]: 1x2 matrix of the start and end lines to extract.
+%      Line 1 is the header line.
+%    NumIdx: column indices that should be converted to double. Empty or
+%      non-numeric fields become NaN. Use getVDJmapper to get these for
+%      BRILIA files.
+%
+%  OUTPUT
+%    CellData: MxN cell array, where N is the number of columns in the 1st
+%      line. Rows with fewer columns are padded with '' (or NaN), and extra
+%      columns are ignored.
+%    Delimiter: the delimiter used, with tab returned as '\t'
+%
+%  EXAMPLE
+%    Header = readDlmFileMEX('MouseH.BRILIAv3.csv', '', 1);
+%    [Map, NumIdx] = getVDJmapper(Header);
+%    VDJdata = readDlmFileMEX('MouseH.BRILIAv3.csv', ',', [2 Inf], NumIdx);
+%
+%  See also readDlmFile, writeDlmFileMEX
+%
+%
@@ -0,0 +1,263 @@
+/*
+readSeqFileMEX will read a range of sequences from a FASTA or FASTQ file,
+which can be gzip-compressed (ex: .fastq.gz). Reading and fixing the input
+sequences are done in one pass: low-quality bases are set to N, letters
+are capitalized, non-ACGTU letters are set to N, and the 5' and 3' N
+overhangs are trimmed off (same as fixInputSeq). The file stream is kept
+open between calls, so reading consecutive SeqRanges (like the batches in
+BRILIA) does not decompress or re-read the file from the start.
+
+After a finite SeqRange is read, the next SeqRange of the same size is
+read and fixed in a background thread while MATLAB works on the current
+one. The next call gets it without waiting if it asks for that range. The
+read-ahead is skipped if a batch is larger than BRILIA_PIPE_MB (default 256
+MB, see getPipeBudget in ThreadTool).
+
+  [SeqName, Seq] = readSeqFileMEX(FileName)
+
+  [SeqName, Seq, OverSeq5, OverSeq3, BadLoc] = readSeqFileMEX(FileName)
+
+  [...] = readSeqFileMEX(FileName, SeqRange)
+
+  [...] = readSeqFileMEX(FileName, SeqRange, MinQuality)
+
+  [...] = readSeqFileMEX(FileName, SeqRange, MinQuality, MaxErrRate)
+
+  readSeqFileMEX('close')
+
+  INPUT
+    FileName: full name of a .fa/.fasta/.fastq file, or a .gz of these
+    SeqRange [1 Inf]: 1x2 matrix of the first and last sequence to read
+    MinQuality ['']: Phred score char (ASCII base 33). Bases with a lower
+      quality score are set to N. Only used for FASTQ files.
+    MaxErrRate [0.1]: Max fraction of N in the trimmed sequence before the
+      sequence is labeled bad.
+    'close': closes the file stream that is kept open between calls
+
+  OUTPUT
+    SeqName: Mx1 cell of sequence names
+    Seq: Mx1 cell of fixed sequences, without the N overhangs
+    OverSeq5: Mx1 cell of the 5' N overhangs that were trimmed off
+    OverSeq3: Mx1 cell of the 3' N overhangs that were trimmed off
+    BadLoc: Mx1 logical array of sequences with > MaxErrRate N. As in
+      fixInputSeq, an all-N sequence becomes '' and is not bad.
+
+  EXAMPLE
+    [SeqName, Seq, ~, ~, BadLoc] = readSeqFileMEX('Reads.fastq.gz', [1 30000], '2');
+
+  See also countSeqFileMEX, fixInputSeq, convertInput2VDJdata
+*/
+
+#include "SeqFileTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <thread>
+#include <utility>
+#include <math.h>
+
+// seq_batch stores the fixed records of 1 SeqRange
+struct seq_batch {
+    std::vector<std::string> Name, Seq, Over5, Over3;
+    std::vector<bool> BadLoc;
+    bool IsEOF = false;
+    size_t Bytes = 0;       //Bytes: total size of the strings
+    size_t First = 0;       //First, Last: the SeqRange that was read
+    double Last = 0;
+    char MinQuality = 0;    //MinQuality, MaxErrRate: the fix settings used
+    double MaxErrRate = 0;
+    std::string ErrMsg;     //ErrMsg: read error, raised by mexFunction on the main thread
+    size_t ErrIdx = 0;      //ErrIdx: index of the record with the read error
+};
+
+static seq_reader *pREADER = NULL; //kept open so the next SeqRange continues from here
+static std::string READER_FILE;
+static std::thread PREFETCH;       //reads NEXT_BATCH in the background
+static seq_batch NEXT_BATCH;
+static bool HAS_NEXT = false;
+
+// Marks the end of the batch, and stores the read error if there is one
+static void endSeqBatch(const seq_reader &Reader, seq_batch &Batch) {
+    Batch.IsEOF = true;
+    Batch.ErrMsg = Reader.ErrMsg;
+    Batch.ErrIdx = Reader.NextIdx;
+}
+
+// Reads and fixes records First to Last. The reader must be at or before First.
+// Makes no mex calls, since it also runs in the PREFETCH thread.
+static void readSeqBatch(seq_reader &Reader, seq_batch &Batch) {
+    seq_record Rec;
+    while (Reader.NextIdx < Batch.First) {
+        if (!readSeqRecord(Reader, Rec)) {
+            endSeqBatch(Reader, Batch);
+            return;
+        }
+    }
+    while (Reader.NextIdx <= Batch.Last) {
+        if (!readSeqRecord(Reader, Rec)) {
+            endSeqBatch(Reader, Batch);
+            return;
+        }
+        Batch.BadLoc.push_back(fixSeqRecord(Rec, Batch.MinQuality, Batch.MaxErrRate));
+        Batch.Bytes += Rec.Name.size() + Rec.Seq.size() + Rec.Over5.size() + Rec.Over3.size();
+        Batch.Name.push_back(std::move(Rec.Name));
+        Batch.Seq.push_back(std::move(Rec.Seq));
+        Batch.Over5.push_back(std::move(Rec.Over5));
+        Batch.Over3.push_back(std::move(Rec.Over3));
+    }
+}
+
+static void joinPrefetch() {
+    if (PREFETCH.joinable()) { PREFETCH.join(); }
+}
+
+static void closeReader() {
+    joinPrefetch();
+    HAS_NEXT = false;
+    NEXT_BATCH = seq_batch();
+    if (pREADER != NULL) {
+        closeSeqReader(*pREADER);
+        delete pREADER;
+        pREADER = NULL;
+    }
+    READER_FILE.clear();
+}
+
+static mxArray *convStr2Char(const std::string &Str) {
+    mwSize Dims[2] = {(mwSize) (Str.empty() ? 0 : 1), Str.size()};
+    mxArray *pStr = mxCreateCharArray(2, Dims);
+    mxChar *pChar = mxGetChars(pStr);
+    for (size_t j = 0; j < Str.size(); j++) {
+        pChar[j] = (unsigned char) Str[j];
+    }
+    return pStr;
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    addExitFunc(closeReader);
+
+    if (nrhs < 1 || nrhs > 4) {
+        mexErrMsgIdAndTxt("readSeqFileMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 4.");
+    }
+    if (nlhs > 5) {
+        mexErrMsgIdAndTxt("readSeqFileMEX:nlhs", "Too many outputs. Max is 5.");
+    }
+    if (!mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("readSeqFileMEX:prhs", "Input1: FileName must be a char array.");
+    }
+
+    char *pFileName = mxArrayToString(prhs[0]);
+    std::string FileName(pFileName);
+    mxFree(pFileName);
+    if (FileName == "close") {
+        closeReader();
+        return;
+    }
+
+    double pRange[2] = {1, INFINITY};
+    if (nrhs >= 2 && !mxIsEmpty(prhs[1])) {
+        if (!mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[1]) > 2) {
+            mexErrMsgIdAndTxt("readSeqFileMEX:prhs", "Input2: SeqRange must be a 1x2 double matrix.");
+        }
+        pRange[0] = mxGetPr(prhs[1])[0];
+        pRange[1] = mxGetNumberOfElements(prhs[1]) > 1 ? mxGetPr(prhs[1])[1] : pRange[0];
+    }
+    if (pRange[0] < 1) { pRange[0] = 1; }
+
+    char MinQuality = 0;
+    if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        if (!mxIsChar(prhs[2])) {
+            mexErrMsgIdAndTxt("readSeqFileMEX:prhs", "Input3: MinQuality must be a Phred score char (ASCII base 33).");
+        }
+        MinQuality = (char) mxGetChars(prhs[2])[0];
+    }
+
+    double MaxErrRate = 0.1;
+    if (nrhs >= 4) {
+        if (!mxIsDouble(prhs[3])) {
+            mexErrMsgIdAndTxt("readSeqFileMEX:prhs", "Input4: MaxErrRate must be a scalar between 0.0 to 1.0.");
+        }
+        MaxErrRate = mxGetScalar(prhs[3]);
+    }
+
+    //Use the batch read in the background if it covers this SeqRange
+    size_t First = (size_t) pRange[0];
+    joinPrefetch();
+    seq_batch Batch;
+    if (HAS_NEXT && READER_FILE == FileName && NEXT_BATCH.First == First && NEXT_BATCH.Last >= pRange[1] &&
+        NEXT_BATCH.MinQuality == MinQuality && NEXT_BATCH.MaxErrRate == MaxErrRate) {
+        Batch = std::move(NEXT_BATCH);
+        if (Batch.Last > pRange[1] && pRange[1] - First + 1 < Batch.Name.size()) { //Read too far, so drop the extra
+            size_t NumKeep = (size_t) (pRange[1] - First + 1);
+            Batch.Name.resize(NumKeep);
+            Batch.Seq.resize(NumKeep);
+            Batch.Over5.resize(NumKeep);
+            Batch.Over3.resize(NumKeep);
+            Batch.BadLoc.resize(NumKeep);
+            Batch.IsEOF = false;
+            if (!Batch.ErrMsg.empty() && Batch.ErrIdx > pRange[1]) { //error is past this SeqRange, so raise it next call
+                Batch.ErrMsg.clear();
+                closeReader();
+            }
+        }
+    } else {
+        //Reopen the file only if it is a new file or the SeqRange goes backwards
+        if (pREADER == NULL || READER_FILE != FileName || pREADER->NextIdx > First) {
+            closeReader();
+            pREADER = new seq_reader;
+            if (!openSeqReader(FileName.c_str(), *pREADER)) {
+                delete pREADER;
+                pREADER = NULL;
+                mexErrMsgIdAndTxt("readSeqFileMEX:prhs", "Could not open the file \"%s\".", FileName.c_str());
+            }
+            READER_FILE = FileName;
+        }
+        Batch.First = First;
+        Batch.Last = pRange[1];
+        Batch.MinQuality = MinQuality;
+        Batch.MaxErrRate = MaxErrRate;
+        readSeqBatch(*pREADER, Batch);
+    }
+    HAS_NEXT = false;
+    NEXT_BATCH = seq_batch();
+
+    if (!Batch.ErrMsg.empty()) {
+        closeReader();
+        mexErrMsgIdAndTxt(SEQ_FILE_ERR_ID, "%s", Batch.ErrMsg.c_str());
+    }
+    if (Batch.IsEOF) {
+        closeReader();
+    } else if (pREADER != NULL && pREADER->NextIdx == pRange[1] + 1 && pRange[1] < INFINITY && Batch.Bytes <= getPipeBudget()) {
+        //Read the next SeqRange of the same size in the background
+        NEXT_BATCH.First = (size_t) pRange[1] + 1;
+        NEXT_BATCH.Last = pRange[1] + (pRange[1] - First + 1);
+        NEXT_BATCH.MinQuality = MinQuality;
+        NEXT_BATCH.MaxErrRate = MaxErrRate;
+        HAS_NEXT = true;
+        PREFETCH = std::thread(readSeqBatch, std::ref(*pREADER), std::ref(NEXT_BATCH));
+    }
+
+    const std::vector<std::string> &Name = Batch.Name, &Seq = Batch.Seq, &Over5 = Batch.Over5, &Over3 = Batch.Over3;
+    const std::vector<bool> &BadLoc = Batch.BadLoc;
+    mwSize NumSeq = Name.size();
+    plhs[0] = mxCreateCellMatrix(NumSeq, 1);
+    for (mwSize j = 0; j < NumSeq; j++) { mxSetCell(plhs[0], j, convStr2Char(Name[j])); }
+    if (nlhs >= 2) {
+        plhs[1] = mxCreateCellMatrix(NumSeq, 1);
+        for (mwSize j = 0; j < NumSeq; j++) { mxSetCell(plhs[1], j, convStr2Char(Seq[j])); }
+    }
+    if (nlhs >= 3) {
+        plhs[2] = mxCreateCellMatrix(NumSeq, 1);
+        for (mwSize j = 0; j < NumSeq; j++) { mxSetCell(plhs[2], j, convStr2Char(Over5[j])); }
+    }
+    if (nlhs >= 4) {
+        plhs[3] = mxCreateCellMatrix(NumSeq, 1);
+        for (mwSize j = 0; j < NumSeq; j++) { mxSetCell(plhs[3], j, convStr2Char(Over3[j])); }
+    }
+    if (nlhs >= 5) {
+        plhs[4] = mxCreateLogicalMatrix(NumSeq, 1);
+        mxLogical *pBad = mxGetLogicals(plhs[4]);
+        for (mwSize j = 0; j < NumSeq; j++) { pBad[j] = BadLoc[j]; }
+    }
+}
@@ -0,0 +1,49 @@
+%readSeqFileMEX will read a range of sequences from a FASTA or FASTQ file,
+%which can be gzip-compressed (ex: .fastq.gz). Reading and fixing the input
+%sequences are done in one pass: low-quality bases are set to N, letters
+%are capitalized, non-ACGTU letters are set to N, and the 5' and 3' N
+%overhangs are trimmed off (same as fixInputSeq). The file stream is kept
+%open between calls, so reading consecutive SeqRanges (like the batches in
+%BRILIA) does not decompress or re-read the file from the start.
+%
+%After a finite SeqRange is read, the next SeqRange of the same size is
+%read and fixed in a background thread while MATLAB works on the current
+%one. The next call gets it without waiting if it asks for that range. The
+%read-ahead is skipped if a batch is larger than BRILIA_PIPE_MB (default 256
+%MB, see getPipeBudget in ThreadTool).
+%
+%  [SeqName, Seq] = readSeqFileMEX(FileName)
+%
+%  [SeqName, Seq, OverSeq5, OverSeq3, BadLoc] = readSeqFileMEX(FileName)
+%
+%  [...] = readSeqFileMEX(FileName, SeqRange)
+%
+%  [...] = readSeqFileMEX(FileName, SeqRange, MinQuality)
+%
+%  [...] = readSeqFileMEX(FileName, SeqRange, MinQuality, MaxErrRate)
+%
+%  readSeqFileMEX('close')
+%
+%  INPUT
+%    FileName: full name of a .fa/.fasta/.fastq file, or a .gz of these
+%    SeqRange [1 Inf]: 1x2 matrix of the first and last sequence to read
+%    MinQuality ['']: Phred score char (ASCII base 33). Bases with a lower
+%      quality score are set to N. Only used for FASTQ files.
+%    MaxErrRate [0.1]: Max fraction of N in the trimmed sequence before the
+%      sequence is labeled bad.
+%    'close': closes the file stream that is kept open between calls
+%
+%  OUTPUT
+%    SeqName: Mx1 cell of sequence names
+%    Seq: Mx1 cell of fixed sequences, without the N overhangs
+%    OverSeq5: Mx1 cell of the 5' N overhangs that were trimmed off
+%    OverSeq3: Mx1 cell of the 3' N overhangs that were trimmed off
+%    BadLoc: Mx1 logical array of sequences with > MaxErrRate N. As in
+%      fixInputSeq, an all-N sequence becomes '' and is not bad.
+%
+%  EXAMPLE
+%    [SeqName, Seq, ~, ~, BadLoc] = readSeqFileMEX('Reads.fastq.gz', [1 30000], '2');
+%
+%  See also countSeqFileMEX, fixInputSeq, convertInput2VDJdata
+%
+%
@@ -0,0 +1,300 @@
+/*
+seedCDR3MEX will find the possible CDR3 start (104C) and end (118W/F)
+positions of a batch of reads against several V and J seed sets in one
+pass, touching each read once. It is the native version of running
+seedCDR3position for V and J (or Vk/Vl and Jk/Jl). Each read can also be
+fixed to the direction with more germline k-mer hits (as fixSeqDirMEX),
+and can be assigned to a locus (ex: kappa or lambda) by a k-mer vote, so
+that only the seed sets of that locus are searched. The reads of several
+chains (ex: the heavy and light Seq columns) can be done in 1 call.
+
+  CDR3Pos = seedCDR3MEX(Seq, Group)
+
+  [CDR3Pos, Seq, Locus] = seedCDR3MEX(Seq, Group, DirRef, LocusRef)
+
+  INPUT
+    Seq: MxC cell of nt sequences, with 1 column per chain
+    Group: 1xG structure of seed sets with fields
+      Seed: Kx1 cell of seed seqs (see getGeneSeed)
+      Nleft: num of nts left of the anchor codon 1st nt in each seed
+      Nright: num of nts right of the anchor codon 1st nt in each seed
+      IsJ: 1 for J seeds (CDR3 end), 0 for V seeds (CDR3 start)
+      Side: 1x3 char of the [TrimSide PenaltySide PreferSide] options of
+        alignSeqMEX
+      Motif: conserved codon char to search for, as is (like strfind).
+        Use '' for none.
+      Locus: 0 to search reads with no locus, or the LocusRef index of the
+        reads to search
+      Col [1]: the Seq column to search
+    DirRef: Px1 cell of germline seqs used to fix the direction of each
+      read, or a 1xC cell of these with 1 per Seq column. Use [] to skip
+      all columns, or a [] cell to skip 1 column.
+    LocusRef: 1xL cell of Px1 cells of germline seqs of each locus. Use []
+      to skip, which sets all Locus to 0. A column only votes among the
+      loci of its groups, so a column with no Locus > 0 group gets 0.
+
+  OUTPUT
+    CDR3Pos: MxG cell of 1xN anchor positions in the Col read of each
+      group, or [] if none were found or the group was not searched. Reads
+      not longer than Nleft + Nright are skipped.
+    Seq: MxC cell of reads, fixed as fixSeqDirMEX in the columns with a
+      DirRef. Non-char cells of these columns become [].
+    Locus: MxC locus of each read, or 0 if the vote is not decisive (the
+      best locus must have >= 2x the k-mer hits of the next one)
+
+  NOTE
+    The positions are the same as seedCDR3position: for each seed, the
+    alignSeqMEX StartAt(2) + Nleft (+1 if StartAt(2) < 0), plus the Motif
+    positions, +2 for J, and only those <= the read length.
+
+  See also seedCDR3position, seedAllCDR3position, getGeneSeed,
+  fixSeqDirMEX
+*/
+
+#include "AlignTool.hpp"
+#include "SeqTool.hpp"
+#include "ThreadTool.hpp"
+#include <vector>
+#include <string>
+#include <algorithm>
+
+// seed_group stores the inputs of 1 Group element
+struct seed_group {
+    std::vector<const mxChar*> pSeed;
+    std::vector<mwSize> SeedLen;
+    mwSize MaxSeedLen = 0;
+    int Nleft = 0;
+    int Nright = 0;
+    bool IsJ = false;
+    mxChar Side[3] = {'n', 'n', 'n'};
+    std::vector<mxChar> Motif;
+    int Locus = 0;
+    mwSize Col = 0;
+};
+
+// Returns the k-mer set of a cell of seqs
+static void buildRefKmerSet(const mxArray *pRef, kmer_set &KS) {
+    mwSize NumRef = mxGetNumberOfElements(pRef);
+    std::vector<std::string> RefSeq(NumRef);
+    for (mwSize r = 0; r < NumRef; r++) {
+        mxArray *pCell = mxGetCell(pRef, r);
+        if (pCell == NULL || !mxIsChar(pCell)) { continue; }
+        mxChar *pChar = mxGetChars(pCell);
+        mwSize Len = mxGetNumberOfElements(pCell);
+        RefSeq[r].resize(Len);
+        for (mwSize j = 0; j < Len; j++) {
+            RefSeq[r][j] = pChar[j] < 256 ? (char) pChar[j] : 'N';
+        }
+    }
+    buildKmerSet(KS, RefSeq, 9);
+}
+
+// Returns the scalar of a struct field, or Default if missing
+static double getFieldScalar(const mxArray *pGroup, mwSize g, const char *pName, double Default) {
+    mxArray *pField = mxGetField(pGroup, g, pName);
+    return pField != NULL && mxIsNumeric(pField) && !mxIsEmpty(pField) ? mxGetScalar(pField) : Default;
+}
+
+// Returns the sorted, unique anchor positions of 1 read for 1 group
+static void findSeedPos(const mxChar *pSeq, mwSize Len, const seed_group &SG, bool *pMatch, std::vector<double> &Pos) {
+    Pos.clear();
+    for (size_t k = 0; k < SG.pSeed.size(); k++) {
+        align_info AI;
+        alignSeq((mxChar*) pSeq, (mxChar*) SG.pSeed[k], Len, SG.SeedLen[k], 0, 'n', 'n', SG.Side[0], SG.Side[1], SG.Side[2], AI, pMatch, true);
+        int StartAt = AI.BShift >= 0 ? AI.BShift + 1 : AI.BShift;
+        Pos.push_back(StartAt + SG.Nleft + (StartAt < 0));
+    }
+    mwSize LenM = SG.Motif.size();
+    for (mwSize j = 0; LenM > 0 && j + LenM <= Len; j++) {
+        if (std::equal(SG.Motif.begin(), SG.Motif.end(), &pSeq[j])) { Pos.push_back((double) j + 1); }
+    }
+    std::sort(Pos.begin(), Pos.end());
+    Pos.erase(std::unique(Pos.begin(), Pos.end()), Pos.end());
+    for (size_t k = 0; k < Pos.size(); k++) {
+        if (SG.IsJ) { Pos[k] += 2; }
+    }
+    Pos.erase(std::remove_if(Pos.begin(), Pos.end(), [Len](double p) { return p > Len; }), Pos.end());
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || nrhs > 4) {
+        mexErrMsgIdAndTxt("seedCDR3MEX:nrhs", "Incorrect number of inputs. Min is 2. Max is 4.");
+    }
+    if (nlhs > 3) {
+        mexErrMsgIdAndTxt("seedCDR3MEX:nlhs", "Too many outputs. Max is 3.");
+    }
+    if (!mxIsCell(prhs[0]) || mxGetNumberOfDimensions(prhs[0]) > 2) {
+        mexErrMsgIdAndTxt("seedCDR3MEX:prhs", "Input1: Seq must be a MxC cell of sequences.");
+    }
+    if (!mxIsStruct(prhs[1]) || mxGetFieldNumber(prhs[1], "Seed") < 0) {
+        mexErrMsgIdAndTxt("seedCDR3MEX:prhs", "Input2: Group must be a structure with a Seed field.");
+    }
+    const mxArray *pDirRef = nrhs >= 3 && !mxIsEmpty(prhs[2]) ? prhs[2] : NULL;
+    const mxArray *pLocusRef = nrhs >= 4 && !mxIsEmpty(prhs[3]) ? prhs[3] : NULL;
+    if ((pDirRef != NULL && !mxIsCell(pDirRef)) || (pLocusRef != NULL && !mxIsCell(pLocusRef))) {
+        mexErrMsgIdAndTxt("seedCDR3MEX:prhs", "Input3-4: DirRef and LocusRef must be a cell or [].");
+    }
+
+    //Gather the seed groups
+    mwSize NumSeq = mxGetM(prhs[0]);
+    mwSize NumCol = mxGetN(prhs[0]);
+    mwSize NumGroup = mxGetNumberOfElements(prhs[1]);
+    std::vector<seed_group> SG(NumGroup);
+    for (mwSize g = 0; g < NumGroup; g++) {
+        mxArray *pSeed = mxGetField(prhs[1], g, "Seed");
+        if (pSeed != NULL && mxIsCell(pSeed)) {
+            for (mwSize k = 0; k < mxGetNumberOfElements(pSeed); k++) {
+                mxArray *pCell = mxGetCell(pSeed, k);
+                bool IsChar = pCell != NULL && mxIsChar(pCell);
+                SG[g].pSeed.push_back(IsChar ? mxGetChars(pCell) : NULL);
+                SG[g].SeedLen.push_back(IsChar ? mxGetNumberOfElements(pCell) : 0);
+                SG[g].MaxSeedLen = std::max(SG[g].MaxSeedLen, SG[g].SeedLen.back());
+            }
+        }
+        SG[g].Nleft = (int) getFieldScalar(prhs[1], g, "Nleft", 0);
+        SG[g].Nright = (int) getFieldScalar(prhs[1], g, "Nright", 0);
+        SG[g].IsJ = getFieldScalar(prhs[1], g, "IsJ", 0) != 0;
+        SG[g].Locus = (int) getFieldScalar(prhs[1], g, "Locus", 0);
+        double Col = getFieldScalar(prhs[1], g, "Col", 1);
+        if (!(Col >= 1 && Col <= NumCol)) {
+            mexErrMsgIdAndTxt("seedCDR3MEX:prhs", "Input2: Group(%d).Col must be from 1 to %d.", (int) g + 1, (int) NumCol);
+        }
+        SG[g].Col = (mwSize) Col - 1;
+        mxArray *pSide = mxGetField(prhs[1], g, "Side");
+        if (pSide != NULL && mxIsChar(pSide)) {
+            for (mwSize k = 0; k < 3 && k < mxGetNumberOfElements(pSide); k++) {
+                SG[g].Side[k] = mxGetChars(pSide)[k];
+            }
+        }
+        mxArray *pMotif = mxGetField(prhs[1], g, "Motif");
+        if (pMotif != NULL && mxIsChar(pMotif)) {
+            SG[g].Motif.assign(mxGetChars(pMotif), mxGetChars(pMotif) + mxGetNumberOfElements(pMotif));
+        }
+    }
+
+    //Gather the DirRef k-mers of each column. A cell of cells or [] has 1 DirRef per column.
+    std::vector<kmer_set> DirKS(NumCol);
+    std::vector<bool> HasDir(NumCol, false);
+    if (pDirRef != NULL) {
+        mxArray *pFirst = mxGetCell(pDirRef, 0);
+        bool PerCol = pFirst == NULL || mxIsCell(pFirst) || !mxIsChar(pFirst);
+        if (PerCol && mxGetNumberOfElements(pDirRef) != NumCol) {
+            mexErrMsgIdAndTxt("seedCDR3MEX:prhs", "Input3: DirRef must have 1 cell per Seq column.");
+        }
+        for (mwSize c = 0; c < NumCol; c++) {
+            const mxArray *pRef = PerCol ? mxGetCell(pDirRef, c) : pDirRef;
+            if (pRef == NULL || !mxIsCell(pRef) || mxIsEmpty(pRef)) { continue; }
+            buildRefKmerSet(pRef, DirKS[c]);
+            HasDir[c] = true;
+        }
+    }
+    mwSize NumLocus = pLocusRef != NULL ? mxGetNumberOfElements(pLocusRef) : 0;
+    std::vector<kmer_set> LocusKS(NumLocus);
+    for (mwSize l = 0; l < NumLocus; l++) {
+        mxArray *pCell = mxGetCell(pLocusRef, l);
+        if (pCell != NULL && mxIsCell(pCell)) { buildRefKmerSet(pCell, LocusKS[l]); }
+    }
+    std::vector<std::vector<bool> > VoteLocus(NumCol, std::vector<bool>(NumLocus, false));
+    std::vector<bool> HasVote(NumCol, false);
+    for (mwSize g = 0; g < NumGroup; g++) {
+        if (SG[g].Locus >= 1 && SG[g].Locus <= (int) NumLocus) {
+            VoteLocus[SG[g].Col][SG[g].Locus - 1] = true;
+            HasVote[SG[g].Col] = true;
+        }
+    }
+
+    //Gather the reads. If fixing the direction, work on the output copy.
+    mwSize NumRead = NumSeq * NumCol;
+    bool AnyDir = std::find(HasDir.begin(), HasDir.end(), true) != HasDir.end();
+    mxArray *pSeqOut = AnyDir ? mxCreateCellMatrix(NumSeq, NumCol) : NULL;
+    std::vector<mxChar*> pSeqs(NumRead, NULL);
+    std::vector<const mxChar*> pSrcs(NumRead, NULL);
+    std::vector<mwSize> SeqLens(NumRead, 0);
+    for (mwSize r = 0; r < NumRead; r++) {
+        mxArray *pCell = mxGetCell(prhs[0], r);
+        bool IsChar = pCell != NULL && mxIsChar(pCell);
+        if (pSeqOut != NULL && HasDir[r / NumSeq]) {
+            mxArray *pOut = IsChar ? mxCreateCharArray(mxGetNumberOfDimensions(pCell), mxGetDimensions(pCell)) : mxCreateDoubleMatrix(0, 0, mxREAL);
+            mxSetCell(pSeqOut, r, pOut);
+            if (!IsChar) { continue; }
+            pSeqs[r] = mxGetChars(pOut);
+            pSrcs[r] = mxGetChars(pCell);
+        } else {
+            if (pSeqOut != NULL && pCell != NULL) { mxSetCell(pSeqOut, r, mxDuplicateArray(pCell)); }
+            if (IsChar) { pSeqs[r] = mxGetChars(pCell); }
+        }
+        SeqLens[r] = IsChar ? mxGetNumberOfElements(pCell) : 0;
+    }
+
+    std::vector<double> Locus(NumRead, 0);
+    std::vector<std::vector<double> > CDR3Pos(NumSeq * NumGroup);
+    parallelFor(NumRead, 64, [&](size_t Beg, size_t End) {
+        std::vector<mxChar> SeqR;
+        std::vector<mwSize> Hits(NumLocus, 0);
+        for (size_t r = Beg; r < End; r++) {
+            if (pSeqs[r] == NULL) { continue; }
+            mxChar *pSeq = pSeqs[r];
+            mwSize Len = SeqLens[r];
+            mwSize s = r % NumSeq;
+            mwSize c = r / NumSeq;
+
+            //Fix the direction, as fixSeqDirMEX
+            if (HasDir[c]) {
+                fixSeqNT(pSrcs[r], Len, pSeq);
+                SeqR.resize(Len);
+                rcompSeqDNA(pSeq, Len, SeqR.data());
+                if (countKmerHits(DirKS[c], SeqR.data(), Len) > countKmerHits(DirKS[c], pSeq, Len)) {
+                    std::copy(SeqR.begin(), SeqR.end(), pSeq);
+                }
+            }
+
+            //Vote for the locus among the loci of this column
+            if (HasVote[c]) {
+                mwSize Best = 0, Next = 0;
+                int BestL = 0;
+                for (mwSize l = 0; l < NumLocus; l++) {
+                    Hits[l] = VoteLocus[c][l] && LocusKS[l].K > 0 ? countKmerHits(LocusKS[l], pSeq, Len) : 0;
+                    if (Hits[l] > Best) {
+                        Next = Best;
+                        Best = Hits[l];
+                        BestL = (int) l + 1;
+                    } else if (Hits[l] > Next) {
+                        Next = Hits[l];
+                    }
+                }
+                if (Best > 0 && Best >= 2*Next) { Locus[r] = BestL; }
+            }
+
+            //Find the anchors of each group of this column
+            mwSize MaxLen = Len;
+            for (mwSize g = 0; g < NumGroup; g++) {
+                MaxLen = std::max(MaxLen, SG[g].MaxSeedLen);
+            }
+            bool pMatch[MaxLen + 1];
+            for (mwSize g = 0; g < NumGroup; g++) {
+                if (SG[g].Col != c || SG[g].Locus != (int) Locus[r]) { continue; }
+                if (Len <= (mwSize) (SG[g].Nleft + SG[g].Nright)) { continue; }
+                findSeedPos(pSeq, Len, SG[g], pMatch, CDR3Pos[s + g*NumSeq]);
+            }
+        }
+    });
+
+    plhs[0] = mxCreateCellMatrix(NumSeq, NumGroup);
+    for (mwSize j = 0; j < NumSeq*NumGroup; j++) {
+        if (CDR3Pos[j].empty()) { continue; }
+        mxArray *pPos = mxCreateDoubleMatrix(1, CDR3Pos[j].size(), mxREAL);
+        std::copy(CDR3Pos[j].begin(), CDR3Pos[j].end(), mxGetPr(pPos));
+        mxSetCell(plhs[0], j, pPos);
+    }
+    if (nlhs >= 2) {
+        plhs[1] = pSeqOut != NULL ? pSeqOut : mxDuplicateArray(prhs[0]);
+    } else if (pSeqOut != NULL) {
+        mxDestroyArray(pSeqOut);
+    }
+    if (nlhs >= 3) {
+        plhs[2] = mxCreateDoubleMatrix(NumSeq, NumCol, mxREAL);
+        std::copy(Locus.begin(), Locus.end(), mxGetPr(plhs[2]));
+    }
+}
@@ -0,0 +1,52 @@
+%seedCDR3MEX will find the possible CDR3 start (104C) and end (118W/F)
+%positions of a batch of reads against several V and J seed sets in one
+%pass, touching each read once. It is the native version of running
+%seedCDR3position for V and J (or Vk/Vl and Jk/Jl). Each read can also be
+%fixed to the direction with more germline k-mer hits (as fixSeqDirMEX),
+%and can be assigned to a locus (ex: kappa or lambda) by a k-mer vote, so
+%that only the seed sets of that locus are searched. The reads of several
+%chains (ex: the heavy and light Seq columns) can be done in 1 call.
+%
+%  CDR3Pos = seedCDR3MEX(Seq, Group)
+%
+%  [CDR3Pos, Seq, Locus] = seedCDR3MEX(Seq, Group, DirRef, LocusRef)
+%
+%  INPUT
+%    Seq: MxC cell of nt sequences, with 1 column per chain
+%    Group: 1xG structure of seed sets with fields
+%      Seed: Kx1 cell of seed seqs (see getGeneSeed)
+%      Nleft: num of nts left of the anchor codon 1st nt in each seed
+%      Nright: num of nts right of the anchor codon 1st nt in each seed
+%      IsJ: 1 for J seeds (CDR3 end), 0 for V seeds (CDR3 start)
+%      Side: 1x3 char of the [TrimSide PenaltySide PreferSide] options of
+%        alignSeqMEX
+%      Motif: conserved codon char to search for, as is (like strfind).
+%        Use '' for none.
+%      Locus: 0 to search reads with no locus, or the LocusRef index of the
+%        reads to search
+%      Col [1]: the Seq column to search
+%    DirRef: Px1 cell of germline seqs used to fix the direction of each
+%      read, or a 1xC cell of these with 1 per Seq column. Use [] to skip
+%      all columns, or a [] cell to skip 1 column.
+%    LocusRef: 1xL cell of Px1 cells of germline seqs of each locus. Use []
+%      to skip, which sets all Locus to 0. A column only votes among the
+%      loci of its groups, so a column with no Locus > 0 group gets 0.
+%
+%  OUTPUT
+%    CDR3Pos: MxG cell of 1xN anchor positions in the Col read of each
+%      group, or [] if none were found or the group was not searched. Reads
+%      not longer than Nleft + Nright are skipped.
+%    Seq: MxC cell of reads, fixed as fixSeqDirMEX in the columns with a
+%      DirRef. Non-char cells of these columns become [].
+%    Locus: MxC locus of each read, or 0 if the vote is not decisive (the
+%      best locus must have >= 2x the k-mer hits of the next one)
+%
+%  NOTE
+%    The positions are the same as seedCDR3position: for each seed, the
+%    alignSeqMEX StartAt(2) + Nleft (+1 if StartAt(2) < 0), plus the Motif
+%    positions, +2 for J, and only those <= the read length.
+%
+%  See also seedCDR3position, seedAllCDR3position, getGeneSeed,
+%  fixSeqDirMEX
+%
+%
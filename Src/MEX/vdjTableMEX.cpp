@@ -0,0 +1,293 @@
+/*
+vdjTableMEX will store VDJdata in native, typed columns behind a numeric
+handle, instead of a cell array with 1 mxArray per cell. Numeric columns
+are stored as doubles, repeated strings like gene names are interned into
+a dictionary, and the other strings like sequences are stored in 1
+contiguous char arena per column (see VdjTableTool). Numeric columns are
+returned as matrices, so there is no cell2mat needed.
+
+  H = vdjTableMEX('create', VDJdata, VDJheader)
+
+  vdjTableMEX('append', H, VDJdata)
+
+  Value = vdjTableMEX('get', H, Col, RowIdx)
+
+  [Code, Dict] = vdjTableMEX('codes', H, Col, RowIdx)
+
+  vdjTableMEX('set', H, Col, RowIdx, Value)
+
+  [VDJdata, VDJheader] = vdjTableMEX('export', H, RowIdx)
+
+  Info = vdjTableMEX('info', H)
+
+  vdjTableMEX('delete', H)
+
+  INPUT
+    VDJdata: MxN cell of BRILIA annotations
+    VDJheader: 1xN cell of the column names
+    H: table handle (a double scalar) returned by 'create'
+    Col: column name (case-insensitive) or column number
+    RowIdx: 1-based row numbers. Default or [] is all rows.
+    Value: for 'set', a cell with 1 cell per RowIdx, or a double matrix
+      for numeric columns, where NaN is stored as [].
+
+  OUTPUT
+    H: table handle. The table is kept until it is deleted or this MEX
+      file is cleared.
+    Value: for 'get', a double column for numeric columns (NaN for []), or
+      else a cell column
+    Code: double column of the index of each string in Dict. 0 for [].
+      Works on any string column.
+    Dict: Kx1 cell of the unique strings
+    Info: structure with NumRow, Header, Kind ('num', 'dict', 'str', or
+      'any' per column), and Bytes (approximate memory used)
+
+  EXAMPLE
+    VDJheader = {'SeqNum', 'Seq', 'vGeneName'};
+    VDJdata = {1, 'ACGTAG', 'IGHV1-1'; 2, 'ACGTTG', 'IGHV1-1'; 3, [], 'IGHV1-2'};
+    H = vdjTableMEX('create', VDJdata, VDJheader);
+    SeqNum = vdjTableMEX('get', H, 'SeqNum')
+    SeqNum =
+         1
+         2
+         3
+    [Code, Dict] = vdjTableMEX('codes', H, 'vGeneName')
+    Code =
+         1
+         1
+         2
+    Dict =
+      2x1 cell array
+        {'IGHV1-1'}
+        {'IGHV1-2'}
+    vdjTableMEX('set', H, 'Seq', 3, {'ACGAAG'});
+    vdjTableMEX('delete', H);
+
+  See also openSeqData, getVDJmapper
+*/
+
+#include "VdjTableTool.hpp"
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <math.h>
+
+static std::map<int, vdj_table*> TABLES;
+static int NEXT_HANDLE = 1;
+
+// vdj_table_free frees a table that is not in TABLES yet, if building it fails
+struct vdj_table_free {
+    void operator()(vdj_table *pVT) const {
+        clearVdjTable(*pVT);
+        delete pVT;
+    }
+};
+
+static void deleteTables() {
+    for (std::map<int, vdj_table*>::iterator Iter = TABLES.begin(); Iter != TABLES.end(); ++Iter) {
+        clearVdjTable(*Iter->second);
+        delete Iter->second;
+    }
+    TABLES.clear();
+}
+
+static vdj_table &getTable(const mxArray *pHandle) {
+    if (!mxIsDouble(pHandle) || mxGetNumberOfElements(pHandle) != 1) {
+        mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input2: H must be a table handle from vdjTableMEX('create', ...).");
+    }
+    std::map<int, vdj_table*>::iterator Iter = TABLES.find((int) mxGetScalar(pHandle));
+    if (Iter == TABLES.end()) {
+        mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input2: H = %g is not an existing table handle.", mxGetScalar(pHandle));
+    }
+    return *Iter->second;
+}
+
+static size_t getColIdx(const vdj_table &VT, const mxArray *pCol) {
+    int Col = -1;
+    if (mxIsChar(pCol)) {
+        char *pName = mxArrayToString(pCol);
+        Col = findVdjColumn(VT, pName);
+        mxFree(pName);
+    } else if (mxIsDouble(pCol) && mxGetNumberOfElements(pCol) == 1) {
+        double Num = mxGetScalar(pCol);
+        Col = Num >= 1 && Num <= (double) VT.Col.size() ? (int) Num - 1 : -1;
+    }
+    if (Col < 0) {
+        mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input3: Col must be a column name or number in the table.");
+    }
+    return (size_t) Col;
+}
+
+static void getRowIdx(const vdj_table &VT, int nrhs, const mxArray *prhs[], int Arg, std::vector<size_t> &RowIdx) {
+    RowIdx.clear();
+    if (nrhs <= Arg || mxIsEmpty(prhs[Arg])) {
+        RowIdx.resize(VT.NumRow);
+        for (size_t r = 0; r < VT.NumRow; r++) { RowIdx[r] = r; }
+        return;
+    }
+    if (!mxIsDouble(prhs[Arg])) {
+        mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input%d: RowIdx must be a double matrix of row numbers.", Arg + 1);
+    }
+    const double *pIdx = mxGetPr(prhs[Arg]);
+    RowIdx.resize(mxGetNumberOfElements(prhs[Arg]));
+    for (size_t j = 0; j < RowIdx.size(); j++) {
+        if (!(pIdx[j] >= 1 && pIdx[j] <= (double) VT.NumRow) || pIdx[j] != floor(pIdx[j])) {
+            mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input%d: RowIdx has a row number outside 1 to %d.", Arg + 1, (int) VT.NumRow);
+        }
+        RowIdx[j] = (size_t) pIdx[j] - 1;
+    }
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    if (nrhs < 2 || !mxIsChar(prhs[0])) {
+        mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "Need a command string and a table handle or VDJdata.");
+    }
+    char *pCmd = mxArrayToString(prhs[0]);
+    std::string Cmd(pCmd);
+    mxFree(pCmd);
+
+    if (Cmd == "create") {
+        if (nrhs != 3) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'create' needs VDJdata and VDJheader.");
+        }
+        std::unique_ptr<vdj_table, vdj_table_free> pVT(new vdj_table);
+        buildVdjTable(prhs[1], prhs[2], *pVT);
+        if (TABLES.empty()) {
+            mexLock(); //keeps the tables until they are deleted
+            mexAtExit(deleteTables);
+        }
+        TABLES[NEXT_HANDLE] = pVT.release();
+        plhs[0] = mxCreateDoubleScalar(NEXT_HANDLE++);
+        return;
+    }
+
+    vdj_table &VT = getTable(prhs[1]);
+    std::vector<size_t> RowIdx;
+
+    if (Cmd == "append") {
+        if (nrhs != 3) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'append' needs H and VDJdata.");
+        }
+        appendVdjRows(prhs[2], VT);
+
+    } else if (Cmd == "get") {
+        if (nrhs < 3 || nrhs > 4) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'get' needs H, Col, and an optional RowIdx.");
+        }
+        const vdj_column &C = VT.Col[getColIdx(VT, prhs[2])];
+        getRowIdx(VT, nrhs, prhs, 3, RowIdx);
+        if (C.Kind == VDJ_NUM) {
+            plhs[0] = mxCreateDoubleMatrix(RowIdx.size(), 1, mxREAL);
+            double *pOut = mxGetPr(plhs[0]);
+            for (size_t j = 0; j < RowIdx.size(); j++) {
+                pOut[j] = C.Has[RowIdx[j]] ? C.Num[RowIdx[j]] : mxGetNaN();
+            }
+        } else {
+            plhs[0] = mxCreateCellMatrix(RowIdx.size(), 1);
+            for (size_t j = 0; j < RowIdx.size(); j++) {
+                mxSetCell(plhs[0], j, getVdjCell(C, RowIdx[j]));
+            }
+        }
+
+    } else if (Cmd == "codes") {
+        if (nrhs < 3 || nrhs > 4) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'codes' needs H, Col, and an optional RowIdx.");
+        }
+        const vdj_column &C = VT.Col[getColIdx(VT, prhs[2])];
+        if (C.Kind != VDJ_DICT && C.Kind != VDJ_STR && !(C.Kind == VDJ_NUM && VT.NumRow == 0)) {
+            mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input3: Col must be a string column for 'codes'.");
+        }
+        getRowIdx(VT, nrhs, prhs, 3, RowIdx);
+
+        //Number the strings in the order they are first seen in RowIdx
+        std::unordered_map<std::string, unsigned int> DictIdx;
+        std::vector<const std::string*> Dict;
+        plhs[0] = mxCreateDoubleMatrix(RowIdx.size(), 1, mxREAL);
+        double *pCode = mxGetPr(plhs[0]);
+        for (size_t j = 0; j < RowIdx.size(); j++) {
+            unsigned int Len;
+            const char *pStr = getVdjStr(C, RowIdx[j], Len);
+            if (pStr == NULL) { continue; }
+            std::pair<std::unordered_map<std::string, unsigned int>::iterator, bool> Ins = DictIdx.insert(std::make_pair(std::string(pStr, Len), (unsigned int) Dict.size() + 1));
+            if (Ins.second) { Dict.push_back(&Ins.first->first); }
+            pCode[j] = Ins.first->second;
+        }
+        if (nlhs >= 2) {
+            plhs[1] = mxCreateCellMatrix(Dict.size(), 1);
+            for (size_t k = 0; k < Dict.size(); k++) {
+                mxSetCell(plhs[1], k, mxCreateString(Dict[k]->c_str()));
+            }
+        }
+
+    } else if (Cmd == "set") {
+        if (nrhs != 5) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'set' needs H, Col, RowIdx, and Value.");
+        }
+        vdj_column &C = VT.Col[getColIdx(VT, prhs[2])];
+        getRowIdx(VT, nrhs, prhs, 3, RowIdx);
+        const mxArray *pValue = prhs[4];
+        if (mxGetNumberOfElements(pValue) != RowIdx.size()) {
+            mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input5: Value must have 1 element per RowIdx.");
+        }
+        if (mxIsCell(pValue)) {
+            for (size_t j = 0; j < RowIdx.size(); j++) {
+                setVdjCell(C, RowIdx[j], mxGetCell(pValue, j));
+            }
+        } else if (mxIsDouble(pValue) && !mxIsComplex(pValue)) {
+            const double *pNum = mxGetPr(pValue);
+            for (size_t j = 0; j < RowIdx.size(); j++) {
+                mxArray *pCell = pNum[j] != pNum[j] ? mxCreateDoubleMatrix(0, 0, mxREAL) : mxCreateDoubleScalar(pNum[j]);
+                setVdjCell(C, RowIdx[j], pCell);
+                mxDestroyArray(pCell);
+            }
+        } else {
+            mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input5: Value must be a cell or a double matrix.");
+        }
+
+    } else if (Cmd == "export") {
+        if (nrhs > 3) {
+            mexErrMsgIdAndTxt("vdjTableMEX:nrhs", "'export' needs H and an optional RowIdx.");
+        }
+        getRowIdx(VT, nrhs, prhs, 2, RowIdx);
+        plhs[0] = mxCreateCellMatrix(RowIdx.size(), VT.Col.size());
+        for (size_t c = 0; c < VT.Col.size(); c++) {
+            for (size_t j = 0; j < RowIdx.size(); j++) {
+                mxSetCell(plhs[0], j + c*RowIdx.size(), getVdjCell(VT.Col[c], RowIdx[j]));
+            }
+        }
+        if (nlhs >= 2) {
+            plhs[1] = mxCreateCellMatrix(1, VT.Col.size());
+            for (size_t c = 0; c < VT.Col.size(); c++) {
+                mxSetCell(plhs[1], c, mxCreateString(VT.Col[c].Name.c_str()));
+            }
+        }
+
+    } else if (Cmd == "info") {
+        static const char *KIND_NAME[4] = {"num", "dict", "str", "any"};
+        const char *Fields[4] = {"NumRow", "Header", "Kind", "Bytes"};
+        plhs[0] = mxCreateStructMatrix(1, 1, 4, Fields);
+        mxArray *pHeader = mxCreateCellMatrix(1, VT.Col.size());
+        mxArray *pKind = mxCreateCellMatrix(1, VT.Col.size());
+        for (size_t c = 0; c < VT.Col.size(); c++) {
+            mxSetCell(pHeader, c, mxCreateString(VT.Col[c].Name.c_str()));
+            mxSetCell(pKind, c, mxCreateString(KIND_NAME[VT.Col[c].Kind]));
+        }
+        mxSetField(plhs[0], 0, "NumRow", mxCreateDoubleScalar((double) VT.NumRow));
+        mxSetField(plhs[0], 0, "Header", pHeader);
+        mxSetField(plhs[0], 0, "Kind", pKind);
+        mxSetField(plhs[0], 0, "Bytes", mxCreateDoubleScalar((double) getVdjBytes(VT)));
+
+    } else if (Cmd == "delete") {
+        int Handle = (int) mxGetScalar(prhs[1]);
+        clearVdjTable(VT);
+        delete TABLES[Handle];
+        TABLES.erase(Handle);
+        if (TABLES.empty()) { mexUnlock(); }
+
+    } else {
+        mexErrMsgIdAndTxt("vdjTableMEX:prhs", "Input1: Unknown command '%s'.", Cmd.c_str());
+    }
+}
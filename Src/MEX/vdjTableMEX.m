@@ -0,0 +1,67 @@
+%vdjTableMEX will store VDJdata in native, typed columns behind a numeric
+%handle, instead of a cell array with 1 mxArray per cell. Numeric columns
+%are stored as doubles, repeated strings like gene names are interned into
+%a dictionary, and the other strings like sequences are stored in 1
+%contiguous char arena per column (see VdjTableTool). Numeric columns are
+%returned as matrices, so there is no cell2mat needed.
+%
+%  H = vdjTableMEX('create', VDJdata, VDJheader)
+%
+%  vdjTableMEX('append', H, VDJdata)
+%
+%  Value = vdjTableMEX('get', H, Col, RowIdx)
+%
+%  [Code, Dict] = vdjTableMEX('codes', H, Col, RowIdx)
+%
+%  vdjTableMEX('set', H, Col, RowIdx, Value)
+%
+%  [VDJdata, VDJheader] = vdjTableMEX('export', H, RowIdx)
+%
+%  Info = vdjTableMEX('info', H)
+%
+%  vdjTableMEX('delete', H)
+%
+%  INPUT
+%    VDJdata: MxN cell of BRILIA annotations
+%    VDJheader: 1xN cell of the column names
+%    H: table handle (a double scalar) returned by 'create'
+%    Col: column name (case-insensitive) or column number
+%    RowIdx: 1-based row numbers. Default or [] is all rows.
+%    Value: for 'set', a cell with 1 cell per RowIdx, or a double matrix
+%      for numeric columns, where NaN is stored as [].
+%
+%  OUTPUT
+%    H: table handle. The table is kept until it is deleted or this MEX
+%      file is cleared.
+%    Value: for 'get', a double column for numeric columns (NaN for []), or
+%      else a cell column
+%    Code: double column of the index of each string in Dict. 0 for [].
+%      Works on any string column.
+%    Dict: Kx1 cell of the unique strings
+%    Info: structure with NumRow, Header, Kind ('num', 'dict', 'str', or
+%      'any' per column), and Bytes (approximate memory used)
+%
+%  EXAMPLE
+%    VDJheader = {'SeqNum', 'Seq', 'vGeneName'};
+%    VDJdata = {1, 'ACGTAG', 'IGHV1-1'; 2, 'ACGTTG', 'IGHV1-1'; 3, [], 'IGHV1-2'};
+%    H = vdjTableMEX('create', VDJdata, VDJheader);
+%    SeqNum = vdjTableMEX('get', H, 'SeqNum')
+%    SeqNum =
+%         1
+%         2
+%         3
+%    [Code, Dict] = vdjTableMEX('codes', H, 'vGeneName')
+%    Code =
+%         1
+%         1
+%         2
+%    Dict =
+%      2x1 cell array
+%        {'IGHV1-1'}
+%        {'IGHV1-2'}
+%    vdjTableMEX('set', H, 'Seq', 3, {'ACGAAG'});
+%    vdjTableMEX('delete', H);
+%
+%  See also openSeqData, getVDJmapper
+%
+%
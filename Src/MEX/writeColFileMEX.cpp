@@ -0,0 +1,222 @@
+/*
+writeColFileMEX will write or append a cell array to a BRILIA columnar
+(.bcol) file, a binary checkpoint format that is much faster to append and
+reopen than a delimited file. Each call adds 1 batch, and the file footer
+indexes all the batches so that a resumed job can find the last SeqNum
+without reading the data. See ColFileTool for the file layout.
+
+  writeColFileMEX(CellData, Header, OutputFile)
+
+  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum)
+
+  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum, 'append')
+
+  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum, 'append', 'async')
+
+  writeColFileMEX('flush')
+
+  INPUT
+    CellData: MxN cell array of [], double, char, or logical values. Any
+      column of only scalars or only 1-row chars is stored more compactly.
+    Header: 1xN cell of column names
+    OutputFile: full name of the file to be saved to
+    LastSeqNum [NaN]: the last SeqNum processed by this batch, which is
+      stored in the footer (ex: a batch with all bad seq has 0 rows but
+      still moves the resume point)
+    'append': appends a batch to the outfile instead of overwriting. The
+      Header must be the same as the one in the file.
+    'async': encodes the batch, then returns while a background thread
+      writes it and the new footer to the file. The next call waits for
+      this write first, so at most 1 batch is pending. A failed write is
+      reported by the next call.
+    'flush': waits until the async write is done. Use this before reading,
+      moving, or checking the size of the file.
+
+  EXAMPLE
+    CellData = {'Seq1', 1, [3 4]; 'Seq2', [], 5};
+    writeColFileMEX(CellData, {'SeqName', 'SeqNum', 'VMapNum'}, 'Test.bcol', 2)
+    writeColFileMEX(CellData(1, :), {'SeqName', 'SeqNum', 'VMapNum'}, 'Test.bcol', 3, 'append')
+    [CellData, Header, Info] = readColFileMEX('Test.bcol');
+    Info =
+      struct with fields:
+        BatchRows: [2x1 double]
+       LastSeqNum: [2x1 double]
+
+  See also readColFileMEX, saveSeqData, openSeqData
+*/
+
+#include "ColFileTool.hpp"
+#include "DlmTool.hpp"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <math.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define seekFile _fseeki64
+#define truncateFile(pFile, Size) _chsize_s(_fileno(pFile), Size)
+#else
+#include <unistd.h>
+#define seekFile fseeko
+#define truncateFile(pFile, Size) ftruncate(fileno(pFile), Size)
+#endif
+
+// col_job stores 1 encoded batch and the new footer, to write at Start
+struct col_job {
+    std::string FileName;
+    std::string Buf;
+    unsigned long long Start = 0;
+    bool IsNew = false;
+};
+
+static std::thread WRITER;      //writes WRITE_JOB in the background
+static col_job WRITE_JOB;
+static bool WRITE_FAILED = false;
+static bool EXIT_ADDED = false;  //joinWriter is set as the mexAtExit function
+
+static bool writeColJob(const col_job &Job) {
+    FILE *pFile = fopen(Job.FileName.c_str(), Job.IsNew ? "wb" : "r+b");
+    if (pFile == NULL) { return false; }
+    bool Success = seekFile(pFile, (long long) Job.Start, SEEK_SET) == 0;
+    Success = Success && fwrite(Job.Buf.data(), 1, Job.Buf.size(), pFile) == Job.Buf.size();
+    Success = Success && fflush(pFile) == 0;
+    Success = Success && truncateFile(pFile, Job.Start + Job.Buf.size()) == 0; //drop a cut-off batch
+    return (fclose(pFile) == 0) && Success;
+}
+
+static void runWriter() {
+    WRITE_FAILED = !writeColJob(WRITE_JOB);
+    std::string().swap(WRITE_JOB.Buf); //free the batch
+}
+
+static void joinWriter() {
+    if (WRITER.joinable()) { WRITER.join(); }
+}
+
+// Waits for the async write, and reports if it failed
+static void checkWriter() {
+    joinWriter();
+    if (WRITE_FAILED) {
+        WRITE_FAILED = false;
+        mexErrMsgIdAndTxt("writeColFileMEX:write", "Could not create/write to the file \"%s\".", WRITE_JOB.FileName.c_str());
+    }
+}
+
+static std::string getString(const mxArray *pStr) {
+    char *pChar = mxArrayToString(pStr);
+    std::string Str(pChar == NULL ? "" : pChar);
+    mxFree(pChar);
+    return Str;
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    (void) plhs; //no outputs
+
+    if (nrhs < 1 || nrhs > 6) {
+        mexErrMsgIdAndTxt("writeColFileMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 6.");
+    }
+    if (nlhs > 0) {
+        mexErrMsgIdAndTxt("writeColFileMEX:nlhs", "Too many outputs. Max is 0.");
+    }
+    if (nrhs == 1 && mxIsChar(prhs[0])) {
+        std::string Cmd = getString(prhs[0]);
+        if (Cmd != "flush") {
+            mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input1: Unknown command \"%s\".", Cmd.c_str());
+        }
+        checkWriter();
+        return;
+    }
+    if (nrhs < 3) {
+        mexErrMsgIdAndTxt("writeColFileMEX:nrhs", "Incorrect number of inputs. Min is 3.");
+    }
+    if (!mxIsCell(prhs[0]) || mxGetNumberOfDimensions(prhs[0]) > 2) {
+        mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input1: CellData must be a MxN cell array.");
+    }
+    size_t NumCol = mxGetN(prhs[0]);
+    if (!mxIsCell(prhs[1]) || mxGetNumberOfElements(prhs[1]) != NumCol) {
+        mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input2: Header must be a 1xN cell of char, with N = # of CellData columns.");
+    }
+    if (!mxIsChar(prhs[2])) {
+        mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input3: OutputFile must be a char array.");
+    }
+    double LastSeqNum = NAN;
+    if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        if (!mxIsDouble(prhs[3])) {
+            mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input4: LastSeqNum must be a scalar.");
+        }
+        LastSeqNum = mxGetScalar(prhs[3]);
+    }
+    bool Append = false, Async = false;
+    for (int k = 4; k < nrhs; k++) {
+        if (!mxIsChar(prhs[k])) { mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input%d: Must be 'append' or 'async'.", k + 1); }
+        mxChar *pStr = mxGetChars(prhs[k]);
+        mwSize Len = mxGetNumberOfElements(prhs[k]);
+        if (Len > 1 && (pStr[0] == 'a' || pStr[0] == 'A')) {
+            if (pStr[1] == 'p' || pStr[1] == 'P') { Append = true; }
+            if (pStr[1] == 's' || pStr[1] == 'S') { Async = true; }
+        }
+    }
+
+    std::vector<std::string> Header(NumCol);
+    for (size_t c = 0; c < NumCol; c++) {
+        const mxArray *pCell = mxGetCell(prhs[1], c);
+        if (pCell == NULL || !mxIsChar(pCell)) {
+            mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input2: Header must be a 1xN cell of char.");
+        }
+        Header[c] = getString(pCell);
+    }
+    std::string FileName = getString(prhs[2]);
+    checkWriter(); //the file and its index must be complete before appending
+
+    //Get the index of the existing file, which is left at FooterEnd = 0 for a new file
+    col_index CI;
+    bool IsNew = true;
+    if (Append) {
+        mapped_file MF;
+        if (openMappedFile(FileName.c_str(), MF)) {
+            IsNew = MF.Size == 0;
+            bool HasIndex = readColIndex(MF.pData, MF.Size, CI);
+            closeMappedFile(MF);
+            if (!IsNew && !HasIndex) {
+                mexErrMsgIdAndTxt("writeColFileMEX:read", "Could not find the index of \"%s\". It is not a .bcol file.", FileName.c_str());
+            }
+            if (!IsNew && CI.Header != Header) {
+                mexErrMsgIdAndTxt("writeColFileMEX:prhs", "Input2: Header is not the same as the one in \"%s\".", FileName.c_str());
+            }
+        }
+    }
+    if (IsNew) {
+        CI = col_index();
+        CI.Header = Header;
+    }
+
+    std::string Buf;
+    encodeColBatch(prhs[0], Buf);
+    CI.BatchStart.push_back(CI.FooterEnd);
+    CI.BatchRows.push_back(mxGetM(prhs[0]));
+    CI.LastSeqNum.push_back(LastSeqNum);
+    CI.FooterEnd += Buf.size();
+    encodeColFooter(CI, Buf);
+
+    WRITE_JOB.FileName = FileName;
+    WRITE_JOB.Buf.swap(Buf);
+    WRITE_JOB.Start = CI.BatchStart.back();
+    WRITE_JOB.IsNew = IsNew;
+    if (Async) {
+        if (!EXIT_ADDED) {
+            mexAtExit(joinWriter); //finishes the write when the MEX file is cleared
+            EXIT_ADDED = true;
+        }
+        WRITER = std::thread(runWriter);
+        return;
+    }
+    bool Success = writeColJob(WRITE_JOB);
+    std::string().swap(WRITE_JOB.Buf);
+    if (!Success) {
+        mexErrMsgIdAndTxt("writeColFileMEX:write", "Could not create/write to the file \"%s\".", FileName.c_str());
+    }
+}
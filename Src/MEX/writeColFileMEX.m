@@ -0,0 +1,46 @@
+%writeColFileMEX will write or append a cell array to a BRILIA columnar
+%(.bcol) file, a binary checkpoint format that is much faster to append and
+%reopen than a delimited file. Each call adds 1 batch, and the file footer
+%indexes all the batches so that a resumed job can find the last SeqNum
+%without reading the data. See ColFileTool for the file layout.
+%
+%  writeColFileMEX(CellData, Header, OutputFile)
+%
+%  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum)
+%
+%  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum, 'append')
+%
+%  writeColFileMEX(CellData, Header, OutputFile, LastSeqNum, 'append', 'async')
+%
+%  writeColFileMEX('flush')
+%
+%  INPUT
+%    CellData: MxN cell array of [], double, char, or logical values. Any
+%      column of only scalars or only 1-row chars is stored more compactly.
+%    Header: 1xN cell of column names
+%    OutputFile: full name of the file to be saved to
+%    LastSeqNum [NaN]: the last SeqNum processed by this batch, which is
+%      stored in the footer (ex: a batch with all bad seq has 0 rows but
+%      still moves the resume point)
+%    'append': appends a batch to the outfile instead of overwriting. The
+%      Header must be the same as the one in the file.
+%    'async': encodes the batch, then returns while a background thread
+%      writes it and the new footer to the file. The next call waits for
+%      this write first, so at most 1 batch is pending. A failed write is
+%      reported by the next call.
+%    'flush': waits until the async write is done. Use this before reading,
+%      moving, or checking the size of the file.
+%
+%  EXAMPLE
+%    CellData = {'Seq1', 1, [3 4]; 'Seq2', [], 5};
+%    writeColFileMEX(CellData, {'SeqName', 'SeqNum', 'VMapNum'}, 'Test.bcol', 2)
+%    writeColFileMEX(CellData(1, :), {'SeqName', 'SeqNum', 'VMapNum'}, 'Test.bcol', 3, 'append')
+%    [CellData, Header, Info] = readColFileMEX('Test.bcol');
+%    Info =
+%      struct with fields:
+%        BatchRows: [2x1 double]
+%       LastSeqNum: [2x1 double]
+%
+%  See also readColFileMEX, saveSeqData, openSeqData
+%
+%
@@ -0,0 +1,193 @@
+/*
+writeDlmFileMEX will write a cell array into a delimited file. The whole
+cell array is formatted into one memory buffer and then written to the file
+at once, which is much faster than writing each row with fprintf. Numbers
+are formatted like mat2str, and any delimiter character in a string is
+replaced with a '|' to ensure the delimiter number is not ruined.
+
+  writeDlmFileMEX(CellData, OutputFile)
+
+  writeDlmFileMEX(CellData, OutputFile, Delimiter)
+
+  writeDlmFileMEX(CellData, OutputFile, Delimiter, 'append')
+
+  writeDlmFileMEX(CellData, OutputFile, Delimiter, 'append', 'async')
+
+  writeDlmFileMEX('flush')
+
+  INPUT
+    CellData: cell array (but must not have a cell in a cell)
+    OutputFile: full name of the file to be saved to
+    Delimiter [',' ';' '\t']: Default is ','
+    'append': appends to the outfile instead of overwriting.
+    'async': formats the data, then returns while a background thread
+      writes it to the file. Writes are done in the order they were given.
+      If more than BRILIA_PIPE_MB (default 256 MB, see getPipeBudget in
+      ThreadTool) is waiting to be written, this waits for the older writes
+      first. A failed write is reported by the next call.
+    'flush': waits until all async writes are done. Use this before
+      reading, moving, or checking the size of the file.
+
+  EXAMPLE
+    CellData = {'SeqName', 'SeqNum', 'VMapNum'; 'Seq1', 1, [3 4]};
+    writeDlmFileMEX(CellData, 'Test.csv', ',')
+    %Test.csv contains:
+    %  SeqName,SeqNum,VMapNum
+    %  Seq1,1,[3 4]
+
+  See also writeDlmFile, readDlmFileMEX
+*/
+
+#include "DlmTool.hpp"
+#include "ThreadTool.hpp"
+#include <string>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <utility>
+
+// write_job stores 1 formatted buffer to write in the background
+struct write_job {
+    std::string FileName;
+    std::string Buf;
+    bool Append;
+};
+
+static std::thread WRITER;
+static std::mutex WRITE_MUTEX;
+static std::condition_variable WRITE_CV;   //signals new jobs or a stop to the writer
+static std::condition_variable DONE_CV;    //signals a finished job to the main thread
+static std::deque<write_job> WRITE_QUEUE;
+static size_t QUEUED_BYTES = 0;            //includes the job being written
+static bool STOP_WRITER = false;
+static std::string FAILED_FILE;            //1st file that could not be written
+
+static void runWriter() {
+    std::unique_lock<std::mutex> Lock(WRITE_MUTEX);
+    while (true) {
+        WRITE_CV.wait(Lock, [] { return STOP_WRITER || !WRITE_QUEUE.empty(); });
+        if (WRITE_QUEUE.empty()) { return; }
+        write_job &Job = WRITE_QUEUE.front();
+        Lock.unlock();
+        bool Success = writeBuffer(Job.FileName.c_str(), Job.Buf, Job.Append);
+        Lock.lock();
+        if (!Success && FAILED_FILE.empty()) { FAILED_FILE = Job.FileName; }
+        QUEUED_BYTES -= Job.Buf.size();
+        WRITE_QUEUE.pop_front();
+        DONE_CV.notify_all();
+    }
+}
+
+// Waits until at most MaxBytes are queued, and returns any failed file name
+static std::string waitWriter(size_t MaxBytes) {
+    std::unique_lock<std::mutex> Lock(WRITE_MUTEX);
+    DONE_CV.wait(Lock, [&] { return QUEUED_BYTES <= MaxBytes || WRITE_QUEUE.empty(); });
+    std::string Failed;
+    Failed.swap(FAILED_FILE);
+    return Failed;
+}
+
+static void stopWriter() {
+    if (!WRITER.joinable()) { return; }
+    {
+        std::lock_guard<std::mutex> Lock(WRITE_MUTEX);
+        STOP_WRITER = true;
+    }
+    WRITE_CV.notify_all();
+    WRITER.join(); //finishes the queued jobs first
+    STOP_WRITER = false;
+}
+
+static void checkWriter(size_t MaxBytes) {
+    std::string Failed = waitWriter(MaxBytes);
+    if (!Failed.empty()) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:write", "Could not create/write to the file \"%s\".", Failed.c_str());
+    }
+}
+
+void mexFunction(int nlhs,        mxArray *plhs[],
+                 int nrhs, const  mxArray *prhs[]) {
+
+    (void) plhs; //no outputs
+
+    if (nrhs < 1 || nrhs > 5) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:nrhs", "Incorrect number of inputs. Min is 1. Max is 5.");
+    }
+    if (nlhs > 0) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:nlhs", "Too many outputs. Max is 0.");
+    }
+    if (nrhs == 1 && mxIsChar(prhs[0])) {
+        char *pCmd = mxArrayToString(prhs[0]);
+        std::string Cmd(pCmd);
+        mxFree(pCmd);
+        if (Cmd != "flush") {
+            mexErrMsgIdAndTxt("writeDlmFileMEX:prhs", "Input1: Unknown command \"%s\".", Cmd.c_str());
+        }
+        checkWriter(0);
+        return;
+    }
+    if (nrhs < 2) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:nrhs", "Incorrect number of inputs. Min is 2.");
+    }
+    if (!mxIsCell(prhs[0])) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:prhs", "Input1: CellData must be a cell array.");
+    }
+    if (!mxIsChar(prhs[1])) {
+        mexErrMsgIdAndTxt("writeDlmFileMEX:prhs", "Input2: OutputFile must be a char array.");
+    }
+
+    char Delim = nrhs >= 3 ? getDelimiter(prhs[2]) : ',';
+    if (Delim == 0) { Delim = ','; }
+
+    bool Append = false, Async = false;
+    for (int k = 3; k < nrhs; k++) {
+        if (!mxIsChar(prhs[k])) { mexErrMsgIdAndTxt("writeDlmFileMEX:prhs", "Input%d: Must be 'append' or 'async'.", k + 1); }
+        mxChar *pStr = mxGetChars(prhs[k]);
+        mwSize Len = mxGetNumberOfElements(prhs[k]);
+        if (Len > 1 && (pStr[0] == 'a' || pStr[0] == 'A')) {
+            if (pStr[1] == 'p' || pStr[1] == 'P') { Append = true; }
+            if (pStr[1] == 's' || pStr[1] == 'S') { Async = true; }
+        }
+    }
+
+    mwSize M = mxGetM(prhs[0]);
+    mwSize N = mxGetN(prhs[0]);
+    std::string Buf;
+    Buf.reserve(M * N * 8);
+    for (mwSize r = 0; r < M; r++) {
+        for (mwSize c = 0; c < N; c++) {
+            if (c > 0) { Buf += Delim; }
+            appendCellValue(Buf, mxGetCell(prhs[0], r + c*M), Delim);
+        }
+        Buf += '\n';
+    }
+
+    char *pFileName = mxArrayToString(prhs[1]);
+    std::string FileName(pFileName);
+    mxFree(pFileName);
+
+    if (!Async) {
+        checkWriter(0); //keep the write order with any async writes
+        if (!writeBuffer(FileName.c_str(), Buf, Append)) {
+            mexErrMsgIdAndTxt("writeDlmFileMEX:write", "Could not create/write to the file.");
+        }
+        return;
+    }
+
+    //Backpressure: wait until there is room in the budget for this buffer
+    size_t Budget = getPipeBudget();
+    checkWriter(Buf.size() < Budget ? Budget - Buf.size() : 0);
+    {
+        std::lock_guard<std::mutex> Lock(WRITE_MUTEX);
+        QUEUED_BYTES += Buf.size();
+        write_job Job = {FileName, std::string(), Append};
+        Job.Buf.swap(Buf);
+        WRITE_QUEUE.push_back(std::move(Job));
+    }
+    if (!WRITER.joinable()) {
+        addExitFunc(stopWriter); //finishes the queued writes when the MEX file is cleared
+        WRITER = std::thread(runWriter);
+    }
+    WRITE_CV.notify_one();
+}
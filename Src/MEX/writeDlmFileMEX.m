@@ -0,0 +1,39 @@
+%writeDlmFileMEX will write a cell array into a delimited file. The whole
+%cell array is formatted into one memory buffer and then written to the file
+%at once, which is much faster than writing each row with fprintf. Numbers
+%are formatted like mat2str, and any delimiter character in a string is
+%replaced with a '|' to ensure the delimiter number is not ruined.
+%
+%  writeDlmFileMEX(CellData, OutputFile)
+%
+%  writeDlmFileMEX(CellData, OutputFile, Delimiter)
+%
+%  writeDlmFileMEX(CellData, OutputFile, Delimiter, 'append')
+%
+%  writeDlmFileMEX(CellData, OutputFile, Delimiter, 'append', 'async')
+%
+%  writeDlmFileMEX('flush')
+%
+%  INPUT
+%    CellData: cell array (but must not have a cell in a cell)
+%    OutputFile: full name of the file to be saved to
+%    Delimiter [',' ';' '\t']: Default is ','
+%    'append': appends to the outfile instead of overwriting.
+%    'async': formats the data, then returns while a background thread
+%      writes it to the file. Writes are done in the order they were given.
+%      If more than BRILIA_PIPE_MB (default 256 MB, see getPipeBudget in
+%      ThreadTool) is waiting to be written, this waits for the older writes
+%      first. A failed write is reported by the next call.
+%    'flush': waits until all async writes are done. Use this before
+%      reading, moving, or checking the size of the file.
+%
+%  EXAMPLE
+%    CellData = {'SeqName', 'SeqNum', 'VMapNum'; 'Seq1', 1, [3 4]};
+%    writeDlmFileMEX(CellData, 'Test.csv', ',')
+%    %Test.csv contains:
+%    %  SeqName,SeqNum,VMapNum
+%    %  Seq1,1,[3 4]
+%
+%  See also writeDlmFile, readDlmFileMEX
+%
+%
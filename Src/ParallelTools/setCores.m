@@ -9,6 +9,9 @@
 %
 %  INPUT
 %    NumCores [N or 'max']: N or max number of processors to use.
+%      This also sets the number of threads used by the MEX kernels. The
+%      pool workers use 1 MEX thread each, since a parfor already uses
+%      all NumCores.
 %
 %  OUTPUT
 %    Success: 1 for successful or 0 for not successful
@@ -38,6 +41,7 @@ if NumCores > MaxCores
 elseif NumCores < 1
     NumCores = 1;
 end
+setenv('BRILIA_NUM_THREADS', num2str(NumCores)); %Thread pool size of the MEX kernels (see ThreadTool)
 
 if ~isdeployed
     ps = parallel.Settings;
@@ -55,4 +59,10 @@ if ActiveCores ~= NumCores
             Success = 0;
         end
     end
+end
+
+%MEX kernels in a parfor must not also use NumCores threads per worker
+Pool = gcp('nocreate');
+if ~isempty(Pool)
+    wait(parfevalOnAll(Pool, @setenv, 0, 'BRILIA_NUM_THREADS', '1'));
 end
\ No newline at end of file
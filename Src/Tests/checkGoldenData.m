@@ -0,0 +1,81 @@
+%checkGoldenData will check the current BRILIA code against the golden
+%output of the MATLAB code that a native kernel replaced. The golden data
+%holds the test inputs too, so the old and new code run on the same data.
+%
+%  checkGoldenData(TestName, CaseName, MakeInput, Func, CmpIdx)
+%
+%  checkGoldenData(TestName, CaseName, MakeInput, Func, CmpIdx, Mode)
+%
+%  INPUT
+%    TestName: name of the test, which is also the golden file name in
+%      BRILIA/Src/Tests/Golden
+%    CaseName: name of the test case, which must be a valid field name
+%    MakeInput: function handle that returns the cell of Func inputs. It is
+%      only used in 'save' mode.
+%    Func: function handle of the code to check, Output = Func(Input{:}).
+%      Output is a cell with 1 row per seq. In 'save' mode, Func may return
+%      struct('Alt', {{Output1, Output2, ...}}) if a row can match any one
+%      of these outputs.
+%    CmpIdx: Output columns to compare, [] for all, or a function handle
+%      that returns these columns as CmpIdx(Input{:})
+%    Mode ['check' 'save']: 'save' runs Func and stores its inputs and
+%      output as the golden data of this case, instead of checking.
+%
+%  NOTE
+%    The golden data must come from the old code. Put the BRILIA version
+%    before the native kernels first on the path, keep this one after it
+%    for the tests and the kernels the old one lacks, and run each test
+%    with 'save' once:
+%      addpath(genpath(OldBRILIADir), '-begin')
+%      testFindCDRMEX('MouseH', 'save')
+%
+function checkGoldenData(TestName, CaseName, MakeInput, Func, CmpIdx, Mode)
+if nargin < 6
+    Mode = 'check';
+end
+GoldenFile = fullfile(fileparts(mfilename('fullpath')), 'Golden', [TestName '.mat']);
+
+if strcmpi(Mode, 'save')
+    Input = MakeInput();
+    Output = Func(Input{:});
+    if isstruct(Output)
+        Output = Output.Alt;
+    else
+        Output = {Output};
+    end
+    Golden = struct;
+    if exist(GoldenFile, 'file')
+        load(GoldenFile, 'Golden');
+    elseif ~isdir(fileparts(GoldenFile))
+        mkdir(fileparts(GoldenFile));
+    end
+    Golden.(CaseName) = struct('Input', {Input}, 'Output', {Output});
+    save(GoldenFile, 'Golden');
+    fprintf('%s: %s saved for %d seq.\n', TestName, CaseName, size(Output{1}, 1));
+    return
+end
+
+assert(exist(GoldenFile, 'file') > 0, '%s: No golden data in "%s". Run %s(..., ''save'') with the old BRILIA first on the path.', TestName, GoldenFile, TestName);
+S = load(GoldenFile, 'Golden');
+assert(isfield(S.Golden, CaseName), '%s: No golden data for %s. Run %s(..., ''save'') with the old BRILIA first on the path.', TestName, CaseName, TestName);
+Input = S.Golden.(CaseName).Input;
+Output = S.Golden.(CaseName).Output;
+
+NewOutput = Func(Input{:});
+if isa(CmpIdx, 'function_handle')
+    CmpIdx = CmpIdx(Input{:});
+elseif isempty(CmpIdx)
+    CmpIdx = 1:size(NewOutput, 2);
+end
+assert(size(NewOutput, 1) == size(Output{1}, 1), '%s: %s has %d rows instead of %d.', TestName, CaseName, size(NewOutput, 1), size(Output{1}, 1));
+
+DiffLoc = true(size(NewOutput, 1), 1);
+for a = 1:length(Output)
+    IsSame = cellfun(@(x, y) (isempty(x) && isempty(y)) || isequal(x, y), NewOutput(:, CmpIdx), Output{a}(:, CmpIdx));
+    DiffLoc = DiffLoc & ~all(IsSame, 2);
+end
+for j = find(DiffLoc)'
+    fprintf('%s: %s differs at row %d.\n', TestName, CaseName, j);
+end
+assert(~any(DiffLoc), '%s: %s has %d of %d different rows.', TestName, CaseName, sum(DiffLoc), length(DiffLoc));
+fprintf('%s: %s passed for %d seq.\n', TestName, CaseName, length(DiffLoc));
@@ -0,0 +1,63 @@
+%prepTestData will run the first BRILIA annotation steps on an example
+%file, to make the VDJdata used to test a native kernel against the golden
+%output of the MATLAB code it replaced (see checkGoldenData).
+%
+%  [VDJdata, Map, DB] = prepTestData(Example)
+%
+%  [VDJdata, Map, DB] = prepTestData(Example, Stage)
+%
+%  INPUT
+%    Example: example folder name in BRILIA/Examples (ex: 'MouseH')
+%    Stage ['match']: last step to run
+%      'fix'      convertInput2VDJdata and fixInputSeq
+%      'seed'     + seedAllCDR3position
+%      'match'    + findVDJmatch and findVJmatch
+%      'indel'    + fixGeneIndel
+%      'degen'    + fixDegenVDJ and constrainGeneVJ
+%
+%  OUTPUT
+%    VDJdata: BRILIA data cell of the example sequences. Sequences that
+%      are labeled bad by any of the steps are removed.
+%    Map: structure of BRILIA data header index
+%    DB: gene database structure of the example species
+%
+function [VDJdata, Map, DB] = prepTestData(Example, Stage)
+if nargin < 2
+    Stage = 'match';
+end
+StageList = {'fix', 'seed', 'match', 'indel', 'degen'};
+StageNum = find(strcmpi(StageList, Stage));
+assert(~isempty(StageNum), '%s: Unknown Stage "%s".', mfilename, Stage);
+
+ExampleDir = fullfile(findRoot, 'Examples', Example);
+FileName = dir2(fullfile(ExampleDir, '*.*'), 'file');
+[~, ~, FileExt] = cellfun(@parseFileName, FileName, 'UniformOutput', false);
+FileName = FileName(startsWith(FileExt, {'.fa', '.csv'}, 'ignorecase', true));
+assert(~isempty(FileName), '%s: No example file in "%s".', mfilename, ExampleDir);
+
+CapIdx = find(isstrprop(Example, 'upper'));
+Species = Example(1:CapIdx(2)-1);
+Chain = Example(CapIdx(2):end);
+DB = getGeneDatabase(Species);
+
+[VDJdata, ~, ~, ~, Map, BadLoc] = convertInput2VDJdata(FileName{1}, 'Chain', Chain);
+if isempty(BadLoc)
+    [VDJdata, BadLoc] = fixInputSeq(VDJdata, Map);
+end
+VDJdata = VDJdata(~BadLoc, :);
+
+if StageNum >= 2
+    VDJdata = seedAllCDR3position(VDJdata, Map, DB, 'n');
+end
+if StageNum >= 3
+    [VDJdata, BadLoc1] = findVDJmatch(VDJdata, Map, DB, 'Update', 'Y');
+    [VDJdata, BadLoc2] = findVJmatch(VDJdata, Map, DB, 'Update', 'Y');
+    VDJdata = VDJdata(~(BadLoc1 | BadLoc2), :);
+end
+if StageNum >= 4
+    VDJdata = fixGeneIndel(VDJdata, Map, DB);
+end
+if StageNum >= 5
+    VDJdata = fixDegenVDJ(VDJdata, Map, DB);
+    VDJdata = constrainGeneVJ(VDJdata, Map, DB);
+end
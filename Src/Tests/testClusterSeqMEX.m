@@ -0,0 +1,53 @@
+%testClusterSeqMEX will check that clusterSeqMEX links the same CDR3s as
+%an all-pairs search, when every CDR3 has the same C and W anchors. These
+%anchor positions never differ, so clusterSeqMEX leaves them out of the
+%segments used to find the pairs to compare.
+%
+%  testClusterSeqMEX
+%
+%  testClusterSeqMEX(K)
+%
+%  INPUT
+%    K [1 2]: max number of mismatched letters, or a vector of these
+%
+function testClusterSeqMEX(K)
+if nargin == 0
+    K = [1 2];
+end
+rng(1);
+AA = 'ACDEFGHIKLMNPQRSTVWY';
+NumSeq = 2000;
+
+%Make CDR3s of 8 to 10 aa with the same anchors, and some 1-letter variants
+Seq = cell(NumSeq, 1);
+for j = 1:NumSeq
+    Seq{j} = ['CAR' AA(randi(20, 1, randi([3 5]))) 'W'];
+    if j > 1 && rand < 0.3
+        Seq{j} = Seq{randi(j-1)};
+        Pos = randi([4 length(Seq{j})-1]);
+        Seq{j}(Pos) = AA(randi(20));
+    end
+end
+
+for k = 1:length(K)
+    ClustNum = clusterSeqMEX(Seq, K(k));
+
+    %Single-linkage clusters of all pairs of the same length within K letters
+    SeqLen = cellfun('length', Seq);
+    Link = zeros(NumSeq);
+    for j = 1:NumSeq
+        SameLoc = SeqLen == SeqLen(j);
+        SameLoc(j) = 0;
+        SameIdx = find(SameLoc);
+        MissCt = sum(vertcat(Seq{SameIdx}) ~= Seq{j}, 2);
+        Link(j, SameIdx(MissCt <= K(k))) = 1;
+    end
+    RefNum = conncomp(graph(Link | Link'))';
+
+    %Both must group the seqs the same way, even if the numbers differ
+    [~, ~, A] = unique(ClustNum);
+    [~, ~, B] = unique(RefNum);
+    IsSame = max(A) == max(B) && size(unique([A B], 'rows'), 1) == max(A);
+    assert(IsSame, '%s: K = %d gives %d clusters instead of %d.', mfilename, K(k), max(A), max(B));
+    fprintf('%s: K = %d passed with %d clusters of %d seq.\n', mfilename, K(k), max(A), NumSeq);
+end
@@ -0,0 +1,50 @@
+%testFindCDRMEX will check that findCDR, which now uses findCDRMEX, gives
+%the same CDR1/2/3 info as the MATLAB findCDR it replaced. See
+%checkGoldenData for the golden data.
+%
+%  testFindCDRMEX
+%
+%  testFindCDRMEX(Example)
+%
+%  testFindCDRMEX(Example, Mode)
+%
+%  INPUT
+%    Example ['MouseH']: example folder name, or a cell of names
+%    Mode ['check' 'save']: 'save' stores the findCDR output as the golden
+%      data
+%
+%  NOTE
+%    The old findCDR uses nt2aa from the Bioinformatics Toolbox.
+%
+function testFindCDRMEX(Example, Mode)
+if nargin < 1 || isempty(Example)
+    Example = 'MouseH';
+end
+if nargin < 2
+    Mode = 'check';
+end
+Example = cellstr(Example);
+
+for e = 1:length(Example)
+    for UseIMGT = [false true]
+        CaseName = sprintf('%s_IMGT%d', Example{e}, UseIMGT);
+        checkGoldenData(mfilename, CaseName, @() makeInput(Example{e}, UseIMGT), @findCDR, @getCmpIdx, Mode);
+    end
+end
+
+%Clear the CDR info of the annotated example
+function Input = makeInput(Example, UseIMGT)
+[VDJdata, Map, DB] = prepTestData(Example, 'match');
+VDJdata(:, getCmpIdx(VDJdata, Map)) = {[]};
+if UseIMGT
+    Input = {VDJdata, Map, DB, 1:3, 'imgt'};
+else
+    Input = {VDJdata, Map, DB, 1:3};
+end
+
+function CmpIdx = getCmpIdx(~, Map, varargin)
+CmpIdx = [];
+for c = 1:length(Map.Chain)
+    C = lower(Map.Chain(c));
+    CmpIdx = [CmpIdx Map.([C 'CDR1']) Map.([C 'CDR2']) Map.([C 'CDR3'])];
+end
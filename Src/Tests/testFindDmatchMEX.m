@@ -0,0 +1,75 @@
+%testFindDmatchMEX will check that findDmatchMEX gives the same D gene
+%match as findGeneMatch(Seq, Dmap, 'D', MissRate), which it replaced in
+%findVDJmatch and findBetterD. The N-D-N windows are taken from the
+%annotated heavy chain examples, with 0 to 3 nt of the V and J ends added
+%(as findBetterD does). See checkGoldenData for the golden data.
+%
+%  testFindDmatchMEX
+%
+%  testFindDmatchMEX(Example)
+%
+%  testFindDmatchMEX(Example, Mode)
+%
+%  INPUT
+%    Example ['MouseH']: example folder name, or a cell of names
+%    Mode ['check' 'save']: 'save' stores the findGeneMatch output as the
+%      golden data
+%
+function testFindDmatchMEX(Example, Mode)
+if nargin < 1 || isempty(Example)
+    Example = 'MouseH';
+end
+if nargin < 2
+    Mode = 'check';
+end
+Example = cellstr(Example);
+if strcmpi(Mode, 'save')
+    Func = @matchEachWindow;
+else
+    Func = @matchAllWindow;
+end
+
+for e = 1:length(Example)
+    for MissRate = [0 0.15 1]
+        CaseName = sprintf('%s_Miss%03d', Example{e}, round(100*MissRate));
+        checkGoldenData(mfilename, CaseName, @() makeInput(Example{e}, MissRate), Func, [], Mode);
+    end
+end
+
+%Make the N-D-N windows of an example
+function Input = makeInput(Example, MissRate)
+[VDJdata, Map, DB] = prepTestData(Example, 'match');
+Window = cell(size(VDJdata, 1), 16);
+for j = 1:size(VDJdata, 1)
+    Seq = VDJdata{j, Map.hSeq};
+    Vlen = VDJdata{j, Map.hLength(1)};
+    Jlen = VDJdata{j, Map.hLength(5)};
+    [Vcut, Jcut] = ndgrid(0:3, 0:3);
+    for k = 1:numel(Vcut)
+        Window{j, k} = Seq(max(1, Vlen-Vcut(k)+1):min(end, end-Jlen+Jcut(k)));
+    end
+end
+Window = Window(~cellfun('isempty', Window));
+Input = {Window, DB.Dmap, DB.MapHeader, MissRate};
+
+%D matches as a cell of [Dnum DrefLMR DsamLMR Dscore], 1 row per window
+function Match = matchEachWindow(Window, Dmap, ~, MissRate)
+Match = cell(length(Window), 4);
+for q = 1:length(Window)
+    Dmatch = findGeneMatch(Window{q}, Dmap, 'D', MissRate);
+    Match{q, 1} = sort(Dmatch{1}(:));
+    if ~isempty(Dmatch{1})
+        Match(q, 2:4) = Dmatch(3:5);
+    end
+end
+
+function Match = matchAllWindow(Window, Dmap, MapHeader, MissRate)
+M = getMapHeaderVar(MapHeader);
+[Dnum, DrefLMR, DsamLMR, Dscore] = findDmatchMEX(Window, Dmap(:, M.Seq), MissRate);
+Match = cell(length(Window), 4);
+for q = 1:length(Window)
+    Match{q, 1} = sort(Dnum{q}(:));
+    if ~isempty(Dnum{q})
+        Match(q, 2:4) = {DrefLMR(q, :), DsamLMR(q, :), Dscore(q, :)};
+    end
+end
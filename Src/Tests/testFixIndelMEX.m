@@ -0,0 +1,67 @@
+%testFixIndelMEX will check that fixGeneIndel, which now uses fixIndelMEX,
+%fixes the same V gene indels as the swalign code it replaced. Each V
+%segment of the annotated examples gets 1 random nt insertion or deletion,
+%and is then annotated again before the indel fix. See checkGoldenData
+%for the golden data.
+%
+%  testFixIndelMEX
+%
+%  testFixIndelMEX(Example)
+%
+%  testFixIndelMEX(Example, Mode)
+%
+%  INPUT
+%    Example ['MouseH']: example folder name, or a cell of names
+%    Mode ['check' 'save']: 'save' stores the fixGeneIndel output as the
+%      golden data
+%
+%  NOTE
+%    The old fixGeneIndel uses swalign from the Bioinformatics Toolbox.
+%
+function testFixIndelMEX(Example, Mode)
+if nargin < 1 || isempty(Example)
+    Example = 'MouseH';
+end
+if nargin < 2
+    Mode = 'check';
+end
+Example = cellstr(Example);
+
+for e = 1:length(Example)
+    checkGoldenData(mfilename, Example{e}, @() makeInput(Example{e}), @fixGeneIndel, @getCmpIdx, Mode);
+end
+
+%Add 1 indel to each V segment, and annotate these seqs again
+function Input = makeInput(Example)
+rng(1);
+NT = 'ACGT';
+[VDJdata, Map, DB] = prepTestData(Example, 'match');
+for k = 1:length(Map.Chain)
+    C = lower(Map.Chain(k));
+    SeqLoc = Map.([C 'Seq']);
+    VLengthLoc = Map.([C 'Length'])(1);
+    for j = 1:size(VDJdata, 1)
+        Vlen = VDJdata{j, VLengthLoc};
+        if isempty(Vlen) || Vlen < 60; continue; end
+        Seq = VDJdata{j, SeqLoc};
+        Pos = randi([20 Vlen-20]);
+        if rand < 0.5
+            Seq(Pos) = [];
+        else
+            Seq = [Seq(1:Pos) NT(randi(4)) Seq(Pos+1:end)];
+        end
+        VDJdata{j, SeqLoc} = Seq;
+    end
+end
+[VDJdata, BadLoc1] = findVDJmatch(VDJdata, Map, DB, 'Update', 'Y');
+[VDJdata, BadLoc2] = findVJmatch(VDJdata, Map, DB, 'Update', 'Y');
+VDJdata = VDJdata(~(BadLoc1 | BadLoc2), :);
+Input = {VDJdata, Map, DB};
+
+%Compare the seq and the V, M lengths of each chain
+function CmpIdx = getCmpIdx(~, Map, ~)
+CmpIdx = [];
+for k = 1:length(Map.Chain)
+    C = lower(Map.Chain(k));
+    CmpIdx = [CmpIdx Map.([C 'Seq']) Map.([C 'Length'])(1:2)];
+end
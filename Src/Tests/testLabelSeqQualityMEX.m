@@ -0,0 +1,60 @@
+%testLabelSeqQualityMEX will check that labelSeqQuality, which now uses
+%labelSeqQualityMEX, gives the same Y/N/M/I labels as the MATLAB
+%labelSeqQuality it replaced. Besides the annotated examples, it tests
+%copies with a TAG stop codon put in the V frame, and copies with a CDR3
+%end that is 1 nt short, to cover the M and N labels. See checkGoldenData
+%for the golden data.
+%
+%  testLabelSeqQualityMEX
+%
+%  testLabelSeqQualityMEX(Example)
+%
+%  testLabelSeqQualityMEX(Example, Mode)
+%
+%  INPUT
+%    Example ['MouseH']: example folder name, or a cell of names
+%    Mode ['check' 'save']: 'save' stores the labelSeqQuality output as
+%      the golden data
+%
+%  NOTE
+%    The old labelSeqQuality uses nt2aa from the Bioinformatics Toolbox.
+%
+function testLabelSeqQualityMEX(Example, Mode)
+if nargin < 1 || isempty(Example)
+    Example = 'MouseH';
+end
+if nargin < 2
+    Mode = 'check';
+end
+Example = cellstr(Example);
+
+for e = 1:length(Example)
+    for ThreshHold = [0.4 0.1]
+        CaseName = sprintf('%s_Thresh%03d', Example{e}, round(100*ThreshHold));
+        checkGoldenData(mfilename, CaseName, @() makeInput(Example{e}, ThreshHold), @labelSeqQuality, @getCmpIdx, Mode);
+    end
+end
+
+%Add the stop codon and short CDR3 copies to the annotated example
+function Input = makeInput(Example, ThreshHold)
+rng(1);
+[VDJdata, Map, ~] = prepTestData(Example, 'degen');
+Map = getVDJmapper(Map);
+C = lower(Map.Chain(1));
+SeqIdx = Map.([C 'Seq']);
+CDR3Idx = Map.([C 'CDR3']);
+
+StopData = VDJdata;
+for j = 1:size(StopData, 1)
+    CDR3S = StopData{j, CDR3Idx(3)};
+    if isempty(CDR3S) || CDR3S < 4; continue; end
+    Pos = CDR3S - 3*randi(floor((CDR3S-1)/3));
+    StopData{j, SeqIdx}(Pos:Pos+2) = 'TAG';
+end
+FrameData = VDJdata;
+HasCDR3E = ~cellfun('isempty', FrameData(:, CDR3Idx(4)));
+FrameData(HasCDR3E, CDR3Idx(4)) = num2cell([FrameData{HasCDR3E, CDR3Idx(4)}]' - 1);
+Input = {[VDJdata; StopData; FrameData], Map, ThreshHold};
+
+function CmpIdx = getCmpIdx(~, Map, ~)
+CmpIdx = cellfun(@(x) Map.([x 'Funct']), num2cell(lower(Map.Chain)));
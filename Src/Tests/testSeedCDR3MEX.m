@@ -0,0 +1,81 @@
+%testSeedCDR3MEX will check that seedAllCDR3position, which uses
+%seedCDR3MEX, seeds the same CDR3 start and end positions as the 4
+%seedCDR3position calls BRILIA used before. Heavy chain seeds must be the
+%same. A light chain read may instead get the seeds of only the kappa or
+%lambda genes, after the locus vote. Half of the seqs are reverse
+%complemented to test the CheckSeqDir = 'y' direction fix too. See
+%checkGoldenData for the golden data.
+%
+%  testSeedCDR3MEX
+%
+%  testSeedCDR3MEX(Example)
+%
+%  testSeedCDR3MEX(Example, Mode)
+%
+%  INPUT
+%    Example [{'MouseH', 'MouseL', 'MouseHL'}]: example folder name, or a
+%      cell of names
+%    Mode ['check' 'save']: 'save' stores the seedCDR3position output as
+%      the golden data
+%
+%  NOTE
+%    seqrcomplement is from the Bioinformatics Toolbox.
+%
+function testSeedCDR3MEX(Example, Mode)
+if nargin < 1 || isempty(Example)
+    Example = {'MouseH', 'MouseL', 'MouseHL'};
+end
+if nargin < 2
+    Mode = 'check';
+end
+Example = cellstr(Example);
+if strcmpi(Mode, 'save')
+    Func = @seedEachLocus;
+else
+    Func = @seedAllCDR3position;
+end
+
+for e = 1:length(Example)
+    for CheckSeqDir = 'ny'
+        CaseName = sprintf('%s_Dir%s', Example{e}, CheckSeqDir);
+        checkGoldenData(mfilename, CaseName, @() makeInput(Example{e}, CheckSeqDir), Func, @getCmpIdx, Mode);
+    end
+end
+
+%Clear the CDR3 seeds, and reverse complement half of the seqs if needed
+function Input = makeInput(Example, CheckSeqDir)
+[VDJdata, Map, DB] = prepTestData(Example, 'fix');
+for c = 1:length(Map.Chain)
+    C = lower(Map.Chain(c));
+    VDJdata(:, Map.([C 'CDR3'])(3:4)) = {[]};
+    if CheckSeqDir == 'y'
+        VDJdata(1:2:end, Map.([C 'Seq'])) = cellfun(@seqrcomplement, VDJdata(1:2:end, Map.([C 'Seq'])), 'un', 0);
+    end
+end
+Input = {VDJdata, Map, DB, CheckSeqDir};
+
+%The old seeds, and the kappa-only and lambda-only seeds of the
+%direction-fixed light seqs
+function Seeds = seedEachLocus(VDJdata, Map, DB, CheckSeqDir)
+OldData = seedCDR3position(VDJdata, Map, DB, 'V',     40,  2, CheckSeqDir);
+OldData = seedCDR3position(OldData, Map, DB, 'J',      3, 14, 'n');
+OldData = seedCDR3position(OldData, Map, DB, 'Vk,Vl', 40,  2, CheckSeqDir);
+OldData = seedCDR3position(OldData, Map, DB, 'Jk,Jl',  3, 14, 'n');
+
+OldK = OldData;
+if contains(Map.Chain, 'L', 'ignorecase', true)
+    OldK(:, Map.lCDR3(3:4)) = {[]};
+end
+OldL = OldK;
+OldK = seedCDR3position(OldK, Map, DB, 'Vk', 40,  2, 'n');
+OldK = seedCDR3position(OldK, Map, DB, 'Jk',  3, 14, 'n');
+OldL = seedCDR3position(OldL, Map, DB, 'Vl', 40,  2, 'n');
+OldL = seedCDR3position(OldL, Map, DB, 'Jl',  3, 14, 'n');
+Seeds = struct('Alt', {{OldData, OldK, OldL}});
+
+function CmpIdx = getCmpIdx(~, Map, varargin)
+CmpIdx = [];
+for c = 1:length(Map.Chain)
+    C = lower(Map.Chain(c));
+    CmpIdx = [CmpIdx Map.([C 'Seq']) Map.([C 'CDR3'])(3:4)];
+end